@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Host implementation of Astar_runJobs. Instead of running the path searches
+// submitted one after the other within the time of a frame, they are all run
+// to completion side by side on a pool of threads, the calling thread taking
+// part. Astar_runJobs only returns once every search is done, so the game logic
+// sees the results at that fixed point in the frame whatever the number of
+// threads, and a simulation turns out the same however many are used.
+
+#include "astar.h"
+#if !defined(REMOVE_ASTAR_PATHFINDING) && defined(ASTAR_THREADS)
+
+#include <pthread.h>
+#include <unistd.h>
+
+static pthread_mutex_t jobsMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobsAvailable = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t jobsDone = PTHREAD_COND_INITIALIZER;
+
+static int runnableJob[ASTAR_SEARCHES];
+static int amountOfRunnableJobs;
+static int nextRunnableJob;      // the next of the runnable jobs to be taken by a thread
+static int amountOfJobsRunning;  // the runnable jobs not done yet
+static int amountOfWorkers;      // the threads started besides the calling one
+static int jobThreads;           // 0 until set
+
+
+void Astar_setThreads(unsigned int threads) {
+    long processors;
+
+    if (threads == 0) {
+        processors = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (processors > 0) ? processors : 1;
+    }
+    jobThreads = (threads < ASTAR_SEARCHES) ? threads : ASTAR_SEARCHES;
+}
+
+// to be called with jobsMutex locked. runs the runnable jobs not yet taken by another thread
+static void takeRunnableJobs() {
+    int job;
+
+    while (nextRunnableJob < amountOfRunnableJobs) {
+        job = runnableJob[nextRunnableJob++];
+        pthread_mutex_unlock(&jobsMutex);
+        Astar_completeJob(job);
+        pthread_mutex_lock(&jobsMutex);
+        if (--amountOfJobsRunning == 0)
+            pthread_cond_signal(&jobsDone);
+    }
+}
+
+static void *runJobsWorker(void *arg) {
+    pthread_mutex_lock(&jobsMutex);
+    while (1) {
+        while (nextRunnableJob >= amountOfRunnableJobs)
+            pthread_cond_wait(&jobsAvailable, &jobsMutex);
+        takeRunnableJobs();
+    }
+    return 0;
+}
+
+void Astar_runJobs(void) {
+    pthread_t thread;
+    int job;
+
+    if (!jobThreads)
+        Astar_setThreads(0);
+
+    pthread_mutex_lock(&jobsMutex);
+    amountOfRunnableJobs = 0;
+    nextRunnableJob = 0;
+    for (job=0; job<ASTAR_SEARCHES; job++) {
+        if (Astar_pollJob(job) == AS_INCOMPLETE)
+            runnableJob[amountOfRunnableJobs++] = job;
+    }
+    amountOfJobsRunning = amountOfRunnableJobs;
+
+    // a single job is simply run by the calling thread
+    if (amountOfRunnableJobs > 1) {
+        while (amountOfWorkers < jobThreads - 1 && amountOfWorkers < amountOfRunnableJobs - 1 &&
+               !pthread_create(&thread, 0, runJobsWorker, 0)) {
+            pthread_detach(thread);
+            amountOfWorkers++;
+        }
+        pthread_cond_broadcast(&jobsAvailable);
+    }
+    takeRunnableJobs();
+    while (amountOfJobsRunning > 0)
+        pthread_cond_wait(&jobsDone, &jobsMutex);
+    pthread_mutex_unlock(&jobsMutex);
+}
+
+#endif
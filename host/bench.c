@@ -0,0 +1,483 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// rts4ds-bench: runs a set of stress scenarios headless and reports how long each
+// step of the game logic took per frame (p50, p99 and max), as well as how often
+// pathfinding had to continue into another frame. The results can be stored as
+// budgets and later be checked against, to catch performance regressions.
+//
+// usage: rts4ds-bench [-n frames] [-r runs] [-o budgets] [-c budgets] [-t tolerance] [<fs root> <project>]
+//   frames     number of frames to run each scenario for (default 1000)
+//   runs       number of times to run each scenario (default 3). per step, the
+//              fastest result of all runs is reported, to filter out noise caused
+//              by other processes on the host
+//   -o budgets write the measured p99 of each step as budgets to the given file
+//   -c budgets check the measured p99 of each step against the given file. exits
+//              with 1 if a step exceeded its budget by more than the tolerance
+//   tolerance  percentage a step may exceed its budget by (default 25)
+//   fs root    directory containing the project directory (default host/bench)
+//   project    name of the project directory within fs root (default stress)
+//
+// budgets file: one line per budget, consisting of scenario, step and p99 in
+// gameticks (see gameticks.h), e.g. "battle doUnitsLogic 5120". The step
+// "searchExtensions" holds the number of times pathfinding was allowed to
+// continue into another frame instead.
+//
+// Every scenario also records the path searches queued during its first run. Once
+// all runs are over, these are searched for again one by one, without time limit,
+// and reported as the step "astarSearch" along with the amount of searches that
+// would fit in a frame. The checksum of the paths found allows the open set
+// implementations of astar.c (see ASTAR_OPENSET_HEAP) to be compared: builds
+// using either should report the same checksum for scenarios that play out
+// the same regardless of timing, such as base. The searches are repeated with
+// Jump Point Search as step "astarSearchJPS"; it finds other paths than a plain
+// search does, but the total length of the paths should be the same.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "fileio.h"
+#include "factions.h"
+#include "environment.h"
+#include "projectiles.h"
+#include "structures.h"
+#include "units.h"
+#include "pathfinding.h"
+#include "firingpositions.h"
+#include "avoidance.h"
+#include "gameticks.h"
+#include "simulation.h"
+
+#define DEFAULT_BENCH_FRAMES     1000
+#define DEFAULT_BENCH_RUNS       3
+#define DEFAULT_BENCH_TOLERANCE  25
+#define DEFAULT_BENCH_FS_ROOT    "host/bench"
+#define DEFAULT_BENCH_PROJECT    "stress"
+#define BENCH_FACTION            "Bench"
+#define BENCH_NOISE_GAMETICKS    100 /* differences smaller than this (about 3 microseconds) are not considered a regression */
+#define BENCH_MAX_BUDGETS        128
+#define HOST_GAMETICKS_PER_MICROSECOND  33.513982
+#define BENCH_MAX_SEARCHES       8192
+
+// the total duration of a frame is reported as an additional step
+#define BENCH_STEPS              (SIMULATION_STEPS + 1)
+
+struct BenchScenario {
+    char *name;
+    int level;
+    int region;
+};
+
+struct BenchScenario benchScenario[] = {
+    { "battle",   1, 1 }, // 75 against 75 units, resulting in up to 150 projectiles
+    { "base",     2, 1 }, // 295 structures (the maximum) attacked by 60 tanks
+    { "orefield", 3, 1 }  // 140 harvesters (and one more per refinery) sharing a large ore field and two refineries
+};
+#define BENCH_SCENARIOS  (sizeof(benchScenario) / sizeof(struct BenchScenario))
+
+struct BenchBudget {
+    char scenario[32];
+    char step[32];
+    unsigned value;
+};
+
+struct BenchBudget benchBudget[BENCH_MAX_BUDGETS];
+int amountOfBenchBudgets;
+
+struct BenchSearch {
+    int unit_nr;
+    int start;
+    int dest;
+    bool attack;
+    int shootRange;
+};
+
+struct BenchSearchResults {
+    int found;
+    unsigned long long expanded;
+    unsigned long long length;  // of the paths found that were not searched for to attack
+    unsigned checksum;
+};
+
+struct BenchSearch benchSearch[BENCH_MAX_SEARCHES];
+struct BenchSearch *lastBenchSearch[MAX_UNITS_ON_MAP];
+int amountOfBenchSearches;
+void (*benchPathfindingStep)();
+
+
+void usage() {
+    fprintf(stderr, "usage: rts4ds-bench [-n frames] [-r runs] [-o budgets] [-c budgets] [-t tolerance] [<fs root> <project>]\n");
+    exit(2);
+}
+
+char *getBenchStepName(int step) {
+    return (step < SIMULATION_STEPS) ? simulationStep[step].name : "frame";
+}
+
+int compareGameticks(const void *a, const void *b) {
+    unsigned x = *(const unsigned *) a;
+    unsigned y = *(const unsigned *) b;
+    return (x > y) - (x < y);
+}
+
+// nearest-rank percentile of an already sorted array
+unsigned getPercentile(unsigned *sorted, int amount, int percentile) {
+    int rank = (percentile * amount + 99) / 100;
+    return sorted[(rank > 0) ? (rank - 1) : 0];
+}
+
+double gameticksToMicroseconds(unsigned gameticks) {
+    return gameticks / HOST_GAMETICKS_PER_MICROSECOND;
+}
+
+
+void readBenchBudgets(char *filename) {
+    FILE *fp = fopen(filename, "r");
+    char oneline[256];
+    struct BenchBudget *curBudget;
+
+    if (!fp)
+        error("Could not open budgets file:", filename);
+    amountOfBenchBudgets = 0;
+    while (fgets(oneline, sizeof(oneline), fp)) {
+        if (amountOfBenchBudgets == BENCH_MAX_BUDGETS)
+            errorSI("Too many budgets specified. Limit is:", BENCH_MAX_BUDGETS);
+        curBudget = &benchBudget[amountOfBenchBudgets];
+        if (sscanf(oneline, "%31s %31s %u", curBudget->scenario, curBudget->step, &curBudget->value) == 3)
+            amountOfBenchBudgets++;
+    }
+    fclose(fp);
+}
+
+// returns -1 if no budget was specified
+long long getBenchBudget(char *scenario, char *step) {
+    int i;
+
+    for (i=0; i<amountOfBenchBudgets; i++) {
+        if (!strcmp(benchBudget[i].scenario, scenario) && !strcmp(benchBudget[i].step, step))
+            return benchBudget[i].value;
+    }
+    return -1;
+}
+
+// returns 1 if the value is within the budget (or no budget exists), 0 otherwise
+int checkBenchBudget(char *scenario, char *step, unsigned value, int tolerance, int noise) {
+    long long budget = getBenchBudget(scenario, step);
+
+    if (budget < 0 || value <= budget + (budget * tolerance) / 100 + noise)
+        return 1;
+    printf("REGRESSION: %s %s is %u, budget is %lli\n", scenario, step, value, budget);
+    return 0;
+}
+
+
+// gives the ore collectors the same order a player would give them: to go mine
+void orderCollectorsToMine() {
+    struct Unit *curUnit;
+    int i, j;
+
+    for (i=0, curUnit=unit; i<MAX_UNITS_ON_MAP; i++, curUnit++) {
+        if (!curUnit->enabled || !unitInfo[curUnit->info].can_collect_ore)
+            continue;
+        for (j=MAX_DIFFERENT_FACTIONS; j<MAX_STRUCTURES_ON_MAP; j++) {
+            if (structure[j].enabled && structure[j].primary && structure[j].side == curUnit->side && structureInfo[structure[j].info].can_extract_ore) {
+                curUnit->retreat_tile = TILE_FROM_XY(structure[j].x + structureInfo[structure[j].info].release_tile, structure[j].y + structureInfo[structure[j].info].height - 1);
+                break;
+            }
+        }
+        curUnit->logic_aid = nearestEnvironmentTileUnoccupied(TILE_FROM_XY(curUnit->x, curUnit->y), ORE, OREHILL16);
+        if (curUnit->logic_aid >= 0)
+            curUnit->logic = UL_MINE_LOCATION;
+    }
+}
+
+// stores the path searches currently queued, unless they were already stored for the unit
+void recordBenchSearches() {
+    struct Path *path = getPathFindings();
+    struct BenchSearch *last;
+    int i;
+
+    for (i=0; i<MAX_PATHFINDING_PATHS && amountOfBenchSearches<BENCH_MAX_SEARCHES; i++, path++) {
+        if (path->unit_nr == -1 || path->queue == PQ_UNQUEUED)
+            continue;
+        last = lastBenchSearch[path->unit_nr];
+        if (last && last->start == path->offset && last->dest == path->dest && last->attack == path->attack)
+            continue;
+        lastBenchSearch[path->unit_nr] = benchSearch + amountOfBenchSearches;
+        benchSearch[amountOfBenchSearches].unit_nr    = path->unit_nr;
+        benchSearch[amountOfBenchSearches].start      = path->offset;
+        benchSearch[amountOfBenchSearches].dest       = path->dest;
+        benchSearch[amountOfBenchSearches].attack     = path->attack;
+        benchSearch[amountOfBenchSearches].shootRange = path->size;
+        amountOfBenchSearches++;
+    }
+}
+
+// takes the place of the pathfinding step while searches are recorded, seeing them before they are started
+void doBenchPathfindingStep() {
+    recordBenchSearches();
+    benchPathfindingStep();
+}
+
+// makes the pathfinding step record the searches queued, or stops it from doing so
+void setBenchSearchesRecording(bool recording) {
+    int i;
+
+    for (i=0; i<SIMULATION_STEPS && strcmp(simulationStep[i].name, "doPathfindingLogic"); i++);
+    if (i == SIMULATION_STEPS)
+        return;
+    if (recording) {
+        amountOfBenchSearches = 0;
+        memset(lastBenchSearch, 0, sizeof(lastBenchSearch));
+        benchPathfindingStep = simulationStep[i].function;
+        simulationStep[i].function = doBenchPathfindingStep;
+    } else if (simulationStep[i].function == doBenchPathfindingStep)
+        simulationStep[i].function = benchPathfindingStep;
+}
+
+unsigned int canContinueBenchSearch(void) {
+    return 1;
+}
+
+// performs all recorded searches on the map as it is now, storing how long each took in duration
+void runBenchSearches(bool jumpPoints, unsigned *duration, struct BenchSearchResults *results) {
+    struct BenchSearch *curSearch = benchSearch;
+    struct Unit *curUnit;
+    unsigned short int tile[PATHBUFFERLEN];
+    const u32 *firingPositions;
+    int size, job;
+    int i, j;
+
+    Astar_callback(&mapCanBeTraversed_callback, &canHitTarget_callback, &canContinueBenchSearch);
+    Astar_jumpPointSearch(jumpPoints, THRESHHOLD_TRAVERSABILITY_CHECK);
+    cancelPathfindingSearches();       // the game is over, and its searches would hold on to the jobs
+    initFiringPositionsWithScenario(); // each run determines the firing positions it uses anew
+    memset(results, 0, sizeof(struct BenchSearchResults));
+    for (i=0; i<amountOfBenchSearches; i++, curSearch++) {
+        curUnit = unit + curSearch->unit_nr;
+        startGameticks();
+        firingPositions = curSearch->attack ? getFiringPositions(curSearch->dest, curSearch->shootRange, curUnit, unitInfo + curUnit->info) : 0;
+        job = Astar_submitJob(curSearch->start, curSearch->dest, curUnit->unit_positioned, curSearch->attack, curSearch->shootRange,
+                              firingPositions, 0, curUnit, unitInfo + curUnit->info);
+        Astar_runJobs(); // the only job, so it is run by this thread
+        duration[i] = getGameticks();
+        if (firingPositions)
+            releaseFiringPositions(firingPositions);
+        results->expanded += Astar_expandedNodes(job);
+        if (Astar_pollJob(job) != AS_COMPLETE) {
+            results->checksum = results->checksum * 31 + Astar_closest(job);
+            Astar_releaseJob(job);
+            continue;
+        }
+        results->found++;
+        size = Astar_loadPath(job, tile);
+        Astar_releaseJob(job);
+        for (j=0; j<size && j<PATHBUFFERLEN; j++)
+            results->checksum = results->checksum * 31 + tile[j];
+        // the elbows are connected by straight lines, so their distances add up to the length of the path
+        if (!curSearch->attack && size <= PATHBUFFERLEN) {
+            for (j=0; j<size; j++)
+                results->length += Astar_heuristicDistance(j ? tile[j-1] : curSearch->start, tile[j]);
+        }
+    }
+    initPathfinding(); // restores the callbacks and settings of the game
+}
+
+// runs the scenario once, storing the p50, p99 and max of each step in stats. returns the amount of frames run
+int runBenchScenarioOnce(struct BenchScenario *scenario, int frames, unsigned *duration, unsigned *sorted, unsigned stats[BENCH_STEPS][3]) {
+    unsigned *curDuration;
+    int units = 0, structures = 0, projectiles, maxProjectiles = 0;
+    int i, j;
+
+    selectScenario(BENCH_FACTION, scenario->level, scenario->region);
+    initRandLogic(0);
+    initSimulationWithScenario();
+    orderCollectorsToMine();
+
+    for (i=0; i<MAX_UNITS_ON_MAP; i++)
+        units += unit[i].enabled;
+    for (i=MAX_DIFFERENT_FACTIONS; i<MAX_STRUCTURES_ON_MAP; i++)
+        structures += structure[i].enabled;
+
+    for (i=0; i<frames && getGameState() == INGAME; i++) {
+        curDuration = duration + i * BENCH_STEPS;
+        startGameticks();
+        doSimulationFrame(curDuration);
+        curDuration[SIMULATION_STEPS] = getGameticks();
+        
+        for (j=0, projectiles=0; j<MAX_PROJECTILES_ON_MAP; j++)
+            projectiles += projectile[j].enabled;
+        if (projectiles > maxProjectiles)
+            maxProjectiles = projectiles;
+    }
+    frames = i;
+
+    for (j=0; j<BENCH_STEPS; j++) {
+        for (i=0; i<frames; i++)
+            sorted[i] = duration[i * BENCH_STEPS + j];
+        qsort(sorted, frames, sizeof(unsigned), compareGameticks);
+        stats[j][0] = getPercentile(sorted, frames, 50);
+        stats[j][1] = getPercentile(sorted, frames, 99);
+        stats[j][2] = sorted[frames - 1];
+    }
+
+    printf("scenario %s: %i frames, %i units, %i structures, at most %i projectiles\n",
+           scenario->name, frames, units, structures, maxProjectiles);
+    return frames;
+}
+
+// performs the searches recorded during the first run of the scenario, both with and without Jump Point Search,
+// reporting the fastest result of all runs
+void runBenchSearchesScenario(struct BenchScenario *scenario, int runs) {
+    unsigned duration[BENCH_MAX_SEARCHES];
+    unsigned sorted[BENCH_MAX_SEARCHES];
+    unsigned long long total, bestTotal = 0;
+    struct BenchSearchResults results;
+    unsigned stats[3];
+    int jumpPoints;
+    int i, j;
+
+    for (jumpPoints=0; jumpPoints<=1; jumpPoints++) {
+        for (i=0; i<runs; i++) {
+            runBenchSearches(jumpPoints, duration, &results);
+            for (j=0, total=0; j<amountOfBenchSearches; j++)
+                total += duration[j];
+            if (i > 0 && total >= bestTotal)
+                continue;
+            bestTotal = total;
+            memcpy(sorted, duration, amountOfBenchSearches * sizeof(unsigned));
+        }
+        qsort(sorted, amountOfBenchSearches, sizeof(unsigned), compareGameticks);
+        stats[0] = getPercentile(sorted, amountOfBenchSearches, 50);
+        stats[1] = getPercentile(sorted, amountOfBenchSearches, 99);
+        stats[2] = sorted[amountOfBenchSearches - 1];
+
+        printf("  %-22s %10.1f %10.1f %10.1f %11.2f%%\n", jumpPoints ? "astarSearchJPS" : "astarSearch",
+               gameticksToMicroseconds(stats[0]), gameticksToMicroseconds(stats[1]), gameticksToMicroseconds(stats[2]),
+               (100.0 * stats[1]) / GAMETICKS_PER_FRAME);
+        printf("    %i searches, %i found a path, %.1f nodes expanded and %.1f searches per frame on average, length %llu, checksum %08x\n",
+               amountOfBenchSearches, results.found, (double) results.expanded / amountOfBenchSearches,
+               (double) GAMETICKS_PER_FRAME * amountOfBenchSearches / (bestTotal ? bestTotal : 1), results.length, results.checksum);
+    }
+}
+
+// returns 0 if a budget was exceeded
+int runBenchScenario(struct BenchScenario *scenario, int frames, int runs, FILE *budgetsOut, int tolerance) {
+    unsigned *duration = malloc(sizeof(unsigned) * BENCH_STEPS * frames);
+    unsigned *sorted = malloc(sizeof(unsigned) * frames);
+    unsigned stats[BENCH_STEPS][3];
+    unsigned best[BENCH_STEPS][3];
+    int searchExtensions = 0;
+    int framesRun = 0, avoided;
+    int withinBudget = 1;
+    int i, j, k;
+
+    if (!duration || !sorted)
+        errorSI("Failed to malloc for amount of frames:", frames);
+
+    for (i=0; i<runs; i++) {
+        // recording the searches takes some time too, which the other runs filter out
+        setBenchSearchesRecording(i == 0);
+        framesRun = runBenchScenarioOnce(scenario, frames, duration, sorted, stats);
+        setBenchSearchesRecording(false);
+        for (j=0; j<BENCH_STEPS; j++) {
+            for (k=0; k<3; k++) {
+                if (i == 0 || stats[j][k] < best[j][k])
+                    best[j][k] = stats[j][k];
+            }
+        }
+        if (i == 0 || getPathfindingSearchExtensions() < searchExtensions)
+            searchExtensions = getPathfindingSearchExtensions();
+    }
+
+    printf("  pathfinding continued into another frame %i times (maxGameticksSearch increased)\n", searchExtensions);
+    // of the last run. each unit that got past another without a search saved one
+    avoided = getAvoidanceResolutions(AR_WAITED) + getAvoidanceResolutions(AR_GAVE_WAY) + getAvoidanceResolutions(AR_STEPPED_AROUND);
+    printf("  local avoidance: %i units got past another without a search (%i waited, %i gave way, %i stepped around), %i searched;"
+           " %.1f searches saved per minute\n", avoided, getAvoidanceResolutions(AR_WAITED), getAvoidanceResolutions(AR_GAVE_WAY),
+           getAvoidanceResolutions(AR_STEPPED_AROUND), getAvoidanceResolutions(AR_SEARCHED), (60.0 * FPS * avoided) / (framesRun ? framesRun : 1));
+    printf("  %-22s %10s %10s %10s %12s\n", "step", "p50 (us)", "p99 (us)", "max (us)", "p99 (frame)");
+    for (j=0; j<BENCH_STEPS; j++) {
+        printf("  %-22s %10.1f %10.1f %10.1f %11.2f%%\n", getBenchStepName(j),
+               gameticksToMicroseconds(best[j][0]), gameticksToMicroseconds(best[j][1]), gameticksToMicroseconds(best[j][2]),
+               (100.0 * best[j][1]) / GAMETICKS_PER_FRAME);
+        if (budgetsOut)
+            fprintf(budgetsOut, "%s %s %u\n", scenario->name, getBenchStepName(j), best[j][1]);
+        withinBudget &= checkBenchBudget(scenario->name, getBenchStepName(j), best[j][1], tolerance, BENCH_NOISE_GAMETICKS);
+    }
+    if (budgetsOut)
+        fprintf(budgetsOut, "%s searchExtensions %i\n", scenario->name, searchExtensions);
+    withinBudget &= checkBenchBudget(scenario->name, "searchExtensions", searchExtensions, 0, 0);
+
+    if (amountOfBenchSearches > 0)
+        runBenchSearchesScenario(scenario, runs);
+
+    free(sorted);
+    free(duration);
+    return withinBudget;
+}
+
+int main(int argc, char **argv) {
+    int frames = DEFAULT_BENCH_FRAMES;
+    int runs = DEFAULT_BENCH_RUNS;
+    int tolerance = DEFAULT_BENCH_TOLERANCE;
+    char *budgetsOutArg = 0;
+    char *budgetsInArg = 0;
+    char *fsRoot = DEFAULT_BENCH_FS_ROOT;
+    char *project = DEFAULT_BENCH_PROJECT;
+    FILE *budgetsOut = 0;
+    int withinBudget = 1;
+    int i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:o:c:t:")) != -1) {
+        switch (opt) {
+            case 'n':
+                frames = atoi(optarg);
+                break;
+            case 'r':
+                runs = atoi(optarg);
+                break;
+            case 'o':
+                budgetsOutArg = optarg;
+                break;
+            case 'c':
+                budgetsInArg = optarg;
+                break;
+            case 't':
+                tolerance = atoi(optarg);
+                break;
+            default:
+                usage();
+        }
+    }
+    if (frames <= 0 || runs <= 0 || (argc - optind != 0 && argc - optind != 2))
+        usage();
+    if (argc - optind == 2) {
+        fsRoot = argv[optind];
+        project = argv[optind+1];
+    }
+
+    // budgets files are given relative to the current directory, not to fs root
+    if (budgetsInArg)
+        readBenchBudgets(budgetsInArg);
+    if (budgetsOutArg && !(budgetsOut = fopen(budgetsOutArg, "w")))
+        error("Could not create budgets file:", budgetsOutArg);
+    if (chdir(fsRoot))
+        error("Could not access fs root:", fsRoot);
+    initFileIO();
+    setCurrentProjectDirname(project);
+
+    initSimulation();
+    for (i=0; i<BENCH_SCENARIOS; i++)
+        withinBudget &= runBenchScenario(&benchScenario[i], frames, runs, budgetsOut, tolerance);
+
+    if (budgetsOut)
+        fclose(budgetsOut);
+    if (budgetsInArg)
+        printf("%s\n", withinBudget ? "all steps within budget" : "budgets exceeded");
+    return !withinBudget;
+}
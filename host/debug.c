@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Host implementation of debug.h: messages go to stderr and errors end the process.
+
+#include "debug.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+void breakpointSI(char *string, int nr) {
+    fprintf(stderr, "breakpoint: %s\n%i\n", string, nr);
+}
+
+void breakpoint(char *string1, char *string2) {
+    fprintf(stderr, "breakpoint: %s\n%s\n", string1, string2);
+}
+
+void errorI4(int int1, int int2, int int3, int int4) {
+    fprintf(stderr, "error:\nint1: %i\nint2: %i\nint3: %i\nint4: %i\n", int1, int2, int3, int4);
+    exit(1);
+}
+
+void errorSI(char *string, int nr) {
+    fprintf(stderr, "error: %s\n%i\n", string, nr);
+    exit(1);
+}
+
+void error(char *string1, char *string2) {
+    fprintf(stderr, "error: %s\n%s\n", string1, string2);
+    exit(1);
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Host implementation of gameticks.h. Instead of hardware timer 2, a monotonic
+// clock is used. Its readings are converted to the unit used on the DS (the
+// 33.513982 MHz bus clock), so GAMETICKS_PER_FRAME keeps its meaning.
+
+#include "gameticks.h"
+
+#include <time.h>
+
+#define HOST_GAMETICKS_PER_SECOND  33513982ULL
+
+static unsigned long long gameticksStart;
+static int gameticksEnabled;
+
+
+static unsigned long long getMonotonicNanoseconds() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((unsigned long long) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+void stopGameticks() {
+    gameticksEnabled = 0;
+}
+
+unsigned getGameticks() {
+    unsigned long long ticks;
+
+    if (!gameticksEnabled)
+        return 0;
+    ticks = ((getMonotonicNanoseconds() - gameticksStart) * HOST_GAMETICKS_PER_SECOND) / 1000000000ULL;
+    // the DS timer only covers a limited amount of frames too; mimic its behaviour once a 32-bit value is insufficient
+    if (ticks >= 0xFFFFFFFFULL) {
+        stopGameticks();
+        return 0;
+    }
+    return (ticks == 0) ? 1 : (unsigned) ticks;
+}
+
+void startGameticksPrecision(unsigned division) {
+    gameticksStart = getMonotonicNanoseconds();
+    gameticksEnabled = 1;
+}
+
+void startGameticks() {
+    stopGameticks();
+    startGameticksPrecision(0);
+}
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Minimal stand-in for libnds, used when building the headless host simulator.
+// It only offers what the game logic needs in order to compile and link on a
+// regular operating system: basic types, key masks, and registers/VRAM areas
+// which are backed by dummy memory so that writes to them are harmless.
+
+#ifndef _HOST_NDS_H_
+#define _HOST_NDS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#ifndef HOST_BUILD
+  #define HOST_BUILD
+#endif
+
+typedef uint8_t   u8;
+typedef uint16_t  u16;
+typedef uint32_t  u32;
+typedef uint64_t  u64;
+typedef int8_t    s8;
+typedef int16_t   s16;
+typedef int32_t   s32;
+typedef int64_t   s64;
+typedef volatile u8   vu8;
+typedef volatile u16  vu16;
+typedef volatile u32  vu32;
+typedef u8   uint8;
+typedef u16  uint16;
+typedef u32  uint32;
+typedef s8   int8;
+typedef s16  int16;
+typedef s32  int32;
+
+#define BIT(n)  (1 << (n))
+
+#define DTCM_DATA
+#define DTCM_BSS
+#define ITCM_CODE
+
+#define SCREEN_WIDTH   256
+#define SCREEN_HEIGHT  192
+
+#define RGB15(r,g,b)   ((r)|((g)<<5)|((b)<<10))
+
+
+// keys
+typedef enum {
+    KEY_A      = BIT(0),
+    KEY_B      = BIT(1),
+    KEY_SELECT = BIT(2),
+    KEY_START  = BIT(3),
+    KEY_RIGHT  = BIT(4),
+    KEY_LEFT   = BIT(5),
+    KEY_UP     = BIT(6),
+    KEY_DOWN   = BIT(7),
+    KEY_R      = BIT(8),
+    KEY_L      = BIT(9),
+    KEY_X      = BIT(10),
+    KEY_Y      = BIT(11),
+    KEY_TOUCH  = BIT(12),
+    KEY_LID    = BIT(13)
+} KEYPAD_BITS;
+
+typedef struct touchPosition {
+    u16 rawx;
+    u16 rawy;
+    u16 px;
+    u16 py;
+    u16 z1;
+    u16 z2;
+} touchPosition;
+
+void scanKeys(void);
+u32 keysHeld(void);
+u32 keysDown(void);
+u32 keysUp(void);
+void touchRead(touchPosition *data);
+
+
+// registers, all backed by a single dummy register
+extern vu16 hostDummyRegister;
+#define REG_MASTER_BRIGHT      hostDummyRegister
+#define REG_MASTER_BRIGHT_SUB  hostDummyRegister
+#define REG_EXMEMCNT           hostDummyRegister
+#define REG_BG0HOFS            hostDummyRegister
+#define REG_BG0VOFS            hostDummyRegister
+#define REG_BG1HOFS            hostDummyRegister
+#define REG_BG1VOFS            hostDummyRegister
+#define REG_BG2HOFS            hostDummyRegister
+#define REG_BG2VOFS            hostDummyRegister
+#define REG_BG3HOFS            hostDummyRegister
+#define REG_BG3VOFS            hostDummyRegister
+
+
+// video memory, all backed by a single dummy buffer large enough for any of the areas below
+#define HOST_VRAM_SIZE  (128*1024)
+extern u16 hostVRAM[HOST_VRAM_SIZE/2];
+#define VRAM_B                     (hostVRAM)
+#define VRAM_E                     (hostVRAM)
+#define VRAM_F                     (hostVRAM)
+#define SPRITE_GFX                 (hostVRAM)
+#define SCREEN_BASE_BLOCK(n)       (hostVRAM + (((n) & 31) << 10))
+#define SCREEN_BASE_BLOCK_SUB(n)   (hostVRAM + (((n) & 31) << 10))
+
+#define ATTR0_SQUARE  (0 << 14)
+
+
+// power management
+#define PM_BACKLIGHT_BOTTOM  BIT(2)
+#define PM_BACKLIGHT_TOP     BIT(3)
+#define BACKLIGHT_LOW        1
+#define BACKLIGHT_MAX        3
+void powerOn(int bits);
+void powerOff(int bits);
+
+
+// system
+extern bool hostDSiMode; // what isDSiMode() reports, e.g. to match a replay recorded on a DSi
+bool isDSiMode(void);
+void lcdSwap(void);
+
+#define ARGV_MAGIC  0x5f617267
+struct __argv {
+    int argvMagic;
+    char *commandLine;
+    int length;
+    int argc;
+    char **argv;
+    char **endARGV;
+    u32 host;
+};
+extern struct __argv *__system_argv;
+
+bool nitroFSInit(char **basepath);
+
+#endif
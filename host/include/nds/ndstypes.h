@@ -0,0 +1,5 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Forwarding header for the headless host build; see nds.h in this directory.
+#include <nds.h>
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// The few libnds functions and hardware areas the game logic relies upon,
+// reimplemented for the headless host build.
+
+#include <nds.h>
+#include <string.h>
+
+
+vu16 hostDummyRegister;
+bool hostDSiMode;
+u16 hostVRAM[HOST_VRAM_SIZE/2];
+
+static char *hostArgv[1] = { "rts4ds-sim" };
+static struct __argv hostSystemArgv = { ARGV_MAGIC, 0, 0, 1, hostArgv, 0, 0 };
+struct __argv *__system_argv = &hostSystemArgv;
+
+
+void scanKeys(void) {}
+u32 keysHeld(void) { return 0; }
+u32 keysDown(void) { return 0; }
+u32 keysUp(void)   { return 0; }
+
+void touchRead(touchPosition *data) {
+    memset(data, 0, sizeof(touchPosition));
+}
+
+void powerOn(int bits) {}
+void powerOff(int bits) {}
+
+bool isDSiMode(void) {
+    return hostDSiMode;
+}
+
+void lcdSwap(void) {}
+
+bool nitroFSInit(char **basepath) {
+    return true;
+}
+
+// replaces astar/memset32.s. size is given in bytes.
+void memset32(u32 *dest, u32 word, u32 size) {
+    u32 i;
+    for (i=0; i<(size>>2); i++)
+        dest[i] = word;
+}
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// rts4ds-sim: runs the game logic of a scenario headless on a regular operating
+// system, for a given number of frames. Nothing is drawn and no input is read.
+//
+// usage: rts4ds-sim [-n frames] [-s seed] [-j threads] <fs root> <project> <faction> <level> <region>
+//        rts4ds-sim [-n frames] [-j threads] -p replay <fs root> <project>
+//   fs root   directory containing the project directories (e.g. fs/uw_demo1)
+//   project   name of the project directory within fs root (e.g. uw_demo1)
+//   faction   name of the faction played as FRIENDLY side
+//   level     level of the scenario to load
+//   region    region of the scenario to load
+//   seed      initial state of the logic's random numbers (default 0)
+//   threads   number of threads path searches are run on (default 0: one per
+//             processor). the outcome is the same for any number of threads
+//   replay    replay file recorded by a debug build (see replay.h). the scenario, seed
+//             and commands given by the player are all taken from it
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "settings.h"
+#include "fileio.h"
+#include "factions.h"
+#include "structures.h"
+#include "units.h"
+#include "objectives.h"
+#include "pathfinding.h"
+#include "replay.h"
+#include "gameticks.h"
+#include "simulation.h"
+
+#define DEFAULT_SIMULATION_FRAMES  1000
+
+
+void usage() {
+    fprintf(stderr, "usage: rts4ds-sim [-n frames] [-s seed] [-j threads] <fs root> <project> <faction> <level> <region>\n");
+    fprintf(stderr, "       rts4ds-sim [-n frames] [-j threads] -p replay <fs root> <project>\n");
+    exit(2);
+}
+
+void printSimulationSummary(int frames) {
+    int unitsPerSide[MAX_SIDES];
+    int structuresPerSide[MAX_SIDES];
+    int i;
+
+    memset(unitsPerSide, 0, sizeof(unitsPerSide));
+    memset(structuresPerSide, 0, sizeof(structuresPerSide));
+    for (i=0; i<MAX_UNITS_ON_MAP; i++) {
+        if (unit[i].enabled)
+            unitsPerSide[unit[i].side]++;
+    }
+    for (i=MAX_DIFFERENT_FACTIONS; i<MAX_STRUCTURES_ON_MAP; i++) {
+        if (structure[i].enabled)
+            structuresPerSide[structure[i].side]++;
+    }
+
+    printf("frames: %i\n", frames);
+    printf("objectives: %s\n", (getObjectivesState() == OBJECTIVES_COMPLETED) ? "completed" :
+                               (getObjectivesState() == OBJECTIVES_FAILED)    ? "failed" : "incomplete");
+    for (i=0; i<MAX_SIDES; i++) {
+        if (unitsPerSide[i] || structuresPerSide[i])
+            printf("side %i: %i units, %i structures\n", i, unitsPerSide[i], structuresPerSide[i]);
+    }
+    printf("state hash: %08x\n", getSimulationStateHash());
+}
+
+int main(int argc, char **argv) {
+    int frames = DEFAULT_SIMULATION_FRAMES;
+    unsigned int seed = 0;
+    char *replayArg = 0;
+    char *replay = 0;
+    int i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:j:p:")) != -1) {
+        switch (opt) {
+            case 'n':
+                frames = atoi(optarg);
+                break;
+            case 's':
+                seed = strtoul(optarg, 0, 0);
+                break;
+            case 'j':
+                #ifdef ASTAR_THREADS
+                Astar_setThreads(atoi(optarg));
+                #endif
+                break;
+            case 'p':
+                replayArg = optarg;
+                break;
+            default:
+                usage();
+        }
+    }
+    if (argc - optind != (replayArg ? 2 : 5))
+        usage();
+
+    // the replay file is given relative to the current directory, not to fs root
+    if (replayArg && !(replay = realpath(replayArg, 0)))
+        error("Could not find replay file:", replayArg);
+    if (chdir(argv[optind]))
+        error("Could not access fs root:", argv[optind]);
+    initFileIO();
+    setCurrentProjectDirname(argv[optind+1]);
+
+    initSimulation();
+    if (replay) {
+        if (!startReplayPlayback(replay))
+            error("Could not read replay file:", replay);
+        hostDSiMode = getReplayHeader()->dsiMode;
+    } else {
+        selectScenario(argv[optind+2], atoi(argv[optind+3]), atoi(argv[optind+4]));
+        initRandLogic(seed);
+    }
+    initSimulationWithScenario();
+
+    for (i=0; i<frames && getGameState() == INGAME; i++) {
+        startGameticks();
+        doSimulationFrame(0);
+    }
+
+    printSimulationSummary(i);
+    return 0;
+}
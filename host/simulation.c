@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Loading a scenario and running its logic frame by frame, without graphics or
+// input. Shared by rts4ds-sim and rts4ds-bench.
+
+#include "simulation.h"
+
+#include <string.h>
+
+#include "game.h"
+#include "settings.h"
+#include "fileio.h"
+#include "factions.h"
+#include "environment.h"
+#include "overlay.h"
+#include "explosions.h"
+#include "projectiles.h"
+#include "structures.h"
+#include "units.h"
+#include "ai.h"
+#include "pathfinding.h"
+#include "objectives.h"
+#include "timedtriggers.h"
+#include "view.h"
+#include "info.h"
+#include "replay.h"
+#include "gameticks.h"
+
+#define STATE_BUFFER_SIZE  (512*1024)
+
+
+void doSimulationAILogic() {
+    if (getGameType() == SINGLEPLAYER)
+        doAILogic();
+}
+
+// what doInfoScreenLogic does, leaving out the drawing
+void doSimulationInfoScreenLogic() {
+    int i;
+
+    for (i=0; i<getAmountOfSides(); i++) {
+        updateStructuresQueue(i);
+        updateUnitsQueue(i);
+    }
+    updateMatchTime();
+}
+
+void doSimulationPathfindingLogic() {
+    #ifndef REMOVE_ASTAR_PATHFINDING
+    if (!isReplayPaused())
+        doPathfindingLogic();
+    #endif
+}
+
+struct SimulationStep simulationStep[SIMULATION_STEPS] = {
+    { "doEnvironmentLogic",   doEnvironmentLogic },
+    { "doOverlayLogic",       doOverlayLogic },
+    { "doExplosionsLogic",    doExplosionsLogic },
+    { "doProjectilesLogic",   doProjectilesLogic },
+    { "doStructuresLogic",    doStructuresLogic },
+    { "doUnitsLogic",         doUnitsLogic },
+    { "doAILogic",            doSimulationAILogic },
+    { "doInfoScreenLogic",    doSimulationInfoScreenLogic },
+    { "doTimedtriggersLogic", doTimedtriggersLogic },
+    { "doObjectivesLogic",    doObjectivesLogic },
+    { "doPathfindingLogic",   doSimulationPathfindingLogic }
+};
+
+
+void selectScenario(char *faction, int level, int region) {
+    int i;
+
+    for (i=0; i<MAX_DIFFERENT_FACTIONS && factionInfo[i].enabled; i++) {
+        if (!strcmp(faction, factionInfo[i].name)) {
+            setFaction(FRIENDLY, i);
+            break;
+        }
+    }
+    if (i == MAX_DIFFERENT_FACTIONS || !factionInfo[i].enabled)
+        error("Non existant Faction was specified:", faction);
+    setLevel(level);
+    setRegion(region);
+}
+
+void initSimulation() {
+    // equivalent of the ingame initialization done by game.c and playscreen.c, leaving out graphics
+    initFactions();
+    initEnvironment();
+    initOverlay();
+    initExplosions();
+    initProjectiles();
+    initStructures();
+    initUnits();
+    initPriorityStructureAI();
+    #ifndef REMOVE_ASTAR_PATHFINDING
+    initPathfinding();
+    #endif
+    createDefaultSaveFile();
+}
+
+void initSimulationWithScenario() {
+    setGameState(INGAME);
+    initView(HORIZONTAL, 0, 0);
+
+    initFactionsWithScenario();
+    initEnvironmentWithScenario();
+    initOverlayWithScenario();
+    initExplosionsWithScenario();
+    initProjectilesWithScenario();
+    initUnitsWithScenario();
+    initStructuresWithScenario();
+    #ifndef REMOVE_ASTAR_PATHFINDING
+    initPathfindingWithScenario();
+    #endif
+    if (getGameType() == SINGLEPLAYER)
+        initAI();
+
+    initTimedtriggers();
+    initObjectives();
+}
+
+void doSimulationFrame(unsigned *stepDuration) {
+    unsigned gameticks;
+    int i;
+
+    doReplayLogic();
+
+    for (i=0; i<SIMULATION_STEPS; i++) {
+        gameticks = getGameticks();
+        simulationStep[i].function();
+        if (stepDuration)
+            stepDuration[i] = getGameticks() - gameticks;
+    }
+
+    advanceReplayFrame();
+}
+
+// FNV-1a hash over the state of all entities, to be able to compare runs
+unsigned getSimulationStateHash() {
+    static unsigned char buffer[STATE_BUFFER_SIZE];
+    unsigned hash = 2166136261u;
+    int size = 0;
+    int i;
+
+    size += getUnitsSaveData(buffer + size, STATE_BUFFER_SIZE - size);
+    size += getStructuresSaveData(buffer + size, STATE_BUFFER_SIZE - size);
+    size += getProjectilesSaveData(buffer + size, STATE_BUFFER_SIZE - size);
+    size += getExplosionsSaveData(buffer + size, STATE_BUFFER_SIZE - size);
+    for (i=0; i<size; i++)
+        hash = (hash ^ buffer[i]) * 16777619u;
+    return hash;
+}
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _SIMULATION_H_
+#define _SIMULATION_H_
+
+// the logic done each frame, in the same order as doGameLogic, doPlayScreenLogic and doInfoScreenLogic use
+struct SimulationStep {
+    char *name;
+    void (*function)();
+};
+
+#define SIMULATION_STEPS  11
+
+extern struct SimulationStep simulationStep[SIMULATION_STEPS];
+
+void selectScenario(char *faction, int level, int region);
+
+void initSimulation();
+void initSimulationWithScenario();
+
+// when stepDuration is given, it receives the gameticks each of the SIMULATION_STEPS took.
+// startGameticks() is expected to have been called at the start of the frame.
+void doSimulationFrame(unsigned *stepDuration);
+
+unsigned getSimulationStateHash();
+
+#endif
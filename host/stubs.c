@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// No-op replacements for the parts of the game that deal with drawing, input,
+// rumble and the info screen. The headless host build only runs game logic.
+
+#include "game.h"
+#include "playscreen.h"
+#include "sprites.h"
+#include "radar.h"
+#include "rumble.h"
+#include "inputx.h"
+#include "infoscreen.h"
+#include "ingame_briefing.h"
+#include "cutscene_debriefing.h"
+
+
+enum GameState gameState = INGAME;
+int gameLevel, gameRegion;
+
+
+// game.c
+void setGameState(enum GameState state) {
+    gameState = state;
+}
+
+enum GameState getGameState() {
+    return gameState;
+}
+
+void setRegion(int region) {
+    gameRegion = region;
+}
+
+int getRegion() {
+    return gameRegion;
+}
+
+void setLevel(int level) {
+    gameLevel = level;
+}
+
+int getLevel() {
+    return gameLevel;
+}
+
+
+// playscreen.c
+void setModifierNone() {}
+
+enum PlayScreenTouchModifier getModifier() {
+    return PSTM_NONE;
+}
+
+int getDeployNrUnit() {
+    return -1;
+}
+
+int getSellNrStructure() {
+    return -1;
+}
+
+
+// sprites.c
+void setPlayScreenSpritesMode(enum PlayScreenSpritesMode mode) {}
+
+void setSpritePlayScreen(int y, unsigned int shape,
+                         int x, unsigned int size, unsigned int flipX, unsigned int flipY,
+                         unsigned int priority, unsigned int palette, unsigned int graphics) {}
+
+
+// radar.c
+void setTileDirtyRadarDirtyBitmap(int tile) {}
+void displayHitRadar(int x, int y) {}
+
+
+// rumble.c
+void addRumble(int level, int duration) {}
+
+
+// inputx.c
+uint32 getKeysDown() { return 0; }
+int    getKeysHeldTimeMin(uint32 keys) { return 0; }
+int    getKeysHeldTimeMax(uint32 keys) { return 0; }
+int    getKeysUpTimeMin(uint32 keys) { return 0; }
+uint32 getKeysOnUp() { return 0; }
+
+
+// infoscreen.c
+void createBarStructures() {}
+
+
+// ingame_briefing.c
+enum IngameBriefingState getIngameBriefingState() {
+    return IBS_INACTIVE;
+}
+
+void startIngameBriefing(char *animation) {}
+void startIngameBriefingWithDelay(char *animation, int delay) {}
+
+
+// cutscene_debriefing.c
+void initCutsceneDebriefingFilename(int win) {}
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// rts4ds-trace: converts a profiling trace written by a debug build with
+// PROFILING_ENABLED (see profiling.h) into a format other tools understand.
+//
+// usage: rts4ds-trace [-f] <trace>
+//   trace   profiling trace, e.g. rts4ds_profiling.bin taken from the root of the SD card
+//   -f      output folded stacks (as used by flamegraph.pl) instead of Chrome trace JSON,
+//           one line per call with the gameticks spent in the function itself
+//
+// the Chrome trace JSON can be opened in chrome://tracing or https://ui.perfetto.dev.
+// output is written to stdout.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "profiling.h"
+
+#define DS_GAMETICKS_PER_MICROSECOND  33.513982
+
+struct ProfilingHeader header;
+char (*traceName)[MAX_PROFILER_NAME_LENGTH];
+struct ProfilingRecord *traceRecord;
+
+
+void usage() {
+    fprintf(stderr, "usage: rts4ds-trace [-f] <trace>\n");
+    exit(2);
+}
+
+void readTrace(char *filename) {
+    FILE *fp = fopen(filename, "rb");
+
+    if (!fp) {
+        fprintf(stderr, "could not open trace: %s\n", filename);
+        exit(1);
+    }
+    if (fread(&header, sizeof(struct ProfilingHeader), 1, fp) != 1 ||
+        header.magic != PROFILER_MAGIC || header.version != PROFILER_VERSION ||
+        header.amountOfNames > MAX_PROFILER_NAMES || header.amountOfRecords > PROFILER_RECORDS) {
+        fprintf(stderr, "not a profiling trace of version %i: %s\n", PROFILER_VERSION, filename);
+        exit(1);
+    }
+    traceName = malloc(MAX_PROFILER_NAME_LENGTH * (header.amountOfNames + 1));
+    traceRecord = malloc(sizeof(struct ProfilingRecord) * (header.amountOfRecords + 1));
+    if (!traceName || !traceRecord ||
+        fread(traceName, MAX_PROFILER_NAME_LENGTH, header.amountOfNames, fp) != header.amountOfNames ||
+        fread(traceRecord, sizeof(struct ProfilingRecord), header.amountOfRecords, fp) != header.amountOfRecords) {
+        fprintf(stderr, "trace is truncated: %s\n", filename);
+        exit(1);
+    }
+    fclose(fp);
+}
+
+int isRecordMeasured(struct ProfilingRecord *record) {
+    if (record->type == PR_INFO)
+        return record->start != 0;
+    return record->start != 0 && record->end != 0 && record->end >= record->start;
+}
+
+double getTimestamp(struct ProfilingRecord *record, unsigned gameticks) {
+    return (((double) record->frame) * header.gameticksPerFrame + gameticks) / DS_GAMETICKS_PER_MICROSECOND;
+}
+
+// prints a name as a JSON string
+void printJSONName(char *name) {
+    putchar('"');
+    for (; *name; name++) {
+        if (*name == '"' || *name == '\\')
+            putchar('\\');
+        putchar(*name);
+    }
+    putchar('"');
+}
+
+void writeChromeTrace() {
+    struct ProfilingRecord *record;
+    int first = 1;
+    unsigned i;
+
+    printf("{\"traceEvents\":[\n");
+    for (i=0, record=traceRecord; i<header.amountOfRecords; i++, record++) {
+        if (record->name >= header.amountOfNames || !isRecordMeasured(record))
+            continue;
+        printf("%s{\"name\":", first ? "" : ",\n");
+        printJSONName(traceName[record->name]);
+        if (record->type == PR_INFO)
+            printf(",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":0,\"tid\":0,\"args\":{\"value\":%i,\"frame\":%u}}",
+                   getTimestamp(record, record->start), (int) record->end, record->frame);
+        else
+            printf(",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":0,\"args\":{\"frame\":%u,\"depth\":%i}}",
+                   getTimestamp(record, record->start), (record->end - record->start) / DS_GAMETICKS_PER_MICROSECOND,
+                   record->frame, record->depth);
+        first = 0;
+    }
+    printf("\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"recordsOverwritten\":%u}}\n", header.recordsOverwritten);
+}
+
+// records are added once a function stops, so a function's callers always come after it.
+// walking the records from newest to oldest thus encounters each caller before its callees.
+void writeFoldedStacks() {
+    struct ProfilingRecord *record;
+    int *stack = malloc(sizeof(int) * MAX_PROFILER_DEPTH);
+    long long *self = malloc(sizeof(long long) * (header.amountOfRecords + 1));
+    int *parent = malloc(sizeof(int) * (header.amountOfRecords + 1));
+    int stackSize = 0;
+    int i, j;
+
+    if (!stack || !self || !parent) {
+        fprintf(stderr, "failed to malloc for amount of records: %u\n", header.amountOfRecords);
+        exit(1);
+    }
+    for (i=header.amountOfRecords-1; i>=0; i--) {
+        record = &traceRecord[i];
+        parent[i] = -1;
+        self[i] = -1;
+        if (record->type != PR_FUNCTION || record->name >= header.amountOfNames || record->depth >= MAX_PROFILER_DEPTH)
+            continue;
+        if (stackSize > record->depth)
+            stackSize = record->depth;
+        // the caller was overwritten in the ring buffer, or belongs to another frame
+        if (stackSize < record->depth || (stackSize > 0 && traceRecord[stack[stackSize-1]].frame != record->frame)) {
+            stackSize = 0;
+            if (record->depth > 0)
+                continue;
+        }
+        if (!isRecordMeasured(record))
+            continue;
+        parent[i] = (stackSize > 0) ? stack[stackSize-1] : -1;
+        self[i] = record->end - record->start;
+        if (parent[i] >= 0 && self[parent[i]] >= 0)
+            self[parent[i]] -= self[i];
+        stack[stackSize++] = i;
+    }
+
+    for (i=0; i<header.amountOfRecords; i++) {
+        if (self[i] < 0)
+            continue;
+        stackSize = 0;
+        for (j=i; j>=0; j=parent[j])
+            stack[stackSize++] = j;
+        for (j=stackSize-1; j>=0; j--)
+            printf("%s%s", traceName[traceRecord[stack[j]].name], j ? ";" : "");
+        printf(" %lli\n", self[i]);
+    }
+    free(parent);
+    free(self);
+    free(stack);
+}
+
+int main(int argc, char **argv) {
+    int folded = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f")) != -1) {
+        switch (opt) {
+            case 'f':
+                folded = 1;
+                break;
+            default:
+                usage();
+        }
+    }
+    if (argc - optind != 1)
+        usage();
+
+    readTrace(argv[optind]);
+    if (header.recordsOverwritten)
+        fprintf(stderr, "%u older records were overwritten in the ring buffer before the trace was written\n", header.recordsOverwritten);
+    if (folded)
+        writeFoldedStacks();
+    else
+        writeChromeTrace();
+    return 0;
+}
@@ -10,6 +10,7 @@
 #include "structures.h"
 #include "music.h"
 #include "fileio.h"
+#include "influence.h"
 
 #define MAX_DIFFERENT_TEAM_SCRIPTED_AI 50
 
@@ -45,6 +46,24 @@ static struct PriorityStructureAI priorityStructureAI;
 
 
 
+// the rally point of the team being formed, unless the player has more firepower around it than the team has or the
+// side lost units there recently. the team then gathers where its units are, rather than one by one under fire
+static int getStagingTileAI(int i) {
+    int staging_tile = teamAI[i].teamScriptedAI[teamAI[i].teamCurrentAI.currentTeam].staging_tile;
+    int firepower = 0;
+    int j;
+    
+    if (staging_tile == -1)
+        return -1;
+    for (j=0; j<MAX_UNITS_ON_MAP; j++) {
+        if (unit[j].side == i+1 && unit[j].enabled && unit[j].group == UGAI_FORMING)
+            firepower += getInfluenceUnitFirepower(j);
+    }
+    if (getInfluenceThreat(i+1, X_FROM_TILE(staging_tile), Y_FROM_TILE(staging_tile)) > firepower)
+        return -1;
+    return staging_tile;
+}
+
 void doTeamAILogic() {
     int i, j, k;
     int possibleUnitToBuild[ENEMY_UNITS_QUEUE];
@@ -53,6 +72,7 @@ void doTeamAILogic() {
     enum UnitType unitTypesToBuild;
     int amountOfUnitsOnMap;
     int formingBecomesStaging;
+    int stagingTile;
     
     startProfilingFunction("doTeamAILogic");
     
@@ -68,7 +88,7 @@ void doTeamAILogic() {
                         unit[j].group &= (~UGAI_STAGING);
                         if (unit[j].group == UGAI_HUNT) {
                             unit[j].logic = UL_HUNT;
-                            unit[j].logic_aid = 0;
+                            setUnitLogicAid(unit + j, 0);
                         } else if (unit[j].group == UGAI_KAMIKAZE)
                             unit[j].logic = UL_KAMIKAZE;
                     }
@@ -90,6 +110,7 @@ void doTeamAILogic() {
             }
             if (formingBecomesStaging) {
                 teamAI[i].currentStagingDuration = FPS; // grant one second minimum
+                stagingTile = getStagingTileAI(i);
                 for (j=0; j<MAX_UNITS_ON_MAP; j++) {
                     if (unit[j].side == i+1 && unit[j].enabled) {                
                         if (unit[j].group & UGAI_STAGING) {
@@ -97,16 +118,16 @@ void doTeamAILogic() {
                             unit[j].group &= (~UGAI_STAGING);
                             if (unit[j].group == UGAI_HUNT) {
                                 unit[j].logic = UL_HUNT;
-                                unit[j].logic_aid = 0;
+                                setUnitLogicAid(unit + j, 0);
                             } else if (unit[j].group == UGAI_KAMIKAZE)
                                 unit[j].logic = UL_KAMIKAZE;
                         }
                         else if (unit[j].group == UGAI_FORMING) {
                             unit[j].group = UGAI_STAGING | teamAI[i].teamScriptedAI[teamAI[i].teamCurrentAI.currentTeam].groupAI;
                             unit[j].logic = UL_MOVE_LOCATION;
-                            unit[j].logic_aid = teamAI[i].teamScriptedAI[teamAI[i].teamCurrentAI.currentTeam].staging_tile;
+                            setUnitLogicAid(unit + j, stagingTile);
                             if (unit[j].logic_aid == -1) // let it "move" to its current location, so sending the units off will kick in 
-                                unit[j].logic_aid = TILE_FROM_XY(unit[j].x, unit[j].y); 
+                                setUnitLogicAid(unit + j, TILE_FROM_XY(unit[j].x, unit[j].y)); 
                             teamAI[i].currentStagingDuration = (teamAI[i].maximumStagingDuration > 0) ?
                                                                 teamAI[i].maximumStagingDuration :
                                                                 max(teamAI[i].currentStagingDuration, 
@@ -132,7 +153,7 @@ void doTeamAILogic() {
                 // determine the number of units for the team and create it
                 teamAI[i].teamCurrentAI.amount = MIN(
                     getUnitLimit(i+1)-amountOfUnitsOnMap, // max additional units allowed for this side
-                    teamAI[i].teamScriptedAI[teamAI[i].teamCurrentAI.currentTeam].minAmount + rand() % (teamAI[i].teamScriptedAI[teamAI[i].teamCurrentAI.currentTeam].maxAmount - teamAI[i].teamScriptedAI[teamAI[i].teamCurrentAI.currentTeam].minAmount)); // ideal additional units for this side
+                    teamAI[i].teamScriptedAI[teamAI[i].teamCurrentAI.currentTeam].minAmount + randLogic() % (teamAI[i].teamScriptedAI[teamAI[i].teamCurrentAI.currentTeam].maxAmount - teamAI[i].teamScriptedAI[teamAI[i].teamCurrentAI.currentTeam].minAmount)); // ideal additional units for this side
                 
                 unitTypesToBuild = teamAI[i].teamScriptedAI[teamAI[i].teamCurrentAI.currentTeam].unitType;
                 amountOfPossibleUnitsToBuild = 0;
@@ -151,7 +172,7 @@ void doTeamAILogic() {
                 }
                 if (amountOfPossibleUnitsToBuild > 0) {
                     for (j=0; j<teamAI[i].teamCurrentAI.amount; j++) {
-                        k = rand() % amountOfPossibleUnitsToBuild;
+                        k = randLogic() % amountOfPossibleUnitsToBuild;
                         addItemUnitsQueue(i+1, possibleUnitToBuild[k], possibleUnitToBuildBy[k]);
                     }
                 }
@@ -479,7 +500,7 @@ void adjustAIUnitAdded(enum Side side, int itemNr, int unitNr) {
         
         dstUnit->group = srcUnit->group & ~(AWAITING_REPLACEMENT | TECHTREE_INSUFFICIENT | QUEUED_FOR_REPLACEMENT);
         dstUnit->guard_tile = srcUnit->guard_tile;
-        dstUnit->retreat_tile = srcUnit->retreat_tile;
+        setUnitRetreatTile(dstUnit, srcUnit->retreat_tile);
         dstUnit->logic = UL_GUARD_RETREAT;
         srcUnit->group = 0; // taken care of
         
@@ -534,6 +555,7 @@ void initRebuildAI() {
 void doAILogic() {
     startProfilingFunction("doAILogic");
     
+    updateInfluence();
     doTeamAILogic();
     doRebuildAILogic();
     
@@ -568,7 +590,7 @@ void initPriorityStructureAI() {
         readstr(fp, oneline);
         replaceEOLwithEOF(oneline, 255);
         for (j=0; j<MAX_DIFFERENT_STRUCTURES && structureInfo[j].enabled; j++) {
-            if (!strncmp(oneline, structureInfo[j].name, strlen(structureInfo[j].name)) && oneline[strlen(structureInfo[j].name)] == 0) {
+            if (!strncmp(oneline, structureInfoText[j].name, strlen(structureInfoText[j].name)) && oneline[strlen(structureInfoText[j].name)] == 0) {
                 priorityStructureAI.item[i] = j;
                 break;
             }
@@ -1,4 +1,3 @@
-
 //
 // Astar - an A* implementation - by sverx
 //
@@ -18,29 +17,69 @@ extern void memset32(u32 *dest, u32 word, u32 size);
 // rehearsals, but here needs to be multiple of 32 so, well, 6400 should be ok.
 #define MAXDISTANCE        6400
 
-// the node set (openSet)
-__attribute__((aligned(32))) openSetNode openSet[MAPSIZE]; // 4096 * sizeof(openSetNode) = 32KB
-
-// this array stores the status of the nodes (2 bit per status: 4 statuses per byte)
-__attribute__((aligned(32))) u8 nodeBitmap[MAPSIZE/4];    // 1024 bytes
-
-// Hash Table and ...
-__attribute__((aligned(32))) unsigned short int hashT [MAXDISTANCE] ;     // 12800 bytes
-// ...  separate chaining (simple list)
-__attribute__((aligned(32))) unsigned short int hashT_next [MAPSIZE];     // 8192 bytes
-
-// the other variables...
-__attribute__((aligned(32))) 
-// The minimum value we've got in the table
-unsigned int hashT_min;
-// the number of nodes in the openSet Hash
-unsigned int hashT_count;
-// the initialized part of the array in the openSet Hash
-unsigned int hashT_initialized;
-// the best node in the closedSet
-unsigned int closedSet_best;
-// the min distance in the closedSet
-unsigned int closedSet_min;
+#ifdef ASTAR_OPENSET_HEAP
+// the openSet as an indexed 4-ary heap. the key of a node holds its f_score in the upper bits and a
+// sequence number decreasing with every node added in the lower bits, so nodes with the same f_score
+// are taken last in, first out: the same order the Hash Table hands them out in
+#define HEAP_ARITY          4
+#define HEAP_SEQUENCE_START 0xFFFF   // more than the 8 additions per node a search can make at most
+#endif
+
+// everything a path search works on. each job has one of its own, so searches can be underway side by side
+typedef struct Astar_search {
+  // the node set (openSet)
+  __attribute__((aligned(32))) openSetNode openSet[MAPSIZE]; // 4096 * sizeof(openSetNode) = 32KB
+
+  // this array stores the status of the nodes (2 bit per status: 4 statuses per byte)
+  __attribute__((aligned(32))) u8 nodeBitmap[MAPSIZE/4];    // 1024 bytes
+
+  #ifdef ASTAR_OPENSET_HEAP
+  __attribute__((aligned(32))) unsigned int heapKey [MAPSIZE];                // 16384 bytes
+  __attribute__((aligned(32))) unsigned short int heapNode [MAPSIZE];         // 8192 bytes
+  __attribute__((aligned(32))) unsigned short int heapPosition [MAPSIZE];     // 8192 bytes
+
+  // the number of nodes in the openSet Heap
+  unsigned int heap_count;
+  // the sequence number for the next node added
+  unsigned int heap_sequence;
+  #else
+  // Hash Table and ...
+  __attribute__((aligned(32))) unsigned short int hashT [MAXDISTANCE] ;     // 12800 bytes
+  // ...  separate chaining (simple list)
+  __attribute__((aligned(32))) unsigned short int hashT_next [MAPSIZE];     // 8192 bytes
+
+  // The minimum value we've got in the table
+  unsigned int hashT_min;
+  // the number of nodes in the openSet Hash
+  unsigned int hashT_count;
+  // the initialized part of the array in the openSet Hash
+  unsigned int hashT_initialized;
+  #endif
+  // the best node in the closedSet
+  unsigned int closedSet_best;
+  // the min distance in the closedSet
+  unsigned int closedSet_min;
+
+  // the job
+  enum Astar_Result status;     // AS_INITIALIZED when the job is free
+  bool started;                 // whether the openSet holds the start node yet
+  unsigned int sequence;        // jobs submitted earlier are run first
+  unsigned int start;
+  unsigned int goal;
+  unsigned int attackPoint;  // the tile from where we can shoot the goal node:
+  enum Positioned start_heading;
+  bool attack_mode;
+  unsigned int max_attack_distance;
+  const u32 *attack_positions;  // a bit per node, set if the goal can be hit from there. 0 to ask canHitTarget
+  unsigned int cruise_range;
+  unsigned int expanded;
+
+  void *cur_unit;
+  void *cur_unitinfo;
+} Astar_search;
+
+__attribute__((aligned(32))) Astar_search searches[ASTAR_SEARCHES];
+unsigned int jobSequence;
 
 // 'global' values (initialized @ 64x64)
 unsigned int WidthMask = 0x3F;
@@ -48,18 +87,9 @@ unsigned int HeightShift = 6;
 unsigned int MapWidth  = 64;
 unsigned int MapHeight = 64;
 
-// statics
-enum Astar_Result A_status = AS_INITIALIZED;
-unsigned int A_start;
-unsigned int A_goal;
-unsigned int A_attackPoint;  // the tile from where we can shoot the goal node:
-enum Positioned A_start_heading;
-bool A_attack_mode;
-unsigned int A_max_attack_distance;
-unsigned int A_cruise_range;
-
-void *A_cur_unit;
-void *A_cur_unitinfo;
+// Jump Point Search
+bool A_jump_points = false;
+unsigned int A_plain_range;
 
 // the function pointers:
 unsigned int (*mapCanBeTraversed)(unsigned int, unsigned int, void* /* cur_unit */, void* /* cur_unitinfo*/) = 0;
@@ -73,72 +103,177 @@ DTCM_DATA s8 Dirs_y[TOTALDIRECTIONS]  = {-1, -1, 0, +1, +1, +1,  0, -1 };
 // this is another short array that goes in DTCM  (2 bytes)
 DTCM_DATA u8 RealDistances[2] = { HORIZVERT_REAL_DISTANCE, DIAGONAL_REAL_DISTANCE};
 
+// the direction of a move, indexed by [dy+1][dx+1]  (9 bytes)
+DTCM_DATA u8 DirOfMove[3][3] = { {7, 0, 1}, {6, 0, 2}, {5, 4, 3} };
+
 //
 // functions
 //
 
-void reset(void) {
+void reset(Astar_search *s) {
   // reset the node bitmap
-  memset32((u32*)nodeBitmap, 0x00000000, sizeof(nodeBitmap));
+  memset32((u32*)s->nodeBitmap, 0x00000000, sizeof(s->nodeBitmap));
   
+  #ifdef ASTAR_OPENSET_HEAP
+  // reset the openset Heap
+  s->heap_count = 0;
+  s->heap_sequence = HEAP_SEQUENCE_START;
+  #else
   // reset the openset Hash Table (first chunk) to all 'NULLLINK'
-  memset32((u32*)hashT, NULLLINK|(NULLLINK<<16), HASHT_CHUNK*sizeof(unsigned short int));
+  memset32((u32*)s->hashT, NULLLINK|(NULLLINK<<16), HASHT_CHUNK*sizeof(unsigned short int));
 
   // reset counters
-  hashT_count = 0;
-  hashT_min   = (MAXDISTANCE-1);
-  hashT_initialized = HASHT_CHUNK;
+  s->hashT_count = 0;
+  s->hashT_min   = (MAXDISTANCE-1);
+  s->hashT_initialized = HASHT_CHUNK;
+  #endif
   
   // reset closedSet var
-  closedSet_min = (MAXDISTANCE-1);
+  s->closedSet_min = (MAXDISTANCE-1);
+  
+  s->expanded = 0;
 }
 
 // ****************************************************************************
 
+#ifdef ASTAR_OPENSET_HEAP
+
+// move the node at position in the heap up until its parent has a lower key
+void heap_siftUp(Astar_search *s, unsigned int position) {
+
+  unsigned int node = s->heapNode[position];
+  unsigned int key = s->heapKey[position];
+  
+  while (position>0) {
+    unsigned int parent = (position-1) / HEAP_ARITY;
+    if (s->heapKey[parent]<=key)
+      break;
+    s->heapKey[position]=s->heapKey[parent];
+    s->heapNode[position]=s->heapNode[parent];
+    s->heapPosition[s->heapNode[position]]=position;
+    position=parent;
+  }
+  
+  s->heapKey[position]=key;
+  s->heapNode[position]=node;
+  s->heapPosition[node]=position;
+}
+
+// move the node at position in the heap down until none of its children has a lower key
+void heap_siftDown(Astar_search *s, unsigned int position) {
+
+  unsigned int node = s->heapNode[position];
+  unsigned int key = s->heapKey[position];
+  
+  while (1) {
+    unsigned int child = position*HEAP_ARITY + 1;
+    if (child>=s->heap_count)
+      break;
+    // find the child with the lowest key
+    unsigned int last = MIN(child+HEAP_ARITY, s->heap_count);
+    unsigned int best = child;
+    for (child++; child<last; child++) {
+      if (s->heapKey[child]<s->heapKey[best])
+        best=child;
+    }
+    if (s->heapKey[best]>=key)
+      break;
+    s->heapKey[position]=s->heapKey[best];
+    s->heapNode[position]=s->heapNode[best];
+    s->heapPosition[s->heapNode[position]]=position;
+    position=best;
+  }
+  
+  s->heapKey[position]=key;
+  s->heapNode[position]=node;
+  s->heapPosition[node]=position;
+}
+
+// add a node to the openSet
+void openSet_add(Astar_search *s, unsigned int new_node, unsigned int seed) {
+
+  s->heapKey[s->heap_count]=(seed<<16) | (s->heap_sequence--);
+  s->heapNode[s->heap_count]=new_node;
+  heap_siftUp(s, s->heap_count++);
+  
+  // update the bitmap
+  SET_NODE_STATUS(s, new_node, NS_OPENSET);
+}
+
+// retrieve the first node from the openSet, and removes it from the heap.
+unsigned int openSet_popFirst(Astar_search *s) {
+
+  // openSet empty? Exit!
+  if (s->heap_count==0)
+    return (NULLLINK);
+  
+  unsigned int first=s->heapNode[0];
+  
+  // the last node takes the place of the first
+  if (--s->heap_count>0) {
+    s->heapKey[0]=s->heapKey[s->heap_count];
+    s->heapNode[0]=s->heapNode[s->heap_count];
+    heap_siftDown(s, 0);
+  }
+  
+  return (first);
+}
+
+// lower the f_score of a node already in the openSet
+void openSet_decrease(Astar_search *s, unsigned int node, unsigned int old_seed, unsigned int new_seed) {
+
+  unsigned int position=s->heapPosition[node];
+  
+  s->heapKey[position]=(new_seed<<16) | (s->heap_sequence--);
+  heap_siftUp(s, position);
+}
+
+#else
+
 // add a node to the openSet
 // the node contains the f_score, and this is used to find the entry in the
 // hash table. Here, there's a simple list (nodes with same f_value) and 
 // we'll add in the beginning.
 // We could also need to update the hashT_min value
-void openSet_add(unsigned int new_node, unsigned int seed) {
+void openSet_add(Astar_search *s, unsigned int new_node, unsigned int seed) {
 
   // check if we need to initialize some other chunks of the hash table
-  while (seed>=hashT_initialized) {
-    memset32((u32*)&hashT[hashT_initialized], NULLLINK|(NULLLINK<<16), HASHT_CHUNK*sizeof(unsigned short int));
-    hashT_initialized+=HASHT_CHUNK;
+  while (seed>=s->hashT_initialized) {
+    memset32((u32*)&s->hashT[s->hashT_initialized], NULLLINK|(NULLLINK<<16), HASHT_CHUNK*sizeof(unsigned short int));
+    s->hashT_initialized+=HASHT_CHUNK;
   }
   
   // insert in the hash table list (as first item)
-  hashT_next[new_node]=hashT[seed];
-  hashT[seed]=new_node;
+  s->hashT_next[new_node]=s->hashT[seed];
+  s->hashT[seed]=new_node;
   
   // we've got 1 more item
-  hashT_count++;
+  s->hashT_count++;
   
   // update hashT_min if needed
-  if (seed<hashT_min)
-    hashT_min=seed;
+  if (seed<s->hashT_min)
+    s->hashT_min=seed;
     
   // update the bitmap
-  SET_NODE_STATUS(new_node, NS_OPENSET);
+  SET_NODE_STATUS(s, new_node, NS_OPENSET);
 }
 
 // ****************************************************************************
 
 // retrieve the first node from the openSet, and removes it from the list.
-unsigned int openSet_popFirst(void) {
+unsigned int openSet_popFirst(Astar_search *s) {
 
   // openSet empty? Exit! Otherwise just decrease it
-  if (hashT_count--==0)
+  if (s->hashT_count--==0)
     return (NULLLINK);
   
   // find the first NOT NULL list in the table (make sure we're actually pointing to a node)
-  while (hashT[hashT_min]==NULLLINK) {
-    hashT_min++;
+  while (s->hashT[s->hashT_min]==NULLLINK) {
+    s->hashT_min++;
   }
 
-  unsigned int first=hashT[hashT_min];
-  hashT[hashT_min]=hashT_next[first];
+  unsigned int first=s->hashT[s->hashT_min];
+  s->hashT[s->hashT_min]=s->hashT_next[first];
   
   return (first);
 }
@@ -146,37 +281,60 @@ unsigned int openSet_popFirst(void) {
 // ****************************************************************************
 
 // remove a node from the openSet
-void openSet_del(unsigned int node, unsigned int seed) {
+void openSet_del(Astar_search *s, unsigned int node, unsigned int seed) {
 
-  if (hashT[seed]==node) {
-    hashT[seed]=hashT_next[node];
+  if (s->hashT[seed]==node) {
+    s->hashT[seed]=s->hashT_next[node];
   } else {
-    unsigned int prev = hashT[seed];
-    seed=hashT_next[prev];
+    unsigned int prev = s->hashT[seed];
+    seed=s->hashT_next[prev];
     while (seed!=node) {
       prev=seed;
-      seed=hashT_next[seed];
+      seed=s->hashT_next[seed];
     }
-    hashT_next[prev]=hashT_next[seed];
+    s->hashT_next[prev]=s->hashT_next[seed];
   }
   
   // we've got 1 less item now
-  hashT_count--;
+  s->hashT_count--;
+}
+
+// ****************************************************************************
+
+// lower the f_score of a node already in the openSet
+void openSet_decrease(Astar_search *s, unsigned int node, unsigned int old_seed, unsigned int new_seed) {
+
+  // remove it from its old list and add it to the new one
+  openSet_del(s, node, old_seed);
+  openSet_add(s, node, new_seed);
 }
 
+#endif
+
 // ****************************************************************************
 
 // add a node to the closedSet
-void closedSet_add(unsigned int node) {
+void closedSet_add(Astar_search *s, unsigned int node) {
 
-  unsigned int h_score = openSet[node].f_score-openSet[node].g_score;
+  unsigned int h_score = s->openSet[node].f_score-s->openSet[node].g_score;
 
-  if (h_score<closedSet_min) {
-    closedSet_best=node;
-    closedSet_min=h_score;
+  if (h_score<s->closedSet_min) {
+    s->closedSet_best=node;
+    s->closedSet_min=h_score;
   }
     
-  SET_NODE_STATUS(node, NS_CLOSEDSET);             
+  SET_NODE_STATUS(s, node, NS_CLOSEDSET);
+}
+
+// a node jumped over counts as reached too, in case no path exists and the closest node is needed
+void closedSet_consider(Astar_search *s, unsigned int node) {
+
+  unsigned int h_score = Astar_heuristicDistance(node, s->goal);
+
+  if (h_score<s->closedSet_min) {
+    s->closedSet_best=node;
+    s->closedSet_min=h_score;
+  }
 }
 
 
@@ -226,6 +384,116 @@ unsigned int moveTo(unsigned int start, unsigned int dir) {
   
 }
 
+//
+//  functions - Jump Point Search
+//
+// On open terrain, many nodes on the way to the goal have the same cost along several symmetric
+// paths. Jump Point Search only adds the nodes at which a path may have to turn (jump points) to
+// the openSet, jumping straight over the nodes in between. As mapCanBeTraversed may consider units
+// near the start, that area is expanded node by node as usual.
+//
+
+// returns the node at x,y, or NULLLINK if it doesn't exist or can't be traversed
+unsigned int traversableNode(Astar_search *s, int x, int y) {
+
+  if (((unsigned int)x>=MapWidth) || ((unsigned int)y>=MapHeight))
+    return (NULLLINK);
+    
+  unsigned int node=(y << HeightShift) | x;
+  if (!mapCanBeTraversed(node, Astar_heuristicDistance(s->start,node), s->cur_unit, s->cur_unitinfo))
+    return (NULLLINK);
+  return (node);
+}
+
+// true if the node is near enough to the start to be expanded as in a plain A* search
+bool isPlainNode(Astar_search *s, unsigned int node) {
+  return ((!A_jump_points) || (Astar_heuristicDistance(s->start,node)<=A_plain_range));
+}
+
+// true if the search ends at this node
+bool isGoalNode(Astar_search *s, unsigned int node) {
+  if (s->attack_mode) {
+    if (s->attack_positions)
+      return ((s->attack_positions[node >> 5] >> (node & 31)) & 1);
+    return (Astar_heuristicDistance(node,s->goal)<=s->max_attack_distance);
+  }
+  return (node==s->goal);
+}
+
+// moves from node in direction dir until arriving at a node that needs to be expanded: the goal,
+// a node near the start or a jump point. returns NULLLINK when running into an obstacle, or out of cruise range
+unsigned int jump(Astar_search *s, unsigned int node, unsigned int dir, unsigned int g_score) {
+
+  int dx=Dirs_x[dir];
+  int dy=Dirs_y[dir];
+  int x=(node & WidthMask);
+  int y=(node >> HeightShift);
+  
+  while (1) {
+    x+=dx;
+    y+=dy;
+    g_score+=RealDistances[dir & 0x01];
+    
+    node=traversableNode(s,x,y);
+    if (node==NULLLINK)
+      return (NULLLINK);
+    if ((s->cruise_range>0) && (g_score>s->cruise_range))
+      return (NULLLINK);
+    closedSet_consider(s, node);
+    
+    if (isGoalNode(s, node) || isPlainNode(s, node))
+      return (node);
+    
+    if (dx && dy) {
+      // a neighbour behind an obstacle to the side is forced
+      if ((traversableNode(s,x-dx,y)==NULLLINK && traversableNode(s,x-dx,y+dy)!=NULLLINK) ||
+          (traversableNode(s,x,y-dy)==NULLLINK && traversableNode(s,x+dx,y-dy)!=NULLLINK))
+        return (node);
+      // moving diagonally, a node from where moving straight leads to a jump point is one as well
+      if (jump(s, node, DirOfMove[1][dx+1], g_score)!=NULLLINK ||
+          jump(s, node, DirOfMove[dy+1][1], g_score)!=NULLLINK)
+        return (node);
+    } else if (dx) {
+      if ((traversableNode(s,x,y-1)==NULLLINK && traversableNode(s,x+dx,y-1)!=NULLLINK) ||
+          (traversableNode(s,x,y+1)==NULLLINK && traversableNode(s,x+dx,y+1)!=NULLLINK))
+        return (node);
+    } else {
+      if ((traversableNode(s,x-1,y)==NULLLINK && traversableNode(s,x-1,y+dy)!=NULLLINK) ||
+          (traversableNode(s,x+1,y)==NULLLINK && traversableNode(s,x+1,y+dy)!=NULLLINK))
+        return (node);
+    }
+  }
+}
+
+// true if a path arriving at node in direction heading may need to continue in direction dir
+bool isJumpDirection(Astar_search *s, unsigned int node, unsigned int heading, unsigned int dir) {
+
+  int hx=Dirs_x[heading];
+  int hy=Dirs_y[heading];
+  int x=(node & WidthMask);
+  int y=(node >> HeightShift);
+  
+  if (dir==heading)
+    return (true);
+    
+  if (hx && hy) {
+    // the straight parts of the heading, and the forced neighbours
+    if ((dir==DirOfMove[1][hx+1]) || (dir==DirOfMove[hy+1][1]))
+      return (true);
+    if (dir==DirOfMove[hy+1][-hx+1])
+      return (traversableNode(s,x-hx,y)==NULLLINK);
+    if (dir==DirOfMove[-hy+1][hx+1])
+      return (traversableNode(s,x,y-hy)==NULLLINK);
+  } else if (hx) {
+    if (Dirs_x[dir]==hx && Dirs_y[dir])
+      return (traversableNode(s,x,y+Dirs_y[dir])==NULLLINK);
+  } else {
+    if (Dirs_y[dir]==hy && Dirs_x[dir])
+      return (traversableNode(s,x+Dirs_x[dir],y)==NULLLINK);
+  }
+  return (false);
+}
+
 //
 //   configuration functions
 //
@@ -264,13 +532,24 @@ bool Astar_config (unsigned int width, unsigned int height) {
   // set mask for width (the lower bits)
   WidthMask = BIT(HeightShift)-1;
   
-  // set status to AS_INITIALIZED, since no search has been yet performed
-  A_status = AS_INITIALIZED;
+  // free all jobs, since no search has been yet performed
+  unsigned int job;
+  for (job=0; job<ASTAR_SEARCHES; job++)
+    searches[job].status = AS_INITIALIZED;
   
   return (true);
 }
 
 
+// switches Jump Point Search on or off. nodes up to plain_range away from the start are always expanded as usual
+void Astar_jumpPointSearch (bool enable, unsigned int plain_range) {
+
+  A_jump_points = enable;
+  A_plain_range = plain_range;
+
+}
+
+
 // to be called ONCE before using Astar, to map function pointers to REAL functions
 void Astar_callback (unsigned int (*mapCanBeTraversed_funct)(unsigned int, unsigned int, void*, void*),
                      unsigned int (*canHitTarget_funct)(unsigned int, unsigned int, void*, void*),
@@ -287,142 +566,222 @@ void Astar_callback (unsigned int (*mapCanBeTraversed_funct)(unsigned int, unsig
 //  The A* search algo. Based on the code found at http://en.wikipedia.org/wiki/A*#Pseudocode
 //
 
-// sets parameters for the path search and starts it
-void Astar_startSearch (unsigned int start, unsigned int goal, enum Positioned start_heading, bool attack_mode, unsigned int max_attack_distance, unsigned int cruise_range, void *cur_unit, void *cur_unitinfo) {
+// puts the start node in the openSet
+void startSearch (Astar_search *s) {
 
   // reset the search
-  reset();
-  
-  // copy all the params into statics
-  A_start = start;
-  A_goal = goal;
-  A_start_heading = start_heading;
-  A_attack_mode = attack_mode;
-  A_max_attack_distance = max_attack_distance;
-  A_cruise_range = cruise_range;
-  A_cur_unit=cur_unit;
-  A_cur_unitinfo=cur_unitinfo;
+  reset(s);
   
   // initialize the start node (f=g+h)
-  openSet[start].f_score=Astar_heuristicDistance(A_start, A_goal);
-  openSet[start].g_score=0;
-  openSet[start].heading=A_start_heading;
+  s->openSet[s->start].f_score=Astar_heuristicDistance(s->start, s->goal);
+  s->openSet[s->start].g_score=0;
+  s->openSet[s->start].heading=s->start_heading;
 
   // add the start node to the openset
-  openSet_add(A_start, openSet[start].f_score);
+  openSet_add(s, s->start, s->openSet[s->start].f_score);
   
-  A_status = AS_INCOMPLETE;
-  Astar_continueSearch();
+  s->started = true;
 
 }
 
-// go on with an already started path search
-void Astar_continueSearch (void) {
+// go on with an already started path search. a cooperative search stops when canContinueSearch tells it to
+void continueSearch (Astar_search *s, bool cooperative) {
 
   // make sure there's a search going on
-  if (A_status != AS_INCOMPLETE)
+  if (s->status != AS_INCOMPLETE)
     return;
 
+  if (!s->started)
+    startSearch(s);
+
   // pop out a node from the openSet
-  unsigned int curr_node = openSet_popFirst();              
+  unsigned int curr_node = openSet_popFirst(s);
   
   // while openSet is not empty
   while (curr_node!=NULLLINK) {
   
     // check if we are in attack_mode and we could shoot the goal from the current tile
     // or if we are NOT in attack_mode and we reached the goal node
-    if (A_attack_mode) {
-      if ((openSet[curr_node].f_score-openSet[curr_node].g_score)<=A_max_attack_distance) {
-        if (canHitTarget(curr_node, A_goal, A_cur_unit, A_cur_unitinfo)) {
-          A_attackPoint=curr_node;
-          A_status=AS_COMPLETE;
+    if (s->attack_mode) {
+      if (s->attack_positions) {
+        // any of the nodes from where the goal can be hit will do
+        if ((s->attack_positions[curr_node >> 5] >> (curr_node & 31)) & 1) {
+          s->attackPoint=curr_node;
+          s->status=AS_COMPLETE;
+          return;
+        }
+      } else if ((s->openSet[curr_node].f_score-s->openSet[curr_node].g_score)<=s->max_attack_distance) {
+        if (canHitTarget(curr_node, s->goal, s->cur_unit, s->cur_unitinfo)) {
+          s->attackPoint=curr_node;
+          s->status=AS_COMPLETE;
           return;
         }
       }
     } else {
-      if (curr_node==A_goal) {
-        A_status = AS_COMPLETE;
+      if (curr_node==s->goal) {
+        s->status = AS_COMPLETE;
         return;
       }
     }
     
     // add curr_node to closedset
-    closedSet_add(curr_node);
+    closedSet_add(s, curr_node);
+    s->expanded++;
+    
+    // whether to expand curr_node by jumping
+    bool jumping = !isPlainNode(s, curr_node);
 
     // for each one of the 8 directions    
-    unsigned int dir = openSet[curr_node].heading;
+    unsigned int dir = s->openSet[curr_node].heading;
     do {
      
       // check every direction, keeping current heading as last one
       dir = (dir+1) % TOTALDIRECTIONS;
      
-      // check if a node exists in this direction
-      unsigned int new_node=moveTo(curr_node,dir);
+      unsigned int new_node;
+      if (jumping) {
+        // only the directions a path can continue in from here
+        if (!isJumpDirection(s, curr_node, s->openSet[curr_node].heading, dir))
+          continue;
+        new_node=jump(s, curr_node, dir, s->openSet[curr_node].g_score);
+      } else
+        // check if a node exists in this direction
+        new_node=moveTo(curr_node,dir);
       
       // if this new node doesn't exist (there's no node in this direction), just skip it
       if (new_node==NULLLINK)
         continue;
      
       // if this node is already in the closedSet just skip it
-      unsigned int node_status = GET_NODE_STATUS(new_node);
+      unsigned int node_status = GET_NODE_STATUS(s, new_node);
       if (node_status==NS_CLOSEDSET)
         continue;
       
-      // here we check if the node in this game can be traversed
-      // if (!mapCanBeTraversed(new_node, tentative_g_score, A_cur_unit, A_cur_unitinfo))
-      if (!mapCanBeTraversed(new_node, Astar_heuristicDistance(A_start,new_node), A_cur_unit, A_cur_unitinfo))
+      // here we check if the node in this game can be traversed (jump already did so)
+      // if (!mapCanBeTraversed(new_node, tentative_g_score, s->cur_unit, s->cur_unitinfo))
+      if (!jumping && !mapCanBeTraversed(new_node, Astar_heuristicDistance(s->start,new_node), s->cur_unit, s->cur_unitinfo))
         continue;
         
-      // distance from start to curr_node (g_score) and from curr_node to new_node
-      unsigned int tentative_g_score = openSet[curr_node].g_score + RealDistances[dir & 0x01];
-      //                               + TurningCost(openSet[curr_node].heading, dir);
+      // distance from start to curr_node (g_score) and from curr_node to new_node. a jump is a straight line,
+      // so its length is what the heuristic tells
+      unsigned int tentative_g_score = s->openSet[curr_node].g_score +
+                                       (jumping ? Astar_heuristicDistance(curr_node,new_node) : RealDistances[dir & 0x01]);
+      //                               + TurningCost(s->openSet[curr_node].heading, dir);
       
       // check if 'cruise_range' (if in use) is enough to reach this new_node
       // if tentative_g_score>range then skip that
-      if ((A_cruise_range>0) && (tentative_g_score>A_cruise_range))
+      if ((s->cruise_range>0) && (tentative_g_score>s->cruise_range))
         continue;
       
       // if node isn't yet in the openset OR needs to be updated then go on, otherwise leave
-      if ((node_status!=NS_OPENSET) || (tentative_g_score < openSet[new_node].g_score)) ;
+      if ((node_status!=NS_OPENSET) || (tentative_g_score < s->openSet[new_node].g_score)) ;
       else continue;
       
-      // if we need to update it, remove it from the openSet (before changing the f_score!)
-      if (node_status==NS_OPENSET)
-        openSet_del(new_node, openSet[new_node].f_score);
+      // the previous f_score is needed to find the node in the openSet, if it's in there
+      unsigned int old_f_score = s->openSet[new_node].f_score;
      
-      openSet[new_node].f_score=tentative_g_score+Astar_heuristicDistance(new_node,A_goal);
-      openSet[new_node].g_score=tentative_g_score;
-      openSet[new_node].heading=dir;
-      openSet[new_node].came_from=curr_node;
+      s->openSet[new_node].f_score=tentative_g_score+Astar_heuristicDistance(new_node,s->goal);
+      s->openSet[new_node].g_score=tentative_g_score;
+      s->openSet[new_node].heading=dir;
+      s->openSet[new_node].came_from=curr_node;
         
-      openSet_add(new_node, openSet[new_node].f_score);
+      if (node_status==NS_OPENSET)
+        openSet_decrease(s, new_node, old_f_score, s->openSet[new_node].f_score);
+      else
+        openSet_add(s, new_node, s->openSet[new_node].f_score);
       
-    } while (dir!=openSet[curr_node].heading);   // end ['Directions']
+    } while (dir!=s->openSet[curr_node].heading);   // end ['Directions']
     
     // check if it's not too 'late' to process another node
-    if (!canContinueSearch()) {
-      A_status = AS_INCOMPLETE;
+    if (cooperative && !canContinueSearch()) {
+      s->status = AS_INCOMPLETE;
       return;
     }
     
     // get next node from the openSet
-    curr_node = openSet_popFirst();
+    curr_node = openSet_popFirst(s);
     
   } // end [while openSet is not empty]
   
   // if we get here, it means the search failed
-  A_status = AS_FAILED;
+  s->status = AS_FAILED;
   return;
 }
 
-// invalidate any started path search
-void Astar_invalidateSearch (void) {
-  A_status = AS_INITIALIZED;
+
+//
+//   jobs
+//
+
+// submits a path search, to be run by Astar_runJobs
+int Astar_submitJob (unsigned int start, unsigned int goal, enum Positioned start_heading, bool attack_mode, unsigned int max_attack_distance, const u32 *attack_positions, unsigned int cruise_range, void *cur_unit, void *cur_unitinfo) {
+
+  // find a free search
+  int job;
+  for (job=0; (job<ASTAR_SEARCHES) && (searches[job].status!=AS_INITIALIZED); job++);
+  if (job==ASTAR_SEARCHES)
+    return (-1);
+
+  // copy all the params into the search
+  Astar_search *s = &searches[job];
+  s->start = start;
+  s->goal = goal;
+  s->start_heading = start_heading;
+  s->attack_mode = attack_mode;
+  s->max_attack_distance = max_attack_distance;
+  s->attack_positions = attack_positions;
+  s->cruise_range = cruise_range;
+  s->cur_unit=cur_unit;
+  s->cur_unitinfo=cur_unitinfo;
+  s->expanded = 0;
+
+  s->started = false;
+  s->sequence = jobSequence++;
+  s->status = AS_INCOMPLETE;
+  return (job);
+}
+
+// runs the jobs one after the other, in the order they were submitted, as long as canContinueSearch allows
+void Astar_runJobsInTurn (void) {
+
+  while (canContinueSearch()) {
+    // the earliest submitted job that is still underway
+    Astar_search *first = 0;
+    unsigned int job;
+    for (job=0; job<ASTAR_SEARCHES; job++) {
+      if ((searches[job].status==AS_INCOMPLETE) && ((!first) || (searches[job].sequence-first->sequence>=0x80000000)))
+        first = &searches[job];
+    }
+    if (!first)
+      return;
+    continueSearch(first, true);
+  }
+}
+
+#ifndef ASTAR_THREADS
+void Astar_runJobs (void) {
+  Astar_runJobsInTurn();
+}
+#endif
+
+// runs the search of a job until it completes or fails
+void Astar_completeJob (int job) {
+  continueSearch(&searches[job], false);
+}
+
+// returns the status of a job
+enum Astar_Result Astar_pollJob (int job) {
+  return (searches[job].status);
+}
+
+// frees a job, cancelling its search if it's still underway
+void Astar_releaseJob (int job) {
+  searches[job].status = AS_INITIALIZED;
 }
 
-// returns current path search status
-enum Astar_Result Astar_getStatus (void) {
-  return (A_status);
+// returns the number of nodes expanded by the search of a job
+unsigned int Astar_expandedNodes (int job) {
+  return (searches[job].expanded);
 }
 
 // turns nodes into tiles
@@ -430,63 +789,62 @@ unsigned int Astar_tile (unsigned int node) {
   return ((node >> HeightShift)*MapWidth + (node & WidthMask));
 }
 
-unsigned int Astar_closest (void) {
-  return (Astar_tile(closedSet_best));
+unsigned int Astar_closest (int job) {
+  return (Astar_tile(searches[job].closedSet_best));
 }
 
-unsigned int Astar_attackPoint (void) {
-  return (Astar_tile(A_attackPoint));
+unsigned int Astar_attackPoint (int job) {
+  return (Astar_tile(searches[job].attackPoint));
 }
 
-unsigned int Astar_loadPath(unsigned short int *nodebuffer) {
-  unsigned short int path[PATHBUFFERLEN];
-  int index=PATHBUFFERLEN-1;
-  int wrap=0;
+// returns the number of 'elbows' on the path from start to goal, the start excluded and the goal included
+unsigned int Astar_pathNodes (int job) {
+  Astar_search *s = &searches[job];
+  unsigned int count=1;
   
   // we make sure a complete search has been performed
-  if (A_status != AS_COMPLETE)
+  if (s->status != AS_COMPLETE)
     return(0);
-    
-  // select where to build the backward 'elbows' list
-  unsigned int goal_node = A_attack_mode?A_attackPoint:A_goal;
-
-  // store the goal node as last path node
-  path[index]=goal_node;
-  index--;
   
-  // go back in the path storing all the 'elbows'
-  unsigned int curr=goal_node;
-  while (curr!=A_start) {
-    // go back searching the 'elbows'
-    if (openSet[curr].heading!=openSet[openSet[curr].came_from].heading) {
-      // avoid storing the start node
-      if (openSet[curr].came_from!=A_start) {
-        path[index]=openSet[curr].came_from;
-        index--;
-        if (index<0) {
-          index=PATHBUFFERLEN-1;
-          wrap++;
-        }
-      }
-    }
-    curr=openSet[curr].came_from;
+  unsigned int curr=s->attack_mode?s->attackPoint:s->goal;
+  while (curr!=s->start) {
+    if ((s->openSet[curr].heading!=s->openSet[s->openSet[curr].came_from].heading) && (s->openSet[curr].came_from!=s->start))
+      count++;
+    curr=s->openSet[curr].came_from;
   }
+  return (count);
+}
+
+unsigned int Astar_loadPathNodes(int job, unsigned short int *nodebuffer, unsigned int max_nodes) {
+  Astar_search *s = &searches[job];
+  unsigned int count=Astar_pathNodes(job);
+  unsigned int index=count-1;
   
-  // copy path
-  int i=index+1;
-  while (i<PATHBUFFERLEN) {
-    *nodebuffer++=path[i++];
-  }
+  if (count==0)
+    return(0);
   
-  if (wrap) {
-    int i=0;
-    while (i<=index) {
-      *nodebuffer++=path[i++];
+  // store the goal node as last path node
+  unsigned int goal_node = s->attack_mode?s->attackPoint:s->goal;
+  if (index<max_nodes)
+    nodebuffer[index]=goal_node;
+  
+  // go back in the path storing the 'elbows' that fit in nodebuffer
+  unsigned int curr=goal_node;
+  while (curr!=s->start) {
+    // go back searching the 'elbows', avoiding storing the start node
+    if ((s->openSet[curr].heading!=s->openSet[s->openSet[curr].came_from].heading) && (s->openSet[curr].came_from!=s->start)) {
+      index--;
+      if (index<max_nodes)
+        nodebuffer[index]=s->openSet[curr].came_from;
     }
+    curr=s->openSet[curr].came_from;
   }
   
-  return (wrap * PATHBUFFERLEN + ((PATHBUFFERLEN-1) - index));
+  return (count);
 }
 
+unsigned int Astar_loadPath(int job, unsigned short int *nodebuffer) {
+  return (Astar_loadPathNodes(job, nodebuffer, PATHBUFFERLEN));
+}
 
 #endif
@@ -6,15 +6,27 @@
 // Astar - an A* implementation - by sverx
 //
 
+// the openSet is kept in a Hash Table of lists of nodes with the same f_score by default. define this to
+// keep it in an indexed 4-ary heap instead, which doesn't need to walk the lists to remove a node from them
+//#define ASTAR_OPENSET_HEAP
+
 // length of the buffer to store path nodes
 #define PATHBUFFERLEN   16
 
+// the number of path searches (jobs) that can be underway at once, each taking some 54 kB. define ASTAR_THREADS
+// when Astar_runJobs is provided by a runner using threads (as in the host build) rather than by astar.c itself
+#ifdef ASTAR_THREADS
+#define ASTAR_SEARCHES  16
+#else
+#define ASTAR_SEARCHES  1
+#endif
+
 // 64x64 == 32x128 == 128x32 == 4096
 #define MAPSIZE       4096
 
-// to access node status
-#define GET_NODE_STATUS(k)      ((nodeBitmap[(k)>>2]>>(((k)&0x03)<<1))&0x03)
-#define SET_NODE_STATUS(k,v)     (nodeBitmap[(k)>>2]|=((v)<<(((k)&0x03)<<1)))
+// to access node status, in the nodeBitmap of search s
+#define GET_NODE_STATUS(s,k)      (((s)->nodeBitmap[(k)>>2]>>(((k)&0x03)<<1))&0x03)
+#define SET_NODE_STATUS(s,k,v)     ((s)->nodeBitmap[(k)>>2]|=((v)<<(((k)&0x03)<<1)))
 
 // node statuses (2 bits)
 #define NS_NEW          0b00
@@ -64,45 +76,75 @@ void Astar_callback (unsigned int (*mapCanBeTraversed_funct)(unsigned int, unsig
 // to be called ONCE before using Astar, to set map size
 bool Astar_config (unsigned int width, unsigned int height);
 
-// this is what Astar_getStatus() will return:
+// switches Jump Point Search on or off (default). with it, the nodes between turning points on open terrain
+// are jumped over rather than added to the openSet. nodes up to plain_range (a heuristic distance) away from
+// the start are expanded one by one as usual, which is where mapCanBeTraversed may consider moving units
+void Astar_jumpPointSearch (bool enable, unsigned int plain_range);
+
+// this is what Astar_pollJob() will return:
 enum Astar_Result { AS_INITIALIZED, AS_COMPLETE, AS_INCOMPLETE, AS_FAILED };
-// AS_INITIALIZED : No path search run, yet -> Start a search at your needs
+// AS_INITIALIZED : No path search submitted -> The job is free
 // AS_COMPLETE    : A path has been found -> You should then read it from nodes
-// AS_INCOMPLETE  : A path hasn't been yet found, still there are chances -> You should continue searching
+// AS_INCOMPLETE  : A path hasn't been yet found, still there are chances -> Have Astar_runJobs() continue searching
 // AS_FAILED      : No path exists -> You can call Astar_closest() to find the closest node to goal you can reach from start
 
-// start the path search itself
-void Astar_startSearch (unsigned int start, unsigned int goal, enum Positioned start_heading, bool attack_mode, unsigned int max_attack_distance, unsigned int cruise_range, void *cur_unit, void *cur_unitinfo);
+// submit a path search. returns the job, or -1 if ASTAR_SEARCHES jobs are already in use
+int Astar_submitJob (unsigned int start, unsigned int goal, enum Positioned start_heading, bool attack_mode, unsigned int max_attack_distance, const u32 *attack_positions, unsigned int cruise_range, void *cur_unit, void *cur_unitinfo);
 // start, goal         : start and goal tile, y and x separated on upper/lower bits
 // start_heading       : 0 to 7, initial heading of the unit
 // attack_mode         : TRUE if we just need to locate a spot close enough to attack the goal node
 // max_attack_distance : The highest distance this unit can shoot (when attack mode is TRUE)
+// attack_positions    : if not 0, the nodes from where the goal can be hit (when attack mode is TRUE): a bit per node,
+//                       as in attack_positions[node >> 5] & BIT(node & 31). any of them ends the search, without
+//                       asking canHitTarget for the nodes within max_attack_distance. it's read while the job runs
 // cruise_range        : if >0, this limits the distance the unit can go
 // cur_unit            : points to the current unit
 // cur_unitinfo        : points to the current unit info
 
-// go on with an already started path search
-void Astar_continueSearch (void);
+// run the jobs submitted. on the DS, they are run one after the other in the order they were submitted, as long
+// as canContinueSearch allows; jobs not done yet are continued the next time. with ASTAR_THREADS, they are all run
+// to completion, side by side, before this returns. mapCanBeTraversed and canHitTarget are then called from
+// several threads at once: whatever they read is not to be changed while this runs
+void Astar_runJobs (void);
+
+// run the jobs the way Astar_runJobs does on the DS, also with ASTAR_THREADS
+void Astar_runJobsInTurn (void);
 
-// invalidate any started path search
-void Astar_invalidateSearch (void);
+// run the search of a job until it completes or fails, without asking canContinueSearch (for runners of jobs)
+void Astar_completeJob (int job);
 
-// get path search status
-enum Astar_Result Astar_getStatus (void);
+#ifdef ASTAR_THREADS
+// set the number of threads Astar_runJobs uses, the calling one included. 0 (default) uses one per processor
+void Astar_setThreads (unsigned int threads);
+#endif
+
+// get the status of a job
+enum Astar_Result Astar_pollJob (int job);
+
+// free a job once its results were read, cancelling its search if it's still underway
+void Astar_releaseJob (int job);
+
+// get the number of nodes expanded by the search of a job
+unsigned int Astar_expandedNodes (int job);
 
 // call this when the path search fails. Returns x,y as a x + mapwidth*y single value.
-unsigned int Astar_closest (void);
+unsigned int Astar_closest (int job);
 
 // turns nodes into tiles (helper)
 unsigned int Astar_tile (unsigned int node);
 
 // call this for finding the location from where it's possible to attack the goal node.
 // Returns x,y as a x + mapwidth*y single value.
-unsigned int Astar_attackPoint (void);
+unsigned int Astar_attackPoint (int job);
 
 // call this for loading the first PATHBUFFERLEN nodes from start to goal
 // nodebuffer is a pointer to a unsigned short int[PATHBUFFERLEN] array
-unsigned int Astar_loadPath(unsigned short int *nodebuffer);
+unsigned int Astar_loadPath(int job, unsigned short int *nodebuffer);
+
+// the same, for loading the first max_nodes nodes. both return the number of nodes of the whole path,
+// which is what Astar_pathNodes returns too
+unsigned int Astar_loadPathNodes(int job, unsigned short int *nodebuffer, unsigned int max_nodes);
+unsigned int Astar_pathNodes (int job);
 
 // added this so we can use the same heuristic outside astar sources
 unsigned int Astar_heuristicDistance (unsigned int node_a, unsigned int node_b);
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Local avoidance: a unit whose next tile is taken by another unit used to have
+// a path searched for right away, one that takes the units nearby into account.
+// In a jam, at a refinery entrance or a chokepoint, that meant every unit
+// searching again and again for a way past the others.
+//
+// Instead, a unit first tries to get past on its own. A unit in the way that is
+// moving on is simply waited for. A friendly unit coming the other way is let
+// past by one of both stepping aside. Any other unit is stepped around, through
+// a free neighbouring tile nearer to where the unit is headed. Only when that
+// fails and the way stays blocked for a while is a path searched for, and the
+// unit waits twice as long the next time it is blocked.
+
+#include "avoidance.h"
+#ifndef REMOVE_ASTAR_PATHFINDING
+
+#include "environment.h"
+#include "bitboards.h"
+#include "shared.h"
+
+static u8 unitBlockedFrames[MAX_UNITS_ON_MAP];  // the logic frames the unit has been waiting, 0 if it isn't blocked
+static u8 unitBackoff[MAX_UNITS_ON_MAP];        // the searches in a row that the unit's waiting ended in
+static int avoidanceResolutions[AR_AMOUNT];
+
+
+void initAvoidanceWithScenario() {
+    int i;
+
+    for (i=0; i<MAX_UNITS_ON_MAP; i++) {
+        unitBlockedFrames[i] = 0;
+        unitBackoff[i] = 0;
+    }
+    for (i=0; i<AR_AMOUNT; i++)
+        avoidanceResolutions[i] = 0;
+}
+
+// returns the move onto the free neighbouring tile nearest to aimTile, or UM_NONE if there is none.
+// if progress, only tiles nearer to aimTile than curTile are considered
+static enum UnitMove getStepAside(struct Unit *curUnit, int curTile, int blockedTile, int aimTile, bool progress) {
+    unsigned int bestDistance = progress ? Astar_heuristicDistance(curTile, aimTile) : ~0u;
+    enum UnitMove best = UM_NONE;
+    enum UnitMove move;
+    unsigned int distance;
+    int tile;
+
+    for (move=UM_MOVE_UP; move<=UM_MOVE_LEFT_UP; move++) {
+        tile = getNextTile(X_FROM_TILE(curTile), Y_FROM_TILE(curTile), move);
+        if (tile < 0 || tile == blockedTile || !freeToPlaceUnitOnTile(curUnit, tile) ||
+            (curUnit->side == FRIENDLY && IS_TILE_BIT_SET(TB_UNDISCOVERED, tile)))
+            continue;
+        distance = Astar_heuristicDistance(tile, aimTile);
+        if (distance < bestDistance) {
+            best = move;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+static enum UnitMove resolveBlockage(int unit_nr, enum AvoidanceResolution resolution, enum UnitMove move) {
+    avoidanceResolutions[resolution]++;
+    unitBlockedFrames[unit_nr] = 0;
+    unitBackoff[unit_nr] = 0;
+    return move;
+}
+
+enum UnitMove avoidBlockingUnit(int unit_nr, int curTile, int blockedTile, int aimTile) {
+    struct Unit *curUnit = unit + unit_nr;
+    int blocker = environment.layout[blockedTile].contains_unit;
+    enum UnitMove move;
+
+    if (blocker >= 0 && unit[blocker].side == curUnit->side && getPathfindingNextTile(blocker) == curTile) {
+        // a friendly unit coming the other way. the one of both with the higher number steps aside and the other
+        // waits for it to, unless only the latter is able to
+        if (unit_nr > blocker || getStepAside(unit + blocker, blockedTile, curTile, curTile, false) == UM_NONE) {
+            move = getStepAside(curUnit, curTile, blockedTile, aimTile, false);
+            if (move != UM_NONE)
+                return resolveBlockage(unit_nr, AR_GAVE_WAY, move);
+        }
+    } else if (blocker >= 0 && !(unit[blocker].move >= UM_MOVE_UP && unit[blocker].move <= UM_MOVE_LEFT_UP)) {
+        // a unit that isn't moving on. step around it, if that gets the unit nearer
+        move = getStepAside(curUnit, curTile, blockedTile, aimTile, true);
+        if (move != UM_NONE)
+            return resolveBlockage(unit_nr, AR_STEPPED_AROUND, move);
+    }
+
+    if (unitBlockedFrames[unit_nr] < (AVOIDANCE_WAIT_FRAMES << unitBackoff[unit_nr])) {
+        unitBlockedFrames[unit_nr]++;
+        return UM_MOVE_HOLD;
+    }
+    // the way stayed blocked. have a path around the units searched for, and wait longer the next time
+    avoidanceResolutions[AR_SEARCHED]++;
+    unitBlockedFrames[unit_nr] = 0;
+    if (unitBackoff[unit_nr] < AVOIDANCE_MAX_BACKOFF)
+        unitBackoff[unit_nr]++;
+    return UM_NONE;
+}
+
+void passBlockingUnit(int unit_nr) {
+    if (unitBlockedFrames[unit_nr] > 0)
+        resolveBlockage(unit_nr, AR_WAITED, UM_NONE);
+}
+
+void forgetBlockingUnit(int unit_nr) {
+    unitBlockedFrames[unit_nr] = 0;
+}
+
+int getAvoidanceResolutions(enum AvoidanceResolution resolution) {
+    return avoidanceResolutions[resolution];
+}
+
+#endif
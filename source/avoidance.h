@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _AVOIDANCE_H_
+#define _AVOIDANCE_H_
+
+#include "pathfinding.h"
+#ifndef REMOVE_ASTAR_PATHFINDING
+
+#include "units.h"
+
+// a unit whose path is blocked by another unit first tries to get past it on its own, before having a path searched
+// for that takes the other units into account: it waits for the unit to move on, gives way to a friendly unit coming
+// the other way, or steps around it through a free neighbouring tile
+#define AVOIDANCE_WAIT_FRAMES   (FPS/4)     /* in logic frames. how long a unit waits for the unit in its way to move on */
+#define AVOIDANCE_MAX_BACKOFF   3           /* the wait doubles after every search that didn't get the unit past, up to 2^this times */
+
+enum AvoidanceResolution { AR_WAITED, AR_GAVE_WAY, AR_STEPPED_AROUND, AR_SEARCHED, AR_AMOUNT };
+
+void initAvoidanceWithScenario();
+
+// returns the move for a unit whose next tile, on its way to aimTile, is blocked by another unit: UM_MOVE_HOLD to wait
+// or a move onto a free neighbouring tile. returns UM_NONE if a path around the other units is to be searched for instead
+enum UnitMove avoidBlockingUnit(int unit_nr, int curTile, int blockedTile, int aimTile);
+// to be called when the unit makes a move along its path
+void passBlockingUnit(int unit_nr);
+// to be called when the unit stops following its path
+void forgetBlockingUnit(int unit_nr);
+
+// the number of times units got past another unit in each way since the scenario started
+int getAvoidanceResolutions(enum AvoidanceResolution resolution);
+
+#endif
+#endif
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Bitboards: for every tile, whether it can be traversed, whether it was
+// discovered and whether a unit occupies it, packed 32 tiles to a word. A path
+// search testing a node then reads a single bit rather than the tile's
+// EnvironmentLayout, and neighbouring nodes share the same words.
+//
+// environment.layout remains leading. Whatever changes one of these properties
+// of a tile does so through the functions below, which update both.
+
+#include "bitboards.h"
+
+#include "lineoffire.h"
+#include "distancefields.h"
+#include "firingpositions.h"
+
+u32 tileBitboard[TB_AMOUNT][MAX_TILES_ENVIRONMENT / 32];
+
+
+static inline void setTileBit(enum TileBitboard bitboard, int tile, int value) {
+    if (value)
+        tileBitboard[bitboard][tile >> 5] |= BIT(tile & 31);
+    else
+        tileBitboard[bitboard][tile >> 5] &= ~BIT(tile & 31);
+}
+
+void initBitboardsWithScenario() {
+    struct EnvironmentLayout *envLayout = environment.layout;
+    int i;
+
+    for (i=0; i<MAX_TILES_ENVIRONMENT; i++, envLayout++) {
+        if (i >= environment.width * environment.height) {
+            setTileBit(TB_TRAVERSABLE_BY_NON_TRACKED, i, 0);
+            setTileBit(TB_TRAVERSABLE_BY_TRACKED, i, 0);
+            setTileBit(TB_UNDISCOVERED, i, 0);
+            setTileBit(TB_OCCUPIED, i, 0);
+            continue;
+        }
+        setTileBit(TB_TRAVERSABLE_BY_NON_TRACKED, i, envLayout->traversability != UNTRAVERSABLE);
+        setTileBit(TB_TRAVERSABLE_BY_TRACKED, i, envLayout->traversability == TRAVERSABLE);
+        setTileBit(TB_UNDISCOVERED, i, envLayout->status == UNDISCOVERED);
+        setTileBit(TB_OCCUPIED, i, envLayout->contains_unit != -1);
+    }
+}
+
+
+void setTileTraversability(int tile, enum Traversability traversability) {
+    environment.layout[tile].traversability = traversability;
+    setTileBit(TB_TRAVERSABLE_BY_NON_TRACKED, tile, traversability != UNTRAVERSABLE);
+    setTileBit(TB_TRAVERSABLE_BY_TRACKED, tile, traversability == TRAVERSABLE);
+}
+
+// unit_nr as stored in contains_unit: -1 for none, less for a unit moving onto the tile
+void setTileUnit(int tile, int unit_nr) {
+    setDistanceFieldsTileUnit(tile, unit_nr);
+    environment.layout[tile].contains_unit = unit_nr;
+    setTileBit(TB_OCCUPIED, tile, unit_nr != -1);
+    invalidateLinesOfFireOfUnits(tile);
+    #ifndef REMOVE_ASTAR_PATHFINDING
+    invalidateFiringPositionsOfUnits(tile);
+    #endif
+}
+
+// to be called once the status of a tile is no longer UNDISCOVERED
+void setTileDiscovered(int tile) {
+    setTileBit(TB_UNDISCOVERED, tile, 0);
+}
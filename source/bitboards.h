@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _BITBOARDS_H_
+#define _BITBOARDS_H_
+
+#include <nds.h>
+
+#include "environment.h"
+
+// a bit per tile of the map, kept alongside environment.layout, for the questions asked about a tile most often.
+// these allow a path search to test a tile without having to read its EnvironmentLayout
+enum TileBitboard { TB_TRAVERSABLE_BY_NON_TRACKED,  /* TRAVERSABLE or TRAVERSABLE_BY_NON_TRACKED */
+                    TB_TRAVERSABLE_BY_TRACKED,      /* TRAVERSABLE */
+                    TB_UNDISCOVERED,                /* status UNDISCOVERED */
+                    TB_OCCUPIED,                    /* contains_unit other than -1: a unit is on it or moving onto it */
+                    TB_AMOUNT };
+
+extern u32 tileBitboard[TB_AMOUNT][MAX_TILES_ENVIRONMENT / 32];
+
+#define IS_TILE_BIT_SET(bitboard, tile)  ((tileBitboard[bitboard][(tile) >> 5] >> ((tile) & 31)) & 1)
+
+// derives all bitboards from environment.layout, i.e. after a scenario or savegame was loaded
+void initBitboardsWithScenario();
+
+// the ways in which environment.layout is to be changed for the bitboards to follow
+void setTileTraversability(int tile, enum Traversability traversability);
+void setTileUnit(int tile, int unit_nr);
+void setTileDiscovered(int tile);
+
+#endif
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Distance fields: the units hunting or attacking on their own look for the
+// nearest enemy unit or structure by searching the rings around them, over the
+// whole map when need be. Far away from the enemy that means going through
+// many empty rings, every time.
+//
+// Instead, a field is kept for the units and for the structures of the player
+// and of the other sides, holding for every tile the distance to the nearest
+// of them in rings. A search starts at the ring that distance gives, and the
+// rings before it are skipped. A unit or structure appearing on a tile lowers
+// the field around it right away. One leaving its tiles doesn't: the field
+// merely holds too little, which makes a search go through a few rings more,
+// until the field is derived anew, at most one field each logic frame.
+//
+// The distance is the number of rings, whatever is on the tiles in between,
+// and the units or structures in the field include those a search would
+// still pass over, so a search finds what it always found.
+
+#include "distancefields.h"
+
+#include "environment.h"
+#include "factions.h"
+#include "structures.h"
+#include "units.h"
+
+#define TEAMS   2   /* the player, and the other sides */
+
+static u8 distanceField[DFT_AMOUNT][TEAMS][MAX_TILES_ENVIRONMENT];
+static bool distanceFieldStale[DFT_AMOUNT][TEAMS];      // targets left tiles since the field was derived
+static unsigned short int distanceFieldQueue[MAX_TILES_ENVIRONMENT];
+static int distanceFieldNext;                           // the field to be derived anew next, if stale
+
+static inline int getTeam(enum Side side) {
+    return side != FRIENDLY;
+}
+
+
+// lowers the field around the tiles given distance 0 in the queue, going outwards ring by ring
+static void spreadDistanceField(u8 *field, int queued) {
+    int first = 0;
+    int tile, x, y, nx, ny, distance;
+
+    while (first < queued) {
+        tile = distanceFieldQueue[first++];
+        x = X_FROM_TILE(tile);
+        y = Y_FROM_TILE(tile);
+        distance = field[tile] + 1;
+        for (ny=max(y-1, 0); ny<=min(y+1, environment.height-1); ny++) {
+            for (nx=max(x-1, 0); nx<=min(x+1, environment.width-1); nx++) {
+                if (field[TILE_FROM_XY(nx, ny)] > distance) {
+                    field[TILE_FROM_XY(nx, ny)] = distance;
+                    distanceFieldQueue[queued++] = TILE_FROM_XY(nx, ny);
+                }
+            }
+        }
+    }
+}
+
+static inline int getTileTeam(enum DistanceFieldTarget target, int tile) {
+    int nr;
+
+    if (target == DFT_UNITS) {
+        nr = environment.layout[tile].contains_unit;
+        return (nr >= 0) ? getTeam(unit[nr].side) : -1;
+    }
+    nr = environment.layout[tile].contains_structure;
+    if (nr < -1)
+        nr = environment.layout[tile + (nr + 1)].contains_structure;
+    return (nr >= MAX_DIFFERENT_FACTIONS) ? getTeam(structure[nr].side) : -1;
+}
+
+static void deriveDistanceField(enum DistanceFieldTarget target, int team) {
+    u8 *field = distanceField[target][team];
+    int queued = 0;
+    int x, y, tile;
+
+    for (y=0; y<environment.height; y++) {
+        for (x=0; x<environment.width; x++) {
+            tile = TILE_FROM_XY(x, y);
+            if (getTileTeam(target, tile) == team) {
+                field[tile] = 0;
+                distanceFieldQueue[queued++] = tile;
+            } else
+                field[tile] = DISTANCE_FIELD_NONE;
+        }
+    }
+    spreadDistanceField(field, queued);
+    distanceFieldStale[target][team] = false;
+}
+
+void initDistanceFieldsWithScenario() {
+    int i, j;
+
+    for (i=0; i<DFT_AMOUNT; i++) {
+        for (j=0; j<TEAMS; j++)
+            deriveDistanceField(i, j);
+    }
+    distanceFieldNext = 0;
+}
+
+void updateDistanceFields() {
+    int i;
+
+    for (i=0; i<DFT_AMOUNT * TEAMS; i++) {
+        distanceFieldNext = (distanceFieldNext + 1) % (DFT_AMOUNT * TEAMS);
+        if (distanceFieldStale[distanceFieldNext / TEAMS][distanceFieldNext % TEAMS]) {
+            deriveDistanceField(distanceFieldNext / TEAMS, distanceFieldNext % TEAMS);
+            return;
+        }
+    }
+}
+
+
+static void addDistanceFieldArea(u8 *field, int x, int y, int width, int height) {
+    int queued = 0;
+    int i, j;
+
+    for (i=y; i<y+height; i++) {
+        for (j=x; j<x+width; j++) {
+            if (field[TILE_FROM_XY(j, i)] > 0) {
+                field[TILE_FROM_XY(j, i)] = 0;
+                distanceFieldQueue[queued++] = TILE_FROM_XY(j, i);
+            }
+        }
+    }
+    spreadDistanceField(field, queued);
+}
+
+void setDistanceFieldsTileUnit(int tile, int unit_nr) {
+    int previous = environment.layout[tile].contains_unit;
+
+    if (previous == unit_nr)
+        return;
+    if (previous >= 0)
+        distanceFieldStale[DFT_UNITS][getTeam(unit[previous].side)] = true;
+    if (unit_nr >= 0)
+        addDistanceFieldArea(distanceField[DFT_UNITS][getTeam(unit[unit_nr].side)], X_FROM_TILE(tile), Y_FROM_TILE(tile), 1, 1);
+}
+
+void addDistanceFieldsStructure(enum Side side, int x, int y, int width, int height) {
+    addDistanceFieldArea(distanceField[DFT_STRUCTURES][getTeam(side)], x, y, width, height);
+}
+
+void removeDistanceFieldsStructure(enum Side side) {
+    distanceFieldStale[DFT_STRUCTURES][getTeam(side)] = true;
+}
+
+
+int getDistanceToNearestTarget(enum DistanceFieldTarget target, enum Side ownSide, int tile) {
+    // the targets are those of the other team
+    return distanceField[target][!getTeam(ownSide)][tile];
+}
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _DISTANCEFIELDS_H_
+#define _DISTANCEFIELDS_H_
+
+#include <nds.h>
+
+#include "shared.h"
+
+// for the units and the structures of the player and of the other sides, a field holding for every tile how many
+// rings around it (as in ringsearch.h) have none of them. the field may hold less than that, never more, so a search
+// for the nearest of them may start at that ring
+enum DistanceFieldTarget { DFT_UNITS, DFT_STRUCTURES, DFT_AMOUNT };
+
+#define DISTANCE_FIELD_NONE     255     /* none of the targets on the map */
+
+// derives all fields from environment.layout, i.e. once the units and structures of a scenario or savegame were placed
+void initDistanceFieldsWithScenario();
+// to be called once every logic frame. makes one field that targets left the tiles of exact again
+void updateDistanceFields();
+
+// to be called before the unit on a tile changes, with the unit_nr as stored in contains_unit
+void setDistanceFieldsTileUnit(int tile, int unit_nr);
+// to be called when a structure of the side was added to or removed from the given area
+void addDistanceFieldsStructure(enum Side side, int x, int y, int width, int height);
+void removeDistanceFieldsStructure(enum Side side);
+
+// the rings around the tile that have no target of the given type to a unit or structure of ownSide on them, at least
+int getDistanceToNearestTarget(enum DistanceFieldTarget target, enum Side ownSide, int tile);
+
+#endif
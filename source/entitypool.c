@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Entity pools: the units, projectiles, explosions and overlays each live in a
+// fixed array, and finding a free entry or going through the ones in use meant
+// reading the enabled flag of every entity, most of them unused. A pool keeps
+// a bit per entry instead, so that 32 entries are skipped at a time.
+//
+// Entries are still found and gone through in the order of the array, the
+// lowest free entry being the one used, so the game plays out exactly as it
+// did. The enabled flags remain leading; whatever sets one also uses or frees
+// the entry in the pool.
+
+#include "entitypool.h"
+
+#include "debug.h"
+
+#define HANDLE_INDEX_BITS   16
+
+
+void initEntityPool(struct EntityPool *pool, int capacity) {
+    int i;
+
+    #ifdef DEBUG_BUILD
+    if (capacity > MAX_ENTITY_POOL_ENTRIES)
+        errorSI("Entity pool too large. Limit is:", MAX_ENTITY_POOL_ENTRIES);
+    #endif
+    pool->capacity = capacity;
+    pool->amount = 0;
+    for (i=0; i<MAX_ENTITY_POOL_ENTRIES / 32; i++)
+        pool->used[i] = 0;
+    for (i=0; i<MAX_ENTITY_POOL_ENTRIES; i++)
+        pool->generation[i] = 0;
+}
+
+int getFreeEntityPoolEntry(struct EntityPool *pool, int index) {
+    u32 word;
+
+    if (index < 0)
+        index = 0;
+    while (index < pool->capacity) {
+        word = ~pool->used[index >> 5] & (~0u << (index & 31));
+        if (word) {
+            index = (index & ~31) + __builtin_ctz(word);
+            return (index < pool->capacity) ? index : -1;
+        }
+        index = (index & ~31) + 32;
+    }
+    return -1;
+}
+
+int getNextUsedEntityPoolEntry(struct EntityPool *pool, int index) {
+    u32 word;
+
+    index++;
+    while (index < pool->capacity) {
+        word = pool->used[index >> 5] & (~0u << (index & 31));
+        if (word)
+            return (index & ~31) + __builtin_ctz(word);
+        index = (index & ~31) + 32;
+    }
+    return -1;
+}
+
+void useEntityPoolEntry(struct EntityPool *pool, int index) {
+    if (IS_ENTITY_POOL_ENTRY_USED(pool, index))
+        return;
+    pool->used[index >> 5] |= BIT(index & 31);
+    pool->amount++;
+}
+
+void freeEntityPoolEntry(struct EntityPool *pool, int index) {
+    if (!IS_ENTITY_POOL_ENTRY_USED(pool, index))
+        return;
+    pool->used[index >> 5] &= ~BIT(index & 31);
+    pool->amount--;
+    pool->generation[index]++;
+}
+
+
+int getEntityPoolHandle(struct EntityPool *pool, int index) {
+    if (index < 0 || !IS_ENTITY_POOL_ENTRY_USED(pool, index))
+        return -1;
+    return (pool->generation[index] << HANDLE_INDEX_BITS) | index;
+}
+
+int getEntityPoolEntryOfHandle(struct EntityPool *pool, int handle) {
+    int index = handle & ((1 << HANDLE_INDEX_BITS) - 1);
+
+    if (handle < 0 || index >= pool->capacity || !IS_ENTITY_POOL_ENTRY_USED(pool, index) ||
+        pool->generation[index] != (handle >> HANDLE_INDEX_BITS))
+        return -1;
+    return index;
+}
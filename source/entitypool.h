@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _ENTITYPOOL_H_
+#define _ENTITYPOOL_H_
+
+#include <nds.h>
+
+// keeps track of which entries of a fixed array of entities (units, projectiles, explosions, overlays) are in use, a
+// bit per entry, so that a free entry is found and the entries in use are gone through without reading every entity
+#define MAX_ENTITY_POOL_ENTRIES     256
+
+struct EntityPool {
+    int capacity;
+    int amount;                                     /* of entries in use */
+    u32 used[MAX_ENTITY_POOL_ENTRIES / 32];
+    u8 generation[MAX_ENTITY_POOL_ENTRIES];         /* increased every time the entry is freed */
+};
+
+void initEntityPool(struct EntityPool *pool, int capacity);
+
+// returns the first free entry at or after index, or -1 if there is none
+int getFreeEntityPoolEntry(struct EntityPool *pool, int index);
+// returns the first entry in use after index (-1 for the first of all), or -1 if there is none
+int getNextUsedEntityPoolEntry(struct EntityPool *pool, int index);
+void useEntityPoolEntry(struct EntityPool *pool, int index);
+void freeEntityPoolEntry(struct EntityPool *pool, int index);
+
+#define IS_ENTITY_POOL_ENTRY_USED(pool, index)  (((pool)->used[(index) >> 5] >> ((index) & 31)) & 1)
+
+// goes through the entries in use in order. entries used or freed further on meanwhile are seen as such
+#define FOR_EACH_USED_ENTITY_POOL_ENTRY(pool, index) \
+    for (index = getNextUsedEntityPoolEntry(pool, -1); index >= 0; index = getNextUsedEntityPoolEntry(pool, index))
+
+// a handle refers to an entry for as long as it is in use: it no longer does once the entry was freed, even after
+// the entry was used for another entity. returns -1 if the entry is free
+int getEntityPoolHandle(struct EntityPool *pool, int index);
+// returns the entry the handle refers to, or -1 if it no longer refers to one
+int getEntityPoolEntryOfHandle(struct EntityPool *pool, int handle);
+
+#endif
@@ -7,6 +7,10 @@
 
 #include "game.h"
 #include "radar.h"
+#include "shroud.h"
+#include "bitboards.h"
+#include "lineoffire.h"
+#include "ringsearch.h"
 #include "projectiles.h"
 #include "settings.h"
 #include "view.h"
@@ -35,6 +39,9 @@ static int paletteAniDirection;
 static int paletteAniNr;
 static int paletteAniTimer;
 
+static u8 shroudSprite[HORIZONTAL_HEIGHT][HORIZONTAL_WIDTH]; // per tile on screen, as returned by getShroudSprite
+static int shroudSpriteX, shroudSpriteY; // the view these were derived for
+
 unsigned int environment_widthmask;
 unsigned int environment_widthshift;
 
@@ -78,21 +85,51 @@ inline void adjustShroudType(int x, int y) {
     if (environment.layout[tile].status == UNDISCOVERED)
         setTileDirtyRadarDirtyBitmap(tile);
     environment.layout[tile].status |= statusMod;
+    if (statusMod)
+        setTileDiscovered(tile);
 }
 
 
 
+// re-derives the shroud sprites of the tiles on screen whose shroud changed, or all of them when the view moved
+void updateShroudSprites(int x, int y) {
+    int x1, y1, x2, y2;
+    int i, j;
+    
+    if (x != shroudSpriteX || y != shroudSpriteY) {
+        x1 = x;
+        y1 = y;
+        x2 = x + HORIZONTAL_WIDTH - 1;
+        y2 = y + HORIZONTAL_HEIGHT - 1;
+        shroudSpriteX = x;
+        shroudSpriteY = y;
+    } else if (getShroudDirtyArea(&x1, &y1, &x2, &y2)) {
+        x1 = max(x1, x);
+        y1 = max(y1, y);
+        x2 = min(x2, x + HORIZONTAL_WIDTH - 1);
+        y2 = min(y2, y + HORIZONTAL_HEIGHT - 1);
+    } else
+        return;
+    
+    for (i=y1; i<=y2; i++) {
+        for (j=x1; j<=x2; j++)
+            shroudSprite[i - y][j - x] = getShroudSprite(environment.layout[TILE_FROM_XY(j,i)].status);
+    }
+    clearShroudDirtyArea();
+}
+
 void drawEnvironment() {
     int i, j, k;
     int graphics;
     int baseTile;
-    int hflip, vflip;
     int envPalette;
     struct EnvironmentLayout *envLayout;
     
     int x = getViewCurrentX();
     int y = getViewCurrentY();
     
+    updateShroudSprites(x, y);
+    
     envLayout = environment.layout + TILE_FROM_XY(x,y); // environment layout tile to start drawing
     if (paletteAniNr > 0) {
         envPalette = paletteAniNr - 1;
@@ -106,70 +143,13 @@ void drawEnvironment() {
             
             k = ACTION_BAR_SIZE * 64 + 64*i + 2*j;
             
-            if (envLayout->status == UNDISCOVERED) {
+            graphics = shroudSprite[i][j];
+            if (graphics != SHROUD_SPRITE_NONE)
                 setSpritePlayScreen((i + ACTION_BAR_SIZE)*16, ATTR0_SQUARE,
-                                    j*16, SPRITE_SIZE_16, 0, 0,
-                                    0, PS_SPRITES_PAL_SHROUD, base_shroud);
-            } else {
-                if (envLayout->status != CLEAR_ALL) {
-                    hflip = 0;
-                    vflip = 0;
-                    switch (envLayout->status) {
-                        // three sides clear
-                        case (CLEAR_UP | CLEAR_RIGHT | CLEAR_DOWN):
-                            graphics = base_shroud + 4;
-                            break;
-                        case (CLEAR_RIGHT | CLEAR_DOWN | CLEAR_LEFT):
-                            graphics = base_shroud + 5;
-                            break;
-                        case (CLEAR_DOWN | CLEAR_LEFT | CLEAR_UP):
-                            graphics = base_shroud + 4;
-                            hflip = 1;
-                            break;
-                        case (CLEAR_LEFT | CLEAR_UP | CLEAR_RIGHT):
-                            graphics = base_shroud + 5;
-                            vflip = 1;
-                            break;
-                        // two sides clear
-                        case (CLEAR_UP | CLEAR_RIGHT):
-                            graphics = base_shroud + 3;
-                            break;
-                        case (CLEAR_RIGHT | CLEAR_DOWN):
-                            graphics = base_shroud + 3;
-                            vflip = 1;
-                            break;
-                        case (CLEAR_DOWN | CLEAR_LEFT):
-                            graphics = base_shroud + 3;
-                            hflip = 1;
-                            vflip = 1;
-                            break;
-                        case (CLEAR_LEFT | CLEAR_UP):
-                            graphics = base_shroud + 3;
-                            hflip = 1;
-                            break;
-                        // one side clear
-                        case CLEAR_UP:
-                            graphics = base_shroud + 1;
-                            break;
-                        case CLEAR_RIGHT:
-                            graphics = base_shroud + 2;
-                            break;
-                        case CLEAR_DOWN:
-                            graphics = base_shroud + 1;
-                            vflip = 1;
-                            break;
-                        case CLEAR_LEFT:
-                        default: // default should not happen, but the switch statement requires it
-                            graphics = base_shroud + 2;
-                            hflip = 1;
-                            break;
-                    }
-                    
-                    setSpritePlayScreen((i + ACTION_BAR_SIZE)*16, ATTR0_SQUARE,
-                                        j*16, SPRITE_SIZE_16, hflip, vflip,
-                                        0, PS_SPRITES_PAL_SHROUD, graphics);
-                }
-                
+                                    j*16, SPRITE_SIZE_16, (graphics & SHROUD_SPRITE_HFLIP) != 0, (graphics & SHROUD_SPRITE_VFLIP) != 0,
+                                    0, PS_SPRITES_PAL_SHROUD, base_shroud + (graphics & SHROUD_SPRITE_GRAPHICS_MASK));
+            
+            if (envLayout->status != UNDISCOVERED) {
                 graphics = envLayout->graphics;
                 if (graphics >= SANDCUSTOM && graphics <= SANDCUSTOM16) { // did sandcustom animate?
                     if (customAniTimer[0 * 16 + graphics - SANDCUSTOM] < 0)
@@ -205,7 +185,7 @@ void doEnvironmentLogic() {
     chasmAnimationTimer++;
     if (chasmAnimationTimer >= CHASM_ANIMATION_FRAMES * CHASM_ANIMATION_FRAME_DURATION)
         chasmAnimationTimer = 0;
-    if (!(chasmAnimationTimer % CHASM_ANIMATION_FRAME_DURATION)) { // need to load in a new chasm animation frame!
+    if (!(chasmAnimationTimer % CHASM_ANIMATION_FRAME_DURATION) && sandchasmAniBase) { // need to load in a new chasm animation frame! (unless no graphics were loaded, as in the host build)
         i = (chasmAnimationTimer / CHASM_ANIMATION_FRAME_DURATION) * 16*16/2;
         baseSandAni = sandchasmAni + i;
         baseRockAni = rockchasmAni + i;
@@ -356,6 +336,7 @@ void reduceEnvironmentOre(int curTile, int amount) {
                     oldOreLevel > ((MAX_ENVIRONMENT_ORE_LEVEL*environment.ore_multiplier)/2) )) {
         envLayout->graphics = mapOreTileGraphicsBySurroundings(x, y);
         setTileDirtyRadarDirtyBitmap(curTile);
+        invalidateLinesOfFire();
         
         if (x > 0) {
             if (environment.layout[curTile - 1].ore_level > 0) {
@@ -451,29 +432,31 @@ void initProjectilesCollission(enum EnvironmentTileGraphics graphics, char *file
 
 
 void initEnvironment() {
-    // nothing done here
+    initShroud();
 }
 
 
 void initTileTraversability(struct EnvironmentLayout *envLayout) {
+    int tile = envLayout - environment.layout;
+    
     if (envLayout->graphics >= SANDCHASM && envLayout->graphics <= SANDCHASM16) {
-        envLayout->traversability = UNTRAVERSABLE;
+        setTileTraversability(tile, UNTRAVERSABLE);
         return;
     }
     if (envLayout->graphics >= ROCKCHASM && envLayout->graphics <= ROCKCHASM16) {
-        envLayout->traversability = UNTRAVERSABLE;
+        setTileTraversability(tile, UNTRAVERSABLE);
         return;
     }
     if (envLayout->graphics >= CHASMCUSTOM) {
-        envLayout->traversability = UNTRAVERSABLE;
+        setTileTraversability(tile, UNTRAVERSABLE);
         return;
     }
     if (envLayout->graphics >= MOUNTAIN && envLayout->graphics <= MOUNTAIN16) {
-        envLayout->traversability = TRAVERSABLE_BY_NON_TRACKED;
+        setTileTraversability(tile, TRAVERSABLE_BY_NON_TRACKED);
         return;
     }
     
-    envLayout->traversability = TRAVERSABLE;
+    setTileTraversability(tile, TRAVERSABLE);
 }
 
 void initEnvironmentWithScenario() {
@@ -512,6 +495,10 @@ void initEnvironmentWithScenario() {
     readstr(fp, oneline);
     if (sscanf(oneline, "OreMultiplier=%i", &environment.ore_multiplier) != 1)
         environment.ore_multiplier=1;  // default
+    #ifdef DEBUG_BUILD
+    if (MAX_ENVIRONMENT_ORE_LEVEL*environment.ore_multiplier > 0x7FFF)
+        errorSI("OreMultiplier too large for the ore level of a tile. Limit is:", 0x7FFF / MAX_ENVIRONMENT_ORE_LEVEL);
+    #endif
     
     closeFile(fp);
 
@@ -538,6 +525,11 @@ void initEnvironmentWithScenario() {
         }
     }
     closeFile(fp);
+    initBitboardsWithScenario();
+    initLinesOfFireWithScenario();
+    initRingSearchWithScenario();
+    initShroudWithScenario();
+    shroudSpriteX = -1;
     
     fp = openFile("", FS_CURRENT_SCENARIO_FILE);
     // GRAPHICS section
@@ -47,14 +47,15 @@ enum EnvironmentTileGraphics { SAND,
                                NUMBER_OF_ENVIRONMENT_TILE_GRAPHICS
                               };
 
+// 12 bytes per tile: every value fits 16 bits, a reference to another tile included
 struct EnvironmentLayout {
     unsigned char  status;          /*      EnvironmentTileStatus   */
     unsigned char  traversability;  /* enum Traversability          */
     unsigned short graphics;        /* enum EnvironmentTileGraphics */
-    int ore_level;
-    int contains_overlay;   // -1 means none, larger is an overlay
-    int contains_structure; // -1 means none, larger is a structure, less is a reference to another tile
-    int contains_unit;      // -1 means none, larger is a unit,      less is a reference to a unit moving there
+    short ore_level;
+    short contains_overlay;   // -1 means none, larger is an overlay
+    short contains_structure; // -1 means none, larger is a structure, less is a reference to another tile
+    short contains_unit;      // -1 means none, larger is a unit,      less is a reference to a unit moving there
 };
 
 
@@ -13,10 +13,12 @@
 #include "game.h"
 #include "rumble.h"
 #include "ingame_briefing.h"
+#include "entitypool.h"
 
 
 struct ExplosionInfo explosionInfo[MAX_DIFFERENT_EXPLOSIONS];
 struct Explosion explosion[MAX_EXPLOSIONS_ON_MAP];
+static struct EntityPool explosionPool;
 
 static int explosionShiftX, explosionShiftY;
 
@@ -123,6 +125,7 @@ void initExplosionsWithScenario() {
     
     for (i=0; i<MAX_EXPLOSIONS_ON_MAP; i++)
         explosion[i].enabled = 0;
+    initExplosionPool();
     
     for (i=0; i<MAX_TANKSHOTS; i++)
         tankShot[i].timer = 0;
@@ -133,6 +136,16 @@ void initExplosionsWithScenario() {
     initExplosionsSpeed();
 }
 
+void initExplosionPool() {
+    int i;
+    
+    initEntityPool(&explosionPool, MAX_EXPLOSIONS_ON_MAP);
+    for (i=0; i<MAX_EXPLOSIONS_ON_MAP; i++) {
+        if (explosion[i].enabled)
+            useEntityPoolEntry(&explosionPool, i);
+    }
+}
+
 
 int addTankShot(int curX, int curY) {
     int i;
@@ -162,24 +175,22 @@ int addExplosion(int curX, int curY, int info, int delay) {
     if (info < 0) // a unit or structure which can't explode tried to create a new explosion
         return -1;
     
-    for (i=0; i<MAX_EXPLOSIONS_ON_MAP; i++) {
-        if (!explosion[i].enabled) {
-            explosion[i].enabled = 1;
-            explosion[i].info = info;
-            explosion[i].x = curX;
-            explosion[i].y = curY;
-            explosion[i].timer = -delay;
-            curExplosionInfo = explosionInfo + info;
-            rumbleDuration = (curExplosionInfo->frames + curExplosionInfo->repeat * (curExplosionInfo->repeat_end - curExplosionInfo->repeat_start)) * curExplosionInfo->frame_duration;
-            if (explosionInfo[info].rumble_level == 10) // can only be Nuke, let it rumble no matter what
-                addRumble(10, rumbleDuration);
-            else if (curX/16 >= getViewCurrentX() && curX/16 < getViewCurrentX() + HORIZONTAL_WIDTH &&
-                     curY/16 >= getViewCurrentY() && curY/16 < getViewCurrentY() + HORIZONTAL_HEIGHT)
-                addRumble(explosionInfo[info].rumble_level, rumbleDuration);
-            return i;
-        }
-    }
-    return -1;
+    if ((i = getFreeEntityPoolEntry(&explosionPool, 0)) < 0)
+        return -1;
+    useEntityPoolEntry(&explosionPool, i);
+    explosion[i].enabled = 1;
+    explosion[i].info = info;
+    explosion[i].x = curX;
+    explosion[i].y = curY;
+    explosion[i].timer = -delay;
+    curExplosionInfo = explosionInfo + info;
+    rumbleDuration = (curExplosionInfo->frames + curExplosionInfo->repeat * (curExplosionInfo->repeat_end - curExplosionInfo->repeat_start)) * curExplosionInfo->frame_duration;
+    if (explosionInfo[info].rumble_level == 10) // can only be Nuke, let it rumble no matter what
+        addRumble(10, rumbleDuration);
+    else if (curX/16 >= getViewCurrentX() && curX/16 < getViewCurrentX() + HORIZONTAL_WIDTH &&
+             curY/16 >= getViewCurrentY() && curY/16 < getViewCurrentY() + HORIZONTAL_HEIGHT)
+        addRumble(explosionInfo[info].rumble_level, rumbleDuration);
+    return i;
 }
 
 
@@ -204,8 +215,9 @@ void drawExplosions() {
     lowY  = getViewCurrentY() * 16;
     highY = (getViewCurrentY() + HORIZONTAL_HEIGHT) * 16;
     
-    for (i=0, curExplosion=explosion; i<MAX_EXPLOSIONS_ON_MAP; i++, curExplosion++) {
-        if (curExplosion->enabled && curExplosion->timer >= 0 &&
+    FOR_EACH_USED_ENTITY_POOL_ENTRY(&explosionPool, i) {
+        curExplosion = explosion + i;
+        if (curExplosion->timer >= 0 &&
             curExplosion->x >= lowX && curExplosion->x < highX &&
             curExplosion->y >= lowY && curExplosion->y < highY) {
             tile = TILE_FROM_XY(curExplosion->x/16, curExplosion->y/16);
@@ -312,11 +324,12 @@ void doExplosionsLogic() {
     
     startProfilingFunction("doExplosionsLogic");
     
-    for (i=0, curExplosion=explosion; i<MAX_EXPLOSIONS_ON_MAP; i++, curExplosion++) {
-        if (curExplosion->enabled) {
-            curExplosionInfo = explosionInfo + curExplosion->info;
-            if (++curExplosion->timer >= (curExplosionInfo->frames + curExplosionInfo->repeat * (curExplosionInfo->repeat_end - curExplosionInfo->repeat_start)) * curExplosionInfo->frame_duration)
-                curExplosion->enabled = 0;
+    FOR_EACH_USED_ENTITY_POOL_ENTRY(&explosionPool, i) {
+        curExplosion = explosion + i;
+        curExplosionInfo = explosionInfo + curExplosion->info;
+        if (++curExplosion->timer >= (curExplosionInfo->frames + curExplosionInfo->repeat * (curExplosionInfo->repeat_end - curExplosionInfo->repeat_start)) * curExplosionInfo->frame_duration) {
+            curExplosion->enabled = 0;
+            freeEntityPoolEntry(&explosionPool, i);
         }
     }
     
@@ -54,6 +54,8 @@ struct Explosion {
 
 void initExplosions();
 void initExplosionsWithScenario();
+// (re)builds the pool of explosions in use from their enabled flags, e.g. after a savegame was loaded
+void initExplosionPool();
 int addExplosion(int curX, int curY, int info, int delay);
 int addTankShot(int curX, int curY);
 
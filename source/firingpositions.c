@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Firing positions: a path search in order to attack ends at the first tile
+// from where the target can be hit. Testing that means following the line a
+// projectile would take, for every tile within range the search comes across.
+// When many units attack the same structure, those lines are the same ones
+// each time.
+//
+// Instead, the tiles from where a target can be hit are determined once, for
+// every tile near enough for the search to consider, and handed to A* as the
+// set of tiles any of which will do. Units of the same side with the same shoot range and projectile
+// share the set. Lines of fire only change when structures come or go, and,
+// for shots and bullets, when units move about. A set is forgotten as soon as
+// either happens within its reach, and otherwise kept for a short while.
+
+#include "firingpositions.h"
+#ifndef REMOVE_ASTAR_PATHFINDING
+
+#include <string.h>
+
+#include "lineoffire.h"
+#include "projectiles.h"
+#include "shared.h"
+#include "debug.h"
+
+struct FiringPositions {
+    bool enabled;
+    unsigned short int target;
+    unsigned short int maxDistance; // the heuristic distance to the target within which tiles are considered
+    unsigned short int shootRange;
+    int projectileInfo;
+    bool friendly;               // lines of fire pass the units of the side shooting
+    bool byUnits;                // units may block the lines of fire
+    unsigned short int created;  // logic frame the set was determined in
+    unsigned char users;         // the searches given the set that haven't released it yet
+    u32 tile[MAX_TILES_ENVIRONMENT / 32];
+};
+
+static struct FiringPositions firingPositions[MAX_FIRING_POSITION_SETS];
+static unsigned short int firingPositionsFrame;
+
+
+void initFiringPositionsWithScenario() {
+    int i;
+
+    for (i=0; i<MAX_FIRING_POSITION_SETS; i++) {
+        firingPositions[i].enabled = false;
+        firingPositions[i].users = 0;
+    }
+    firingPositionsFrame = 0;
+}
+
+void updateFiringPositions() {
+    int i;
+
+    firingPositionsFrame++;
+    for (i=0; i<MAX_FIRING_POSITION_SETS; i++) {
+        if (firingPositions[i].enabled && (unsigned short int) (firingPositionsFrame - firingPositions[i].created) > FIRING_POSITIONS_LIFETIME)
+            firingPositions[i].enabled = false;
+    }
+}
+
+// tiles within maxDistance are at most this many tiles away from the target in either direction
+static inline int getFiringPositionsRadius(struct FiringPositions *set) {
+    return min(set->shootRange, set->maxDistance / HORIZVERT_HEUR_DISTANCE);
+}
+
+// a line of fire doesn't leave the square around the target its tiles are in
+static inline void invalidateFiringPositionsOfSet(struct FiringPositions *set, int x, int y, int width, int height) {
+    int targetX = X_FROM_TILE(set->target);
+    int targetY = Y_FROM_TILE(set->target);
+    int radius = getFiringPositionsRadius(set);
+
+    if (x <= targetX + radius && x + width  > targetX - radius &&
+        y <= targetY + radius && y + height > targetY - radius)
+        set->enabled = false;
+}
+
+void invalidateFiringPositions(int x, int y, int width, int height) {
+    int i;
+
+    for (i=0; i<MAX_FIRING_POSITION_SETS; i++) {
+        if (firingPositions[i].enabled)
+            invalidateFiringPositionsOfSet(firingPositions + i, x, y, width, height);
+    }
+}
+
+void invalidateFiringPositionsOfUnits(int tile) {
+    struct FiringPositions *set = firingPositions;
+    int x = X_FROM_TILE(tile);
+    int y = Y_FROM_TILE(tile);
+    int i;
+
+    for (i=0; i<MAX_FIRING_POSITION_SETS; i++, set++) {
+        if (set->enabled && set->byUnits)
+            invalidateFiringPositionsOfSet(set, x, y, 1, 1);
+    }
+}
+
+void determineFiringPositions(struct FiringPositions *set) {
+    enum Side side = set->friendly ? FRIENDLY : ENEMY1;
+    int targetX = X_FROM_TILE(set->target);
+    int targetY = Y_FROM_TILE(set->target);
+    int radius = getFiringPositionsRadius(set);
+    int x1 = max(0, targetX - radius);
+    int y1 = max(0, targetY - radius);
+    int x2 = min(environment.width  - 1, targetX + radius);
+    int y2 = min(environment.height - 1, targetY + radius);
+    int x, y, tile;
+
+    memset(set->tile, 0, sizeof(set->tile));
+    for (y=y1; y<=y2; y++) {
+        for (x=x1; x<=x2; x++) {
+            tile = TILE_FROM_XY(x, y);
+            if (Astar_heuristicDistance(tile, set->target) > set->maxDistance ||
+                !withinRange(x, y, set->shootRange, targetX, targetY) ||
+                !isLineOfFireClear(x, y, side, set->projectileInfo, targetX, targetY))
+                continue;
+            set->tile[tile >> 5] |= BIT(tile & 31);
+        }
+    }
+}
+
+const u32 *getFiringPositions(int target, int maxDistance, struct Unit *curUnit, struct UnitInfo *curUnitInfo) {
+    struct FiringPositions *set = firingPositions;
+    struct FiringPositions *oldest = 0;
+    int i;
+
+    for (i=0; i<MAX_FIRING_POSITION_SETS; i++, set++) {
+        if (!set->enabled) {
+            if (!set->users)
+                oldest = set;
+            continue;
+        }
+        if (set->target == target && set->maxDistance == maxDistance && set->shootRange == curUnitInfo->shoot_range &&
+            set->projectileInfo == curUnitInfo->projectile_info && set->friendly == (curUnit->side == FRIENDLY)) {
+            set->users++;
+            return set->tile;
+        }
+        if (!set->users && (!oldest || (oldest->enabled && (unsigned short int) (firingPositionsFrame - set->created) >
+                                                           (unsigned short int) (firingPositionsFrame - oldest->created))))
+            oldest = set;
+    }
+    #ifdef DEBUG_BUILD
+    if (!oldest) errorSI("no firing positions set free@getFiringPositions", MAX_FIRING_POSITION_SETS);
+    #endif
+
+    oldest->enabled        = true;
+    oldest->target         = target;
+    oldest->maxDistance    = maxDistance;
+    oldest->shootRange     = curUnitInfo->shoot_range;
+    oldest->projectileInfo = curUnitInfo->projectile_info;
+    oldest->friendly       = (curUnit->side == FRIENDLY);
+    oldest->byUnits        = isLineOfFireBlockedByUnits(curUnitInfo->projectile_info);
+    oldest->created        = firingPositionsFrame;
+    oldest->users          = 1;
+    determineFiringPositions(oldest);
+    return oldest->tile;
+}
+
+void releaseFiringPositions(const u32 *tile) {
+    int i;
+    
+    for (i=0; i<MAX_FIRING_POSITION_SETS; i++) {
+        if (firingPositions[i].tile == tile && firingPositions[i].users > 0) {
+            firingPositions[i].users--;
+            return;
+        }
+    }
+}
+
+#endif
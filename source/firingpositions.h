@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _FIRINGPOSITIONS_H_
+#define _FIRINGPOSITIONS_H_
+
+#include "pathfinding.h"
+#ifndef REMOVE_ASTAR_PATHFINDING
+
+#include "environment.h"
+#include "units.h"
+
+// the firing positions of a target are the tiles from where a unit of a side can hit it, given its shoot range and
+// projectile. they are determined once and shared by all units like it attacking the same target, rather than
+// every path search testing the line of fire from every tile it comes across
+#define MAX_FIRING_POSITION_SETS    (7 + ASTAR_SEARCHES)    /* the searches underway each hold on to theirs */
+#define FIRING_POSITIONS_LIFETIME   FPS     /* in logic frames. ore and wall pieces being shot away may have opened lines of fire since */
+
+void initFiringPositionsWithScenario();
+// to be called once every logic frame
+void updateFiringPositions();
+// to be called whenever structures were added to or removed from the given area
+void invalidateFiringPositions(int x, int y, int width, int height);
+// to be called whenever the unit on the tile changed
+void invalidateFiringPositionsOfUnits(int tile);
+
+// returns the firing positions of target for units like the given one, of the tiles within maxDistance (a heuristic
+// distance, as the max_attack_distance of Astar) of it: a bit per tile, as in IS_TILE_BIT_SET. the set is kept as it
+// is until released, for the search it was handed to may still be reading it
+const u32 *getFiringPositions(int target, int maxDistance, struct Unit *curUnit, struct UnitInfo *curUnitInfo);
+void releaseFiringPositions(const u32 *tile);
+
+#endif
+#endif
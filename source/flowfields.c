@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Flow fields: when a group of units is ordered towards the same destination,
+// the distance from every tile to that destination is computed once. Each unit
+// of the group then moves to the neighbouring tile nearest to the destination,
+// rather than having a path of its own searched for.
+//
+// A flow field does not take other units into account. A unit whose way
+// downhill stays blocked leaves the flow field and has a path searched for
+// instead. Flow fields are not saved; units simply request a path again after
+// a game is loaded.
+
+#include "flowfields.h"
+#ifndef REMOVE_ASTAR_PATHFINDING
+
+#include "factions.h"
+#include "structures.h"
+#include "shared.h"
+
+struct FlowField {
+    int users;             // the amount of units following the flow field. 0 means not in use
+    int dest;
+    bool tracked;
+    bool friendly;         // friendly units cannot move through undiscovered tiles
+    unsigned short int lastUsed; // logic frame a unit last moved along the flow field
+    unsigned short int distance[MAX_TILES_ENVIRONMENT]; // real distance to dest, or FLOW_FIELD_UNREACHABLE
+};
+
+static struct FlowField flowField[MAX_FLOW_FIELDS];
+static unsigned short int flowFieldFrame;
+
+static s8 unitFlowField[MAX_UNITS_ON_MAP];        // -1 if the unit follows no flow field
+static bool unitFlowFieldAttack[MAX_UNITS_ON_MAP];
+static u8 unitFlowFieldHolds[MAX_UNITS_ON_MAP];
+static int unitFlowFieldBlockedDest[MAX_UNITS_ON_MAP]; // the destination the unit got stuck going to using a flow field
+
+// the tiles whose distance is not yet final, ordered by distance
+static unsigned short int flowFieldHeap[MAX_TILES_ENVIRONMENT];
+static unsigned short int flowFieldHeapPosition[MAX_TILES_ENVIRONMENT];
+static int flowFieldHeapSize;
+
+// in the order of the moves, starting with UM_MOVE_UP
+static const s8 flowFieldDirX[8] = { 0, +1, +1, +1,  0, -1, -1, -1 };
+static const s8 flowFieldDirY[8] = {-1, -1,  0, +1, +1, +1,  0, -1 };
+
+
+void initFlowFieldsWithScenario() {
+    int i;
+
+    for (i=0; i<MAX_FLOW_FIELDS; i++)
+        flowField[i].users = 0;
+    flowFieldFrame = 0;
+
+    for (i=0; i<MAX_UNITS_ON_MAP; i++) {
+        unitFlowField[i] = -1;
+        unitFlowFieldBlockedDest[i] = -1;
+    }
+}
+
+void releaseFlowField(int field) {
+    int i;
+
+    for (i=0; i<MAX_UNITS_ON_MAP; i++) {
+        if (unitFlowField[i] == field)
+            unitFlowField[i] = -1;
+    }
+    flowField[field].users = 0;
+}
+
+void updateFlowFields() {
+    int i;
+
+    flowFieldFrame++;
+    // units that were given another order, or that are busy shooting, don't leave their flow field
+    for (i=0; i<MAX_FLOW_FIELDS; i++) {
+        if (flowField[i].users > 0 && (unsigned short int) (flowFieldFrame - flowField[i].lastUsed) > FLOW_FIELD_IDLE_TIME)
+            releaseFlowField(i);
+    }
+}
+
+
+static inline int isFlowFieldTileTraversable(struct FlowField *field, int tile) {
+    if (field->friendly && environment.layout[tile].status == UNDISCOVERED)
+        return 0;
+    if (environment.layout[tile].traversability == TRAVERSABLE)
+        return 1;
+    return (!field->tracked && environment.layout[tile].traversability == TRAVERSABLE_BY_NON_TRACKED);
+}
+
+void siftUpFlowFieldHeap(struct FlowField *field, int position, int tile) {
+    int parent;
+
+    while (position > 0) {
+        parent = (position - 1) / 2;
+        if (field->distance[flowFieldHeap[parent]] <= field->distance[tile])
+            break;
+        flowFieldHeap[position] = flowFieldHeap[parent];
+        flowFieldHeapPosition[flowFieldHeap[position]] = position;
+        position = parent;
+    }
+    flowFieldHeap[position] = tile;
+    flowFieldHeapPosition[tile] = position;
+}
+
+int popFlowFieldHeap(struct FlowField *field) {
+    int first = flowFieldHeap[0];
+    int last = flowFieldHeap[--flowFieldHeapSize];
+    int position = 0;
+    int child;
+
+    while ((child = 2 * position + 1) < flowFieldHeapSize) {
+        if (child + 1 < flowFieldHeapSize && field->distance[flowFieldHeap[child + 1]] < field->distance[flowFieldHeap[child]])
+            child++;
+        if (field->distance[last] <= field->distance[flowFieldHeap[child]])
+            break;
+        flowFieldHeap[position] = flowFieldHeap[child];
+        flowFieldHeapPosition[flowFieldHeap[position]] = position;
+        position = child;
+    }
+    flowFieldHeap[position] = last;
+    flowFieldHeapPosition[last] = position;
+    return first;
+}
+
+void setFlowFieldDistance(struct FlowField *field, int tile, int distance) {
+    int position = (field->distance[tile] == FLOW_FIELD_UNREACHABLE) ? flowFieldHeapSize++ : flowFieldHeapPosition[tile];
+
+    field->distance[tile] = distance;
+    siftUpFlowFieldHeap(field, position, tile);
+}
+
+void computeFlowField(struct FlowField *field) {
+    int tile, newTile, newDistance;
+    int x, y, newX, newY;
+    int structureNr;
+    int i, j;
+
+    for (i=0; i<environment.width*environment.height; i++)
+        field->distance[i] = FLOW_FIELD_UNREACHABLE;
+    flowFieldHeapSize = 0;
+
+    // a structure is reached by reaching any of its tiles
+    structureNr = environment.layout[field->dest].contains_structure;
+    if (structureNr < -1)
+        structureNr = environment.layout[field->dest + (structureNr + 1)].contains_structure;
+    if (structureNr >= MAX_DIFFERENT_FACTIONS) {
+        for (i=0; i<structureInfo[structure[structureNr].info].height; i++) {
+            for (j=0; j<structureInfo[structure[structureNr].info].width; j++)
+                setFlowFieldDistance(field, TILE_FROM_XY(structure[structureNr].x + j, structure[structureNr].y + i), 0);
+        }
+    } else
+        setFlowFieldDistance(field, field->dest, 0);
+
+    // Dijkstra outwards from the destination
+    while (flowFieldHeapSize > 0) {
+        tile = popFlowFieldHeap(field);
+        x = X_FROM_TILE(tile);
+        y = Y_FROM_TILE(tile);
+        for (i=0; i<8; i++) {
+            newX = x + flowFieldDirX[i];
+            newY = y + flowFieldDirY[i];
+            if (newX < 0 || newX >= environment.width || newY < 0 || newY >= environment.height)
+                continue;
+            newTile = TILE_FROM_XY(newX, newY);
+            newDistance = field->distance[tile] + ((i & 1) ? DIAGONAL_REAL_DISTANCE : HORIZVERT_REAL_DISTANCE);
+            if (newDistance < field->distance[newTile] && isFlowFieldTileTraversable(field, newTile))
+                setFlowFieldDistance(field, newTile, newDistance);
+        }
+    }
+}
+
+
+int getFlowField(int dest, struct Unit *curUnit, struct UnitInfo *curUnitInfo) {
+    int i;
+
+    for (i=0; i<MAX_FLOW_FIELDS; i++) {
+        if (flowField[i].users > 0 && flowField[i].dest == dest &&
+            flowField[i].tracked  == (curUnitInfo->type == UT_TRACKED) &&
+            flowField[i].friendly == (curUnit->side == FRIENDLY))
+            return i;
+    }
+    return -1;
+}
+
+int createFlowField(int dest, struct Unit *curUnit, struct UnitInfo *curUnitInfo) {
+    int i;
+
+    for (i=0; i<MAX_FLOW_FIELDS; i++) {
+        if (flowField[i].users == 0) {
+            flowField[i].dest     = dest;
+            flowField[i].tracked  = (curUnitInfo->type == UT_TRACKED);
+            flowField[i].friendly = (curUnit->side == FRIENDLY);
+            flowField[i].lastUsed = flowFieldFrame;
+            computeFlowField(&flowField[i]);
+            return i;
+        }
+    }
+    return -1;
+}
+
+int isFlowFieldReachable(int field, int tile) {
+    return (flowField[field].distance[tile] != FLOW_FIELD_UNREACHABLE);
+}
+
+
+void joinFlowField(int unit_nr, int field, bool attack) {
+    leaveFlowField(unit_nr, false);
+    unitFlowField[unit_nr] = field;
+    unitFlowFieldAttack[unit_nr] = attack;
+    unitFlowFieldHolds[unit_nr] = 0;
+    flowField[field].users++;
+}
+
+void leaveFlowField(int unit_nr, bool blocked) {
+    if (unitFlowField[unit_nr] < 0)
+        return;
+    if (blocked)
+        unitFlowFieldBlockedDest[unit_nr] = flowField[(int) unitFlowField[unit_nr]].dest;
+    flowField[(int) unitFlowField[unit_nr]].users--;
+    unitFlowField[unit_nr] = -1;
+}
+
+int getUnitFlowField(int unit_nr, bool attack, int dest) {
+    int field = unitFlowField[unit_nr];
+
+    if (field < 0 || unitFlowFieldAttack[unit_nr] != attack || flowField[field].dest != dest)
+        return -1;
+    return field;
+}
+
+int canUnitUseFlowField(int unit_nr, int dest) {
+    return (unitFlowFieldBlockedDest[unit_nr] != dest);
+}
+
+
+enum UnitMove getFlowFieldMove(int field, int unit_nr, int curTile) {
+    struct FlowField *curField = &flowField[field];
+    int x = X_FROM_TILE(curTile);
+    int y = Y_FROM_TILE(curTile);
+    int bestDistance = curField->distance[curTile];
+    int best = -1;
+    int newX, newY, newTile;
+    int i;
+
+    curField->lastUsed = flowFieldFrame;
+
+    for (i=0; i<8; i++) {
+        newX = x + flowFieldDirX[i];
+        newY = y + flowFieldDirY[i];
+        if (newX < 0 || newX >= environment.width || newY < 0 || newY >= environment.height)
+            continue;
+        newTile = TILE_FROM_XY(newX, newY);
+        if (curField->distance[newTile] >= bestDistance)
+            continue;
+        if (!freeToMoveUnitViaTile(unit + unit_nr, newTile) || isTileBlockedByOtherUnit(unit + unit_nr, newTile))
+            continue;
+        best = i;
+        bestDistance = curField->distance[newTile];
+    }
+
+    if (best < 0)
+        return UM_MOVE_HOLD;
+    unitFlowFieldHolds[unit_nr] = 0;
+    return UM_MOVE_UP + best;
+}
+
+int waitOnFlowField(int unit_nr) {
+    return (++unitFlowFieldHolds[unit_nr] < FLOW_FIELD_MAX_HOLDS);
+}
+
+#endif
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _FLOWFIELDS_H_
+#define _FLOWFIELDS_H_
+
+#include "pathfinding.h"
+#ifndef REMOVE_ASTAR_PATHFINDING
+
+#include "environment.h"
+#include "units.h"
+
+// a flow field holds, for every tile, the real distance to a single destination for one kind of unit. the units
+// of a group sent to that destination each move to the nearest neighbouring tile closer to it, instead of having
+// a path of their own searched for
+#define MAX_FLOW_FIELDS         4
+#define MIN_FLOW_FIELD_GROUP    4           /* units queued for the same destination before a flow field is made for them */
+#define FLOW_FIELD_MAX_HOLDS    16          /* times a unit waits for its way downhill to clear before searching for a path instead */
+#define FLOW_FIELD_IDLE_TIME    (FPS*2)     /* in logic frames. a flow field no unit moved along for this long is released */
+#define FLOW_FIELD_UNREACHABLE  0xFFFF
+
+void initFlowFieldsWithScenario();
+// to be called once every logic frame
+void updateFlowFields();
+
+// returns the flow field towards dest in use for units like the given one, or -1 if there is none
+int getFlowField(int dest, struct Unit *curUnit, struct UnitInfo *curUnitInfo);
+// makes a flow field towards dest for units like the given one. returns -1 if all flow fields are in use
+int createFlowField(int dest, struct Unit *curUnit, struct UnitInfo *curUnitInfo);
+int isFlowFieldReachable(int field, int tile);
+
+void joinFlowField(int unit_nr, int field, bool attack);
+// blocked: the unit got stuck following the flow field. it won't use one towards the same destination again
+void leaveFlowField(int unit_nr, bool blocked);
+// returns the flow field the unit follows towards dest, or -1 if it doesn't
+int getUnitFlowField(int unit_nr, bool attack, int dest);
+int canUnitUseFlowField(int unit_nr, int dest);
+
+// returns the move downhill the unit is able to make, or UM_MOVE_HOLD if its way is blocked
+enum UnitMove getFlowFieldMove(int field, int unit_nr, int curTile);
+// returns whether the unit, whose way downhill is blocked, should keep waiting for it to clear
+int waitOnFlowField(int unit_nr);
+
+#endif
+#endif
@@ -56,6 +56,7 @@
 #include "objectives.h"
 #include "timedtriggers.h"
 #include "ingame_briefing.h"
+#include "replay.h"
 
 
 enum GameState gameState;
@@ -225,6 +226,9 @@ void setGameState(enum GameState state) {
                 (gameState < MENU_INGAME || gameState > MENU_GAMEINFO_TECHTREE)) {
                 delayNewRumble();
                 
+                initRandLogic(rand());
+                startReplayRecording();
+                
                 initIngameBriefing();
                 initView(HORIZONTAL, 0, 0);
                 initPlayScreen();
@@ -685,6 +689,7 @@ void doGameLogic() {
                 inputPlayScreen();
             else
                 doScreenSetUpLogic();
+            doReplayLogic();
             
             /* then do logic for both screens which do not rely on user input */
             //if (getObjectivesState() == OBJECTIVES_INCOMPLETE || (gameFrame & 1)) {
@@ -706,6 +711,7 @@ void doGameLogic() {
                     swiWaitForVBlank();
                     drawGame(); // ensuring every layer is shifted to its proper position again
                 }
+                recordReplayCommand(RC_PAUSE, 0, 0, 0);
                 setGameState(MENU_INGAME);
                 playSoundeffect(SE_MENU_OK);
             }
@@ -717,7 +723,7 @@ void doGameLogic() {
             
 #ifdef DEBUG_BUILD
 // INFAMOUS MONEY CHEAT!!11!1!1! and Profiling cheat and Level Win cheat.
-if (keysDown() & KEY_R) changeCredits(FRIENDLY, 1000);
+if (keysDown() & KEY_R) { changeCredits(FRIENDLY, 1000); recordReplayCommand(RC_CHANGE_CREDITS, 0, 1000, 0); }
 if ((getKeysDown() & KEY_L) && (getKeysDown() & KEY_R)) {
   setScreenSetUp(MAIN_TOUCH);
   stopSoundeffects();
@@ -729,8 +735,9 @@ if ((getKeysDown() & KEY_L) && (getKeysDown() & KEY_R)) {
   writeSaveFile();
   setGameState(CUTSCENE_DEBRIEFING);
 }
-if (keysDown() & KEY_SELECT) stopProfiling();
+if (keysDown() & KEY_SELECT) flushProfiling();
 #endif
+            advanceReplayFrame();
             break;
         case MENU_INGAME:
             doMenuIngameLogic();
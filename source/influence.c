@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Influence: the AI picked the rally point of a team and the structure to
+// attack without knowing anything of the map, sending teams to gather under
+// the guns of the player and units to the first structure on its list,
+// wherever that was.
+//
+// Instead, a coarse map is kept per side, in the cells of the unit grid, of
+// the firepower of its units and structures, the value of its structures and
+// what it lost recently. It is kept up to date as units move from cell to
+// cell and as units and structures come and go, so that consulting it never
+// means going through the units or structures. Losses are forgotten bit by
+// bit, so that the AI dares to come back after a while.
+
+#include "influence.h"
+
+#include "environment.h"
+#include "factions.h"
+#include "info.h"
+#include "projectiles.h"
+#include "structures.h"
+#include "units.h"
+
+struct InfluenceCell {
+    u16 unitFirepower;
+    u16 structureFirepower;
+    u16 structureValue;
+    u16 losses;
+};
+
+static struct InfluenceCell influence[MAX_DIFFERENT_FACTIONS][MAX_UNIT_GRID_CELLS];
+static int influenceDecayFrame;
+
+
+static int getFirepower(int projectile_info, int double_shot, int reload_time) {
+    if (projectile_info < 0 || reload_time <= 0)
+        return 0;
+    return max(0, min(INFLUENCE_MAX_CONTRIBUTION, (projectileInfo[projectile_info].power * (double_shot ? 2 : 1) * FPS) / reload_time));
+}
+
+static inline int getStructureFirepower(struct StructureInfo *curStructureInfo) {
+    if (curStructureInfo->shoot_range <= 0)
+        return 0;
+    return getFirepower(curStructureInfo->projectile_info, curStructureInfo->double_shot, curStructureInfo->original_reload_time);
+}
+
+int getInfluenceUnitFirepower(int unit_nr) {
+    struct UnitInfo *curUnitInfo = unitInfo + unit[unit_nr].info;
+
+    if (curUnitInfo->shoot_range <= 0)
+        return 0;
+    return getFirepower(curUnitInfo->projectile_info, curUnitInfo->double_shot, curUnitInfo->original_reload_time);
+}
+
+static inline int getStructureValue(struct StructureInfo *curStructureInfo) {
+    // foundations and walls aren't worth attacking for
+    if (curStructureInfo->foundation || curStructureInfo->barrier)
+        return 0;
+    return min(INFLUENCE_MAX_CONTRIBUTION, curStructureInfo->build_cost / 16);
+}
+
+
+void initInfluenceOfUnits() {
+    int i, j;
+
+    for (i=0; i<MAX_DIFFERENT_FACTIONS; i++) {
+        for (j=0; j<MAX_UNIT_GRID_CELLS; j++)
+            influence[i][j].unitFirepower = 0;
+    }
+}
+
+void initInfluenceWithScenario() {
+    int i, j;
+
+    for (i=0; i<MAX_DIFFERENT_FACTIONS; i++) {
+        for (j=0; j<MAX_UNIT_GRID_CELLS; j++) {
+            influence[i][j].structureFirepower = 0;
+            influence[i][j].structureValue = 0;
+            influence[i][j].losses = 0;
+        }
+    }
+    for (i=MAX_DIFFERENT_FACTIONS; i<MAX_STRUCTURES_ON_MAP; i++) {
+        if (structure[i].enabled)
+            addInfluenceStructure(i);
+    }
+    influenceDecayFrame = 0;
+}
+
+void updateInfluence() {
+    int i, j;
+
+    if (++influenceDecayFrame < INFLUENCE_DECAY_FRAMES)
+        return;
+    influenceDecayFrame = 0;
+    for (i=0; i<getAmountOfSides(); i++) {
+        for (j=getUnitGridWidth() * getUnitGridHeight() - 1; j>=0; j--) {
+            if (influence[i][j].losses)
+                influence[i][j].losses -= max(1, influence[i][j].losses >> 3);
+        }
+    }
+}
+
+
+void moveInfluenceUnit(int unit_nr, int oldCell, int cell) {
+    int firepower = getInfluenceUnitFirepower(unit_nr);
+
+    if (oldCell >= 0)
+        influence[unit[unit_nr].side][oldCell].unitFirepower -= firepower;
+    if (cell >= 0)
+        influence[unit[unit_nr].side][cell].unitFirepower += firepower;
+}
+
+void addInfluenceStructure(int structure_nr) {
+    struct StructureInfo *curStructureInfo = structureInfo + structure[structure_nr].info;
+    struct InfluenceCell *curCell = &influence[structure[structure_nr].side][getUnitGridCell(structure[structure_nr].x, structure[structure_nr].y)];
+
+    curCell->structureFirepower += getStructureFirepower(curStructureInfo);
+    curCell->structureValue += getStructureValue(curStructureInfo);
+}
+
+void removeInfluenceStructure(int structure_nr) {
+    struct StructureInfo *curStructureInfo = structureInfo + structure[structure_nr].info;
+    struct InfluenceCell *curCell = &influence[structure[structure_nr].side][getUnitGridCell(structure[structure_nr].x, structure[structure_nr].y)];
+
+    curCell->structureFirepower -= getStructureFirepower(curStructureInfo);
+    curCell->structureValue -= getStructureValue(curStructureInfo);
+}
+
+void addInfluenceLoss(enum Side side, int x, int y, int cost) {
+    struct InfluenceCell *curCell = &influence[side][getUnitGridCell(x, y)];
+
+    curCell->losses = min(0xFFFF, curCell->losses + min(INFLUENCE_MAX_CONTRIBUTION, cost / 16));
+}
+
+
+// the cells of the unit grid around the one of x,y
+static inline void getInfluenceCellsAround(int x, int y, int *cellX1, int *cellY1, int *cellX2, int *cellY2) {
+    *cellX1 = max(0, (x >> UNIT_GRID_SHIFT) - 1);
+    *cellY1 = max(0, (y >> UNIT_GRID_SHIFT) - 1);
+    *cellX2 = min(getUnitGridWidth() - 1,  (x >> UNIT_GRID_SHIFT) + 1);
+    *cellY2 = min(getUnitGridHeight() - 1, (y >> UNIT_GRID_SHIFT) + 1);
+}
+
+int getInfluenceThreat(enum Side side, int x, int y) {
+    int cellX1, cellY1, cellX2, cellY2;
+    int cellX, cellY, cell;
+    int i, threat = 0;
+
+    getInfluenceCellsAround(x, y, &cellX1, &cellY1, &cellX2, &cellY2);
+    for (cellY=cellY1; cellY<=cellY2; cellY++) {
+        for (cellX=cellX1; cellX<=cellX2; cellX++) {
+            cell = cellY * getUnitGridWidth() + cellX;
+            for (i=0; i<getAmountOfSides(); i++) {
+                if ((!i) != (!side))
+                    threat += influence[i][cell].unitFirepower + influence[i][cell].structureFirepower;
+            }
+            threat += influence[side][cell].losses;
+        }
+    }
+    return threat;
+}
+
+int getInfluenceStructureValue(enum Side side, int x, int y) {
+    int cellX1, cellY1, cellX2, cellY2;
+    int cellX, cellY;
+    int value = 0;
+
+    getInfluenceCellsAround(x, y, &cellX1, &cellY1, &cellX2, &cellY2);
+    for (cellY=cellY1; cellY<=cellY2; cellY++) {
+        for (cellX=cellX1; cellX<=cellX2; cellX++)
+            value += influence[side][cellY * getUnitGridWidth() + cellX].structureValue;
+    }
+    return value;
+}
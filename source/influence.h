@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _INFLUENCE_H_
+#define _INFLUENCE_H_
+
+#include <nds.h>
+
+#include "shared.h"
+
+// a coarse map of what each side has where, in the cells of the unit grid: the firepower of its units and structures,
+// the value of its structures and what it lost there recently. the AI consults it to decide where to gather a team and
+// which structure to attack
+#define INFLUENCE_DECAY_FRAMES      FPS     /* in logic frames. how often an eighth of the recent losses is forgotten */
+#define INFLUENCE_MAX_CONTRIBUTION  255     /* the most firepower, value or loss a single unit or structure accounts for */
+
+// to be called when the unit grid is (re)built, before the units are added to it
+void initInfluenceOfUnits();
+// (re)derives the influence of the structures and forgets the recent losses, i.e. after a scenario or savegame was loaded
+void initInfluenceWithScenario();
+// to be called once every logic frame
+void updateInfluence();
+
+// to be called when the unit moved from one cell of the unit grid to another. -1 for none, i.e. when added or removed
+void moveInfluenceUnit(int unit_nr, int oldCell, int cell);
+void addInfluenceStructure(int structure_nr);
+void removeInfluenceStructure(int structure_nr);
+// to be called when a unit or structure of the side, worth the given build cost, was destroyed at x,y
+void addInfluenceLoss(enum Side side, int x, int y, int cost);
+
+// the firepower of the sides hostile to the given side, plus the recent losses of the side, in the cells around x,y
+int getInfluenceThreat(enum Side side, int x, int y);
+// the value of the structures of the side in the cells around x,y
+int getInfluenceStructureValue(enum Side side, int x, int y);
+// the firepower the unit accounts for
+int getInfluenceUnitFirepower(int unit_nr);
+
+#endif
@@ -136,16 +136,16 @@ int readTechtreeItem(struct TechtreeItem *ti, char *oneline) {
     
     // structure that builds the item
     ti->buildingInfo = getStructureNameInfo(oneline);
-    offset += strlen(structureInfo[ti->buildingInfo].name);
+    offset += strlen(structureInfoText[ti->buildingInfo].name);
     offset += 1; // +1 for the comma that follows it
     
     // item that it builds
     if (ti->buildStructure) { // it should have a structure as buildable
         ti->buildableInfo = getStructureNameInfo(oneline + offset);
-        offset += strlen(structureInfo[ti->buildableInfo].name);
+        offset += strlen(structureInfoText[ti->buildableInfo].name);
     } else {
         ti->buildableInfo = getUnitNameInfo(oneline + offset);
-        offset += strlen(unitInfo[ti->buildableInfo].name);
+        offset += strlen(unitInfoText[ti->buildableInfo].name);
     }
     if (oneline[offset] != ',') return 1;
     offset += 1; // +1 for the comma that follows it
@@ -153,7 +153,7 @@ int readTechtreeItem(struct TechtreeItem *ti, char *oneline) {
     // required additional structures in order to build the item
     for (i=0; i<MAX_REQUIREDINFO_COUNT; i++) {
         ti->requiredInfo[i] = getStructureNameInfo(oneline + offset);
-        offset += strlen(structureInfo[ti->requiredInfo[i]].name);
+        offset += strlen(structureInfoText[ti->requiredInfo[i]].name);
         if (oneline[offset] != ',') return 1;
         offset += 1; // +1 for the comma that follows it
     }
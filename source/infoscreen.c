@@ -15,6 +15,7 @@
 #include "game.h"
 #include "settings.h"
 #include "soundeffects.h"
+#include "replay.h"
 
 #include "factions.h"
 #include "structures.h"
@@ -230,16 +231,20 @@ int inputBuildQueue(int x, int y) {
             item = (x-48)/32;
             if (getStructuresQueue(FRIENDLY)[item].enabled) {
                 if (getKeysHeldTimeMax(KEY_TOUCH) >= FPS/2) {
-                    if (removeItemStructuresQueueNr(FRIENDLY, item, 1, 0))
+                    if (removeItemStructuresQueueNr(FRIENDLY, item, 1, 0)) {
+                        recordReplayCommand(RC_REMOVE_QUEUE_ITEM, 1, item, 0);
                         playSoundeffect(SE_BUTTONCLICK);
+                    }
                 } else {
                     if (getStructuresQueue(FRIENDLY)[item].status == DONE) {
                         setModifierPlaceStructure(item);
                         playSoundeffect(SE_BUTTONCLICK);
                         return 1;
                     }
-                    if (togglePauseItemStructuresQueueNr(FRIENDLY, item))
+                    if (togglePauseItemStructuresQueueNr(FRIENDLY, item)) {
+                        recordReplayCommand(RC_TOGGLE_PAUSE_QUEUE_ITEM, 1, item, 0);
                         playSoundeffect(SE_BUTTONCLICK);
+                    }
                 }
             }
         } else if (y < 104) {
@@ -247,11 +252,15 @@ int inputBuildQueue(int x, int y) {
             item = ((y-56)/24)*5 + ((x-48)/32);
             if (getUnitsQueue(FRIENDLY)[item].enabled) {
                 if (getKeysHeldTimeMax(KEY_TOUCH) >= FPS/2) {
-                    if (removeItemUnitsQueueNr(FRIENDLY, item, 1, 0))
+                    if (removeItemUnitsQueueNr(FRIENDLY, item, 1, 0)) {
+                        recordReplayCommand(RC_REMOVE_QUEUE_ITEM, 0, item, 0);
                         playSoundeffect(SE_BUTTONCLICK);
+                    }
                 } else {
-                    if (togglePauseItemUnitsQueueNr(FRIENDLY, item))
+                    if (togglePauseItemUnitsQueueNr(FRIENDLY, item)) {
+                        recordReplayCommand(RC_TOGGLE_PAUSE_QUEUE_ITEM, 0, item, 0);
                         playSoundeffect(SE_BUTTONCLICK);
+                    }
                 }
             }
         }
@@ -271,11 +280,15 @@ void inputButtonMinplus(int x, int y) {
             if (x < 64) {
                 /* minus clicked */
                 if (infoScreenBuildInfoIsStructure) {
-                    if (removeItemStructuresQueueWithInfo(FRIENDLY, infoScreenBuildInfoNr, 1, 0))
+                    if (removeItemStructuresQueueWithInfo(FRIENDLY, infoScreenBuildInfoNr, 1, 0)) {
+                        recordReplayCommand(RC_REMOVE_QUEUE_ITEM_WITH_INFO, 1, infoScreenBuildInfoNr, 0);
                         playSoundeffect(SE_BUTTONCLICK);
+                    }
                 } else {
-                    if (removeItemUnitsQueueWithInfo(FRIENDLY, infoScreenBuildInfoNr, 1, 0))
+                    if (removeItemUnitsQueueWithInfo(FRIENDLY, infoScreenBuildInfoNr, 1, 0)) {
+                        recordReplayCommand(RC_REMOVE_QUEUE_ITEM_WITH_INFO, 0, infoScreenBuildInfoNr, 0);
                         playSoundeffect(SE_BUTTONCLICK);
+                    }
                 }
             } else if (x < 80) {
                 /* plus clicked */
@@ -295,6 +308,7 @@ void inputButtonMinplus(int x, int y) {
                     }
                     if (amountOfItems < MAX_STRUCTURES_ON_MAP) {
                         if (addItemStructuresQueue(FRIENDLY, infoScreenBuildInfoNr, infoScreenBuildInfoBuilderNr)) {
+                            recordReplayCommand(RC_ADD_QUEUE_ITEM, 1, infoScreenBuildInfoNr, infoScreenBuildInfoBuilderNr);
                             amountOfItems++;
                             if (amountOfItems == MAX_STRUCTURES_ON_MAP)
                                 playMiscSoundeffect("Sound_structureLimitReached");
@@ -315,6 +329,7 @@ void inputButtonMinplus(int x, int y) {
                     }
                     if (amountOfItems < getUnitLimit(FRIENDLY)) {
                         if (addItemUnitsQueue(FRIENDLY, infoScreenBuildInfoNr, infoScreenBuildInfoBuilderNr)) {
+                            recordReplayCommand(RC_ADD_QUEUE_ITEM, 0, infoScreenBuildInfoNr, infoScreenBuildInfoBuilderNr);
                             amountOfItems++;
                             if (amountOfItems == getUnitLimit(FRIENDLY))
                                 playMiscSoundeffect("Sound_unitLimitReached");
@@ -777,8 +792,8 @@ void inputBarBuildables(int x, int y) { // buildable structures or units
                 REG_DISPCNT_SUB &= (~DISPLAY_BG2_ACTIVE); // temporarily disable the radar background until it is rewritten here to be used as information text display
                 REG_DISPCNT_SUB &= (~DISPLAY_BG1_ACTIVE); // disable covering up background behind radar
                 drawInformationBG( (infoScreenBuildInfoIsStructure) ? 
-                                    structureInfo[infoScreenBuildInfoNr].description : 
-                                    unitInfo[infoScreenBuildInfoNr].description );
+                                    structureInfoText[infoScreenBuildInfoNr].description : 
+                                    unitInfoText[infoScreenBuildInfoNr].description );
 //                REG_DISPCNT_SUB |= DISPLAY_BG2_ACTIVE; // activate radar background, used now for text-display
                 REG_BLDCNT_SUB = BLEND_NONE;
             }
@@ -1644,7 +1659,7 @@ void drawInfoScreen() {
                                     48, SPRITE_SIZE_32, 0, 0,
                                     1, 0, base_structure_icons + infoScreenBuildInfoNr*4);
                 /* display name */
-                drawAlphaCaption(structureInfo[infoScreenBuildInfoNr].name, 84, 10);
+                drawAlphaCaption(structureInfoText[infoScreenBuildInfoNr].name, 84, 10);
                 if (infoScreenBuildInfoCanBuild) {
                     /* display costs*/
                     drawDigitsCaption(structureInfo[infoScreenBuildInfoNr].build_cost, 200, 10);
@@ -1733,7 +1748,7 @@ void drawInfoScreen() {
                                 48, SPRITE_SIZE_32, 0, 0,
                                 1, 0, base_unit_icons + infoScreenBuildInfoNr*4);
             /* display name */
-            drawAlphaCaption(unitInfo[infoScreenBuildInfoNr].name, 84, 10);
+            drawAlphaCaption(unitInfoText[infoScreenBuildInfoNr].name, 84, 10);
             if (infoScreenBuildInfoCanBuild) {
                 /* display costs*/
                 drawDigitsCaption(unitInfo[infoScreenBuildInfoNr].build_cost, 200, 10);
@@ -1998,7 +2013,7 @@ void loadInfoScreenGraphics() {
     
     base_structure_icons = offset/(16*16);
     for (i=0; i<MAX_DIFFERENT_STRUCTURES && structureInfo[i].enabled; i++) {
-        offset += copyFileVRAM(SPRITE_GFX_SUB + (offset>>1), structureInfo[i].name, FS_ICONS_GRAPHICS);
+        offset += copyFileVRAM(SPRITE_GFX_SUB + (offset>>1), structureInfoText[i].name, FS_ICONS_GRAPHICS);
         for (j=0; j<(256>>1); j++) // set the remaining bytes of a 32x32 sprites to be transparent
             SPRITE_GFX_SUB[(offset>>1) + j] = 0;
         offset += 256;
@@ -2006,7 +2021,7 @@ void loadInfoScreenGraphics() {
     
     base_unit_icons = offset/(16*16);
     for (i=0; i<MAX_DIFFERENT_UNITS && unitInfo[i].enabled; i++) {
-        offset += copyFileVRAM(SPRITE_GFX_SUB + (offset>>1), unitInfo[i].name, FS_ICONS_GRAPHICS);
+        offset += copyFileVRAM(SPRITE_GFX_SUB + (offset>>1), unitInfoText[i].name, FS_ICONS_GRAPHICS);
         for (j=0; j<(256>>1); j++) // set the remaining bytes of a 32x32 sprites to be transparent
             SPRITE_GFX_SUB[(offset>>1) + j] = 0;
         offset += 256;
@@ -2237,8 +2252,8 @@ void setInfoScreenBuildInfo(int isStructure, int info) {
         REG_DISPCNT_SUB &= (~DISPLAY_BG2_ACTIVE); // temporarily disable the radar background until it is rewritten here to be used as information text display
         REG_DISPCNT_SUB &= (~DISPLAY_BG1_ACTIVE); // disable covering up background behind radar
         drawInformationBG( (infoScreenBuildInfoIsStructure) ? 
-                            structureInfo[infoScreenBuildInfoNr].description : 
-                            unitInfo[infoScreenBuildInfoNr].description );
+                            structureInfoText[infoScreenBuildInfoNr].description : 
+                            unitInfoText[infoScreenBuildInfoNr].description );
 //                REG_DISPCNT_SUB |= DISPLAY_BG2_ACTIVE; // activate radar background, used now for text-display
         REG_BLDCNT_SUB = BLEND_NONE;
     }
@@ -2385,8 +2400,8 @@ void drawInfoScreenBG() {
         REG_DISPCNT_SUB &= (~DISPLAY_BG2_ACTIVE); // temporarily disable the radar background until it is rewritten here to be used as information text display
         REG_DISPCNT_SUB &= (~DISPLAY_BG1_ACTIVE); // disable covering up background behind radar
         drawInformationBG( (infoScreenBuildInfoIsStructure) ? 
-                            structureInfo[infoScreenBuildInfoNr].description : 
-                            unitInfo[infoScreenBuildInfoNr].description );
+                            structureInfoText[infoScreenBuildInfoNr].description : 
+                            unitInfoText[infoScreenBuildInfoNr].description );
 //        REG_DISPCNT_SUB |= DISPLAY_BG2_ACTIVE; // activate radar background, used now for text-display
         REG_BLDCNT_SUB = BLEND_NONE;
     } else if (infoScreenType == IS_BUILDQUEUE) {
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Lines of fire: every unit and structure with a target tests whether its
+// projectile makes it there, following the line the projectile would take,
+// every logic frame. Most of those lines are the very ones tested the frame
+// before, and nothing along them changed meanwhile.
+//
+// Instead, the outcome is remembered in a small table, by the tiles shot from
+// and to and the projectile. Whether a line is clear depends on the
+// environment and the structures along it, and for shots and bullets also on
+// the units along it. The environment and structures have a version, increased
+// whenever any of it changes. Units change tiles nearly every frame, so they
+// have a version per area of the map instead, and a line depends on the sum
+// of those of the areas it goes through only. As the versions only increase,
+// the sum changes whenever one of them does. An outcome only holds while the
+// versions it was found with do. It is therefore always the one a new test
+// would give.
+
+#include "lineoffire.h"
+
+#include "projectiles.h"
+
+struct LineOfFire {
+    unsigned short int from;
+    unsigned short int to;
+    unsigned char projectileInfo;
+    unsigned char friendly;         // whether the side shooting is FRIENDLY, for lines that units may block
+    unsigned char clear;
+    unsigned int version;           // of the environment and structures. 0 for none remembered
+    unsigned int unitsVersion;      // of the units in the areas along the line, for lines that units may block
+};
+
+static struct LineOfFire lineOfFire[LINE_OF_FIRE_CACHE_SIZE];
+static unsigned int linesOfFireVersion;
+static unsigned int linesOfFireUnitsVersion[MAX_LINE_OF_FIRE_AREAS];
+static int linesOfFireAreasWidth;
+
+
+void initLinesOfFireWithScenario() {
+    int i;
+
+    for (i=0; i<LINE_OF_FIRE_CACHE_SIZE; i++)
+        lineOfFire[i].version = 0;
+    linesOfFireVersion = 1;
+    for (i=0; i<MAX_LINE_OF_FIRE_AREAS; i++)
+        linesOfFireUnitsVersion[i] = 0;
+    linesOfFireAreasWidth = (environment.width + (1 << LINE_OF_FIRE_AREA_SHIFT) - 1) >> LINE_OF_FIRE_AREA_SHIFT;
+}
+
+void invalidateLinesOfFire() {
+    if (++linesOfFireVersion == 0)
+        initLinesOfFireWithScenario();
+}
+
+void invalidateLinesOfFireOfUnits(int tile) {
+    linesOfFireUnitsVersion[(Y_FROM_TILE(tile) >> LINE_OF_FIRE_AREA_SHIFT) * linesOfFireAreasWidth +
+                            (X_FROM_TILE(tile) >> LINE_OF_FIRE_AREA_SHIFT)]++;
+}
+
+// the sum of the versions of the units in the areas covered by the line. the line doesn't leave the rectangle its
+// ends span, so these are all the areas it goes through
+static unsigned int getLineOfFireUnitsVersion(int curX, int curY, int tgtX, int tgtY) {
+    int x1 = min(curX, tgtX) >> LINE_OF_FIRE_AREA_SHIFT;
+    int x2 = max(curX, tgtX) >> LINE_OF_FIRE_AREA_SHIFT;
+    int y1 = min(curY, tgtY) >> LINE_OF_FIRE_AREA_SHIFT;
+    int y2 = max(curY, tgtY) >> LINE_OF_FIRE_AREA_SHIFT;
+    unsigned int version = 0;
+    unsigned int *areaVersion;
+    int x, y;
+
+    for (y=y1; y<=y2; y++) {
+        areaVersion = linesOfFireUnitsVersion + y * linesOfFireAreasWidth;
+        for (x=x1; x<=x2; x++)
+            version += areaVersion[x];
+    }
+    return version;
+}
+
+// shots and bullets are the projectiles units get in the way of
+int isLineOfFireBlockedByUnits(int projectile_info) {
+    return projectile_info >= 0 &&
+           (projectileInfo[projectile_info].type == PT_SHOT || projectileInfo[projectile_info].type == PT_BULLET);
+}
+
+static inline unsigned int getLineOfFireEntry(int from, int to, int projectile_info) {
+    return ((from * 2654435761u) ^ (to * 40503u) ^ projectile_info) & (LINE_OF_FIRE_CACHE_SIZE - 1);
+}
+
+int isLineOfFireClear(int curX, int curY, enum Side side, int projectile_info, int tgtX, int tgtY) {
+    // no projectile and aerial projectiles always have a clear path
+    if (projectile_info <= -1 || (projectileInfo[projectile_info].type & 1))
+        return 1;
+
+    int from = TILE_FROM_XY(curX, curY);
+    int to = TILE_FROM_XY(tgtX, tgtY);
+    bool byUnits = isLineOfFireBlockedByUnits(projectile_info);
+    bool friendly = byUnits && side == FRIENDLY;
+    unsigned int unitsVersion = byUnits ? getLineOfFireUnitsVersion(curX, curY, tgtX, tgtY) : 0;
+    struct LineOfFire *line = lineOfFire + getLineOfFireEntry(from, to, projectile_info);
+
+    if (line->version == linesOfFireVersion && line->from == from && line->to == to &&
+        line->projectileInfo == projectile_info && line->friendly == friendly && line->unitsVersion == unitsVersion)
+        return line->clear;
+
+    line->from = from;
+    line->to = to;
+    line->projectileInfo = projectile_info;
+    line->friendly = friendly;
+    line->clear = isClearPathProjectileOfSide(curX, curY, side, projectile_info, tgtX, tgtY);
+    line->version = linesOfFireVersion;
+    line->unitsVersion = unitsVersion;
+    return line->clear;
+}
+
+int isLineOfFireClearFromTile(int curX, int curY, int projectile_info, int tgtX, int tgtY) {
+    if (projectile_info <= -1 || (projectileInfo[projectile_info].type & 1))
+        return 1;
+
+    // only the side of shots and bullets is of consequence
+    if (!isLineOfFireBlockedByUnits(projectile_info))
+        return isLineOfFireClear(curX, curY, FRIENDLY, projectile_info, tgtX, tgtY);
+    return isLineOfFireClear(curX, curY, getSideShootingFromTile(curX, curY), projectile_info, tgtX, tgtY);
+}
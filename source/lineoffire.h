@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _LINEOFFIRE_H_
+#define _LINEOFFIRE_H_
+
+#include <nds.h>
+
+#include "environment.h"
+#include "shared.h"
+
+// whether a projectile makes it from one tile to another is remembered, for the same lines of fire are tested over and
+// over by the units and structures looking for a target. what is remembered is forgotten as soon as anything it
+// depended on may have changed
+#define LINE_OF_FIRE_CACHE_SIZE     512     /* a power of 2 */
+#define LINE_OF_FIRE_AREA_SHIFT     3       /* units changing tiles only affect the lines through areas of 8x8 tiles */
+#define MAX_LINE_OF_FIRE_AREAS      (MAX_TILES_ENVIRONMENT/64 + MAX_TILES_ENVIRONMENT/8 + 1) /* enough for any width and height of the map */
+
+void initLinesOfFireWithScenario();
+// to be called whenever the environment graphics or the structures on a tile changed
+void invalidateLinesOfFire();
+// to be called whenever the unit on the tile changed
+void invalidateLinesOfFireOfUnits(int tile);
+
+// whether units may block the projectile's line of fire, i.e. it's a shot or bullet
+int isLineOfFireBlockedByUnits(int projectile_info);
+
+// as isClearPathProjectileOfSide. only to be called from the logic, not from a path search
+int isLineOfFireClear(int curX, int curY, enum Side side, int projectile_info, int tgtX, int tgtY);
+// as isClearPathProjectile. only to be called from the logic, not from a path search
+int isLineOfFireClearFromTile(int curX, int curY, int projectile_info, int tgtX, int tgtY);
+
+#endif
@@ -60,6 +60,7 @@ int main() {
     init3DforExpandedSprites();
     
     for (;;) {
+        startProfilingFrame();
         drawGame();
         doGameLogic();
         doMusicLogic();
@@ -64,7 +64,7 @@ void loadMenuGameinfoItemInfoGraphics(enum GameState oldState) {
 
 
 int initMenuGameinfoItemInfo() {
-    screenGif = initScreenGif((getGameinfoIsStructure() ? structureInfo[getGameinfoItemNr()].name : unitInfo[getGameinfoItemNr()].name), FS_GAMEINFO_GRAPHICS, SGO_SCREEN_SUB | SGO_REPEAT);
+    screenGif = initScreenGif((getGameinfoIsStructure() ? structureInfoText[getGameinfoItemNr()].name : unitInfoText[getGameinfoItemNr()].name), FS_GAMEINFO_GRAPHICS, SGO_SCREEN_SUB | SGO_REPEAT);
     previousGameState = getGameState();
     
     REG_DISPCNT_SUB = ( MODE_3_2D | DISPLAY_SPR_ACTIVE | DISPLAY_SPR_1D | DISPLAY_SPR_1D_SIZE_64 );
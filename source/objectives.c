@@ -589,7 +589,7 @@ void initObjectives() {
         } else {
             structureObjective.need[i].info = getStructureNameInfo(cur + len);
             if (structureObjective.need[i].info >= 0)
-                len += strlen(structureInfo[structureObjective.need[i].info].name);
+                len += strlen(structureInfoText[structureObjective.need[i].info].name);
         }
         if (structureObjective.need[i].info >= 0) {
             if (cur[len] == ',') // a wav was mentioned
@@ -617,7 +617,7 @@ void initObjectives() {
         } else {
             structureObjective.kill[i].info = getStructureNameInfo(cur + len);
             if (structureObjective.kill[i].info >= 0)
-                len += strlen(structureInfo[structureObjective.kill[i].info].name);
+                len += strlen(structureInfoText[structureObjective.kill[i].info].name);
         }
         if (structureObjective.kill[i].info >= 0) {
             if (cur[len] == ',') // a wav was mentioned
@@ -657,7 +657,7 @@ void initObjectives() {
         } else {
             unitObjective.need[i].info = getUnitNameInfo(cur + len);
             if (unitObjective.need[i].info >= 0)
-                len += strlen(unitInfo[unitObjective.need[i].info].name);
+                len += strlen(unitInfoText[unitObjective.need[i].info].name);
         }
         if (unitObjective.need[i].info >= 0) {
             if (cur[len] == ',') // a wav was mentioned
@@ -685,7 +685,7 @@ void initObjectives() {
         } else {
             unitObjective.kill[i].info = getUnitNameInfo(cur + len);
             if (unitObjective.kill[i].info >= 0)
-                len += strlen(unitInfo[unitObjective.kill[i].info].name);
+                len += strlen(unitInfoText[unitObjective.kill[i].info].name);
         }
         if (unitObjective.kill[i].info >= 0) {
             if (cur[len] == ',') // a wav was mentioned
@@ -724,7 +724,7 @@ void initObjectives() {
             len += strlen("Any");
         } else {
             structureObjective.get_to[i].info = getStructureNameInfo(cur + len);
-            len += strlen(structureInfo[structureObjective.get_to[i].info].name);
+            len += strlen(structureInfoText[structureObjective.get_to[i].info].name);
         }
         if (structureObjective.get_to[i].info >= 0)
             sscanf(cur + len, ",%i,%i,%i,%i, %s", &structureObjective.get_to[i].x1, &structureObjective.get_to[i].y1, &structureObjective.get_to[i].x2, &structureObjective.get_to[i].y2, structureObjective.get_to[i].wav);
@@ -761,7 +761,7 @@ void initObjectives() {
             len += strlen("Any");
         } else {
             unitObjective.get_to[i].info = getUnitNameInfo(cur + len);
-            len += strlen(unitInfo[unitObjective.get_to[i].info].name);
+            len += strlen(unitInfoText[unitObjective.get_to[i].info].name);
         }
         if (unitObjective.get_to[i].info >= 0)
             sscanf(cur + len, ",%i,%i,%i,%i, %s", &unitObjective.get_to[i].x1, &unitObjective.get_to[i].y1, &unitObjective.get_to[i].x2, &unitObjective.get_to[i].y2, unitObjective.get_to[i].wav);
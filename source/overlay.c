@@ -8,6 +8,7 @@
 #include "settings.h"
 #include "soundeffects.h"
 #include "fileio.h"
+#include "entitypool.h"
 
 #define OVERLAY_TRACKS_SHORT_DURATION  ((2*(2*FPS)) / getGameSpeed())
 #define OVERLAY_TRACKS_LONG_DURATION   ((2*(4*FPS)) / getGameSpeed())
@@ -16,10 +17,17 @@
 #define OVERLAY_BLOOD_DURATION         ((2*(5*FPS)) / getGameSpeed())
 
 struct Overlay overlay[MAX_OVERLAY_ON_MAP];
+static struct EntityPool overlayPool;
 
 static int base_overlay[NUMBER_OF_OVERLAY_TYPES];
 
 
+static void disableOverlay(int nr) {
+    overlay[nr].enabled = 0;
+    freeEntityPoolEntry(&overlayPool, nr);
+}
+
+
 
 
 void addStructureDestroyedOverlay(int x, int y, int width, int height) { // the Destroyed gfx can be 4x3 or smaller
@@ -34,7 +42,7 @@ void addStructureDestroyedOverlay(int x, int y, int width, int height) { // the
     if (tilesDestroyedGraphics >= 12) {
 		// we can assume 4x3 (or even greater height)
 		// so we will randomly grab a section out of these graphics, so there is a bit of variation in destruction
-		base += (rand() % ((3+1) - height)) * 4 + (rand() % ((4+1) - width));
+		base += (randLogic() % ((3+1) - height)) * 4 + (randLogic() % ((4+1) - width));
 	}
     
     for (i=0; i<height; i++) {
@@ -42,7 +50,7 @@ void addStructureDestroyedOverlay(int x, int y, int width, int height) { // the
             curOverlayNr = envLayout[TILE_FROM_XY(x+j, y+i)].contains_overlay;
             if (curOverlayNr != -1) {
                 if (curOverlayNr < MAX_OVERLAY_ON_MAP)
-                   overlay[curOverlayNr].enabled = 0;
+                   disableOverlay(curOverlayNr);
                 else if (curOverlayNr - MAX_OVERLAY_ON_MAP < MAX_PERMANENT_OVERLAY_TYPES)
                     continue;
             }
@@ -84,40 +92,39 @@ int addOverlay(int x, int y, enum OverlayType type, int frame) {
         if (type < overlay[curOverlayNr].type)
             return -1;
         prevOverlay = overlay[curOverlayNr];
-        overlay[curOverlayNr].enabled = 0;
+        disableOverlay(curOverlayNr);
     }
     
-    for (i=0, curOverlay=overlay; i<MAX_OVERLAY_ON_MAP; i++, curOverlay++) {
-        if (!curOverlay->enabled) {
-            curOverlay->enabled = 1;
-            curOverlay->x = x;
-            curOverlay->y = y;
-            curOverlay->type = type;
-            if (curOverlayNr != -1 && (type == OT_ROCK_SHOT || type == OT_SAND_SHOT) && type == prevOverlay.type) {
-                curOverlay->frame = prevOverlay.frame;
-/*              if (type == OT_ROCK_SHOT && base_overlay[OT_ROCK_SHOT] != base_overlay[OT_SAND_SHOT]) {
-                    if ((base_overlay[OT_ROCK_SHOT + 1] - base_overlay[OT_ROCK_SHOT]) / 4 > (prevOverlay.frame + 2))
-                        curOverlay->frame = prevOverlay.frame + 2;
-                } else {
-                    if ((base_overlay[OT_SAND_SHOT + 1] - base_overlay[OT_SAND_SHOT]) / 4 > (prevOverlay.frame + 2))
-                        curOverlay->frame = prevOverlay.frame + 2;
-                }
-*/              if (((base_overlay[(type == OT_ROCK_SHOT && base_overlay[OT_ROCK_SHOT] != base_overlay[OT_SAND_SHOT]) ? (OT_SAND_SHOT) : (OT_SAND_SHOT+1)] -
-                      base_overlay[type]) / 4) > (curOverlay->frame + 2))
-                    curOverlay->frame += 2;
-//if (type == OT_SAND_SHOT && curOverlay->frame > 2) errorI4(prevOverlay.frame, type, base_overlay[OT_SAND_SHOT + 1], base_overlay[OT_SAND_SHOT]);
-            } else if (type == OT_ROCK_SHOT || type == OT_SAND_SHOT || type == OT_BLOOD)
-                curOverlay->frame = (x + y) & 1;
-            else
-                curOverlay->frame = frame;
-            curOverlay->timer = 0;
-            environment.layout[TILE_FROM_XY(x,y)].contains_overlay = i;
-            if (type == OT_SAND_SHOT)
-                playSoundeffectControlled(SE_IMPACT_SAND, volumePercentageOfLocation(x, y, DISTANCE_TO_HALVE_SE_IMPACT_SAND), soundeffectPanningOfLocation(x, y));
-            return i;
+    if ((i = getFreeEntityPoolEntry(&overlayPool, 0)) < 0)
+        return -1;
+    curOverlay = overlay + i;
+    useEntityPoolEntry(&overlayPool, i);
+    curOverlay->enabled = 1;
+    curOverlay->x = x;
+    curOverlay->y = y;
+    curOverlay->type = type;
+    if (curOverlayNr != -1 && (type == OT_ROCK_SHOT || type == OT_SAND_SHOT) && type == prevOverlay.type) {
+        curOverlay->frame = prevOverlay.frame;
+/*      if (type == OT_ROCK_SHOT && base_overlay[OT_ROCK_SHOT] != base_overlay[OT_SAND_SHOT]) {
+            if ((base_overlay[OT_ROCK_SHOT + 1] - base_overlay[OT_ROCK_SHOT]) / 4 > (prevOverlay.frame + 2))
+                curOverlay->frame = prevOverlay.frame + 2;
+        } else {
+            if ((base_overlay[OT_SAND_SHOT + 1] - base_overlay[OT_SAND_SHOT]) / 4 > (prevOverlay.frame + 2))
+                curOverlay->frame = prevOverlay.frame + 2;
         }
-    }
-    return -1;
+*/      if (((base_overlay[(type == OT_ROCK_SHOT && base_overlay[OT_ROCK_SHOT] != base_overlay[OT_SAND_SHOT]) ? (OT_SAND_SHOT) : (OT_SAND_SHOT+1)] -
+              base_overlay[type]) / 4) > (curOverlay->frame + 2))
+            curOverlay->frame += 2;
+//if (type == OT_SAND_SHOT && curOverlay->frame > 2) errorI4(prevOverlay.frame, type, base_overlay[OT_SAND_SHOT + 1], base_overlay[OT_SAND_SHOT]);
+    } else if (type == OT_ROCK_SHOT || type == OT_SAND_SHOT || type == OT_BLOOD)
+        curOverlay->frame = (x + y) & 1;
+    else
+        curOverlay->frame = frame;
+    curOverlay->timer = 0;
+    environment.layout[TILE_FROM_XY(x,y)].contains_overlay = i;
+    if (type == OT_SAND_SHOT)
+        playSoundeffectControlled(SE_IMPACT_SAND, volumePercentageOfLocation(x, y, DISTANCE_TO_HALVE_SE_IMPACT_SAND), soundeffectPanningOfLocation(x, y));
+    return i;
 }
 
 void drawOverlay() {
@@ -155,7 +162,8 @@ void doOverlayLogic() {
     
     startProfilingFunction("doOverlayLogic");
     
-    for (i=0, curOverlay=overlay; i<MAX_OVERLAY_ON_MAP; i++, curOverlay++) {
+    FOR_EACH_USED_ENTITY_POOL_ENTRY(&overlayPool, i) {
+        curOverlay = overlay + i;
         if (curOverlay->enabled) {
             curOverlay->timer++;
             switch (curOverlay->type) {
@@ -198,8 +206,10 @@ void doOverlayLogic() {
                 case OT_PERMANENT:
                     break;
             }
-            if (!curOverlay->enabled)
+            if (!curOverlay->enabled) {
                 environment.layout[TILE_FROM_XY(curOverlay->x, curOverlay->y)].contains_overlay = -1;
+                freeEntityPoolEntry(&overlayPool, i);
+            }
         }
     }
     
@@ -279,6 +289,16 @@ void loadOverlayGraphicsBG(int baseBg, int *offsetBg) {
 void loadOverlayGraphicsSprites(int *offsetSp) {
 }
 
+void initOverlayPool() {
+    int i;
+    
+    initEntityPool(&overlayPool, MAX_OVERLAY_ON_MAP);
+    for (i=0; i<MAX_OVERLAY_ON_MAP; i++) {
+        if (overlay[i].enabled)
+            useEntityPoolEntry(&overlayPool, i);
+    }
+}
+
 void initOverlayWithScenario() {
     FILE *fp;
     char oneline[256];
@@ -289,6 +309,7 @@ void initOverlayWithScenario() {
         environment.layout[i].contains_overlay = -1;
     for (i=0; i<MAX_OVERLAY_ON_MAP; i++)
         overlay[i].enabled = 0;
+    initOverlayPool();
     
     
     fp = openFile("", FS_CURRENT_SCENARIO_FILE);
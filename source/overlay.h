@@ -30,6 +30,8 @@ void doOverlayLogic();
 void loadOverlayGraphicsBG(int baseBg, int *offsetBg);
 void loadOverlayGraphicsSprites(int *offsetSp);
 void initOverlayWithScenario();
+// (re)builds the pool of overlay in use from their enabled flags, e.g. after a savegame was loaded
+void initOverlayPool();
 void initOverlay();
 
 struct Overlay *getOverlay();
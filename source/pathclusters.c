@@ -0,0 +1,397 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Hierarchical pathfinding: a graph of the entrances between clusters of tiles,
+// used to find out which way to go for destinations far away. The first leg of
+// the route found is then searched for on the tiles by Astar, the remainder is
+// searched for once the unit got there.
+//
+// The graph is kept for both tracked and non-tracked units. It does not take
+// other units into account; that is left to the search on the tiles.
+
+#include "pathclusters.h"
+#ifndef REMOVE_ASTAR_PATHFINDING
+
+#include <string.h>
+
+#include "shared.h"
+#include "debug.h"
+
+#define PATH_CLUSTER_TILES      (PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE)
+#define PATH_CLUSTER_UNREACHABLE 0xFF
+#define PATH_CLUSTER_NONE       0xFFFF
+#define MAX_PATH_CLUSTER_SEARCH_NODES (MAX_PATH_CLUSTERS * MAX_PATH_CLUSTER_NODES + 1) /* the last one being the goal */
+
+enum PathClusterBorder { PCB_UP, PCB_RIGHT, PCB_DOWN, PCB_LEFT };
+
+struct PathCluster {
+    u8 amountOfNodes;
+    u8 border[MAX_PATH_CLUSTER_NODES];   // enum PathClusterBorder the entrance is at
+    u16 tile[MAX_PATH_CLUSTER_NODES];
+    u16 peer[MAX_PATH_CLUSTER_NODES];    // the node on the other side of the entrance, or PATH_CLUSTER_NONE
+    u8 cost[MAX_PATH_CLUSTER_NODES][MAX_PATH_CLUSTER_NODES]; // real distance within the cluster, or PATH_CLUSTER_UNREACHABLE
+};
+
+static struct PathCluster pathCluster[2][MAX_PATH_CLUSTERS]; // for non-tracked and tracked units respectively
+static u8 pathClusterDirty[MAX_PATH_CLUSTERS];
+static int pathClusterAnyDirty;
+static int pathClustersWidth, pathClustersHeight;
+
+// distances within a single cluster, using buckets as no move costs more than DIAGONAL_REAL_DISTANCE
+static u8 distanceBucket[DIAGONAL_REAL_DISTANCE + 1][PATH_CLUSTER_TILES * 8];
+static int distanceBucketSize[DIAGONAL_REAL_DISTANCE + 1];
+
+// the search on the graph
+static u16 searchGScore[MAX_PATH_CLUSTER_SEARCH_NODES];
+static u16 searchFScore[MAX_PATH_CLUSTER_SEARCH_NODES];
+static u16 searchCameFrom[MAX_PATH_CLUSTER_SEARCH_NODES];
+static u8 searchStatus[MAX_PATH_CLUSTER_SEARCH_NODES]; // NS_NEW, NS_OPENSET or NS_CLOSEDSET
+static u16 searchHeap[MAX_PATH_CLUSTER_SEARCH_NODES];
+static u16 searchHeapPosition[MAX_PATH_CLUSTER_SEARCH_NODES];
+static int searchHeapSize;
+
+static const s8 clusterDirX[8] = { 0, +1, +1, +1, 0, -1, -1, -1 };
+static const s8 clusterDirY[8] = {-1, -1, 0, +1, +1, +1,  0, -1 };
+
+
+static inline int isPathClusterTileTraversable(int x, int y, int tracked) {
+    int traversability = environment.layout[TILE_FROM_XY(x,y)].traversability;
+    return (traversability == TRAVERSABLE || (!tracked && traversability == TRAVERSABLE_BY_NON_TRACKED));
+}
+
+static inline int getPathClusterOfTile(int tile) {
+    return (Y_FROM_TILE(tile) >> PATH_CLUSTER_SHIFT) * pathClustersWidth + (X_FROM_TILE(tile) >> PATH_CLUSTER_SHIFT);
+}
+
+static inline int getPathClusterLocalTile(int tile) {
+    return ((Y_FROM_TILE(tile) & (PATH_CLUSTER_SIZE - 1)) << PATH_CLUSTER_SHIFT) + (X_FROM_TILE(tile) & (PATH_CLUSTER_SIZE - 1));
+}
+
+
+// real distances from tile source to all tiles of the cluster it is in, only moving through that cluster.
+// the source itself need not be traversable, e.g. when it's a structure
+void getPathClusterDistances(int source, int tracked, int friendly, u8 *distance) {
+    int x1 = X_FROM_TILE(source) & ~(PATH_CLUSTER_SIZE - 1);
+    int y1 = Y_FROM_TILE(source) & ~(PATH_CLUSTER_SIZE - 1);
+    int x2 = min(x1 + PATH_CLUSTER_SIZE, environment.width);
+    int y2 = min(y1 + PATH_CLUSTER_SIZE, environment.height);
+    int current, remaining, bucket, newBucket;
+    int local, newDistance, x, y, newX, newY, newLocal;
+    int i;
+
+    memset(distance, PATH_CLUSTER_UNREACHABLE, PATH_CLUSTER_TILES);
+    memset(distanceBucketSize, 0, sizeof(distanceBucketSize));
+    local = getPathClusterLocalTile(source);
+    distance[local] = 0;
+    distanceBucket[0][distanceBucketSize[0]++] = local;
+    remaining = 1;
+
+    for (current=0; remaining > 0; current++) {
+        bucket = current % (DIAGONAL_REAL_DISTANCE + 1);
+        while (distanceBucketSize[bucket] > 0) {
+            local = distanceBucket[bucket][--distanceBucketSize[bucket]];
+            remaining--;
+            if (distance[local] != current)
+                continue; // reached more cheaply since it was added
+            x = x1 + (local & (PATH_CLUSTER_SIZE - 1));
+            y = y1 + (local >> PATH_CLUSTER_SHIFT);
+            for (i=0; i<8; i++) {
+                newX = x + clusterDirX[i];
+                newY = y + clusterDirY[i];
+                if (newX < x1 || newX >= x2 || newY < y1 || newY >= y2 || !isPathClusterTileTraversable(newX, newY, tracked))
+                    continue;
+                if (friendly && environment.layout[TILE_FROM_XY(newX, newY)].status == UNDISCOVERED)
+                    continue;
+                newDistance = current + ((i & 1) ? DIAGONAL_REAL_DISTANCE : HORIZVERT_REAL_DISTANCE);
+                newLocal = ((newY - y1) << PATH_CLUSTER_SHIFT) + (newX - x1);
+                if (newDistance >= distance[newLocal])
+                    continue;
+                distance[newLocal] = newDistance;
+                newBucket = newDistance % (DIAGONAL_REAL_DISTANCE + 1);
+                distanceBucket[newBucket][distanceBucketSize[newBucket]++] = newLocal;
+                remaining++;
+            }
+        }
+    }
+}
+
+// adds an entrance in the middle of every run of tiles along the border that can be crossed
+void addPathClusterBorderNodes(struct PathCluster *cluster, int clusterNr, enum PathClusterBorder border, int tracked) {
+    int x1 = (clusterNr % pathClustersWidth) << PATH_CLUSTER_SHIFT;
+    int y1 = (clusterNr / pathClustersWidth) << PATH_CLUSTER_SHIFT;
+    int x, y, otherX, otherY, stepX, stepY, length;
+    int runStart = -1;
+    int i;
+
+    switch (border) {
+        case PCB_UP:
+            if (y1 == 0) return;
+            x = x1; y = y1; stepX = 1; stepY = 0; otherX = 0; otherY = -1;
+            length = min(PATH_CLUSTER_SIZE, environment.width - x1);
+            break;
+        case PCB_RIGHT:
+            if (x1 + PATH_CLUSTER_SIZE >= environment.width) return;
+            x = x1 + PATH_CLUSTER_SIZE - 1; y = y1; stepX = 0; stepY = 1; otherX = 1; otherY = 0;
+            length = min(PATH_CLUSTER_SIZE, environment.height - y1);
+            break;
+        case PCB_DOWN:
+            if (y1 + PATH_CLUSTER_SIZE >= environment.height) return;
+            x = x1; y = y1 + PATH_CLUSTER_SIZE - 1; stepX = 1; stepY = 0; otherX = 0; otherY = 1;
+            length = min(PATH_CLUSTER_SIZE, environment.width - x1);
+            break;
+        case PCB_LEFT:
+        default:
+            if (x1 == 0) return;
+            x = x1; y = y1; stepX = 0; stepY = 1; otherX = -1; otherY = 0;
+            length = min(PATH_CLUSTER_SIZE, environment.height - y1);
+            break;
+    }
+
+    for (i=0; i<=length; i++) {
+        if (i < length && isPathClusterTileTraversable(x + i*stepX, y + i*stepY, tracked) &&
+                          isPathClusterTileTraversable(x + i*stepX + otherX, y + i*stepY + otherY, tracked)) {
+            if (runStart < 0)
+                runStart = i;
+            continue;
+        }
+        if (runStart >= 0 && cluster->amountOfNodes < MAX_PATH_CLUSTER_NODES) {
+            cluster->border[cluster->amountOfNodes] = border;
+            cluster->tile[cluster->amountOfNodes] = TILE_FROM_XY(x + ((runStart + i - 1) / 2) * stepX, y + ((runStart + i - 1) / 2) * stepY);
+            cluster->amountOfNodes++;
+        }
+        runStart = -1;
+    }
+}
+
+void buildPathCluster(int clusterNr, int tracked) {
+    struct PathCluster *cluster = &pathCluster[tracked][clusterNr];
+    u8 distance[PATH_CLUSTER_TILES];
+    int i, j;
+
+    cluster->amountOfNodes = 0;
+    addPathClusterBorderNodes(cluster, clusterNr, PCB_UP, tracked);
+    addPathClusterBorderNodes(cluster, clusterNr, PCB_RIGHT, tracked);
+    addPathClusterBorderNodes(cluster, clusterNr, PCB_DOWN, tracked);
+    addPathClusterBorderNodes(cluster, clusterNr, PCB_LEFT, tracked);
+
+    for (i=0; i<cluster->amountOfNodes; i++) {
+        getPathClusterDistances(cluster->tile[i], tracked, 0, distance);
+        for (j=0; j<cluster->amountOfNodes; j++)
+            cluster->cost[i][j] = distance[getPathClusterLocalTile(cluster->tile[j])];
+    }
+}
+
+void linkPathClusters(int tracked) {
+    struct PathCluster *cluster, *other;
+    int clusterNr, otherNr, otherTile;
+    int i, j;
+
+    for (clusterNr=0; clusterNr<pathClustersWidth*pathClustersHeight; clusterNr++) {
+        cluster = &pathCluster[tracked][clusterNr];
+        for (i=0; i<cluster->amountOfNodes; i++) {
+            switch (cluster->border[i]) {
+                case PCB_UP:
+                    otherNr = clusterNr - pathClustersWidth;
+                    otherTile = cluster->tile[i] - environment.width;
+                    break;
+                case PCB_RIGHT:
+                    otherNr = clusterNr + 1;
+                    otherTile = cluster->tile[i] + 1;
+                    break;
+                case PCB_DOWN:
+                    otherNr = clusterNr + pathClustersWidth;
+                    otherTile = cluster->tile[i] + environment.width;
+                    break;
+                case PCB_LEFT:
+                default:
+                    otherNr = clusterNr - 1;
+                    otherTile = cluster->tile[i] - 1;
+                    break;
+            }
+            other = &pathCluster[tracked][otherNr];
+            cluster->peer[i] = PATH_CLUSTER_NONE;
+            for (j=0; j<other->amountOfNodes; j++) {
+                if (other->tile[j] == otherTile && other->border[j] == ((cluster->border[i] + 2) % 4)) {
+                    cluster->peer[i] = otherNr * MAX_PATH_CLUSTER_NODES + j;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+
+void initPathClustersWithScenario() {
+    pathClustersWidth  = (environment.width  + PATH_CLUSTER_SIZE - 1) >> PATH_CLUSTER_SHIFT;
+    pathClustersHeight = (environment.height + PATH_CLUSTER_SIZE - 1) >> PATH_CLUSTER_SHIFT;
+    #ifdef DEBUG_BUILD
+    if (pathClustersWidth * pathClustersHeight > MAX_PATH_CLUSTERS) errorSI("Too many path clusters for map. Limit is:", MAX_PATH_CLUSTERS);
+    #endif
+    invalidatePathClusters(0, 0, environment.width, environment.height);
+}
+
+void invalidatePathClusters(int x, int y, int width, int height) {
+    int x1, y1, x2, y2;
+    int i, j;
+
+    // entrances are shared with neighbouring clusters, so these need to be rebuilt as well
+    x1 = max(0, (x >> PATH_CLUSTER_SHIFT) - 1);
+    y1 = max(0, (y >> PATH_CLUSTER_SHIFT) - 1);
+    x2 = min(pathClustersWidth  - 1, ((x + width  - 1) >> PATH_CLUSTER_SHIFT) + 1);
+    y2 = min(pathClustersHeight - 1, ((y + height - 1) >> PATH_CLUSTER_SHIFT) + 1);
+    for (i=y1; i<=y2; i++) {
+        for (j=x1; j<=x2; j++)
+            pathClusterDirty[i * pathClustersWidth + j] = 1;
+    }
+    pathClusterAnyDirty = 1;
+}
+
+void updatePathClusters() {
+    int i;
+
+    if (!pathClusterAnyDirty)
+        return;
+    for (i=0; i<pathClustersWidth*pathClustersHeight; i++) {
+        if (pathClusterDirty[i]) {
+            buildPathCluster(i, 0);
+            buildPathCluster(i, 1);
+            pathClusterDirty[i] = 0;
+        }
+    }
+    // the nodes of the rebuilt clusters were renumbered
+    linkPathClusters(0);
+    linkPathClusters(1);
+    pathClusterAnyDirty = 0;
+}
+
+
+void pushPathClusterSearchHeap(int node) {
+    int position, parent;
+
+    if (searchStatus[node] != NS_OPENSET) {
+        searchStatus[node] = NS_OPENSET;
+        position = searchHeapSize++;
+    } else
+        position = searchHeapPosition[node];
+    // sift up
+    while (position > 0) {
+        parent = (position - 1) / 2;
+        if (searchFScore[searchHeap[parent]] <= searchFScore[node])
+            break;
+        searchHeap[position] = searchHeap[parent];
+        searchHeapPosition[searchHeap[position]] = position;
+        position = parent;
+    }
+    searchHeap[position] = node;
+    searchHeapPosition[node] = position;
+}
+
+int popPathClusterSearchHeap() {
+    int first = searchHeap[0];
+    int last = searchHeap[--searchHeapSize];
+    int position = 0, child;
+
+    // sift down
+    while ((child = 2 * position + 1) < searchHeapSize) {
+        if (child + 1 < searchHeapSize && searchFScore[searchHeap[child + 1]] < searchFScore[searchHeap[child]])
+            child++;
+        if (searchFScore[last] <= searchFScore[searchHeap[child]])
+            break;
+        searchHeap[position] = searchHeap[child];
+        searchHeapPosition[searchHeap[position]] = position;
+        position = child;
+    }
+    searchHeap[position] = last;
+    searchHeapPosition[last] = position;
+    searchStatus[first] = NS_CLOSEDSET;
+    return first;
+}
+
+void relaxPathClusterSearchNode(int node, int gScore, int cameFrom, int hScore) {
+    if (searchStatus[node] == NS_CLOSEDSET || (searchStatus[node] == NS_OPENSET && gScore >= searchGScore[node]))
+        return;
+    searchGScore[node] = gScore;
+    searchFScore[node] = gScore + hScore;
+    searchCameFrom[node] = cameFrom;
+    pushPathClusterSearchHeap(node);
+}
+
+int getPathClusterWaypoint(int start, int goal, struct Unit *curUnit, struct UnitInfo *curUnitInfo) {
+    struct PathCluster *clusters, *cluster;
+    u8 startDistance[PATH_CLUSTER_TILES];
+    u8 goalDistance[PATH_CLUSTER_TILES];
+    int tracked = (curUnitInfo->type == UT_TRACKED);
+    int friendly = (curUnit->side == FRIENDLY);
+    int goalNode = MAX_PATH_CLUSTER_SEARCH_NODES - 1;
+    int startCluster, goalCluster, clusterNr, node, other, tile;
+    int waypoint, length;
+    int i;
+
+    if (Astar_heuristicDistance(start, goal) <= PATH_CLUSTER_MIN_DISTANCE || pathClusterAnyDirty)
+        return -1;
+
+    clusters = pathCluster[tracked];
+    startCluster = getPathClusterOfTile(start);
+    goalCluster = getPathClusterOfTile(goal);
+    getPathClusterDistances(start, tracked, friendly, startDistance);
+    getPathClusterDistances(goal, tracked, friendly, goalDistance);
+
+    memset(searchStatus, NS_NEW, sizeof(searchStatus));
+    searchHeapSize = 0;
+    cluster = &clusters[startCluster];
+    for (i=0; i<cluster->amountOfNodes; i++) {
+        if (startDistance[getPathClusterLocalTile(cluster->tile[i])] != PATH_CLUSTER_UNREACHABLE)
+            relaxPathClusterSearchNode(startCluster * MAX_PATH_CLUSTER_NODES + i, startDistance[getPathClusterLocalTile(cluster->tile[i])],
+                                       PATH_CLUSTER_NONE, Astar_heuristicDistance(cluster->tile[i], goal));
+    }
+
+    while (searchHeapSize > 0) {
+        node = popPathClusterSearchHeap();
+        if (node == goalNode)
+            break;
+        clusterNr = node / MAX_PATH_CLUSTER_NODES;
+        cluster = &clusters[clusterNr];
+        i = node % MAX_PATH_CLUSTER_NODES;
+        tile = cluster->tile[i];
+
+        if (clusterNr == goalCluster && goalDistance[getPathClusterLocalTile(tile)] != PATH_CLUSTER_UNREACHABLE)
+            relaxPathClusterSearchNode(goalNode, searchGScore[node] + goalDistance[getPathClusterLocalTile(tile)], node, 0);
+        // through the cluster
+        for (other=0; other<cluster->amountOfNodes; other++) {
+            if (cluster->cost[i][other] == PATH_CLUSTER_UNREACHABLE || other == i)
+                continue;
+            if (friendly && environment.layout[cluster->tile[other]].status == UNDISCOVERED)
+                continue;
+            relaxPathClusterSearchNode(clusterNr * MAX_PATH_CLUSTER_NODES + other, searchGScore[node] + cluster->cost[i][other],
+                                       node, Astar_heuristicDistance(cluster->tile[other], goal));
+        }
+        // into the neighbouring cluster
+        other = cluster->peer[i];
+        if (other != PATH_CLUSTER_NONE) {
+            tile = clusters[other / MAX_PATH_CLUSTER_NODES].tile[other % MAX_PATH_CLUSTER_NODES];
+            if (!friendly || environment.layout[tile].status != UNDISCOVERED)
+                relaxPathClusterSearchNode(other, searchGScore[node] + HORIZVERT_REAL_DISTANCE, node, Astar_heuristicDistance(tile, goal));
+        }
+    }
+    if (searchStatus[goalNode] != NS_CLOSEDSET)
+        return -1;
+
+    // the route from start to goal, in reverse
+    length = 0;
+    for (node=searchCameFrom[goalNode]; node!=PATH_CLUSTER_NONE; node=searchCameFrom[node])
+        searchHeap[length++] = node;
+
+    // the furthest entrance the first leg reaches without leaving the leg's distance, though at least one
+    waypoint = -1;
+    for (i=length-1; i>=0; i--) {
+        tile = clusters[searchHeap[i] / MAX_PATH_CLUSTER_NODES].tile[searchHeap[i] % MAX_PATH_CLUSTER_NODES];
+        if (tile == start)
+            continue;
+        if (waypoint >= 0 && Astar_heuristicDistance(start, tile) > PATH_CLUSTER_LEG_DISTANCE)
+            break;
+        waypoint = tile;
+    }
+    return waypoint;
+}
+
+#endif
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _PATHCLUSTERS_H_
+#define _PATHCLUSTERS_H_
+
+#include "pathfinding.h"
+#ifndef REMOVE_ASTAR_PATHFINDING
+
+#include "environment.h"
+#include "units.h"
+
+// the map is divided into clusters of PATH_CLUSTER_SIZE x PATH_CLUSTER_SIZE tiles. the entrances between
+// neighbouring clusters, and the distances between the entrances within each cluster, form a graph that is
+// small enough to be searched in full. long-range path searches are answered on that graph first, after
+// which only the first leg towards the destination needs to be searched for on the tiles themselves.
+#define PATH_CLUSTER_SHIFT          3
+#define PATH_CLUSTER_SIZE           (1 << PATH_CLUSTER_SHIFT)
+#define MAX_PATH_CLUSTERS           (MAX_TILES_ENVIRONMENT / (PATH_CLUSTER_SIZE * PATH_CLUSTER_SIZE))
+#define MAX_PATH_CLUSTER_NODES      12 /* entrances per cluster. any more are not used */
+
+#define PATH_CLUSTER_MIN_DISTANCE   (24 * HORIZVERT_HEUR_DISTANCE) /* searches to destinations this far away or nearer do not use clusters */
+#define PATH_CLUSTER_LEG_DISTANCE   (16 * HORIZVERT_HEUR_DISTANCE) /* how far ahead the first leg of a long-range path reaches */
+
+void initPathClustersWithScenario();
+
+// to be called whenever the traversability of tiles in the given area changed
+void invalidatePathClusters(int x, int y, int width, int height);
+// rebuilds the clusters that were invalidated. not to be called while traversability is temporarily altered
+void updatePathClusters();
+
+// returns the tile the unit should head for first on its way from start to goal, or -1 if start and goal
+// are near enough to each other (or no route is known) for a search on the tiles themselves to be used
+int getPathClusterWaypoint(int start, int goal, struct Unit *curUnit, struct UnitInfo *curUnitInfo);
+
+#endif
+#endif
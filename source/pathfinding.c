@@ -12,8 +12,16 @@
 #include "factions.h"
 #include "structures.h"
 #include "units.h"
+#include "projectiles.h"
+#include "pathclusters.h"
+#include "pathregions.h"
+#include "flowfields.h"
+#include "firingpositions.h"
+#include "avoidance.h"
+#include "bitboards.h"
 #include "profiling.h"
 #include "gameticks.h"
+#include "replay.h"
 #include "shared.h"
 #include "debug.h"
 #include "profiling.h"
@@ -23,57 +31,121 @@
 #define MAX_QUEUED_TIME        (FPS/2) // in logic frames. currently half a second.
 #define ADDITIONAL_FRAME_ALLOWED_DELAY   (FPS/4) // in logic frames. currently four times a second.
 
-#define MAX_PATHFINDING_PATHS  (MAX_UNITS_ON_MAP)  /* MAX_UNITS_ON_MAP is the max ever required (== +- 6.5 kb) */
-#define THRESHHOLD_TRAVERSABILITY_CHECK    50      // this is no longer related to GSCORE
 
 #define PATHFINDING_REQUEUE_TIMER   2
 
 #define THRESHHOLD_DANCE_DISTANCE   (DIAGONAL_REAL_DISTANCE*2)
 #define THRESHHOLD_SETTLE_DISTANCE  (DIAGONAL_REAL_DISTANCE*3)
 
-struct Path pathfindingPath[MAX_PATHFINDING_PATHS];
-
-struct Path *astarProcessingPath;
+#define MAX_PATH_CACHE_ENTRIES      16
+#define PATH_CACHE_CELL_SHIFT       3                             /* paths are shared by units starting within the same cell of 8x8 tiles */
+#define PATH_CACHE_MIN_DISTANCE     (8*HORIZVERT_HEUR_DISTANCE)   /* searches to destinations this near are not worth caching */
+#define PATH_CACHE_MAX_JOIN_LENGTH  (2 << PATH_CACHE_CELL_SHIFT)  /* in tiles. how far a unit may need to go to get onto a cached path */
+
+struct PathCacheEntry {
+    unsigned int version;       // the traversabilityVersion the path was found in. outdated entries aren't used
+    unsigned int lastUsed;
+    unsigned short int startCell;
+    unsigned short int dest;
+    unsigned short int shootRange;
+    enum UnitType type;
+    bool friendly;
+    bool attack;
+    unsigned short int tile[PATHBUFFERLEN];
+    unsigned short int size;
+};
+
+struct PathfindingPaths {
+    struct Path path[MAX_PATHFINDING_PATHS];
+    unsigned short int node[MAX_PATH_NODES]; // the nodes of the paths. those of each path are consecutive
+    unsigned short int nodesUsed;            // the nodes from here onwards are free
+};
+
+struct PathfindingPaths pathfindingPaths;
+struct Path *const pathfindingPath = pathfindingPaths.path;
+bool pathfindingPathCacheable[MAX_PATHFINDING_PATHS]; // false for searches to get around units, which cached paths don't consider
+
+struct PathCacheEntry pathCache[MAX_PATH_CACHE_ENTRIES];
+unsigned int pathCacheTime;
+unsigned int traversabilityVersion;
+
+// the searches underway, by their Astar job. a path has at most one of them
+struct PathfindingSearch {
+    struct Path *path;      // 0 when the job is free
+    bool cacheable;         // whether the search is towards the destination itself
+    const u32 *firingPositions;
+};
+struct PathfindingSearch pathfindingSearch[ASTAR_SEARCHES];
+s8 pathfindingPathJob[MAX_PATHFINDING_PATHS];      // the job searching for a path, or -1
+int pathfindingGoalStructure[MAX_UNITS_ON_MAP];   // the destination structure a unit's search may enter, or -1
 
 unsigned maxGameticksSearch;
 unsigned additionalFrameAllowedDelay;
+int searchExtensions; // the number of times maxGameticksSearch was increased, i.e. pathfinding had to run into another frame
+
+// how far the searches got in a frame depends on time, which a replay can't reproduce. the frames time ran out in are
+// recorded instead, with the times the searches were allowed to continue before that
+unsigned int searchContinuations;  // this frame
+bool searchCutShort;               // this frame
+int searchBudget = -1;             // in replay playback, the times the searches may continue this frame. -1 for no limit
 
 // ********************************************************************************************
 // the callback functions:
 
-unsigned int mapCanBeTraversed_callback (unsigned int node, unsigned int g_score, void *cur_unit, void *cur_unitinfo) {
-    if (((struct Unit *)cur_unit)->side == FRIENDLY && environment.layout[node].status == UNDISCOVERED)
-        return (0);
-
-    // map traversable?
-    if (environment.layout[node].traversability == TRAVERSABLE) {
-        return (g_score > THRESHHOLD_TRAVERSABILITY_CHECK ||           
-                !isTileBlockedByOtherUnit((struct Unit *) cur_unit, node));
-    }
+// whether the tile is one of the given structure's. searches don't change the map, so they may run side by side;
+// the destination structure a search may enter is instead checked for here
+static inline int isGoalStructureTile(int goalStructureNr, unsigned int node) {
+    int structureNr;
+    
+    if (goalStructureNr == -1)
+        return 0;
+    structureNr = environment.layout[node].contains_structure;
+    if (structureNr < -1)
+        structureNr = environment.layout[node + (structureNr + 1)].contains_structure;
+    return (structureNr == goalStructureNr);
+}
 
-    // map is not empty
-    if (environment.layout[node].traversability == UNTRAVERSABLE)
+unsigned int mapCanBeTraversed_callback (unsigned int node, unsigned int g_score, void *cur_unit, void *cur_unitinfo) {
+    // map traversable by this type of unit?
+    if (!IS_TILE_BIT_SET((((struct UnitInfo *)cur_unitinfo)->type == UT_TRACKED) ? TB_TRAVERSABLE_BY_TRACKED : TB_TRAVERSABLE_BY_NON_TRACKED, node) &&
+        !isGoalStructureTile(pathfindingGoalStructure[(struct Unit *)cur_unit - unit], node))
         return (0);
 
-    // map is definitely of a type only traversable by non-tracked vehicles
-    if (((struct UnitInfo *)cur_unitinfo)->type == UT_TRACKED)
+    if (((struct Unit *)cur_unit)->side == FRIENDLY && IS_TILE_BIT_SET(TB_UNDISCOVERED, node))
         return (0);
 
-    // unit type is able to traverse aforementioned terrain type
-    return (g_score > THRESHHOLD_TRAVERSABILITY_CHECK ||
+    // only a tile other units are on, or are moving onto, may block the unit
+    return (g_score > THRESHHOLD_TRAVERSABILITY_CHECK || !IS_TILE_BIT_SET(TB_OCCUPIED, node) ||
             !isTileBlockedByOtherUnit((struct Unit *) cur_unit, node));
 }
 
+// may be called while searches are run side by side, so the lines of fire remembered by the logic are left alone
 unsigned int canHitTarget_callback (unsigned int start, unsigned int goal, void *cur_unit, void *cur_unitinfo) {
-    return withinShootRange(X_FROM_TILE(start), Y_FROM_TILE(start),            // start x,y 
-                            ((struct UnitInfo*)cur_unitinfo)->shoot_range,     // shoot range
-                            ((struct UnitInfo*)cur_unitinfo)->projectile_info, // projectile info
-                            X_FROM_TILE(goal), Y_FROM_TILE(goal));             // goal x,y
+    return withinRange(X_FROM_TILE(start), Y_FROM_TILE(start),                          // start x,y 
+                       ((struct UnitInfo*)cur_unitinfo)->shoot_range,                  // shoot range
+                       X_FROM_TILE(goal), Y_FROM_TILE(goal)) &&                         // goal x,y
+           isClearPathProjectile(X_FROM_TILE(start), Y_FROM_TILE(start),                // start x,y
+                                 ((struct UnitInfo*)cur_unitinfo)->projectile_info,     // projectile info
+                                 X_FROM_TILE(goal), Y_FROM_TILE(goal));                 // goal x,y
 }
 
 unsigned int canContinueSearch_callback(void) {
-    unsigned gameticks = getGameticks();
-    return ((gameticks != 0) && (gameticks < maxGameticksSearch));
+    unsigned gameticks;
+    
+    if (getReplayMode() == RM_PLAYBACK) {
+        if (searchBudget == 0)
+            return 0;
+        if (searchBudget > 0)
+            searchBudget--;
+        return 1;
+    }
+    gameticks = getGameticks();
+    if ((gameticks != 0) && (gameticks < maxGameticksSearch)) {
+        searchContinuations++;
+        return 1;
+    }
+    searchCutShort = true;
+    return 0;
 }
 
 // ********************************************************************************************
@@ -84,18 +156,154 @@ void initPathfinding() {
     Astar_callback(&mapCanBeTraversed_callback,
                    &canHitTarget_callback,
                    &canContinueSearch_callback);
+    #ifdef PATHFINDING_JUMP_POINTS
+    Astar_jumpPointSearch(true, THRESHHOLD_TRAVERSABILITY_CHECK);
+    #else
+    Astar_jumpPointSearch(false, THRESHHOLD_TRAVERSABILITY_CHECK);
+    #endif
 }
 
 void initPathfindingWithScenario() {
     int i;
     
     Astar_config(environment.width, environment.height);
-    astarProcessingPath = 0;
     
-    for (i=0; i<MAX_PATHFINDING_PATHS; i++)
+    for (i=0; i<MAX_PATHFINDING_PATHS; i++) {
         pathfindingPath[i].unit_nr = -1;
+        pathfindingPath[i].stored = 0;
+    }
+    cancelPathfindingSearches();
+    pathfindingPaths.nodesUsed = 0;
+    
+    for (i=0; i<MAX_PATH_CACHE_ENTRIES; i++)
+        pathCache[i].version = 0;
+    pathCacheTime = 0;
+    traversabilityVersion = 1;
     
     additionalFrameAllowedDelay = ADDITIONAL_FRAME_ALLOWED_DELAY;
+    searchExtensions = 0;
+    
+    initPathClustersWithScenario();
+    initPathRegionsWithScenario();
+    initFlowFieldsWithScenario();
+    initFiringPositionsWithScenario();
+    initAvoidanceWithScenario();
+}
+
+// the nodes of a path are only in use while it isn't queued. those of the last path in the pool are reclaimed right away
+void releasePathNodes(struct Path *path) {
+    if (path->stored > 0 && path->first + path->stored == pathfindingPaths.nodesUsed)
+        pathfindingPaths.nodesUsed = path->first;
+    path->stored = 0;
+}
+
+// moves the nodes of all paths to the start of the pool, in the order they are in, leaving the free nodes at its end
+void compactPathNodes() {
+    struct Path *next;
+    int used = 0;
+    int i;
+    
+    do {
+        next = 0;
+        for (i=0; i<MAX_PATHFINDING_PATHS; i++) {
+            if (pathfindingPath[i].stored > 0 && pathfindingPath[i].first >= used && (!next || pathfindingPath[i].first < next->first))
+                next = pathfindingPath + i;
+        }
+        if (next) {
+            memmove(pathfindingPaths.node + used, pathfindingPaths.node + next->first, next->stored * sizeof(pathfindingPaths.node[0]));
+            next->first = used;
+            used += next->stored;
+        }
+    } while (next);
+    pathfindingPaths.nodesUsed = used;
+}
+
+// takes nodes from the pool for the given path. it gets fewer than requested if the pool runs out
+void allocatePathNodes(struct Path *path, int amount) {
+    releasePathNodes(path);
+    if (pathfindingPaths.nodesUsed + amount > MAX_PATH_NODES)
+        compactPathNodes();
+    path->first  = pathfindingPaths.nodesUsed;
+    path->stored = min(amount, MAX_PATH_NODES - pathfindingPaths.nodesUsed);
+    pathfindingPaths.nodesUsed += path->stored;
+}
+
+
+// the searches underway are for paths no longer there when a scenario or savegame was loaded
+void cancelPathfindingSearches() {
+    int i;
+    
+    for (i=0; i<ASTAR_SEARCHES; i++) {
+        if (pathfindingSearch[i].path)
+            Astar_releaseJob(i);
+        pathfindingSearch[i].path = 0;
+        pathfindingSearch[i].firingPositions = 0;
+    }
+    for (i=0; i<MAX_PATHFINDING_PATHS; i++)
+        pathfindingPathJob[i] = -1;
+    for (i=0; i<MAX_UNITS_ON_MAP; i++)
+        pathfindingGoalStructure[i] = -1;
+}
+
+// submits a search for the path as an Astar job. there must be a job free
+void submitPathfindingSearch(struct Path *path, unsigned int goal, bool attack, unsigned int cruise_range, bool cacheable, int goalStructureNr) {
+    struct Unit *cur_unit = unit + path->unit_nr;
+    const u32 *firingPositions = attack ? getFiringPositions(goal, path->size, cur_unit, unitInfo + cur_unit->info) : 0;
+    int job;
+    
+    job = Astar_submitJob(path->offset, goal, cur_unit->unit_positioned, attack, attack ? path->size : 0,
+                          firingPositions, cruise_range, cur_unit, unitInfo + cur_unit->info);
+    #ifdef DEBUG_BUILD
+    if (job < 0) errorSI("job@submitPathfindingSearch", job);
+    #endif
+    pathfindingSearch[job].path            = path;
+    pathfindingSearch[job].cacheable       = cacheable;
+    pathfindingSearch[job].firingPositions = firingPositions;
+    pathfindingPathJob[path - pathfindingPath] = job;
+    pathfindingGoalStructure[path->unit_nr]    = goalStructureNr;
+}
+
+void endPathfindingSearch(int job) {
+    struct Path *path = pathfindingSearch[job].path;
+    
+    Astar_releaseJob(job);
+    if (pathfindingSearch[job].firingPositions)
+        releaseFiringPositions(pathfindingSearch[job].firingPositions);
+    pathfindingPathJob[path - pathfindingPath] = -1;
+    pathfindingGoalStructure[path->unit_nr]    = -1;
+    pathfindingSearch[job].path = 0;
+}
+
+// whether the searches are run as on the DS: a single job at a time, continued for as long as time within the frame
+// allows. searches run on threads are instead handed out all at once and run to completion however long they take,
+// so that the paths found don't depend on the time they took. a replay is played back the way it was recorded though,
+// as searches handed out one after the other may take up the paths stored by the one before
+static inline int areSearchesRunInTurn() {
+    #ifdef ASTAR_THREADS
+    return (getReplayMode() == RM_PLAYBACK);
+    #else
+    return 1;
+    #endif
+}
+
+int isPathfindingJobFree() {
+    int i;
+    
+    for (i=0; i<(areSearchesRunInTurn() ? 1 : ASTAR_SEARCHES); i++) {
+        if (!pathfindingSearch[i].path)
+            return 1;
+    }
+    return 0;
+}
+
+int isPathfindingSearchUnderway() {
+    int i;
+    
+    for (i=0; i<ASTAR_SEARCHES; i++) {
+        if (pathfindingSearch[i].path)
+            return 1;
+    }
+    return 0;
 }
 
 struct Path *getQueuedPathfindingPathSearch() {
@@ -105,8 +313,9 @@ struct Path *getQueuedPathfindingPathSearch() {
     int i;
     
     for (i=0; i<MAX_PATHFINDING_PATHS; i++) {
-        if (pathfindingPath[i].unit_nr != -1 && pathfindingPath[i].queue != PQ_UNQUEUED
-            && ((!chosen) || 
+        // paths waiting for their delay timer to run out aren't searched for yet
+        if (pathfindingPath[i].unit_nr != -1 && pathfindingPath[i].queue != PQ_UNQUEUED && pathfindingPath[i].queue < PQ_QUEUED
+            && pathfindingPathJob[i] == -1 && ((!chosen) || 
                 (pathfindingPath[i].queue < queueMin) ||
                 (pathfindingPath[i].queue == queueMin && pathfindingPath[i].queuedTime < queuedTimeMin))) {
             chosen = pathfindingPath + i;
@@ -119,7 +328,7 @@ struct Path *getQueuedPathfindingPathSearch() {
 }
 
 
-void queuePathfindingPathSearch(int unit_nr, int curX, int curY, bool attack, int shoot_range, int newX, int newY, bool priority) {
+void queuePathfindingPathSearch(int unit_nr, int curX, int curY, bool attack, int shoot_range, int newX, int newY, bool priority, bool cacheable) {
     int i;
     struct Path *path = 0;
 
@@ -136,12 +345,15 @@ void queuePathfindingPathSearch(int unit_nr, int curX, int curY, bool attack, in
         return;
    
     path->unit_nr = unit_nr;
+    path->stored  = 0;
     path->queue   = priority?PQ_HIGHPRIORITY:PQ_NORMALPRIORITY;
     path->dest    = TILE_FROM_XY(newX, newY);
     path->attack  = attack;
+    path->partial = false;
     path->size    = shoot_range;
     path->offset  = TILE_FROM_XY(curX, curY);
     path->queuedTime = 0;
+    pathfindingPathCacheable[path - pathfindingPath] = cacheable;
     
     #ifdef DEBUG_BUILD
     if (path->dest < 0 || path->dest >= environment.width * environment.height) errorSI("dest@queuePathfindingPathSearch", path->dest);
@@ -150,22 +362,52 @@ void queuePathfindingPathSearch(int unit_nr, int curX, int curY, bool attack, in
 }
 
 enum UnitMove obtainNextMove(struct Path *path, int cur_tile) {
-    if (path->tile[path->offset] == cur_tile) {
+    unsigned short int *node = pathfindingPaths.node + path->first;
+    
+    // the pool of path nodes could not hold the remainder of the path
+    if (path->offset >= path->stored)
+        return UM_MOVE_HOLD;
+    
+    if (node[path->offset] == cur_tile) {
         path->offset++;
         if (path->offset >= path->size)
-            return (!path->attack && cur_tile != path->dest) ?
+            return (path->partial || (!path->attack && cur_tile != path->dest)) ?
                     UM_MOVE_HOLD :
                     UM_NONE;
-        if (path->offset >= PATHBUFFERLEN)
+        if (path->offset >= path->stored)
             return UM_MOVE_HOLD;
     }
     
-    int dest_tile = path->tile[path->offset];
+    int dest_tile = node[path->offset];
     
     return UM_MOVE_UP + (int) positionedToFaceXY(X_FROM_TILE(cur_tile), Y_FROM_TILE(cur_tile),
                                                  X_FROM_TILE(dest_tile), Y_FROM_TILE(dest_tile));
 }
 
+int getPathfindingNextTile(int unit_nr) {
+    struct Unit *cur_unit = unit + unit_nr;
+    struct Path *path;
+    unsigned short int *node;
+    int offset;
+    int i;
+    
+    for (i=0; i<MAX_PATHFINDING_PATHS; i++) {
+        path = pathfindingPath + i;
+        if (path->unit_nr != unit_nr || path->queue != PQ_UNQUEUED)
+            continue;
+        // as obtainNextMove would, without changing the path
+        node = pathfindingPaths.node + path->first;
+        offset = path->offset;
+        if (offset < path->stored && node[offset] == TILE_FROM_XY(cur_unit->x, cur_unit->y))
+            offset++;
+        if (offset >= path->size || offset >= path->stored)
+            return -1;
+        return getNextTile(cur_unit->x, cur_unit->y, UM_MOVE_UP + (int) positionedToFaceXY(cur_unit->x, cur_unit->y,
+                                                                                           X_FROM_TILE(node[offset]), Y_FROM_TILE(node[offset])));
+    }
+    return -1;
+}
+
 struct Path *locatePathfindingPath(int unit_nr, bool attack, int dest) {
     int i;
     
@@ -179,13 +421,52 @@ struct Path *locatePathfindingPath(int unit_nr, bool attack, int dest) {
     return 0;
 }
 
+// whether units going to dest can be sent there using a flow field. one only reaches the tile itself, so
+// units needing to enter a structure (like a refinery or repair facility) have their paths searched for
+int isFlowFieldDestination(int dest, bool attack) {
+    int structureNr = environment.layout[dest].contains_structure;
+    return (attack || (structureNr >= -1 && structureNr < MAX_DIFFERENT_FACTIONS));
+}
+
+enum UnitMove followFlowField(int field, int unit_nr, int curX, int curY, bool attack, int shoot_range, int newX, int newY) {
+    struct Unit *cur_unit = unit + unit_nr;
+    int cur_tile = TILE_FROM_XY(curX, curY);
+    enum UnitMove move;
+    
+    if (attack ? canHitTarget_callback(cur_tile, TILE_FROM_XY(newX, newY), cur_unit, unitInfo + cur_unit->info) :
+                 (cur_tile == TILE_FROM_XY(newX, newY))) {
+        leaveFlowField(unit_nr, false);
+        return UM_NONE;
+    }
+    
+    move = getFlowFieldMove(field, unit_nr, cur_tile);
+    if (move == UM_MOVE_HOLD && !waitOnFlowField(unit_nr)) {
+        // other units keep blocking the way. have a path around them searched for instead
+        leaveFlowField(unit_nr, true);
+        queuePathfindingPathSearch(unit_nr, curX, curY, attack, shoot_range, newX, newY, true, false);
+    }
+    return move;
+}
+
 enum UnitMove searchPathfindingPath(int unit_nr, int curX, int curY, bool attack, int shoot_range, int newX, int newY, bool priority) {
+    int field = getUnitFlowField(unit_nr, attack, TILE_FROM_XY(newX, newY));
+    if (field >= 0)
+        return followFlowField(field, unit_nr, curX, curY, attack, shoot_range, newX, newY);
+    
     struct Path *path = locatePathfindingPath(unit_nr, attack, TILE_FROM_XY(newX, newY));
     if (!path) {
         #ifdef DEBUG_BUILD
         if (TILE_FROM_XY(newX, newY) < 0 || TILE_FROM_XY(newX, newY) >= environment.width * environment.height) errorSI("dest@searchPathfindingPath-1", TILE_FROM_XY(newX, newY));
         #endif
-        queuePathfindingPathSearch(unit_nr, curX, curY, attack, shoot_range, newX, newY, priority); // add to queue for searching new path
+        // join the units already on their way there, if any
+        field = getFlowField(TILE_FROM_XY(newX, newY), unit + unit_nr, unitInfo + unit[unit_nr].info);
+        if (field >= 0 && isFlowFieldDestination(TILE_FROM_XY(newX, newY), attack) &&
+            canUnitUseFlowField(unit_nr, TILE_FROM_XY(newX, newY)) && isFlowFieldReachable(field, TILE_FROM_XY(curX, curY))) {
+            removePathfindingPath(unit_nr);
+            joinFlowField(unit_nr, field, attack);
+            return followFlowField(field, unit_nr, curX, curY, attack, shoot_range, newX, newY);
+        }
+        queuePathfindingPathSearch(unit_nr, curX, curY, attack, shoot_range, newX, newY, priority, true); // add to queue for searching new path
         return UM_MOVE_HOLD_INITIAL;
     }
     
@@ -196,7 +477,7 @@ enum UnitMove searchPathfindingPath(int unit_nr, int curX, int curY, bool attack
             #ifdef DEBUG_BUILD
             if (TILE_FROM_XY(newX, newY) < 0 || TILE_FROM_XY(newX, newY) >= environment.width * environment.height) errorSI("dest@searchPathfindingPath-2", TILE_FROM_XY(newX, newY));
             #endif
-            queuePathfindingPathSearch(unit_nr, curX, curY, attack, shoot_range, newX, newY, priority); // add to queue for searching new path
+            queuePathfindingPathSearch(unit_nr, curX, curY, attack, shoot_range, newX, newY, priority, true); // add to queue for searching new path
         }
         return UM_MOVE_HOLD_INITIAL;
     }
@@ -216,12 +497,22 @@ enum UnitMove searchPathfindingPath(int unit_nr, int curX, int curY, bool attack
     #ifdef DEBUG_BUILD
     if (move != UM_MOVE_HOLD && (getNextTile(curX, curY, move) < 0 || getNextTile(curX, curY, move) >= environment.width * environment.height)) errorSI("nextTile@searchPathfindingPath", getNextTile(curX, curY, move));
     #endif
-    if (move == UM_MOVE_HOLD || !freeToMoveUnitViaTile(unit + unit_nr, getNextTile(curX, curY, move)) || isTileBlockedByOtherUnit(unit + unit_nr, getNextTile(curX, curY, move))) {
-        // requeue pathfinding but with cur_tile as starting point
-        queuePathfindingPathSearch(unit_nr, curX, curY, attack, shoot_range, newX, newY, true);
+    if (move == UM_MOVE_HOLD || !freeToMoveUnitViaTile(unit + unit_nr, getNextTile(curX, curY, move))) {
+        // requeue pathfinding but with cur_tile as starting point. a path that ended need not be searched for from scratch
+        queuePathfindingPathSearch(unit_nr, curX, curY, attack, shoot_range, newX, newY, true, move == UM_MOVE_HOLD);
+        return UM_MOVE_HOLD;
+    }
+    if (isTileBlockedByOtherUnit(unit + unit_nr, getNextTile(curX, curY, move))) {
+        // another unit is in the way. unless the unit gets past it on its own, it requires a search that takes units into account
+        enum UnitMove avoidance = avoidBlockingUnit(unit_nr, TILE_FROM_XY(curX, curY), getNextTile(curX, curY, move),
+                                                    pathfindingPaths.node[path->first + path->offset]);
+        if (avoidance != UM_NONE)
+            return avoidance;
+        queuePathfindingPathSearch(unit_nr, curX, curY, attack, shoot_range, newX, newY, true, false);
         return UM_MOVE_HOLD;
     }
     
+    passBlockingUnit(unit_nr);
     return move;
 }
 
@@ -240,17 +531,20 @@ inline enum UnitMove getPathfindingAttackPath(int unit_nr, int curX, int curY, i
 void removePathfindingPath(int unit_nr) {
     int i;
     
+    leaveFlowField(unit_nr, false);
+    forgetBlockingUnit(unit_nr);
     for (i=0; i<MAX_PATHFINDING_PATHS; i++) {
         if (pathfindingPath[i].unit_nr == unit_nr) {
+            if (pathfindingPathJob[i] != -1)
+                endPathfindingSearch(pathfindingPathJob[i]);
+            releasePathNodes(&pathfindingPath[i]);
             pathfindingPath[i].unit_nr = -1;
-            if (astarProcessingPath == &pathfindingPath[i]) {
-                Astar_invalidateSearch();
-                astarProcessingPath = 0;
-            }
         }
     }
 }
 
+// only ever used to make a destination structure traversable while searching for a path to it. the path
+// clusters are therefore not invalidated; their searches connect to the destination on the fly instead
 void setDestinationStructureTraversability(int structureNr, enum Traversability t) {
     int i,j;
     int x = structure[structureNr].x;
@@ -260,7 +554,7 @@ void setDestinationStructureTraversability(int structureNr, enum Traversability
     
     for (i=0; i<h; i++) {
         for (j=0; j<w; j++) {
-            environment.layout[TILE_FROM_XY(x+j, y+i)].traversability = t;
+            setTileTraversability(TILE_FROM_XY(x+j, y+i), t);
         }
     }
 }
@@ -272,27 +566,39 @@ int tileDistance(int tile1, int tile2) {
     return (diffX - diagonalTiles) + (diffY - diagonalTiles);
 }
 
-int allowDestinationStructureTraversability (unsigned int goal, struct UnitInfo *cur_unitinfo)  {
+// to be called whenever the traversability of tiles in the given area changed
+void invalidatePathfindingArea(int x, int y, int width, int height) {
+    traversabilityVersion++;
+    invalidatePathClusters(x, y, width, height);
+    invalidatePathRegions(x, y, width, height);
+    invalidateFiringPositions(x, y, width, height);
+}
+
+// the structure at the destination if the unit may enter it, i.e. to have its ore extracted or to be repaired, or -1
+int getDestinationStructure (unsigned int goal, struct UnitInfo *cur_unitinfo)  {
     #ifdef DEBUG_BUILD
-    if (goal < 0 || goal >= environment.width * environment.height) errorSI("tile@allowDestinationStructureTraversability", goal);
+    if (goal < 0 || goal >= environment.width * environment.height) errorSI("tile@getDestinationStructure", goal);
     #endif
     
-    // check whether traversability of destination structure should temporarily be set to traversable for special cases
     int goalStructureNr = environment.layout[goal].contains_structure;
     if (goalStructureNr < -1) {
         #ifdef DEBUG_BUILD
-        if ((goal + goalStructureNr + 1) < 0 || (goal + goalStructureNr + 1) >= environment.width * environment.height) errorSI("goalStructureNr@allowDestinationStructureTraversability", goalStructureNr);
+        if ((goal + goalStructureNr + 1) < 0 || (goal + goalStructureNr + 1) >= environment.width * environment.height) errorSI("goalStructureNr@getDestinationStructure", goalStructureNr);
         #endif
         goalStructureNr = environment.layout[goal + (goalStructureNr + 1)].contains_structure;
     }
-    if (goalStructureNr >= MAX_DIFFERENT_FACTIONS) {
-        if ((cur_unitinfo->can_collect_ore && structureInfo[structure[goalStructureNr].info].can_extract_ore) ||
-            (cur_unitinfo->type != UT_FOOT && structureInfo[structure[goalStructureNr].info].can_repair_unit)) {
-             setDestinationStructureTraversability(goalStructureNr, TRAVERSABLE);
-        } else
-            goalStructureNr = -1;
-    } else
-    goalStructureNr = -1;
+    if (goalStructureNr >= MAX_DIFFERENT_FACTIONS &&
+        ((cur_unitinfo->can_collect_ore && structureInfo[structure[goalStructureNr].info].can_extract_ore) ||
+         (cur_unitinfo->type != UT_FOOT && structureInfo[structure[goalStructureNr].info].can_repair_unit)))
+        return goalStructureNr;
+    return -1;
+}
+
+int allowDestinationStructureTraversability (unsigned int goal, struct UnitInfo *cur_unitinfo)  {
+    // check whether traversability of destination structure should temporarily be set to traversable for special cases
+    int goalStructureNr = getDestinationStructure(goal, cur_unitinfo);
+    if (goalStructureNr != -1)
+        setDestinationStructureTraversability(goalStructureNr, TRAVERSABLE);
     
     return goalStructureNr;
 }
@@ -302,20 +608,249 @@ void disallowDestinationStructureTraversability (int StructureNr) {
         setDestinationStructureTraversability(StructureNr, UNTRAVERSABLE);
 }
 
+// the unit is as close to its destination as it can get. it settles there if that's close enough, or tries again later
+void settlePathfindingPath(struct Path *path) {
+    if (Astar_heuristicDistance(path->offset,path->dest)<THRESHHOLD_SETTLE_DISTANCE) {
+      path->queue = PQ_UNQUEUED;
+      path->size = 0;
+    } else {
+      path->queue = PQ_QUEUED + ((PATHFINDING_REQUEUE_TIMER*FPS)*2)/getGameSpeed();
+    }
+}
+
+// starts the search for a queued path. for a destination far away, only the way to the first waypoint
+// of the route found on the path clusters is searched for. a destination that can't be reached is replaced
+// by the nearest tile that can, rather than having the search find out the hard way.
+// returns 0 if no search was started, the unit already being on that tile. there must be a job free
+int startPathfindingPathSearch(struct Path *path, bool viaClusters) {
+    struct Unit *cur_unit = unit + path->unit_nr;
+    int goalStructureNr;
+    int goal = path->dest;
+    int waypoint = -1;
+    
+    goalStructureNr=allowDestinationStructureTraversability(path->dest, unitInfo + cur_unit->info);
+    if (!path->attack && goalStructureNr == -1 && !isPathRegionReachable(path->offset, path->dest, unitInfo + cur_unit->info)) {
+        goal = getNearestPathRegionTile(path->offset, path->dest, unitInfo + cur_unit->info);
+        if (goal == path->offset) {
+            settlePathfindingPath(path);
+            return 0;
+        }
+        if (goal < 0)
+            goal = path->dest;
+    }
+    if (viaClusters)
+        waypoint = getPathClusterWaypoint(path->offset, goal, cur_unit, unitInfo + cur_unit->info);
+    path->partial = (waypoint >= 0);
+    disallowDestinationStructureTraversability(goalStructureNr);
+    if (path->partial)
+        submitPathfindingSearch(path, waypoint, false,
+                                Astar_heuristicDistance(path->offset,waypoint)*2, // needing a larger detour means the waypoint is blocked
+                                false, goalStructureNr);
+    else
+        submitPathfindingSearch(path, goal, path->attack,
+                                (Astar_heuristicDistance(path->offset,goal)<THRESHHOLD_DANCE_DISTANCE)?Astar_heuristicDistance(path->offset,goal)*3/2:0,
+                                goal == path->dest && pathfindingPathCacheable[path - pathfindingPath], goalStructureNr);
+    return 1;
+}
+
+int getPathCacheCell(int tile) {
+    return (Y_FROM_TILE(tile) >> PATH_CACHE_CELL_SHIFT) * ((environment.width + (1 << PATH_CACHE_CELL_SHIFT) - 1) >> PATH_CACHE_CELL_SHIFT) +
+           (X_FROM_TILE(tile) >> PATH_CACHE_CELL_SHIFT);
+}
+
+int isPathCacheEntryFor(struct PathCacheEntry *entry, struct Path *path) {
+    struct Unit *cur_unit = unit + path->unit_nr;
+    
+    return (entry->version == traversabilityVersion && entry->startCell == getPathCacheCell(path->offset) &&
+            entry->dest == path->dest && entry->attack == path->attack && (!path->attack || entry->shootRange == path->size) &&
+            entry->type == unitInfo[cur_unit->info].type && entry->friendly == (cur_unit->side == FRIENDLY));
+}
+
+// whether moving straight towards 'to', the way obtainNextMove does, gets the unit there without running into terrain or structures
+int isPathCacheJoinClear(int from, int to, struct Unit *cur_unit) {
+    int steps;
+    
+    for (steps=0; from != to; steps++) {
+        if (steps >= PATH_CACHE_MAX_JOIN_LENGTH)
+            return 0;
+        from = getNextTile(X_FROM_TILE(from), Y_FROM_TILE(from), UM_MOVE_UP + (int) positionedToFaceXY(X_FROM_TILE(from), Y_FROM_TILE(from), X_FROM_TILE(to), Y_FROM_TILE(to)));
+        if (!mapCanBeTraversed_callback(from, THRESHHOLD_TRAVERSABILITY_CHECK + 1, cur_unit, unitInfo + cur_unit->info))
+            return 0;
+    }
+    return 1;
+}
+
+// completes a queued path with a path found earlier for a unit like it, starting nearby. returns whether it could
+int loadCachedPath(struct Path *path) {
+    struct Unit *cur_unit = unit + path->unit_nr;
+    struct PathCacheEntry *entry;
+    int goalStructureNr;
+    int i, j;
+    
+    if (!pathfindingPathCacheable[path - pathfindingPath])
+        return 0;
+    
+    for (i=0; i<MAX_PATH_CACHE_ENTRIES; i++) {
+        entry = pathCache + i;
+        if (!isPathCacheEntryFor(entry, path))
+            continue;
+        // join the cached path at its furthest elbow that can be moved to straight away
+        goalStructureNr = allowDestinationStructureTraversability(path->dest, unitInfo + cur_unit->info);
+        for (j=entry->size-1; j>=0 && !isPathCacheJoinClear(path->offset, entry->tile[j], cur_unit); j--);
+        disallowDestinationStructureTraversability(goalStructureNr);
+        if (j < 0)
+            continue;
+        
+        path->size = entry->size - j;
+        allocatePathNodes(path, path->size);
+        memcpy(pathfindingPaths.node + path->first, entry->tile + j, path->stored * sizeof(entry->tile[0]));
+        path->queue = PQ_UNQUEUED;
+        path->offset = 0;
+        entry->lastUsed = ++pathCacheTime;
+        return 1;
+    }
+    return 0;
+}
+
+// called when a search completed, with the path loaded into its nodes but 'offset' still holding the start tile
+void storeCachedPath(struct Path *path, unsigned short int *tile, int size, bool cacheable) {
+    struct Unit *cur_unit = unit + path->unit_nr;
+    struct PathCacheEntry *entry = pathCache;
+    int i;
+    
+    if (!cacheable || size <= 0 || size > PATHBUFFERLEN || path->stored < size ||
+        Astar_heuristicDistance(path->offset, path->dest) < PATH_CACHE_MIN_DISTANCE)
+        return;
+    
+    // replace the entry for the same path, or else the one that is outdated or least recently used
+    for (i=0; i<MAX_PATH_CACHE_ENTRIES; i++) {
+        if (isPathCacheEntryFor(pathCache + i, path)) {
+            entry = pathCache + i;
+            break;
+        }
+        if (entry->version == traversabilityVersion && (pathCache[i].version != traversabilityVersion || pathCache[i].lastUsed < entry->lastUsed))
+            entry = pathCache + i;
+    }
+    
+    entry->version    = traversabilityVersion;
+    entry->lastUsed   = ++pathCacheTime;
+    entry->startCell  = getPathCacheCell(path->offset);
+    entry->dest       = path->dest;
+    entry->shootRange = path->attack ? path->size : 0;
+    entry->type       = unitInfo[cur_unit->info].type;
+    entry->friendly   = (cur_unit->side == FRIENDLY);
+    entry->attack     = path->attack;
+    entry->size       = size;
+    memcpy(entry->tile, tile, size * sizeof(tile[0]));
+}
+
+int isPathForFlowField(struct Path *path, struct Path *chosen) {
+    if (path->unit_nr == -1 || path->queue < PQ_HIGHPRIORITY || path->queue >= PQ_QUEUED || pathfindingPathJob[path - pathfindingPath] != -1 ||
+        path->dest != chosen->dest || path->attack != chosen->attack)
+        return 0;
+    
+    struct Unit *cur_unit = unit + path->unit_nr;
+    struct Unit *chosen_unit = unit + chosen->unit_nr;
+    
+    return ((unitInfo[cur_unit->info].type == UT_TRACKED) == (unitInfo[chosen_unit->info].type == UT_TRACKED) &&
+            (cur_unit->side == FRIENDLY) == (chosen_unit->side == FRIENDLY) &&
+            canUnitUseFlowField(path->unit_nr, path->dest));
+}
+
+// when a group of units is queued to search for a path to the same destination, a single flow field is made
+// for all of them to follow instead. returns whether the chosen path was replaced by it
+int startFlowField(struct Path *chosen) {
+    int amount = 0;
+    int field, i;
+    
+    if (!isFlowFieldDestination(chosen->dest, chosen->attack) || !isPathForFlowField(chosen, chosen))
+        return 0;
+    
+    for (i=0; i<MAX_PATHFINDING_PATHS; i++) {
+        if (isPathForFlowField(pathfindingPath + i, chosen))
+            amount++;
+    }
+    if (amount < MIN_FLOW_FIELD_GROUP)
+        return 0;
+    
+    field = createFlowField(chosen->dest, unit + chosen->unit_nr, unitInfo + unit[chosen->unit_nr].info);
+    if (field < 0)
+        return 0;
+    
+    // 'chosen' is among the paths handed over, so compare against a copy
+    struct Path group = *chosen;
+    for (i=0; i<MAX_PATHFINDING_PATHS; i++) {
+        if (isPathForFlowField(pathfindingPath + i, &group) && isFlowFieldReachable(field, pathfindingPath[i].offset)) {
+            joinFlowField(pathfindingPath[i].unit_nr, field, pathfindingPath[i].attack);
+            releasePathNodes(pathfindingPath + i);
+            pathfindingPath[i].unit_nr = -1;
+        }
+    }
+    return (chosen->unit_nr == -1);
+}
+
+// handles the searches that are done, in the order of their jobs: a path found is stored, and a search that failed
+// is followed up by one to the destination itself or to the tile closest to it
+void applyPathfindingSearches() {
+    struct Path *path;
+    unsigned int closest;
+    int i, job;
+    
+    for (job=0; job<ASTAR_SEARCHES; job++) {
+        path = pathfindingSearch[job].path;
+        if (!path)
+            continue;
+        #ifdef DEBUG_BUILD
+        if (path->dest < 0 || path->dest >= environment.width * environment.height) errorSI("path->dest@applyPathfindingSearches", path->dest);
+        #endif
+        switch (Astar_pollJob(job)) {
+          case AS_COMPLETE:
+            // store the turning points ('elbows') as the path, or as many as the pool of path nodes can hold
+            allocatePathNodes(path, Astar_pathNodes(job));
+            i = Astar_loadPathNodes(job, pathfindingPaths.node + path->first, path->stored);
+            storeCachedPath(path, pathfindingPaths.node + path->first, i, pathfindingSearch[job].cacheable);
+            path->size = i;
+            path->queue = PQ_UNQUEUED;
+            path->offset = 0;
+            endPathfindingSearch(job);
+            break;
+          case AS_FAILED:
+            closest = Astar_closest(job);
+            endPathfindingSearch(job);
+            if (path->partial) {
+                // the way to the waypoint is blocked, likely by other units. search for the way to the destination itself instead
+                startPathfindingPathSearch(path, false);
+            } else if (closest == path->offset) {
+                // we're already on the closest tile, check if we're close enough to dest to settle definately
+                settlePathfindingPath(path);
+            } else {
+                // search for the way to the closest tile instead
+                submitPathfindingSearch(path, closest, false, 0, false, getDestinationStructure(path->dest, unitInfo + unit[path->unit_nr].info));
+            }
+            break;
+          default:
+            break;
+        }
+    }
+}
+
+// whether there is time left to hand out searches
+static inline int canStartPathfindingSearches() {
+    return !areSearchesRunInTurn() || canContinueSearch_callback();
+}
+
 void doPathfindingLogic() {
-    struct Unit *cur_unit=0;
-    int i,goalStructureNr;
+    struct Path *path;
+    int i;
     int maxQueuedTime = 0;
 
     startProfilingFunction("doPathfindingLogic");
     
-    // if there's a current unit in process, check if it still exists
-    if (astarProcessingPath && astarProcessingPath->unit_nr==-1) {
-        // unit is no longer alive, kill any running pathsearch
-        Astar_invalidateSearch();
-        astarProcessingPath = 0;
-    }
-
+    updatePathClusters();
+    updatePathRegions();
+    updateFlowFields();
+    updateFiringPositions();
+    
     // diminish delay timers for queued paths until they are ready to initiate a new search
     for (i=0; i<MAX_PATHFINDING_PATHS; i++) {
         if (pathfindingPath[i].queue >= PQ_QUEUED) {
@@ -335,6 +870,7 @@ void doPathfindingLogic() {
     maxGameticksSearch = MAX_GAMETICKS_IN_FRAME;
     while (getGameticks() > maxGameticksSearch) {
         maxGameticksSearch += GAMETICKS_PER_FRAME;
+        searchExtensions++;
         addProfilingInformationInt("pathfinding maxGameticksSearch increased (1).", maxGameticksSearch);
     }
     // Using up an additional frame is not to happen every cycle. Hence the additionalFrameAllowedDelay.
@@ -342,114 +878,60 @@ void doPathfindingLogic() {
         additionalFrameAllowedDelay--;
     if (maxQueuedTime > MAX_QUEUED_TIME && additionalFrameAllowedDelay == 0) {
         maxGameticksSearch += GAMETICKS_PER_FRAME;
+        searchExtensions++;
         addProfilingInformationInt("pathfinding maxGameticksSearch increased (2).", maxGameticksSearch);
         additionalFrameAllowedDelay = ADDITIONAL_FRAME_ALLOWED_DELAY;
     }
     
-    while (canContinueSearch_callback()) {
-        // check if we have a current unit
-        if (astarProcessingPath) {
-            if (Astar_getStatus()==AS_INCOMPLETE) {
-                // an incompleted search requires continuation. This is easy.
-                cur_unit = unit + astarProcessingPath->unit_nr;
-                #ifdef DEBUG_BUILD
-                if (astarProcessingPath->dest < 0 || astarProcessingPath->dest >= environment.width * environment.height) errorSI("AS_INCOMPLETE-path->dest@doPathfindingLogic", astarProcessingPath->dest);
-                #endif
-                goalStructureNr=allowDestinationStructureTraversability(astarProcessingPath->dest, unitInfo + cur_unit->info);
-                Astar_continueSearch();
-                disallowDestinationStructureTraversability(goalStructureNr);
-            } else if (Astar_getStatus()==AS_FAILED) {
-                // the previous search failed, we need to run a search to the closed
-                // check if we're already on closest tile
-                if (Astar_closest()==astarProcessingPath->offset) {
-                    
-                    // we're already on the closest tile, check if we're close enough to dest to settle definately
-                    if (Astar_heuristicDistance(astarProcessingPath->offset,astarProcessingPath->dest)<THRESHHOLD_SETTLE_DISTANCE) {
-                      astarProcessingPath->queue = PQ_UNQUEUED;
-                      astarProcessingPath->size = 0;
-                    } else {
-                      astarProcessingPath->queue = PQ_QUEUED + ((PATHFINDING_REQUEUE_TIMER*FPS)*2)/getGameSpeed();
-                    }
-                
-                    // set free for next one
-                    Astar_invalidateSearch();
-                    astarProcessingPath=0;
-                } else {
-                    // check if there's enough time to start
-                    if (!canContinueSearch_callback()) {
-                        stopProfilingFunction();
-                        return;
-                    }
-                    // start!
-                    cur_unit = unit + astarProcessingPath->unit_nr;
-                    #ifdef DEBUG_BUILD
-                    if (astarProcessingPath->dest < 0 || astarProcessingPath->dest >= environment.width * environment.height) errorSI("AS_FAILED-path->dest@doPathfindingLogic", astarProcessingPath->dest);
-                    #endif
-                    goalStructureNr=allowDestinationStructureTraversability(astarProcessingPath->dest, unitInfo + cur_unit->info);
-                    Astar_startSearch (astarProcessingPath->offset, Astar_closest(),
-                                       cur_unit->unit_positioned, false, 0, 0,
-                                       cur_unit, unitInfo + cur_unit->info);
-                    disallowDestinationStructureTraversability(goalStructureNr);
-                }
-            } else if (Astar_getStatus() == AS_COMPLETE) {
-                // store first PATHBUFFERLEN turning points ('elbows') as the path
-                astarProcessingPath->size = Astar_loadPath(astarProcessingPath->tile);
-                astarProcessingPath->queue = PQ_UNQUEUED;
-                astarProcessingPath->offset = 0;
-                // set free for next one
-                Astar_invalidateSearch();
-                astarProcessingPath=0;
-            } else {  // Astar_getStatus() == AS_INITIALIZED
-                // start a new search, if there's enough time
-                if (!canContinueSearch_callback()) {
-                    stopProfilingFunction();
-                    return;
-                }
-                // start!
-                cur_unit = unit + astarProcessingPath->unit_nr;
-                #ifdef DEBUG_BUILD
-                if (astarProcessingPath->dest < 0 || astarProcessingPath->dest >= environment.width * environment.height) errorSI("AS_INITIALIZED-path->dest@doPathfindingLogic", astarProcessingPath->dest);
-                #endif
-                goalStructureNr=allowDestinationStructureTraversability(astarProcessingPath->dest, unitInfo + cur_unit->info);
-                Astar_startSearch (astarProcessingPath->offset, astarProcessingPath->dest,
-                                   cur_unit->unit_positioned, 
-                                   astarProcessingPath->attack, astarProcessingPath->size,
-                                   (Astar_heuristicDistance(astarProcessingPath->offset,astarProcessingPath->dest)<THRESHHOLD_DANCE_DISTANCE)?Astar_heuristicDistance(astarProcessingPath->offset,astarProcessingPath->dest)*3/2:0,
-                                   cur_unit, unitInfo + cur_unit->info);
-                disallowDestinationStructureTraversability(goalStructureNr);
-            }
-        } else {
-            // no current unit selected
-            // get a new unit from the queue, if any
-            Astar_invalidateSearch(); // make sure we start
-            astarProcessingPath = getQueuedPathfindingPathSearch();
-            // if queue is empty, return
-            if (!astarProcessingPath) {
-                stopProfilingFunction();
-                return;
-            }
+    while (canStartPathfindingSearches()) {
+        // hand out the free jobs to the queued paths not served by a flow field or the path cache
+        while (isPathfindingJobFree() && (path = getQueuedPathfindingPathSearch())) {
+            if (!startFlowField(path) && !loadCachedPath(path))
+                startPathfindingPathSearch(path, true);
         }
-    } // end while
+        if (!isPathfindingSearchUnderway())
+            break;
+        if (areSearchesRunInTurn())
+            Astar_runJobsInTurn();
+        else
+            Astar_runJobs();
+        applyPathfindingSearches();
+    }
+    
+    if (searchCutShort)
+        recordReplayCommand(RC_PATHFINDING_CUT_SHORT, 0, searchContinuations, 0);
+    searchContinuations = 0;
+    searchCutShort = false;
+    searchBudget = -1;
     stopProfilingFunction();
 }
 
+void setPathfindingSearchBudget(int continuations) {
+    searchBudget = continuations;
+}
+
 
 int getPathFindingsSaveSize(void) {
-    return sizeof(pathfindingPath);
+    return sizeof(pathfindingPaths);
 }
 
 int getPathFindingsSaveData(void *dest, int max_size) {
-    int size=sizeof(pathfindingPath);
+    int size=sizeof(pathfindingPaths);
     
     if (size>max_size)
         return(0);
         
-    memcpy (dest,&pathfindingPath,size);
+    memcpy (dest,&pathfindingPaths,size);
     return (size);
 }
 
+// the paths being the start of the block that is saved, a savegame is loaded into this as well
 inline struct Path *getPathFindings() {
-    return pathfindingPath;
+    return pathfindingPaths.path;
+}
+
+int getPathfindingSearchExtensions() {
+    return searchExtensions;
 }
 
 #endif
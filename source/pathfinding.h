@@ -14,6 +14,16 @@ enum PathfindingQueueStatus { PQ_UNQUEUED = -1,
                               PQ_LOWPRIORITY = 2 , PQ_QUEUED = 3 };
 // ( PQ_LOWPRIORITY still unused )
 
+// other units are only considered blocking when this near (in heuristic distance) to the start of a path search
+#define THRESHHOLD_TRAVERSABILITY_CHECK    50      // this is no longer related to GSCORE
+
+// define this to have path searches jump over open terrain beyond THRESHHOLD_TRAVERSABILITY_CHECK (Jump Point
+// Search). far fewer nodes are expanded, but every node jumped over is still checked for traversability
+//#define PATHFINDING_JUMP_POINTS
+
+#define MAX_PATHFINDING_PATHS  (MAX_UNITS_ON_MAP)  /* MAX_UNITS_ON_MAP is the max ever required (== +- 3 kb) */
+#define MAX_PATH_NODES         (MAX_PATHFINDING_PATHS * PATHBUFFERLEN) /* shared by all paths, so a long path can take more than PATHBUFFERLEN */
+
 struct Path {
     int unit_nr;                           // unit_nr.  -1 when not in use.
     enum PathfindingQueueStatus queue;     // whether the path is queued for a search.  if !PQ_UNQUEUED: 'size' indicates shoot_range and 'offset' indicates current tile
@@ -21,9 +31,11 @@ struct Path {
 //    bool queued;                // whether the path is queued for a search.  if true: 'size' indicates shoot_range and 'offset' indicates current tile
     unsigned short int dest;    // final destination tile (possibly to attack) searched for.
     bool attack;                // whether the path was searched for in order to attack or to move to
-    unsigned short int tile[PATHBUFFERLEN];
-    unsigned short int size;    // the number of nodes valid in 'tile'.  is > PATHBUFFERLEN when 'tile' could not store all nodes.
-    unsigned short int offset;  // offset within 'tile' for the current to-move-to tile on a straight line
+    bool partial;               // whether the path leads to a waypoint on the way to 'dest' rather than to 'dest' itself
+    unsigned short int first;   // the first node of the path in the pool of path nodes. the others follow it
+    unsigned short int stored;  // the number of nodes kept in the pool.  is < 'size' when the pool could not hold all nodes.
+    unsigned short int size;    // the number of nodes of the path.
+    unsigned short int offset;  // offset within the nodes for the current to-move-to tile on a straight line
 };
 
 enum UnitMove getPathfindingPath(int unit_nr, int curX, int curY, int newX, int newY);
@@ -33,15 +45,33 @@ enum UnitMove getPathfindingAttackPath(int unit_nr, int curX, int curY, int shoo
 //                        a unit is destroyed
 //                        a unit bumps too often (apparently in need of a new/better path)
 void removePathfindingPath(int unit_nr);
+// the tile the unit moves onto next following its path, or -1 if it has no path to follow
+int getPathfindingNextTile(int unit_nr);
+
+// should be called when: a savegame is loaded, the searches underway being for the paths it replaced
+void cancelPathfindingSearches();
+
+// to be called whenever the traversability of tiles in the given area changed
+void invalidatePathfindingArea(int x, int y, int width, int height);
 
 void doPathfindingLogic();
+// in replay playback, the times the searches of this logic frame may continue, as they were when recorded
+void setPathfindingSearchBudget(int continuations);
+
+// the callbacks pathfinding gives Astar, for tools repeating its searches
+unsigned int mapCanBeTraversed_callback(unsigned int node, unsigned int g_score, void *cur_unit, void *cur_unitinfo);
+unsigned int canHitTarget_callback(unsigned int start, unsigned int goal, void *cur_unit, void *cur_unitinfo);
 
 void initPathfinding();
 void initPathfindingWithScenario();
 
+// the paths are saved followed by the pool of their nodes, as a single block
 int getPathFindingsSaveSize();
 int getPathFindingsSaveData(void *dest, int max_size);
 struct Path *getPathFindings();
 
+// the number of times pathfinding was allowed to continue into another frame since the scenario started
+int getPathfindingSearchExtensions();
+
 #endif
 #endif
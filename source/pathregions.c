@@ -0,0 +1,261 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Connected regions of the map: a path search towards a goal that can't be
+// reached would otherwise visit every tile that can be, before failing and
+// having to search for a path to the closest tile instead.
+//
+// When the traversability of an area changes, only the regions touching that
+// area are updated. A structure being destroyed may merge several regions; the
+// labels of those are then merely joined, as in a union-find. A structure being
+// built may split a region in two; the tiles flooded from the area then get new
+// labels, while regions elsewhere keep theirs.
+
+#include "pathregions.h"
+#ifndef REMOVE_ASTAR_PATHFINDING
+
+#include "shared.h"
+
+#define MAX_PATH_REGION_LABELS  (MAX_TILES_ENVIRONMENT + 1) /* enough to label the whole map, tile by tile */
+
+static u16 pathRegion[2][MAX_TILES_ENVIRONMENT]; // for non-tracked and tracked units respectively
+static u16 pathRegionParent[2][MAX_PATH_REGION_LABELS]; // the label a label was joined with. a region is known by its root label
+static unsigned int nextPathRegion[2];
+static int pathRegionDirtyX1, pathRegionDirtyY1, pathRegionDirtyX2, pathRegionDirtyY2; // inclusive; x1 > x2 when clean
+
+static u16 pathRegionQueue[MAX_TILES_ENVIRONMENT];
+
+static const s8 regionDirX[8] = { 0, +1, +1, +1, 0, -1, -1, -1 };
+static const s8 regionDirY[8] = {-1, -1, 0, +1, +1, +1,  0, -1 };
+
+
+static inline int isPathRegionTileTraversable(int tile, int tracked) {
+    int traversability = environment.layout[tile].traversability;
+    return (traversability == TRAVERSABLE || (!tracked && traversability == TRAVERSABLE_BY_NON_TRACKED));
+}
+
+void clearPathRegions(int tracked) {
+    int i;
+
+    for (i=0; i<environment.width*environment.height; i++)
+        pathRegion[tracked][i] = PATH_REGION_NONE;
+    nextPathRegion[tracked] = PATH_REGION_NONE + 1;
+}
+
+void initPathRegionsWithScenario() {
+    clearPathRegions(0);
+    clearPathRegions(1);
+    pathRegionDirtyX1 = 1;
+    pathRegionDirtyX2 = 0;
+    invalidatePathRegions(0, 0, environment.width, environment.height);
+}
+
+void invalidatePathRegions(int x, int y, int width, int height) {
+    // the regions around the area are affected as well, as they may now be split or merged
+    int x1 = max(0, x - 1);
+    int y1 = max(0, y - 1);
+    int x2 = min(environment.width  - 1, x + width);
+    int y2 = min(environment.height - 1, y + height);
+
+    if (pathRegionDirtyX1 > pathRegionDirtyX2) {
+        pathRegionDirtyX1 = x1;
+        pathRegionDirtyY1 = y1;
+        pathRegionDirtyX2 = x2;
+        pathRegionDirtyY2 = y2;
+        return;
+    }
+    pathRegionDirtyX1 = min(pathRegionDirtyX1, x1);
+    pathRegionDirtyY1 = min(pathRegionDirtyY1, y1);
+    pathRegionDirtyX2 = max(pathRegionDirtyX2, x2);
+    pathRegionDirtyY2 = max(pathRegionDirtyY2, y2);
+}
+
+static inline u16 getPathRegionRoot(int tracked, u16 label) {
+    u16 *parent = pathRegionParent[tracked];
+
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+    return label;
+}
+
+static inline u16 getPathRegion(int tracked, int tile) {
+    return getPathRegionRoot(tracked, pathRegion[tracked][tile]);
+}
+
+// labels every tile that can be reached from the given one
+void floodPathRegion(int tile, int tracked, u16 label) {
+    u16 *region = pathRegion[tracked];
+    int head = 0, tail = 0;
+    int x, y, newX, newY, newTile;
+    int i;
+
+    pathRegionParent[tracked][label] = label;
+    region[tile] = label;
+    pathRegionQueue[tail++] = tile;
+    while (head < tail) {
+        tile = pathRegionQueue[head++];
+        x = X_FROM_TILE(tile);
+        y = Y_FROM_TILE(tile);
+        for (i=0; i<8; i++) {
+            newX = x + regionDirX[i];
+            newY = y + regionDirY[i];
+            if (newX < 0 || newX >= environment.width || newY < 0 || newY >= environment.height)
+                continue;
+            newTile = TILE_FROM_XY(newX, newY);
+            if (region[newTile] != label && isPathRegionTileTraversable(newTile, tracked)) {
+                region[newTile] = label;
+                pathRegionQueue[tail++] = newTile;
+            }
+        }
+    }
+}
+
+// tiles in the area only became traversable: each is joined with the regions around it
+void joinPathRegions(int tracked, int x1, int y1, int x2, int y2) {
+    u16 *region = pathRegion[tracked];
+    u16 label, other;
+    int x, y, newX, newY, newTile;
+    int i;
+
+    for (y=y1; y<=y2; y++) {
+        for (x=x1; x<=x2; x++) {
+            if (region[TILE_FROM_XY(x, y)] != PATH_REGION_NONE || !isPathRegionTileTraversable(TILE_FROM_XY(x, y), tracked))
+                continue;
+            label = PATH_REGION_NONE;
+            for (i=0; i<8; i++) {
+                newX = x + regionDirX[i];
+                newY = y + regionDirY[i];
+                if (newX < 0 || newX >= environment.width || newY < 0 || newY >= environment.height)
+                    continue;
+                newTile = TILE_FROM_XY(newX, newY);
+                if (region[newTile] == PATH_REGION_NONE)
+                    continue;
+                other = getPathRegion(tracked, newTile);
+                if (label == PATH_REGION_NONE)
+                    label = other;
+                else if (other != label)
+                    pathRegionParent[tracked][other] = label;
+            }
+            if (label == PATH_REGION_NONE) {
+                label = nextPathRegion[tracked]++;
+                pathRegionParent[tracked][label] = label;
+            }
+            region[TILE_FROM_XY(x, y)] = label;
+        }
+    }
+}
+
+// returns whether tiles in the area that had a region can no longer be traversed
+int isPathRegionSplit(int tracked, int x1, int y1, int x2, int y2) {
+    int tile;
+    int i, j;
+
+    for (i=y1; i<=y2; i++) {
+        for (j=x1; j<=x2; j++) {
+            tile = TILE_FROM_XY(j, i);
+            if (pathRegion[tracked][tile] != PATH_REGION_NONE && !isPathRegionTileTraversable(tile, tracked))
+                return 1;
+        }
+    }
+    return 0;
+}
+
+void updatePathRegionsOf(int tracked) {
+    unsigned int firstNewRegion;
+    int x1 = pathRegionDirtyX1;
+    int y1 = pathRegionDirtyY1;
+    int x2 = pathRegionDirtyX2;
+    int y2 = pathRegionDirtyY2;
+    int tile;
+    int i, j;
+
+    // labels are only ever handed out once. when they run out, the whole map is labelled anew
+    if (nextPathRegion[tracked] + (x2 - x1 + 1) * (y2 - y1 + 1) >= MAX_PATH_REGION_LABELS) {
+        clearPathRegions(tracked);
+        x1 = 0;
+        y1 = 0;
+        x2 = environment.width  - 1;
+        y2 = environment.height - 1;
+    }
+
+    if (!isPathRegionSplit(tracked, x1, y1, x2, y2)) {
+        joinPathRegions(tracked, x1, y1, x2, y2);
+        return;
+    }
+
+    for (i=y1; i<=y2; i++) {
+        for (j=x1; j<=x2; j++) {
+            tile = TILE_FROM_XY(j, i);
+            if (!isPathRegionTileTraversable(tile, tracked))
+                pathRegion[tracked][tile] = PATH_REGION_NONE;
+        }
+    }
+    // every region touching the area is flooded anew, unless it already was from another tile of the area
+    firstNewRegion = nextPathRegion[tracked];
+    for (i=y1; i<=y2; i++) {
+        for (j=x1; j<=x2; j++) {
+            tile = TILE_FROM_XY(j, i);
+            if (pathRegion[tracked][tile] < firstNewRegion && isPathRegionTileTraversable(tile, tracked))
+                floodPathRegion(tile, tracked, nextPathRegion[tracked]++);
+        }
+    }
+}
+
+void updatePathRegions() {
+    if (pathRegionDirtyX1 > pathRegionDirtyX2)
+        return;
+    updatePathRegionsOf(0);
+    updatePathRegionsOf(1);
+    pathRegionDirtyX1 = 1;
+    pathRegionDirtyX2 = 0;
+}
+
+
+int isPathRegionReachable(int start, int goal, struct UnitInfo *curUnitInfo) {
+    int tracked = (curUnitInfo->type == UT_TRACKED);
+
+    // a unit that doesn't stand on a tile it could traverse (i.e. leaving a structure) is given the benefit of the doubt
+    if (pathRegion[tracked][start] == PATH_REGION_NONE)
+        return 1;
+    return (pathRegion[tracked][goal] != PATH_REGION_NONE && getPathRegion(tracked, goal) == getPathRegion(tracked, start));
+}
+
+int getNearestPathRegionTile(int start, int goal, struct UnitInfo *curUnitInfo) {
+    int tracked = (curUnitInfo->type == UT_TRACKED);
+    u16 region;
+    int goalX = X_FROM_TILE(goal);
+    int goalY = Y_FROM_TILE(goal);
+    int maxRing = max(environment.width, environment.height);
+    int best = -1;
+    unsigned int bestDistance = 0, distance;
+    int ring, x, y, step;
+
+    if (pathRegion[tracked][start] == PATH_REGION_NONE)
+        return -1;
+    region = getPathRegion(tracked, start);
+
+    // the tiles of a ring are between HORIZVERT_HEUR_DISTANCE and DIAGONAL_HEUR_DISTANCE times the ring away from goal
+    for (ring=1; ring<=maxRing && (best < 0 || (unsigned int) (ring * HORIZVERT_HEUR_DISTANCE) < bestDistance); ring++) {
+        for (y=goalY-ring; y<=goalY+ring; y++) {
+            if (y < 0 || y >= environment.height)
+                continue;
+            // only the left and right end of the rows in between the top and bottom of the ring
+            step = (y == goalY-ring || y == goalY+ring) ? 1 : 2*ring;
+            for (x=goalX-ring; x<=goalX+ring; x+=step) {
+                if (x < 0 || x >= environment.width || pathRegion[tracked][TILE_FROM_XY(x,y)] == PATH_REGION_NONE ||
+                    getPathRegion(tracked, TILE_FROM_XY(x,y)) != region)
+                    continue;
+                distance = Astar_heuristicDistance(TILE_FROM_XY(x,y), goal);
+                if (best < 0 || distance < bestDistance) {
+                    best = TILE_FROM_XY(x,y);
+                    bestDistance = distance;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+#endif
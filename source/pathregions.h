@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _PATHREGIONS_H_
+#define _PATHREGIONS_H_
+
+#include "pathfinding.h"
+#ifndef REMOVE_ASTAR_PATHFINDING
+
+#include "environment.h"
+#include "units.h"
+
+// every tile that can be traversed is labelled with the region it belongs to: the tiles that can be reached from
+// one another. this is kept for both tracked and non-tracked units. a goal outside of the region of the start of a
+// path search can't be reached, whatever the search would try
+#define PATH_REGION_NONE    0       /* the label of tiles that can't be traversed */
+
+void initPathRegionsWithScenario();
+
+// to be called whenever the traversability of tiles in the given area changed
+void invalidatePathRegions(int x, int y, int width, int height);
+// relabels the regions that were invalidated. not to be called while traversability is temporarily altered
+void updatePathRegions();
+
+// returns whether goal can be reached from start by units like the given one, other units and shroud aside
+int isPathRegionReachable(int start, int goal, struct UnitInfo *curUnitInfo);
+// returns the tile nearest to goal (in heuristic distance) that can be reached from start, or -1 if none is known
+int getNearestPathRegionTile(int start, int goal, struct UnitInfo *curUnitInfo);
+
+#endif
+#endif
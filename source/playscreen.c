@@ -23,6 +23,7 @@
 #include "pathfinding.h"
 #include "settings.h"
 #include "soundeffects.h"
+#include "replay.h"
 
 #define DRAG_SELECTION_THRESHHOLD  8
 #define GRAPHICAL_ACTION_DURATION       (((FPS / 2) / 5) * 5)
@@ -100,15 +101,16 @@ void inputPlayScreenFriendlyForcedAttack(int tile, int forceHeal) {
                 if (unit[i].selected) {
                     if (!unitInfo[unit[i].info].shoot_range || (!forceHeal && unitInfo[unit[i].info].can_heal_foot)) {
                         unit[i].logic = UL_MOVE_LOCATION;
-                        unit[i].logic_aid = tile;
+                        setUnitLogicAid(unit + i, tile);
                     } else {
                         unit[i].logic = UL_ATTACK_UNIT;
-                        unit[i].logic_aid = environment.layout[tile].contains_unit;
+                        setUnitLogicAid(unit + i, environment.layout[tile].contains_unit);
                         unit[i].group = (unit[i].group & (~UGAI_FRIENDLY_MASK)) | UGAI_ATTACK_FORCED;
                     }
                     #ifdef REMOVE_ASTAR_PATHFINDING
                     unit[i].hugging_obstacle = 0;
                     #endif
+                    recordReplayUnitOrder(i);
                     if (unitType == 255 || unitInfo[unit[i].info].type > unitType)
                         unitType = unitInfo[unit[i].info].type;
                 }
@@ -128,10 +130,11 @@ void inputPlayScreenFriendlyForcedAttack(int tile, int forceHeal) {
                         unit[i].logic = UL_ATTACK_LOCATION;
                         unit[i].group = (unit[i].group & (~UGAI_FRIENDLY_MASK)) | UGAI_ATTACK_FORCED;
                     }
-                    unit[i].logic_aid = tile;
+                    setUnitLogicAid(unit + i, tile);
                     #ifdef REMOVE_ASTAR_PATHFINDING
                     unit[i].hugging_obstacle = 0;
                     #endif
+                    recordReplayUnitOrder(i);
                     if (unitType == 255 || unitInfo[unit[i].info].type > unitType)
                         unitType = unitInfo[unit[i].info].type;
                 }
@@ -181,12 +184,13 @@ void inputPlayScreenFriendlyForcedMove(int tile) {
             if (unit[i].selected) {
                 unit[i].logic = logic;
                 if (logic == UL_RETREAT)
-                    unit[i].retreat_tile = tile;
+                    setUnitRetreatTile(unit + i, tile);
                 else
-                    unit[i].logic_aid = tile;
+                    setUnitLogicAid(unit + i, tile);
                 #ifdef REMOVE_ASTAR_PATHFINDING
                 unit[i].hugging_obstacle = 0;
                 #endif
+                recordReplayUnitOrder(i);
                 if (unitType == 255 || unitInfo[unit[i].info].type > unitType)
                     unitType = unitInfo[unit[i].info].type;
             }
@@ -237,24 +241,19 @@ void inputPlayScreen() {
                         if (getGameType() == SINGLEPLAYER) { // immediately place, be nice
                             if (playScreenTouchModifier == PSTM_PLACE_STRUCTURE) {
                                 if (addStructure(FRIENDLY, getViewCurrentX() + touchPlaceStructure.px/16, getViewCurrentY() + touchPlaceStructure.py/16, getStructuresQueue(FRIENDLY)[queueNrPlaceStructure].itemInfo, 0) != -1) {
+                                    recordReplayCommand(RC_PLACE_STRUCTURE, queueNrPlaceStructure, getViewCurrentX() + touchPlaceStructure.px/16, getViewCurrentY() + touchPlaceStructure.py/16);
                                     removeItemStructuresQueueNr(FRIENDLY, queueNrPlaceStructure, 0, 0);
                                     playScreenTouchModifier = PSTM_NONE;
                                 } else
                                     playSoundeffect(SE_CANNOT);
                             } else {
-                                environment.layout[TILE_FROM_XY(unit[queueNrPlaceStructure].x, unit[queueNrPlaceStructure].y)].contains_unit = -1;
-                                if ((i = addStructure(FRIENDLY, unit[queueNrPlaceStructure].x, unit[queueNrPlaceStructure].y, unitInfo[unit[queueNrPlaceStructure].info].contains_structure, 1)) != -1) {
-                                    if (structure[i].armour != INFINITE_ARMOUR) {
-                                        structure[i].armour = (structure[i].armour * 3) / 4;
+                                if ((i = deployUnit(queueNrPlaceStructure)) != -1) {
+                                    recordReplayCommand(RC_DEPLOY_UNIT, queueNrPlaceStructure, 0, 0);
+                                    if (structure[i].armour != INFINITE_ARMOUR)
                                         structure[i].selected = 1;
-                                    }
-                                    unit[queueNrPlaceStructure].armour = 0;
-                                    unit[queueNrPlaceStructure].selected = 0;
                                     playScreenTouchModifier = PSTM_NONE;
-                                } else {
-                                    environment.layout[TILE_FROM_XY(unit[queueNrPlaceStructure].x, unit[queueNrPlaceStructure].y)].contains_unit = queueNrPlaceStructure;
+                                } else
                                     playSoundeffect(SE_CANNOT);
-                                }
                             }
                         }/* else { // queue it for placing
                             requestAddStructure(FRIENDLY, getViewCurrentX() + touchPlaceStructure.px/16, getViewCurrentY() + touchPlaceStructure.py/16, getStructuresQueue(FRIENDLY)[queueNrPlaceStructure].itemInfo, 0);
@@ -269,8 +268,8 @@ void inputPlayScreen() {
                     } else if (touchXY.px >= 16 && touchXY.px < 32) { // sell structure
                         if (getGameType() == SINGLEPLAYER) { // immediately sell, be nice
                             if (structure[sellNrStructure].armour > 0) {
-                                changeCredits(FRIENDLY, ((structure[sellNrStructure].armour * structureInfo[structure[sellNrStructure].info].build_cost) / structureInfo[structure[sellNrStructure].info].max_armour) / 2);
-                                structure[sellNrStructure].armour = 0;
+                                recordReplayCommand(RC_SELL_STRUCTURE, sellNrStructure, 0, 0);
+                                sellStructure(sellNrStructure);
                             }
                             playScreenTouchModifier = PSTM_NONE;
     /*TODO: MULTIPLAYER CODE!!! */
@@ -290,6 +289,7 @@ void inputPlayScreen() {
                                             structure[i].logic--;
                                         else
                                             structure[i].logic++;
+                                        recordReplayStructureOrder(i);
                                     }
                                     playSoundeffect(SE_BUTTONCLICK);
                                 }
@@ -297,9 +297,11 @@ void inputPlayScreen() {
                                 //if (structureInfo[structure[i].info].release_tile >= 0) {
                                 if (structure[i].rally_tile >= 0) {
                                     structure[i].primary = 1;
+                                    recordReplayStructureOrder(i);
                                     for (j=0; j<MAX_STRUCTURES_ON_MAP; j++) {
                                         if (j!=i && structure[j].primary && structure[j].info == structure[i].info && structure[j].side == structure[i].side && structure[j].enabled) {
                                             structure[j].primary = 0;
+                                            recordReplayStructureOrder(j);
                                             break;
                                         }
                                     }
@@ -382,16 +384,20 @@ void inputPlayScreen() {
                                 } else if (j == 3) { // make unit selection guard
                                     if (getGameType() == SINGLEPLAYER) {
                                         for (j=i; j<MAX_UNITS_ON_MAP; j++) {
-                                            if (unit[j].selected && unit[j].enabled && unit[j].side == FRIENDLY)
+                                            if (unit[j].selected && unit[j].enabled && unit[j].side == FRIENDLY) {
                                                 unit[j].logic = UL_GUARD;
+                                                recordReplayUnitOrder(j);
+                                            }
                                         }
                                     }
                                     playSoundeffect(SE_BUTTONCLICK);
                                 } else if (j == 5) { // make unit selection retreat
                                     if (getGameType() == SINGLEPLAYER) {
                                         for (j=i; j<MAX_UNITS_ON_MAP; j++) {
-                                            if (unit[j].selected && unit[j].enabled && unit[j].side == FRIENDLY)
+                                            if (unit[j].selected && unit[j].enabled && unit[j].side == FRIENDLY) {
                                                 unit[j].logic = UL_RETREAT;
+                                                recordReplayUnitOrder(j);
+                                            }
                                         }
                                     }
                                     playSoundeffect(SE_BUTTONCLICK);
@@ -421,6 +427,7 @@ void inputPlayScreen() {
         if ((getKeysOnUp() & KEY_TOUCH) && getKeysHeldTimeMax(KEY_TOUCH) < (FPS/4)) { // could be a tap to place structure here
             if (getGameType() == SINGLEPLAYER) { // immediately place, be nice
                 if (addStructure(FRIENDLY, getViewCurrentX() + touchPlaceStructure.px/16, getViewCurrentY() + touchPlaceStructure.py/16, getStructuresQueue(FRIENDLY)[queueNrPlaceStructure].itemInfo, 0) != -1) {
+                    recordReplayCommand(RC_PLACE_STRUCTURE, queueNrPlaceStructure, getViewCurrentX() + touchPlaceStructure.px/16, getViewCurrentY() + touchPlaceStructure.py/16);
                     removeItemStructuresQueueNr(FRIENDLY, queueNrPlaceStructure, 0, 0);
                     playScreenTouchModifier = PSTM_NONE;
                 } else
@@ -447,18 +454,13 @@ void inputPlayScreen() {
         if ((getKeysOnUp() & KEY_TOUCH) && getKeysHeldTimeMax(KEY_TOUCH) < (FPS/4)) {
             if (touchXY.px/16 == touchPlaceStructure.px/16 && touchXY.py/16 == (touchPlaceStructure.py/16 + ACTION_BAR_SIZE)) { // could be a tap to place structure here
                 if (getGameType() == SINGLEPLAYER) { // immediately place, be nice
-                    environment.layout[TILE_FROM_XY(unit[queueNrPlaceStructure].x, unit[queueNrPlaceStructure].y)].contains_unit = -1;
-                    if ((i = addStructure(FRIENDLY, unit[queueNrPlaceStructure].x, unit[queueNrPlaceStructure].y, unitInfo[unit[queueNrPlaceStructure].info].contains_structure, 1)) != -1) {
-                        structure[i].armour = (structure[i].armour * 3) / 4;
+                    if ((i = deployUnit(queueNrPlaceStructure)) != -1) {
+                        recordReplayCommand(RC_DEPLOY_UNIT, queueNrPlaceStructure, 0, 0);
                         if (structure[i].armour != INFINITE_ARMOUR)
                             structure[i].selected = 1;
-                        unit[queueNrPlaceStructure].armour = 0;
-                        unit[queueNrPlaceStructure].selected = 0;
                         playScreenTouchModifier = PSTM_NONE;
-                    } else {
-                        environment.layout[TILE_FROM_XY(unit[queueNrPlaceStructure].x, unit[queueNrPlaceStructure].y)].contains_unit = queueNrPlaceStructure;
+                    } else
                         playSoundeffect(SE_CANNOT);
-                    }
                 }
             } else
                 playScreenTouchModifier = PSTM_NONE;
@@ -594,6 +596,7 @@ void inputPlayScreen() {
                 for (i=0; i<MAX_STRUCTURES_ON_MAP; i++) {
                     if (structure[i].selected && structure[i].side == FRIENDLY && structure[i].enabled) {
                         structure[i].rally_tile = tile;
+                        recordReplayStructureOrder(i);
                         playSoundeffect(SE_BUTTONCLICK);
                         break;
                     }
@@ -724,10 +727,11 @@ void inputPlayScreen() {
                                             unit[i].logic = UL_ATTACK_LOCATION;
                                             unit[i].group = (unit[i].group & (~UGAI_FRIENDLY_MASK)) | UGAI_ATTACK_FORCED;
                                         }
-                                        unit[i].logic_aid = tile;
+                                        setUnitLogicAid(unit + i, tile);
                                         #ifdef REMOVE_ASTAR_PATHFINDING
                                         unit[i].hugging_obstacle = 0;
                                         #endif
+                                        recordReplayUnitOrder(i);
                                         if (unitType == 255 || unitInfo[unit[i].info].type > unitType)
                                             unitType = unitInfo[unit[i].info].type;
                                     }
@@ -772,16 +776,17 @@ void inputPlayScreen() {
                                         if (unit[i].selected) {
                                             if (!unitInfo[unit[i].info].shoot_range) {
                                                 unit[i].logic = UL_MOVE_LOCATION;
-                                                unit[i].logic_aid = tile;
+                                                setUnitLogicAid(unit + i, tile);
                                             } else {
                                                 graphicalActionIssued = GAI_ATTACK_UNIT;
                                                 unit[i].logic = UL_ATTACK_UNIT;
-                                                unit[i].logic_aid = unit_t;
+                                                setUnitLogicAid(unit + i, unit_t);
                                                 unit[i].group = (unit[i].group & (~UGAI_FRIENDLY_MASK)) | UGAI_ATTACK_FORCED;
                                             }
                                             #ifdef REMOVE_ASTAR_PATHFINDING
                                             unit[i].hugging_obstacle = 0;
                                             #endif
+                                            recordReplayUnitOrder(i);
                                             if (unitType == 255 || unitInfo[unit[i].info].type > unitType)
                                                 unitType = unitInfo[unit[i].info].type;
                                         }
@@ -891,12 +896,13 @@ void inputPlayScreen() {
                                         if (unit[i].selected) {
                                             unit[i].logic = logic;
                                             if (logic == UL_RETREAT)
-                                                unit[i].retreat_tile = tile;
+                                                setUnitRetreatTile(unit + i, tile);
                                             else
-                                                unit[i].logic_aid = tile;
+                                                setUnitLogicAid(unit + i, tile);
                                             #ifdef REMOVE_ASTAR_PATHFINDING
                                             unit[i].hugging_obstacle = 0;
                                             #endif
+                                            recordReplayUnitOrder(i);
                                             if (unitType == 255 || unitInfo[unit[i].info].type > unitType)
                                                 unitType = unitInfo[unit[i].info].type;
                                         }
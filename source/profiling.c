@@ -1,12 +1,14 @@
 // SPDX-License-Identifier: MIT
 // Copyright © 2007-2025 Sander Stolk
 
+// Profiles functions by keeping a record of each call in a ring buffer in memory.
+// Nothing is written to file until flushProfiling is called, so that the
+// profiler hardly influences the timings it measures.
+
 #include "profiling.h"
 
 #ifdef PROFILING_ENABLED
 
-#define FUNCTION_START_OUTPUT_ENABLED
-
 #include <nds.h>
 #include <string.h>
 #include <stdio.h>
@@ -14,105 +16,120 @@
 #include "debug.h"
 
 struct ProfilingTimer {
-    char function_name[32];
-/*  u16 vcount_self;
-    u16 vcount_added;*/
+    u16 name;
     unsigned ticks_start;
 };
 
 struct ProfilingTimer profilingTimer[MAX_PROFILER_DEPTH];
 int profilerDepth = -1;
-FILE *profilingFP;
-/*bool profilerBusy = 1;*/
+
+char profilingName[MAX_PROFILER_NAMES][MAX_PROFILER_NAME_LENGTH];
+int amountOfProfilingNames;
+
+struct ProfilingRecord profilingRecord[PROFILER_RECORDS];
+unsigned amountOfProfilingRecords; // total amount ever added, including those overwritten since
+unsigned profilingFrame;
+
+
+// the names are kept once profiling started anew, as the call sites keep the index they looked up
+u16 getProfilingName(char *name) {
+    int i;
+
+    for (i=0; i<amountOfProfilingNames; i++) {
+        if (!strncmp(profilingName[i], name, MAX_PROFILER_NAME_LENGTH-1))
+            return i;
+    }
+    if (amountOfProfilingNames == MAX_PROFILER_NAMES)
+        errorSI("Too many different names are being profiled. Limit is:", MAX_PROFILER_NAMES);
+    strncpy(profilingName[amountOfProfilingNames], name, MAX_PROFILER_NAME_LENGTH-1);
+    return amountOfProfilingNames++;
+}
+
+void addProfilingRecord(u16 name, int depth, enum ProfilingRecordType type, unsigned start, unsigned end) {
+    struct ProfilingRecord *record = &profilingRecord[amountOfProfilingRecords % PROFILER_RECORDS];
+
+    record->name  = name;
+    record->depth = depth;
+    record->type  = type;
+    record->frame = profilingFrame;
+    record->start = start;
+    record->end   = end;
+    amountOfProfilingRecords++;
+}
 
 #endif
 
 
 
-inline void startProfilingFunction(char *name) {
+inline void startProfilingFunctionOfName(u16 name) {
     #ifdef PROFILING_ENABLED
     profilerDepth++;
+    if (profilerDepth >= MAX_PROFILER_DEPTH)
+        errorSI("Profiled functions are nested too deep. Limit is:", MAX_PROFILER_DEPTH);
     struct ProfilingTimer *current = &profilingTimer[profilerDepth];
-    strncpy(current->function_name, name, 32-1);
+    current->name = name;
     current->ticks_start = getGameticks();
-    #ifdef FUNCTION_START_OUTPUT_ENABLED
-    fprintf(profilingFP, "%i. ", profilerDepth);
-    fprintf(profilingFP, current->function_name);
-    fprintf(profilingFP, "\n");
-    #endif
     #endif
 }
 
-inline void stopProfilingFunction() {    
+inline void stopProfilingFunction() {
     #ifdef PROFILING_ENABLED
     struct ProfilingTimer *current = &profilingTimer[profilerDepth];
-    unsigned gameticks = getGameticks();
-    
-    fprintf(profilingFP, "%i. ", profilerDepth);
-    fprintf(profilingFP, current->function_name);
-    if (gameticks == 0 || current->ticks_start == 0)
-        fprintf(profilingFP, " || ticks: unknown\n");
-    else {
-        fprintf(profilingFP, " || ticks: %u\n", gameticks - current->ticks_start);
-        
-        if (gameticks < current->ticks_start) {
-            fprintf(profilingFP, "-- end of file\n\n");
-            fclose(profilingFP);
-            errorSI("Currently measured gameticks at the end of a function was smaller than the gameticks measured at the start of the function. See profiling log. Gameticks:", getGameticks());
-        }
-    }
-    
-//    int i;
-//    if (gameticks - current->ticks_start > 1000000) {
-//        if (!strncmp(current->function_name, "doOverlayLogic", 14)) {
-//            char gameticks_string[8*sizeof(unsigned)+1];
-//            gameticks_string[8*sizeof(unsigned)] = 0;
-//            for (i=0; i<8*sizeof(unsigned); i++) {
-//                gameticks_string[(8*sizeof(unsigned)-1)-i] = (gameticks & BIT(i)) ? '1' : '0';
-//            }
-//            
-//            char start_string[8*sizeof(unsigned)+1];
-//            start_string[8*sizeof(unsigned)] = 0;
-//            for (i=0; i<8*sizeof(unsigned); i++) {
-//                start_string[(8*sizeof(unsigned)-1)-i] = (current->ticks_start & BIT(i)) ? '1' : '0';
-//            }
-//            
-//            fprintf(profilingFP, "ticks_start was %u or b%s\n", current->ticks_start, start_string);
-//            fprintf(profilingFP, "gameticks   was %u or b%s\n", gameticks, gameticks_string);
-//        }
-//    }
-    
+
+    // gameticks of 0 mean they could not be measured; these are kept, and skipped when converting
+    addProfilingRecord(current->name, profilerDepth, PR_FUNCTION, current->ticks_start, getGameticks());
     profilerDepth--;
     #endif
 }
 
-inline void addProfilingInformation(char *info) {
+inline void addProfilingInformationOfName(u16 info, int value) {
     #ifdef PROFILING_ENABLED
-    fprintf(profilingFP, "--- %s\n", info);
+    addProfilingRecord(info, profilerDepth + 1, PR_INFO, getGameticks(), value);
     #endif
 }
 
-inline void addProfilingInformationInt(char *info, int value) {
+// to be called at the start of every frame, before anything is profiled
+inline void startProfilingFrame() {
     #ifdef PROFILING_ENABLED
-    fprintf(profilingFP, "--- %s [value: %i]\n", info, value);
+    profilingFrame++;
     #endif
 }
 
 inline void startProfiling() {
     #ifdef PROFILING_ENABLED
-    profilingFP = fopen(PROFILER_FILEPATH, "wb");
-    if (!profilingFP)
-        error("Could not create profiling file", "");
-/*  profilerBusy = 0;*/
+    profilerDepth = -1;
+    amountOfProfilingRecords = 0;
+    profilingFrame = 0;
     #endif
 }
 
-inline void stopProfiling() {
+// writes the records currently in the ring buffer to file. profiling continues afterwards
+inline void flushProfiling() {
     #ifdef PROFILING_ENABLED
-/*  profilerBusy = 1;*/
-    // ignoring all functions which are still being profiled at this point
-    fprintf(profilingFP, "-- end of file\n\n");
-    fclose(profilingFP);
-    error("Stopped profiling", "");
+    struct ProfilingHeader header;
+    FILE *fp;
+    unsigned first;
+
+    fp = fopen(PROFILER_FILEPATH, "wb");
+    if (!fp)
+        error("Could not create profiling file", PROFILER_FILEPATH);
+
+    header.magic              = PROFILER_MAGIC;
+    header.version            = PROFILER_VERSION;
+    header.gameticksPerFrame  = GAMETICKS_PER_FRAME * (SCREEN_REFRESH_RATE / FPS);
+    header.amountOfNames      = amountOfProfilingNames;
+    header.amountOfRecords    = (amountOfProfilingRecords < PROFILER_RECORDS) ? amountOfProfilingRecords : PROFILER_RECORDS;
+    header.recordsOverwritten = amountOfProfilingRecords - header.amountOfRecords;
+    fwrite(&header, sizeof(struct ProfilingHeader), 1, fp);
+    fwrite(profilingName, MAX_PROFILER_NAME_LENGTH, amountOfProfilingNames, fp);
+
+    // oldest records first
+    if (header.recordsOverwritten) {
+        first = amountOfProfilingRecords % PROFILER_RECORDS;
+        fwrite(&profilingRecord[first], sizeof(struct ProfilingRecord), PROFILER_RECORDS - first, fp);
+        fwrite(profilingRecord, sizeof(struct ProfilingRecord), first, fp);
+    } else
+        fwrite(profilingRecord, sizeof(struct ProfilingRecord), header.amountOfRecords, fp);
+    fclose(fp);
     #endif
 }
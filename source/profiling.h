@@ -9,16 +9,72 @@
 //#define PROFILING_ENABLED
 #endif
 
-#define MAX_PROFILER_DEPTH  100
-#define PROFILER_FILEPATH   "/rts4ds_profiling.txt"
+#define MAX_PROFILER_DEPTH        100
+#define MAX_PROFILER_NAMES        256
+#define MAX_PROFILER_NAME_LENGTH  32
+#define PROFILER_RECORDS          4096 /* ring buffer; once full, the oldest records are overwritten */
+#define PROFILER_FILEPATH         "/rts4ds_profiling.bin"
+#define PROFILER_MAGIC            0x46505452 // "RTPF"
+#define PROFILER_VERSION          1
 
-void startProfilingFunction(char *name);
+// profiling trace file: a ProfilingHeader, followed by amountOfNames names of
+// MAX_PROFILER_NAME_LENGTH characters each, followed by amountOfRecords
+// ProfilingRecords ordered from oldest to newest.
+// use host/trace.c (rts4ds-trace) to convert it to Chrome trace JSON or folded stacks.
+
+enum ProfilingRecordType {
+    PR_FUNCTION, // start and end hold the gameticks at which the function started and stopped
+    PR_INFO      // start holds the gameticks at which the information was added, end holds its value
+};
+
+struct ProfilingHeader {
+    int magic;
+    int version;
+    unsigned gameticksPerFrame;
+    unsigned amountOfNames;
+    unsigned amountOfRecords;
+    unsigned recordsOverwritten;
+};
+
+struct ProfilingRecord {
+    u16 name;  // index into the names
+    u8 depth;
+    u8 type;   // enum ProfilingRecordType
+    unsigned frame;
+    unsigned start; // gameticks since the start of the frame
+    unsigned end;   // gameticks since the start of the frame
+};
+
+// a name is looked up once per call site, the first time it is reached. from then on only its index is passed on
+#ifdef PROFILING_ENABLED
+#define startProfilingFunction(name) \
+    do { static int profilingNameOfCallSite = -1; \
+         if (profilingNameOfCallSite < 0) profilingNameOfCallSite = getProfilingName(name); \
+         startProfilingFunctionOfName(profilingNameOfCallSite); } while (0)
+#define addProfilingInformation(info) \
+    do { static int profilingNameOfCallSite = -1; \
+         if (profilingNameOfCallSite < 0) profilingNameOfCallSite = getProfilingName(info); \
+         addProfilingInformationOfName(profilingNameOfCallSite, 0); } while (0)
+#define addProfilingInformationInt(info, value) \
+    do { static int profilingNameOfCallSite = -1; \
+         if (profilingNameOfCallSite < 0) profilingNameOfCallSite = getProfilingName(info); \
+         addProfilingInformationOfName(profilingNameOfCallSite, value); } while (0)
+#else
+#define startProfilingFunction(name)             do { } while (0)
+#define addProfilingInformation(info)            do { } while (0)
+#define addProfilingInformationInt(info, value)  do { } while (0)
+#endif
+
+// the index of the name, added to the names if it is new
+u16 getProfilingName(char *name);
+void startProfilingFunctionOfName(u16 name);
 void stopProfilingFunction();
 
-void addProfilingInformation(char *info);
-void addProfilingInformationInt(char *info, int value);
+void addProfilingInformationOfName(u16 info, int value);
+
+void startProfilingFrame();
 
 void startProfiling();
-void stopProfiling();
+void flushProfiling();
 
 #endif
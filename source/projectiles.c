@@ -15,9 +15,13 @@
 #include "factions.h"
 #include "soundeffects.h"
 #include "rumble.h"
+#include "entitypool.h"
+#include "lineoffire.h"
+#include "distancefields.h"
 
 struct ProjectileInfo projectileInfo[MAX_DIFFERENT_PROJECTILES];
 struct Projectile projectile[MAX_PROJECTILES_ON_MAP];
+static struct EntityPool projectilePool;
 
 unsigned int projectileImpassableOverEnvironment[(NUMBER_OF_ENVIRONMENT_TILE_GRAPHICS + 31) / 32];
 
@@ -172,10 +176,26 @@ void initProjectilesWithScenario() {
     
     for (i=0; i<MAX_PROJECTILES_ON_MAP; i++, curProjectile++)
         curProjectile->enabled = 0;
+    initProjectilePool();
     
     initProjectilesSpeed();
 }
 
+void initProjectilePool() {
+    int i;
+    
+    initEntityPool(&projectilePool, MAX_PROJECTILES_ON_MAP);
+    for (i=0; i<MAX_PROJECTILES_ON_MAP; i++) {
+        if (projectile[i].enabled)
+            useEntityPoolEntry(&projectilePool, i);
+    }
+}
+
+static void disableProjectile(struct Projectile *curProjectile) {
+    curProjectile->enabled = 0;
+    freeEntityPoolEntry(&projectilePool, curProjectile - projectile);
+}
+
 
 // has some tan(X) * 1000 values hardcoded.
 enum ProjectilePositioned positionProjectileToFace(int curX, int curY, int tgtX, int tgtY) {
@@ -210,38 +230,37 @@ enum ProjectilePositioned positionProjectileToFace(int curX, int curY, int tgtX,
 int addProjectile(enum Side side, int curX, int curY, int tgtX, int tgtY, int info, int shot) {
     int i;
     int absDX, absDY;
-    struct Projectile *curProjectile = projectile;
+    struct Projectile *curProjectile;
     
     if (info < 0) // a unit or structure which has no weapon tried to create a new projectile
         return -1;
     
-    for (i=0; i<MAX_PROJECTILES_ON_MAP; i++, curProjectile++) {
-        if (!curProjectile->enabled) {
-            curProjectile->enabled = 1;
-            curProjectile->info = info;
-            curProjectile->side = side;
-            if (projectileInfo[info].type >= PT_ROCKET)
-                curProjectile->positioned = positionProjectileToFace(curX, curY, tgtX, tgtY);
-            curProjectile->src_x = curX * 16 + 8;
-            curProjectile->src_y = curY * 16 + 8;
-            curProjectile->tgt_x = tgtX * 16 + 8;
-            curProjectile->tgt_y = tgtY * 16 + 8;
-            curProjectile->x = curProjectile->src_x;
-            curProjectile->y = curProjectile->src_y;
-            absDX = abs(tgtX - curX) * 16;
-            absDY = abs(tgtY - curY) * 16;
-            curProjectile->time_required = square_root(absDX*absDX + absDY*absDY) / projectileInfo[info].speed;
-            curProjectile->timer = 0;
-            playSoundeffectControlled(SE_PROJECTILE + 2*info + shot, volumePercentageOfLocation(curX, curY, DISTANCE_TO_HALVE_SE_PROJECTILE), soundeffectPanningOfLocation(curX, curY));
-            
-            if (curX >= getViewCurrentX() && curX < getViewCurrentX() + HORIZONTAL_WIDTH &&
-                curY >= getViewCurrentY() && curY < getViewCurrentY() + HORIZONTAL_HEIGHT)
-                addRumble(5, 1);
-            
-            return i;
-        }
-    }
-    return -1;
+    if ((i = getFreeEntityPoolEntry(&projectilePool, 0)) < 0)
+        return -1;
+    curProjectile = projectile + i;
+    useEntityPoolEntry(&projectilePool, i);
+    curProjectile->enabled = 1;
+    curProjectile->info = info;
+    curProjectile->side = side;
+    if (projectileInfo[info].type >= PT_ROCKET)
+        curProjectile->positioned = positionProjectileToFace(curX, curY, tgtX, tgtY);
+    curProjectile->src_x = curX * 16 + 8;
+    curProjectile->src_y = curY * 16 + 8;
+    curProjectile->tgt_x = tgtX * 16 + 8;
+    curProjectile->tgt_y = tgtY * 16 + 8;
+    curProjectile->x = curProjectile->src_x;
+    curProjectile->y = curProjectile->src_y;
+    absDX = abs(tgtX - curX) * 16;
+    absDY = abs(tgtY - curY) * 16;
+    curProjectile->time_required = square_root(absDX*absDX + absDY*absDY) / projectileInfo[info].speed;
+    curProjectile->timer = 0;
+    playSoundeffectControlled(SE_PROJECTILE + 2*info + shot, volumePercentageOfLocation(curX, curY, DISTANCE_TO_HALVE_SE_PROJECTILE), soundeffectPanningOfLocation(curX, curY));
+    
+    if (curX >= getViewCurrentX() && curX < getViewCurrentX() + HORIZONTAL_WIDTH &&
+        curY >= getViewCurrentY() && curY < getViewCurrentY() + HORIZONTAL_HEIGHT)
+        addRumble(5, 1);
+    
+    return i;
 }
 
 
@@ -251,7 +270,7 @@ void drawProjectiles() {
     int x, y, graphics;
     int hflip, vflip;
     int lowX, highX, lowY, highY;
-    struct Projectile *curProjectile = projectile;
+    struct Projectile *curProjectile;
     struct ProjectileInfo *curProjectileInfo;
     
     lowX  = getViewCurrentX() * 16;
@@ -259,8 +278,9 @@ void drawProjectiles() {
     lowY  = getViewCurrentY() * 16;
     highY = (getViewCurrentY() + HORIZONTAL_HEIGHT) * 16;
     
-    for (i=0; i<MAX_PROJECTILES_ON_MAP; i++, curProjectile++) {
-        if (curProjectile->enabled && projectileInfo[curProjectile->info].graphics_size > 0 &&
+    FOR_EACH_USED_ENTITY_POOL_ENTRY(&projectilePool, i) {
+        curProjectile = projectile + i;
+        if (projectileInfo[curProjectile->info].graphics_size > 0 &&
             curProjectile->x >= lowX && curProjectile->x < highX &&
             curProjectile->y >= lowY && curProjectile->y < highY) {
             // bullet needs to be displayed
@@ -347,7 +367,7 @@ void doProjectileImpact(struct Projectile *curProjectile, struct ProjectileInfo
                     playSoundeffect(SE_IMPACT_UNIT);
             }
         }
-        curProjectile->enabled = 0;
+        disableProjectile(curProjectile);
     } else if (environmentLayout->contains_structure != -1) { // might have hit a structure
         structureId = environmentLayout->contains_structure;
         if (structureId < -1) // it was just a reference to a structure ID
@@ -407,7 +427,7 @@ void doProjectileImpact(struct Projectile *curProjectile, struct ProjectileInfo
                                         if (unit[j].side != FRIENDLY) {
                                             if (unit[j].group == UGAI_HUNT) {
                                                 unit[j].logic = UL_HUNT;
-                                                unit[j].logic_aid = 0;
+                                                setUnitLogicAid(unit + j, 0);
                                             } else if (unit[j].group == UGAI_KAMIKAZE)
                                                 unit[j].logic = UL_KAMIKAZE;
                                         }
@@ -417,6 +437,8 @@ void doProjectileImpact(struct Projectile *curProjectile, struct ProjectileInfo
                             // remove it from map
                             environment.layout[tile].contains_structure = -1;
                             setTileDirtyRadarDirtyBitmap(tile);
+                            invalidateLinesOfFire();
+                            removeDistanceFieldsStructure(structure[structureId].side);
                             addExplosion(curProjectile->x / 16, curProjectile->y / 16, structureInfo[structure[structureId].info].destroyed_explosion_info, 0);
                             // set it back to existing again for reuse by other locations
                             structure[structureId].armour = 1;
@@ -432,7 +454,7 @@ void doProjectileImpact(struct Projectile *curProjectile, struct ProjectileInfo
                     }
                 }
             }
-            curProjectile->enabled = 0;
+            disableProjectile(curProjectile);
         }
     } else { // maybe sand or rock was hit?
 /*        if (environmentLayout->graphics >= ROCKCHASM && environmentLayout->graphics <= ROCKCHASM16)
@@ -445,7 +467,7 @@ void doProjectileImpact(struct Projectile *curProjectile, struct ProjectileInfo
                 addOverlay(curProjectile->x / 16, curProjectile->y / 16, OT_ROCK_SHOT, 0);
             else if ((environmentLayout->graphics >= SANDCHASM && environmentLayout->graphics <= SANDCHASM16) || (environmentLayout->graphics >= ROCKCHASM && environmentLayout->graphics <= ROCKCHASM16) || environmentLayout->graphics >= CHASMCUSTOM)
                 playSoundeffectControlled(SE_IMPACT_SAND, volumePercentageOfLocation(curProjectile->x / 16, curProjectile->y / 16, DISTANCE_TO_HALVE_SE_IMPACT_SAND), soundeffectPanningOfLocation(curProjectile->x / 16, curProjectile->y / 16));
-            curProjectile->enabled = 0;
+            disableProjectile(curProjectile);
         }
     }
 }
@@ -465,11 +487,33 @@ inline unsigned int getProjectileImpassableOverEnvironment(enum EnvironmentTileG
 
 
 
+enum Side getSideShootingFromTile(int curX, int curY) {
+    // the side shooting is that of whatever is on the tile shot from
+    struct EnvironmentLayout *envTile = environment.layout + TILE_FROM_XY(curX, curY);
+    if (envTile->contains_unit >= 0)
+        return unit[envTile->contains_unit].side;
+    if (envTile->contains_structure < -1)
+        return structure[(envTile + (envTile->contains_structure + 1))->contains_structure].side;
+    return structure[envTile->contains_structure].side;
+}
+
 int isClearPathProjectile(int curX, int curY, int projectile_info, int tgtX, int tgtY) {
     // no projectile never affected code before, shouldn't now either. stating it as clear path.
     if (projectile_info <= -1)
         return 1;
     
+    // aerial projectiles always have a clear path
+    if (projectileInfo[projectile_info].type & 1)
+        return 1;
+    
+    return isClearPathProjectileOfSide(curX, curY, getSideShootingFromTile(curX, curY), projectile_info, tgtX, tgtY);
+}
+
+int isClearPathProjectileOfSide(int curX, int curY, enum Side side, int projectile_info, int tgtX, int tgtY) {
+    // no projectile never affected code before, shouldn't now either. stating it as clear path.
+    if (projectile_info <= -1)
+        return 1;
+    
     // aerial projectiles always have a clear path
     struct ProjectileInfo *curProjectileInfo = projectileInfo + projectile_info;
     if (curProjectileInfo->type & 1)
@@ -493,55 +537,69 @@ int isClearPathProjectile(int curX, int curY, int projectile_info, int tgtX, int
     if (targetStructure < -1)
         targetStructure = (envTile + (targetStructure + 1))->contains_structure;
     
-    envTile = environment.layout + TILE_FROM_XY(curX, curY);
-    enum Side side;
-    int originStructure = envTile->contains_unit < 0; // used as boolean here
-    if (!originStructure)
-        side = unit[envTile->contains_unit].side;
-    else {
-        if (envTile->contains_structure < -1)
-            side = structure[(envTile + (envTile->contains_structure + 1))->contains_structure].side;
-        else
-            side = structure[envTile->contains_structure].side;
-    }
-    
     curX = curX*16 + 8;
     curY = curY*16 + 8;
     tgtX = tgtX*16 + 8;
     tgtY = tgtY*16 + 8;
     
+    // the distance covered, (tgt - cur) * timer / time_required, grows by the same quotient and remainder every
+    // timer tick, so that it is added to rather than divided anew
+    int travelledX = 0, travelledXRemainder = 0, stepX = 0, stepXRemainder = 0;
+    int travelledY = 0, travelledYRemainder = 0, stepY = 0, stepYRemainder = 0;
+    int travelledMajor, travelledMinor, steppedMinor, steppedMinorRemainder, stepMinor = 0, stepMinorRemainder = 0;
+    if (time_required > 1) {
+        stepX = absDX / time_required;
+        stepXRemainder = absDX % time_required;
+        stepY = absDY / time_required;
+        stepYRemainder = absDY % time_required;
+    }
+    
     for (timer=1; timer<time_required; timer++) {
+        travelledX += stepX;
+        travelledXRemainder += stepXRemainder;
+        if (travelledXRemainder >= time_required) {
+            travelledXRemainder -= time_required;
+            travelledX++;
+        }
+        travelledY += stepY;
+        travelledYRemainder += stepYRemainder;
+        if (travelledYRemainder >= time_required) {
+            travelledYRemainder -= time_required;
+            travelledY++;
+        }
+        
+        // the axis travelled along most is stepped PROJECTILE_MAXIMUM_COLISSION_STEP pixels at a time, and the other
+        // one by the same quotient and remainder every step, rather than divided anew
+        travelledMajor = (travelledX > travelledY) ? travelledX : travelledY;
+        travelledMinor = (travelledX > travelledY) ? travelledY : travelledX;
+        steppedMinor = 0;
+        steppedMinorRemainder = 0;
+        if (travelledMajor > PROJECTILE_MAXIMUM_COLISSION_STEP) {
+            stepMinor = (travelledMinor * PROJECTILE_MAXIMUM_COLISSION_STEP) / travelledMajor;
+            stepMinorRemainder = (travelledMinor * PROJECTILE_MAXIMUM_COLISSION_STEP) % travelledMajor;
+        }
         
         step = 1; // multiple steps might be needed to have proper colission detection on each tile 
         do {
             done = 1; // assuming the current (colission) step will suffice for the current projectile
-            xdiff = ((tgtX - curX) * timer) / time_required;
-            ydiff = ((tgtY - curY) * timer) / time_required;
-            if (abs(xdiff) > abs(ydiff)) {
-                if (abs(xdiff) > step * PROJECTILE_MAXIMUM_COLISSION_STEP) {
-                    if (ydiff >= 0)
-                        ydiff = (ydiff * (step * PROJECTILE_MAXIMUM_COLISSION_STEP)) / abs(xdiff);
-                    else
-                        ydiff = - ((abs(ydiff) * (step * PROJECTILE_MAXIMUM_COLISSION_STEP)) / abs(xdiff));
-                    if (xdiff >= 0)
-                        xdiff = step * PROJECTILE_MAXIMUM_COLISSION_STEP;
-                    else
-                        xdiff = - step * PROJECTILE_MAXIMUM_COLISSION_STEP;
-                    done = 0;
+            if (travelledMajor > step * PROJECTILE_MAXIMUM_COLISSION_STEP) {
+                steppedMinor += stepMinor;
+                steppedMinorRemainder += stepMinorRemainder;
+                if (steppedMinorRemainder >= travelledMajor) {
+                    steppedMinorRemainder -= travelledMajor;
+                    steppedMinor++;
                 }
+                xdiff = (travelledX > travelledY) ? step * PROJECTILE_MAXIMUM_COLISSION_STEP : steppedMinor;
+                ydiff = (travelledX > travelledY) ? steppedMinor : step * PROJECTILE_MAXIMUM_COLISSION_STEP;
+                done = 0;
             } else {
-                if (abs(ydiff) > step * PROJECTILE_MAXIMUM_COLISSION_STEP) {
-                    if (xdiff >= 0)
-                        xdiff = (xdiff * (step * PROJECTILE_MAXIMUM_COLISSION_STEP)) / abs(ydiff);
-                    else
-                        xdiff = - ((abs(xdiff) * (step * PROJECTILE_MAXIMUM_COLISSION_STEP)) / abs(ydiff));
-                    if (ydiff >= 0)
-                        ydiff = step * PROJECTILE_MAXIMUM_COLISSION_STEP;
-                    else
-                        ydiff = - step * PROJECTILE_MAXIMUM_COLISSION_STEP;
-                    done = 0;
-                }
+                xdiff = travelledX;
+                ydiff = travelledY;
             }
+            if (tgtX < curX)
+                xdiff = -xdiff;
+            if (tgtY < curY)
+                ydiff = -ydiff;
             x = curX + xdiff;
             y = curY + ydiff;
             
@@ -601,12 +659,13 @@ void doProjectilesLogic() {
     int maxsquared;
     int done, step;
     enum EnvironmentTileGraphics environmentTileGraphics;
-    struct Projectile *curProjectile = projectile;
+    struct Projectile *curProjectile;
     struct ProjectileInfo *curProjectileInfo;
     
     startProfilingFunction("doProjectilesLogic");
     
-    for (i=0; i<MAX_PROJECTILES_ON_MAP; i++, curProjectile++) {
+    FOR_EACH_USED_ENTITY_POOL_ENTRY(&projectilePool, i) {
+        curProjectile = projectile + i;
         if (curProjectile->enabled) {
             projectileStructureHitAmount = 0;
             curProjectileInfo = projectileInfo + curProjectile->info;
@@ -656,49 +715,49 @@ void doProjectilesLogic() {
                         for (k=1; k<=curProjectileInfo->explosion_radius; k++) {
                             if ((curProjectile->x = x - (k*16)) > 0) {
                                 doProjectileImpact(curProjectile, curProjectileInfo, structure, structureInfo, unit, unitInfo);
-                                addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, rand()%6);
+                                addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, randLogic()%6);
                             }
                             if ((curProjectile->x = x + (k*16)) < environment.width * 16) {
                                 doProjectileImpact(curProjectile, curProjectileInfo, structure, structureInfo, unit, unitInfo);
-                                addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, rand()%6);
+                                addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, randLogic()%6);
                             }
                         }
                         for (j=1; j<=curProjectileInfo->explosion_radius; j++) {
                             if ((curProjectile->y = y - (j*16)) > 0) {
                                 curProjectile->x = x;
                                 doProjectileImpact(curProjectile, curProjectileInfo, structure, structureInfo, unit, unitInfo);
-                                addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, rand()%6);
+                                addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, randLogic()%6);
                                 maxsquared = curProjectileInfo->explosion_radius*curProjectileInfo->explosion_radius - j*j;
                                 for (k=1; k*k <= maxsquared; k++) {
                                     if ((curProjectile->x = x - (k*16)) > 0) {
                                         doProjectileImpact(curProjectile, curProjectileInfo, structure, structureInfo, unit, unitInfo);
-                                        addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, rand()%6);
+                                        addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, randLogic()%6);
                                     }
                                     if ((curProjectile->x = x + (k*16)) < environment.width * 16) {
                                         doProjectileImpact(curProjectile, curProjectileInfo, structure, structureInfo, unit, unitInfo);
-                                        addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, rand()%6);
+                                        addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, randLogic()%6);
                                     }
                                 }
                             }
                             if ((curProjectile->y = y + (j*16)) < environment.height * 16) {
                                 curProjectile->x = x;
                                 doProjectileImpact(curProjectile, curProjectileInfo, structure, structureInfo, unit, unitInfo);
-                                addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, rand()%6);
+                                addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, randLogic()%6);
                                 maxsquared = curProjectileInfo->explosion_radius*curProjectileInfo->explosion_radius - j*j;
                                 for (k=1; k*k <= maxsquared; k++) {
                                     if ((curProjectile->x = x - (k*16)) > 0) {
                                         doProjectileImpact(curProjectile, curProjectileInfo, structure, structureInfo, unit, unitInfo);
-                                        addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, rand()%6);
+                                        addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, randLogic()%6);
                                     }
                                     if ((curProjectile->x = x + (k*16)) < environment.width * 16) {
                                         doProjectileImpact(curProjectile, curProjectileInfo, structure, structureInfo, unit, unitInfo);
-                                        addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, rand()%6);
+                                        addExplosion(curProjectile->x, curProjectile->y, curProjectileInfo->explosion_info, randLogic()%6);
                                     }
                                 }
                             }
                         }
                     }
-                    curProjectile->enabled = 0;
+                    disableProjectile(curProjectile);
                     done = 1;
                 } else if ((curProjectileInfo->type == PT_SHOT || curProjectileInfo->type == PT_BULLET) && (abs(curProjectile->x - curProjectile->src_x) >= 16 || abs(curProjectile->y - curProjectile->src_y) >= 16) &&
                             (environment.layout[TILE_FROM_XY(curProjectile->x/16, curProjectile->y/16)].contains_unit <= -1 || (!unit[environment.layout[TILE_FROM_XY(curProjectile->x/16, curProjectile->y/16)].contains_unit].side != !curProjectile->side))) {
@@ -61,6 +61,8 @@ struct Projectile {
 void setProjectileImpassableOverEnvironment(unsigned graphics, unsigned int impassable);
 void initProjectiles();
 void initProjectilesWithScenario();
+// (re)builds the pool of projectiles in use from their enabled flags, e.g. after a savegame was loaded
+void initProjectilePool();
 int addProjectile(enum Side side, int curX, int curY, int tgtX, int tgtY, int info, int shot);
 
 void drawProjectiles();
@@ -69,7 +71,11 @@ void loadProjectilesGraphicsSprites(int *offsetSp);
 
 void doProjectilesLogic();
 
+// the side of the unit or structure on the tile, whose shot a line of fire from there is
+enum Side getSideShootingFromTile(int curX, int curY);
 int isClearPathProjectile(int curX, int curY, int projectile_info, int tgtX, int tgtY);
+// the same, for a shot by the given side from a tile that need not hold the one shooting
+int isClearPathProjectileOfSide(int curX, int curY, enum Side side, int projectile_info, int tgtX, int tgtY);
 
 extern struct ProjectileInfo projectileInfo[];
 extern struct Projectile projectile[];
@@ -566,7 +566,7 @@ void initRadar() {
     
     radarStructureInfo = -1;
     for (i=0; i<MAX_DIFFERENT_STRUCTURES; i++) {
-        if (!strncmp("Radar", structureInfo[i].name, strlen(structureInfo[i].name))) {
+        if (!strncmp("Radar", structureInfoText[i].name, strlen(structureInfoText[i].name))) {
             radarStructureInfo = i;
             break;
         }
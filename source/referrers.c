@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Referrers: when a unit or structure was destroyed, every unit and structure
+// was read to find those still attacking or guarding it, and every unit to
+// find the ore collectors retreating to a destroyed refinery. With a base
+// being destroyed, many of those searches fall in the same frames.
+//
+// Instead, the units and structures are kept listed by the unit or tile they
+// target, and the units by the tile they retreat to, so that only those
+// referring to what was destroyed are gone through. A referrer is listed by
+// the value of its field, whatever its logic, and those going through the
+// list still check the logic as before, so nothing is missed when the logic
+// changes while the value remains.
+
+#include "referrers.h"
+
+#include "debug.h"
+
+
+void initReferrers(struct Referrers *referrers, int keys) {
+    int i;
+
+    #ifdef DEBUG_BUILD
+    if (keys > MAX_REFERRER_KEYS)
+        errorSI("Too many keys to list referrers by. Limit is:", MAX_REFERRER_KEYS);
+    #endif
+    referrers->keys = keys;
+    for (i=0; i<MAX_REFERRER_KEYS; i++)
+        referrers->first[i] = 0;
+    for (i=0; i<MAX_REFERRERS; i++) {
+        referrers->next[i] = 0;
+        referrers->previous[i] = 0;
+        referrers->key[i] = 0;
+    }
+}
+
+void setReferrerKey(struct Referrers *referrers, int referrer, int key) {
+    int listed = referrers->key[referrer];
+
+    if ((unsigned int) key >= (unsigned int) referrers->keys)
+        key = -1;
+    if (listed == key + 1)
+        return;
+
+    // take it out of the list it was in
+    if (listed) {
+        if (referrers->previous[referrer])
+            referrers->next[referrers->previous[referrer] - 1] = referrers->next[referrer];
+        else
+            referrers->first[listed - 1] = referrers->next[referrer];
+        if (referrers->next[referrer])
+            referrers->previous[referrers->next[referrer] - 1] = referrers->previous[referrer];
+    }
+
+    // and put it first in the list of its key
+    referrers->key[referrer] = key + 1;
+    referrers->previous[referrer] = 0;
+    if (key >= 0) {
+        referrers->next[referrer] = referrers->first[key];
+        if (referrers->first[key])
+            referrers->previous[referrers->first[key] - 1] = referrer + 1;
+        referrers->first[key] = referrer + 1;
+    } else
+        referrers->next[referrer] = 0;
+}
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _REFERRERS_H_
+#define _REFERRERS_H_
+
+#include <nds.h>
+
+#include "environment.h"
+
+// keeps entities of one kind (the referrers) listed by the value of one of their fields, e.g. the unit or tile a unit
+// targets, so that those referring to a certain unit, structure or tile are gone through without reading every one.
+// the field is to be changed through setReferrerKey only, or the lists are to be rebuilt afterwards. referrers holding
+// a value outside of 0..keys-1 aren't listed. a zeroed struct Referrers has no referrer listed
+#define MAX_REFERRERS       300                     /* of one kind */
+#define MAX_REFERRER_KEYS   MAX_TILES_ENVIRONMENT
+
+struct Referrers {
+    int keys;
+    s16 first[MAX_REFERRER_KEYS];                   /* per key, the first referrer listed +1, 0 if none */
+    s16 next[MAX_REFERRERS];                        /* per referrer, the next one listed by the same key +1, 0 if none */
+    s16 previous[MAX_REFERRERS];                    /* per referrer, the previous one listed by the same key +1, 0 if none */
+    s16 key[MAX_REFERRERS];                         /* per referrer, the key it's listed by +1, 0 if not listed */
+};
+
+// lists none of the referrers
+void initReferrers(struct Referrers *referrers, int keys);
+void setReferrerKey(struct Referrers *referrers, int referrer, int key);
+
+static inline int getFirstReferrer(struct Referrers *referrers, int key) {
+    return ((unsigned int) key < (unsigned int) referrers->keys) ? referrers->first[key] - 1 : -1;
+}
+
+static inline int getNextReferrer(struct Referrers *referrers, int referrer) {
+    return referrers->next[referrer] - 1;
+}
+
+// goes through the referrers listed by the key, in no particular order. the referrer gone through may be listed anew
+// meanwhile: it isn't met again by the same key, but it is when listed by another key gone through later on
+#define FOR_EACH_REFERRER(referrers, key, referrer, nextReferrer) \
+    for (referrer = getFirstReferrer(referrers, key); \
+         referrer >= 0 && ((nextReferrer = getNextReferrer(referrers, referrer)), 1); \
+         referrer = nextReferrer)
+
+#endif
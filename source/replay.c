@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Records the commands given by the player, each stamped with the logic frame it
+// was given in, so that a game can be fed back into the game logic later on. The
+// logic's random state is stored along. Path searches are run for as long as the
+// time within a frame allows, so the frames in which time ran out are recorded
+// as well, with how far the searches got; played back, they get exactly as far.
+// With the same commands, random numbers and searches, the outcome is identical.
+
+#include "replay.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "game.h"
+#include "settings.h"
+#include "factions.h"
+#include "structures.h"
+#include "units.h"
+#include "pathfinding.h"
+#include "info.h"
+#include "debug.h"
+
+
+enum ReplayMode replayMode = RM_NONE;
+unsigned int replayFrame;
+int replayGameSpeed;
+int replayPaused;
+struct ReplayHeader replayHeader;
+struct ReplayCommand replayNextCommand;
+int replayNextCommandAvailable;
+FILE *replayFP;
+
+
+void recordReplayCommandParams(enum ReplayCommandType type, int nr, int param0, int param1, int param2, int param3) {
+    struct ReplayCommand command;
+    
+    if (replayMode != RM_RECORDING)
+        return;
+    
+    command.frame = replayFrame;
+    command.type = type;
+    command.nr = nr;
+    command.param[0] = param0;
+    command.param[1] = param1;
+    command.param[2] = param2;
+    command.param[3] = param3;
+    fwrite(&command, sizeof(struct ReplayCommand), 1, replayFP);
+    fflush(replayFP); // a game is often ended by switching off the DS
+}
+
+void recordReplayCommand(enum ReplayCommandType type, int nr, int param0, int param1) {
+    recordReplayCommandParams(type, nr, param0, param1, 0, 0);
+}
+
+void recordReplayUnitOrder(int nr) {
+    struct Unit *curUnit = &unit[nr];
+    recordReplayCommandParams(RC_UNIT_ORDER, nr, curUnit->logic, curUnit->logic_aid, curUnit->retreat_tile, curUnit->group);
+}
+
+void recordReplayStructureOrder(int nr) {
+    struct Structure *curStructure = &structure[nr];
+    recordReplayCommandParams(RC_STRUCTURE_ORDER, nr, curStructure->logic, curStructure->primary, curStructure->rally_tile, 0);
+}
+
+
+void applyReplayCommand(struct ReplayCommand *command) {
+    struct Unit *curUnit;
+    struct Structure *curStructure;
+    
+    switch (command->type) {
+        case RC_UNIT_ORDER:
+            curUnit = &unit[command->nr];
+            curUnit->logic        = command->param[0];
+            setUnitLogicAid(curUnit, command->param[1]);
+            setUnitRetreatTile(curUnit, command->param[2]);
+            curUnit->group        = command->param[3];
+            #ifdef REMOVE_ASTAR_PATHFINDING
+            curUnit->hugging_obstacle = 0;
+            #endif
+            break;
+        case RC_STRUCTURE_ORDER:
+            curStructure = &structure[command->nr];
+            curStructure->logic      = command->param[0];
+            curStructure->primary    = command->param[1];
+            curStructure->rally_tile = command->param[2];
+            break;
+        case RC_ADD_QUEUE_ITEM:
+            if (command->nr)
+                addItemStructuresQueue(FRIENDLY, command->param[0], command->param[1]);
+            else
+                addItemUnitsQueue(FRIENDLY, command->param[0], command->param[1]);
+            break;
+        case RC_REMOVE_QUEUE_ITEM:
+            if (command->nr)
+                removeItemStructuresQueueNr(FRIENDLY, command->param[0], 1, 0);
+            else
+                removeItemUnitsQueueNr(FRIENDLY, command->param[0], 1, 0);
+            break;
+        case RC_REMOVE_QUEUE_ITEM_WITH_INFO:
+            if (command->nr)
+                removeItemStructuresQueueWithInfo(FRIENDLY, command->param[0], 1, 0);
+            else
+                removeItemUnitsQueueWithInfo(FRIENDLY, command->param[0], 1, 0);
+            break;
+        case RC_TOGGLE_PAUSE_QUEUE_ITEM:
+            if (command->nr)
+                togglePauseItemStructuresQueueNr(FRIENDLY, command->param[0]);
+            else
+                togglePauseItemUnitsQueueNr(FRIENDLY, command->param[0]);
+            break;
+        case RC_PLACE_STRUCTURE:
+            if (addStructure(FRIENDLY, command->param[0], command->param[1], getStructuresQueue(FRIENDLY)[command->nr].itemInfo, 0) != -1)
+                removeItemStructuresQueueNr(FRIENDLY, command->nr, 0, 0);
+            break;
+        case RC_DEPLOY_UNIT:
+            deployUnit(command->nr);
+            break;
+        case RC_SELL_STRUCTURE:
+            sellStructure(command->nr);
+            break;
+        case RC_CHANGE_CREDITS:
+            changeCredits(FRIENDLY, command->param[0]);
+            break;
+        case RC_GAME_SPEED:
+            setGameSpeed(command->param[0]);
+            break;
+        case RC_PAUSE:
+            replayPaused = 1;
+            break;
+        case RC_PATHFINDING_CUT_SHORT:
+            setPathfindingSearchBudget(command->param[0]);
+            break;
+        default:
+            errorSI("Replay contains an unknown command:", command->type);
+    }
+}
+
+void readReplayNextCommand() {
+    replayNextCommandAvailable = (fread(&replayNextCommand, sizeof(struct ReplayCommand), 1, replayFP) == 1);
+}
+
+
+// to be called once every logic frame, after the player's input was handled and before any logic is done
+void doReplayLogic() {
+    replayPaused = 0;
+    
+    if (replayMode == RM_RECORDING) {
+        if (getGameSpeed() != replayGameSpeed) {
+            replayGameSpeed = getGameSpeed();
+            recordReplayCommand(RC_GAME_SPEED, 0, replayGameSpeed, 0);
+        }
+    } else if (replayMode == RM_PLAYBACK) {
+        while (replayNextCommandAvailable && replayNextCommand.frame <= replayFrame) {
+            applyReplayCommand(&replayNextCommand);
+            readReplayNextCommand();
+        }
+    }
+}
+
+// to be called once every logic frame, after all logic was done
+void advanceReplayFrame() {
+    replayFrame++;
+}
+
+// whether the player opened the ingame menu during the frame played back, which means pathfinding was skipped
+int isReplayPaused() {
+    return replayPaused;
+}
+
+
+enum ReplayMode getReplayMode() {
+    return replayMode;
+}
+
+unsigned int getReplayFrame() {
+    return replayFrame;
+}
+
+inline struct ReplayHeader *getReplayHeader() {
+    return &replayHeader;
+}
+
+
+// to be called after the logic's random state was initialized, but before the scenario is
+void startReplayRecording() {
+    #ifdef REPLAY_RECORDING_ENABLED
+    stopReplay();
+    
+    replayHeader.magic     = REPLAY_MAGIC;
+    replayHeader.version   = REPLAY_VERSION;
+    replayHeader.faction   = getFaction(FRIENDLY);
+    replayHeader.level     = getLevel();
+    replayHeader.region    = getRegion();
+    replayHeader.gamespeed = getGameSpeed();
+    replayHeader.dsiMode   = isDSiMode();
+    replayHeader.randState = *getRandState();
+    
+    replayFP = fopen(REPLAY_FILEPATH, "wb");
+    if (!replayFP)
+        error("Could not create replay file", REPLAY_FILEPATH);
+    fwrite(&replayHeader, sizeof(struct ReplayHeader), 1, replayFP);
+    
+    replayMode = RM_RECORDING;
+    replayFrame = 0;
+    replayGameSpeed = replayHeader.gamespeed;
+    #endif
+}
+
+// sets up faction, level, region, game speed and random state as they were at the start of the replay.
+// the scenario should be initialized afterwards. returns 0 in case of FAILURE
+int startReplayPlayback(char *filename) {
+    stopReplay();
+    
+    replayFP = fopen(filename, "rb");
+    if (!replayFP)
+        return 0;
+    if (fread(&replayHeader, sizeof(struct ReplayHeader), 1, replayFP) != 1 ||
+        replayHeader.magic != REPLAY_MAGIC || replayHeader.version != REPLAY_VERSION) {
+        fclose(replayFP);
+        replayFP = 0;
+        return 0;
+    }
+    
+    setFaction(FRIENDLY, replayHeader.faction);
+    setLevel(replayHeader.level);
+    setRegion(replayHeader.region);
+    setGameSpeed(replayHeader.gamespeed);
+    *getRandState() = replayHeader.randState;
+    
+    replayMode = RM_PLAYBACK;
+    replayFrame = 0;
+    readReplayNextCommand();
+    return 1;
+}
+
+void stopReplay() {
+    if (replayFP)
+        fclose(replayFP);
+    replayFP = 0;
+    replayMode = RM_NONE;
+}
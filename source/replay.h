@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#include "shared.h"
+#ifdef DEBUG_BUILD
+#define REPLAY_RECORDING_ENABLED
+#endif
+
+#define REPLAY_FILEPATH   "/rts4ds_replay.bin"
+#define REPLAY_MAGIC      0x50525452 // "RTRP"
+#define REPLAY_VERSION    2
+
+enum ReplayMode { RM_NONE, RM_RECORDING, RM_PLAYBACK };
+
+enum ReplayCommandType {
+    RC_UNIT_ORDER,                 // nr: unit.             param: logic, logic_aid, retreat_tile, group
+    RC_STRUCTURE_ORDER,            // nr: structure.        param: logic, primary, rally_tile
+    RC_ADD_QUEUE_ITEM,             // nr: is structure.     param: item info, builder info
+    RC_REMOVE_QUEUE_ITEM,          // nr: is structure.     param: queue nr
+    RC_REMOVE_QUEUE_ITEM_WITH_INFO,// nr: is structure.     param: item info
+    RC_TOGGLE_PAUSE_QUEUE_ITEM,    // nr: is structure.     param: queue nr
+    RC_PLACE_STRUCTURE,            // nr: queue nr.         param: x, y
+    RC_DEPLOY_UNIT,                // nr: unit
+    RC_SELL_STRUCTURE,             // nr: structure
+    RC_CHANGE_CREDITS,             //                       param: amount
+    RC_GAME_SPEED,                 //                       param: speed
+    RC_PAUSE,                      // the ingame menu was opened, pathfinding was skipped this frame
+    RC_PATHFINDING_CUT_SHORT       //                       param: the times the searches were allowed to continue
+};
+
+struct ReplayHeader {
+    int magic;
+    int version;
+    int faction;
+    int level;
+    int region;
+    int gamespeed;
+    int dsiMode;
+    struct RandState randState;
+};
+
+struct ReplayCommand {
+    unsigned int frame;
+    u16 type;
+    u16 nr;
+    int param[4];
+};
+
+void recordReplayCommand(enum ReplayCommandType type, int nr, int param0, int param1);
+void recordReplayUnitOrder(int nr);
+void recordReplayStructureOrder(int nr);
+
+void doReplayLogic();
+void advanceReplayFrame();
+int isReplayPaused();
+
+enum ReplayMode getReplayMode();
+unsigned int getReplayFrame();
+struct ReplayHeader *getReplayHeader();
+
+void startReplayRecording();
+int startReplayPlayback(char *filename);
+void stopReplay();
+
+#endif
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Ring searches: the nearest enemy unit or structure to attack, the nearest
+// ore and the nearest structure to build next to were each found by walking
+// the rings around a tile in the same order, with the bounds of the map tested
+// for every tile along the way.
+//
+// Instead, the order is kept in a table of offsets, ring after ring, and one
+// search goes through it with a test for the tiles. The bounds of the map are
+// only tested for the rings that cross an edge of the map. The tiles are gone
+// through in the order they always were, so the same tile is found.
+
+#include "ringsearch.h"
+
+struct RingOffset ringOffset[RING_SEARCH_FIRST_OF_RING(RING_SEARCH_MAX_RADIUS + 1)];
+static bool ringOffsetsMade = false;
+
+
+static inline void addRingOffset(int *i, int x, int y) {
+    ringOffset[*i].x = x;
+    ringOffset[*i].y = y;
+    (*i)++;
+}
+
+void initRingSearchWithScenario() {
+    int i = 0;
+    int r, k;
+
+    // the order is the same for every map
+    if (ringOffsetsMade)
+        return;
+    for (r=1; r<=RING_SEARCH_MAX_RADIUS; r++) {
+        // the middle tiles of the bottom row, right column, left column and top row
+        addRingOffset(&i,  0,  r);
+        addRingOffset(&i,  r,  0);
+        addRingOffset(&i, -r,  0);
+        addRingOffset(&i,  0, -r);
+        // the tiles k away from those, in the same order
+        for (k=1; k<r; k++) {
+            addRingOffset(&i,  k,  r);
+            addRingOffset(&i, -k,  r);
+            addRingOffset(&i,  r,  k);
+            addRingOffset(&i,  r, -k);
+            addRingOffset(&i, -r,  k);
+            addRingOffset(&i, -r, -k);
+            addRingOffset(&i,  k, -r);
+            addRingOffset(&i, -k, -r);
+        }
+        // the corner tiles
+        addRingOffset(&i,  r,  r);
+        addRingOffset(&i, -r,  r);
+        addRingOffset(&i,  r, -r);
+        addRingOffset(&i, -r, -r);
+    }
+    ringOffsetsMade = true;
+}
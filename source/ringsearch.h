@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _RINGSEARCH_H_
+#define _RINGSEARCH_H_
+
+#include <nds.h>
+#include <stdlib.h>
+
+#include "environment.h"
+#include "shared.h"
+
+// a search for the nearest tile to satisfy a test goes through the tiles around the tile searched from ring by ring,
+// ring r being the tiles r tiles away horizontally, vertically or both. within a ring, tiles nearer by Manhattan
+// distance come first. the order of the tiles is kept in a table, made once
+#define RING_SEARCH_MAX_RADIUS      63      /* the rings that fit in a map of the largest size */
+
+struct RingOffset {
+    s8 x;
+    s8 y;
+};
+
+extern struct RingOffset ringOffset[];
+
+// the index in ringOffset of the first tile of ring r
+#define RING_SEARCH_FIRST_OF_RING(r)    ((2*(r) - 1) * (2*(r) - 1) - 1)
+
+void initRingSearchWithScenario();
+
+// returns the first result of test other than -1, of the tiles around curTile within the given radius, or -1 if
+// there is none. a radius of RING_SEARCH_MAX_RADIUS covers the whole map. if distance is given, it is set to the
+// Manhattan distance of the tile the result is of. the rings before firstRadius are skipped
+static inline int searchRingsFrom(int curTile, int firstRadius, int radius, int (*test)(int tile, void *data), void *data, int *distance) {
+    int x = X_FROM_TILE(curTile);
+    int y = Y_FROM_TILE(curTile);
+    struct RingOffset *offset, *end;
+    int r, result;
+
+    radius = min(radius, min(max(environment.width, environment.height) - 1, RING_SEARCH_MAX_RADIUS));
+    for (r=max(firstRadius, 1); r<=radius; r++) {
+        offset = ringOffset + RING_SEARCH_FIRST_OF_RING(r);
+        end    = ringOffset + RING_SEARCH_FIRST_OF_RING(r + 1);
+        if (x - r >= 0 && x + r < environment.width && y - r >= 0 && y + r < environment.height) {
+            // the ring lies within the map as a whole
+            for (; offset<end; offset++) {
+                if ((result = test(curTile + offset->y * environment.width + offset->x, data)) >= 0)
+                    break;
+            }
+        } else {
+            for (; offset<end; offset++) {
+                if ((unsigned int) (x + offset->x) >= (unsigned int) environment.width ||
+                    (unsigned int) (y + offset->y) >= (unsigned int) environment.height)
+                    continue;
+                if ((result = test(curTile + offset->y * environment.width + offset->x, data)) >= 0)
+                    break;
+            }
+        }
+        if (offset < end) {
+            if (distance)
+                *distance = abs(offset->x) + abs(offset->y);
+            return result;
+        }
+    }
+    return -1;
+}
+
+static inline int searchRings(int curTile, int radius, int (*test)(int tile, void *data), void *data, int *distance) {
+    return searchRingsFrom(curTile, 1, radius, test, data, distance);
+}
+
+#endif
@@ -11,6 +11,12 @@
 #include "factions.h"
 
 #include "environment.h"
+#include "shroud.h"
+#include "bitboards.h"
+#include "lineoffire.h"
+#include "ringsearch.h"
+#include "distancefields.h"
+#include "influence.h"
 #include "overlay.h"
 #include "structures.h"
 #include "units.h"
@@ -21,6 +27,10 @@
 #include "timedtriggers.h"
 #include "view.h"
 #include "pathfinding.h"
+#include "pathclusters.h"
+#include "pathregions.h"
+#include "firingpositions.h"
+#include "avoidance.h"
 //#include "ingame_briefing.h"
 
 #include "info.h"
@@ -30,8 +40,9 @@
 #include "playscreen.h"
 #include "infoscreen.h"
 #include "music.h"
+#include "replay.h"
 
-#define TEMPAREA_SIZE  (64*64*20+12)
+#define TEMPAREA_SIZE  (sizeof(struct Environment))  /* the largest block */
 
 enum SaveGameBlockHeaders { 
     SGBH_ENVIRONMENT,
@@ -46,6 +57,7 @@ enum SaveGameBlockHeaders {
     SGBH_STRUCTUREOBJECTIVES,SGBH_UNITOBJECTIVES,SGBH_RESOURCEOBJECTIVES,
 //    SGBH_INGAMEBRIEFING,               // cannot pause (and therefore not save) when an ingame briefing is playing
     SGBH_PATHFINDINGS,
+    SGBH_RANDSTATE,
     /*  add other blocks here  */
     SGBH_STATS,
     SGBH_NUMBLOCKS
@@ -69,6 +81,10 @@ int saveGameLoadHeader(struct SavegameHeader *header, int slot) {
         // an entire SaveGameHeader was indeed read in, but the savegame is empty
         return 0;
     }
+    if (res && header->version != SAVEGAME_VERSION) {
+        // the savegame was made by another version, with blocks of another layout
+        return 0;
+    }
     return(res);
 }
 
@@ -144,6 +160,9 @@ int saveGameWriteBlock(int head, void *temp, FILE *fp) {
         case SGBH_PATHFINDINGS:
             size=getPathFindingsSaveData(temp,TEMPAREA_SIZE);
             break;
+        case SGBH_RANDSTATE:
+            size=getRandStateSaveData(temp,TEMPAREA_SIZE);
+            break;
         
         // add others here...
         
@@ -193,6 +212,7 @@ int saveGame(int slot) {
         header=temparea;
         dataSaveGameRadar(header->radar.image);
         dataSaveGameInfo(&header->info);
+        header->version=SAVEGAME_VERSION;
         res=fwrite(header,sizeof(struct SavegameHeader),1,fp);
         if (res==0) {
             free(temparea);
@@ -305,6 +325,10 @@ int saveGameReadBlock(int head, int blocksize, FILE *fp) {
             size=getPathFindingsSaveSize();
             dest=getPathFindings();
             break;    
+        case SGBH_RANDSTATE:
+            size=getRandStateSaveSize();
+            dest=getRandState();
+            break;
         
         // add others here...
         case SGBH_STATS:
@@ -351,7 +375,7 @@ int loadGame(int slot) {
     
     // read header
     res=fread(header,sizeof(struct SavegameHeader),1,fp);
-    if (res==0) {
+    if (res==0 || header->version!=SAVEGAME_VERSION) {
         free(header);
         #ifdef DEBUG_BUILD
 //        error("can't correctly load savegame header", "");      // BETA!
@@ -381,6 +405,9 @@ int loadGame(int slot) {
     
     // header no longer needed
     free(header);
+    
+    // a loaded game cannot be replayed from the start of its scenario
+    stopReplay();
 
     
     // read blocks from file (copy memory from snapshot)
@@ -413,6 +440,25 @@ int loadGame(int slot) {
     fclose(fp);
     
     createBarStructures(); // make sure to recreate this.
+    initUnitGrid();
+    initUnitReferrers();
+    initStructureReferrers();
+    initProjectilePool();
+    initExplosionPool();
+    initOverlayPool();
+    initBitboardsWithScenario();
+    initLinesOfFireWithScenario();
+    initRingSearchWithScenario();
+    initDistanceFieldsWithScenario();
+    initInfluenceWithScenario();
+    initShroudWithScenario(); // the whole map needs redrawing
+    #ifndef REMOVE_ASTAR_PATHFINDING
+    initPathClustersWithScenario();
+    initPathRegionsWithScenario();
+    initFiringPositionsWithScenario();
+    initAvoidanceWithScenario();
+    cancelPathfindingSearches();
+    #endif
     
     return 1;   // savegame loaded successfully!
 }
@@ -4,6 +4,11 @@
 #ifndef _SAVEGAME_H_
 #define _SAVEGAME_H_
 
+// to be increased whenever the layout of the header or of any block changes. a savegame of another version is refused
+// rather than converted. those made before the version was kept, with the wider blocks of the environment, units,
+// structures and paths, hold a 0 where the version is now: the ID of the first block
+#define SAVEGAME_VERSION  1
+
 struct SavegameHeader_radar {
     unsigned short image[64*64];       // 64x64 15bpp image   ( 8 KB )
 };
@@ -28,6 +33,7 @@ struct SavegameHeader_info {
 struct SavegameHeader {
     struct SavegameHeader_radar radar;
     struct SavegameHeader_info info;
+    int version;               // SAVEGAME_VERSION
     // do we need padding?
 };
 
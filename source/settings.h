@@ -56,6 +56,7 @@ void setFactionMedalReceived(int factionInfo, enum Medal medal);
 
 
 
+void createDefaultSaveFile();
 void readSaveFile();
 void writeSaveFile();
 void clearProgress();
@@ -3,10 +3,16 @@
 
 #include "shared.h"
 
+#include <string.h>
+
+#include "environment.h"
 #include "structures.h"
 #include "units.h"
 #include "view.h"
 #include "radar.h"
+#include "shroud.h"
+#include "bitboards.h"
+#include "lineoffire.h"
 #include "settings.h"
 #include "soundeffects.h"
 #include "inputx.h"
@@ -43,14 +49,22 @@ inline int max(int lh, int rh) {
     return (lh > rh) ? lh : rh;
 }
 
+// the root a bit at a time, in as many steps for any value. it gives what the search for the first i with i*i >= value
+// that this used to be gave: one less than the root rounded up, and half the value below 8
 inline int square_root(int value) {
-    int i;
-    
-    for (i=0; i<value/2; i++) {
-        if (i*i >= value)
-            return (i == 0) ? 0 : i-1;
-    }
-    return value/2;
+    unsigned int remainder, root = 0, bit;
+    
+    if (value < 8)
+        return value/2;
+    remainder = value - 1;
+    for (bit=1u<<30; bit; bit>>=2) {
+        if (remainder >= root + bit) {
+            remainder -= root + bit;
+            root = (root >> 1) + bit;
+        } else
+            root >>= 1;
+    }
+    return root;
 }
 
 
@@ -86,33 +100,51 @@ int withinShootRange(int curX, int curY, int range, int projectile_info, int tgt
     if (!withinRange(curX, curY, range, tgtX, tgtY))
         return 0;
     
-    if (!isClearPathProjectile(curX, curY, projectile_info, tgtX, tgtY))
+    if (!isLineOfFireClearFromTile(curX, curY, projectile_info, tgtX, tgtY))
         return 0;
     
     return 1;
 }
 
+// determines the cells of the unit grid that cover all tiles within range of curX, curY
+void getUnitGridCellsWithinRange(int curX, int curY, int range, int *cellX1, int *cellY1, int *cellX2, int *cellY2) {
+    *cellX1 = max(curX - range, 0) >> UNIT_GRID_SHIFT;
+    *cellY1 = max(curY - range, 0) >> UNIT_GRID_SHIFT;
+    *cellX2 = min(curX + range, environment.width - 1) >> UNIT_GRID_SHIFT;
+    *cellY2 = min(curY + range, environment.height - 1) >> UNIT_GRID_SHIFT;
+}
+
+// as the cells are visited in an order other than that of the unit numbers, all cells within range
+// are visited and the lowest unit number found is returned, just like a search through all units would.
 int sideUnitWithinRangeStartingAt(enum Side side, int curX, int curY, int range, int unitnr) {
-    int i = unitnr;
-    
-    for (; i<MAX_UNITS_ON_MAP; i++) {
-        if (unit[i].enabled && !unit[i].side == !side) {
-            if (withinRange(curX, curY, range, unit[i].x, unit[i].y))
-                return i;
+    int cellX1, cellY1, cellX2, cellY2;
+    int cellX, cellY;
+    int i, bestUnitNum = MAX_UNITS_ON_MAP;
+    
+    getUnitGridCellsWithinRange(curX, curY, range, &cellX1, &cellY1, &cellX2, &cellY2);
+    for (cellY=cellY1; cellY<=cellY2; cellY++) {
+        for (cellX=cellX1; cellX<=cellX2; cellX++) {
+            for (i=unitGridFirst[cellY * getUnitGridWidth() + cellX]; i>=0; i=unitGridNext[i]) {
+                if (i >= unitnr && i < bestUnitNum && !unit[i].side == !side) {
+                    if (withinRange(curX, curY, range, unit[i].x, unit[i].y))
+                        bestUnitNum = i;
+                }
+            }
         }
     }
-    return -1;
-
+    return (bestUnitNum == MAX_UNITS_ON_MAP) ? -1 : bestUnitNum;
 }
 
 int sideUnitWithinRange(enum Side side, int curX, int curY, int range) {
     return sideUnitWithinRangeStartingAt(side, curX, curY, range, 0);
 }
 
+struct RandState randState;
+
+
 int randFixed() {
   #define RANDFIXEDARRAYLEN 31
   // RANDFIXEDARRAYLEN should be a PRIME for this to perform better!
-  static int idx = 0;
   static u16 randStore[RANDFIXEDARRAYLEN] = {28379, 38924, 40223, 31191, 50039, 37195,
                                               51804, 65446, 59058,   407, 33931, 49799,
                                               25902, 65110, 39492, 65383,  8259, 29236,
@@ -120,10 +152,40 @@ int randFixed() {
                                               37226, 49546,  3957, 57633, 60420, 52254,
                                               48024};
 
-  if ((++idx)==RANDFIXEDARRAYLEN)
-    idx=0;
+  if ((++randState.fixedIdx)==RANDFIXEDARRAYLEN)
+    randState.fixedIdx=0;
+
+  return randStore[randState.fixedIdx];
+}
+
+// pseudo-random value between 0 and 32767 for use by the game logic. unlike rand(), its state
+// is known (see getRandState) so that a game can be saved and replayed exactly.
+int randLogic() {
+    randState.seed = randState.seed * 1103515245 + 12345;
+    return (randState.seed >> 16) & 0x7FFF;
+}
+
+void initRandLogic(unsigned int seed) {
+    randState.seed = seed;
+    randState.fixedIdx = 0;
+}
+
+inline struct RandState *getRandState() {
+    return &randState;
+}
+
+int getRandStateSaveSize(void) {
+    return sizeof(randState);
+}
 
-  return randStore[idx];
+int getRandStateSaveData(void *dest, int max_size) {
+    int size=sizeof(randState);
+    
+    if (size>max_size)
+        return(0);
+    
+    memcpy(dest,&randState,size);
+    return (size);
 }
 
 
@@ -160,36 +222,49 @@ int calculateDistance2(int curX, int curY, int tgtX, int tgtY) {
 
 
 int sideUnitWithinShootRange(enum Side side, int curX, int curY, int range, int projectile_info) {
-    //  linear complexity (testing units just once)
-    //  doesn't call sideUnitWithinRangeStartingAt() function )
-
+    //  only visits the units in the cells of the unit grid within range, testing each just once.
+    //  of equally close hittable units, the lowest unit number is returned
+    int cellX1, cellY1, cellX2, cellY2;
+    int cellX, cellY;
     int i, bestUnitNum = -1;
     int dist, bestDist = range * range + 1;
-  
-    for (i=0; i<MAX_UNITS_ON_MAP; i++) {
-        if (unit[i].enabled && !unit[i].side == !side) {
-            dist = calculateDistance2(curX, curY, unit[i].x, unit[i].y); 
-            if ((dist<bestDist) && isClearPathProjectile(curX, curY, projectile_info, unit[i].x, unit[i].y)) {
-                // found a closer hittable unit
-                bestDist=dist;
-                bestUnitNum=i;
+    
+    getUnitGridCellsWithinRange(curX, curY, range, &cellX1, &cellY1, &cellX2, &cellY2);
+    for (cellY=cellY1; cellY<=cellY2; cellY++) {
+        for (cellX=cellX1; cellX<=cellX2; cellX++) {
+            for (i=unitGridFirst[cellY * getUnitGridWidth() + cellX]; i>=0; i=unitGridNext[i]) {
+                if (!unit[i].side == !side) {
+                    dist = calculateDistance2(curX, curY, unit[i].x, unit[i].y);
+                    if ((dist<bestDist || (dist==bestDist && i<bestUnitNum)) && isLineOfFireClearFromTile(curX, curY, projectile_info, unit[i].x, unit[i].y)) {
+                        // found a closer hittable unit
+                        bestDist=dist;
+                        bestUnitNum=i;
+                    }
+                }
             }
         }
     }
-  
+    
     return bestUnitNum;
 }
 
 int damagedFootWithinRange(enum Side side, int curX, int curY, int range) {
-    int i;
-    
-    for (i=0; i<MAX_UNITS_ON_MAP; i++) {
-        if (unit[i].enabled && unit[i].side == side && unitInfo[unit[i].info].type == UT_FOOT && unit[i].armour < unitInfo[unit[i].info].max_armour) {
-            if (withinRange(curX, curY, range, unit[i].x, unit[i].y))
-                return i;
+    int cellX1, cellY1, cellX2, cellY2;
+    int cellX, cellY;
+    int i, bestUnitNum = MAX_UNITS_ON_MAP;
+    
+    getUnitGridCellsWithinRange(curX, curY, range, &cellX1, &cellY1, &cellX2, &cellY2);
+    for (cellY=cellY1; cellY<=cellY2; cellY++) {
+        for (cellX=cellX1; cellX<=cellX2; cellX++) {
+            for (i=unitGridFirst[cellY * getUnitGridWidth() + cellX]; i>=0; i=unitGridNext[i]) {
+                if (i < bestUnitNum && unit[i].side == side && unitInfo[unit[i].info].type == UT_FOOT && unit[i].armour < unitInfo[unit[i].info].max_armour) {
+                    if (withinRange(curX, curY, range, unit[i].x, unit[i].y))
+                        bestUnitNum = i;
+                }
+            }
         }
     }
-    return -1;
+    return (bestUnitNum == MAX_UNITS_ON_MAP) ? -1 : bestUnitNum;
 }
 
 int rotateBaseToFace(enum Positioned positioned, enum Positioned positioned_new) {
@@ -285,12 +360,16 @@ void activateEntityView(int x, int y, int width, int height, int viewRange) {
     int amountX, amountY;
     int i, j;
     
+    setShroudDirtyArea(x - viewRange - 1, y - viewRange - 1, x + width + viewRange, y + height + viewRange);
+    
     // first take care of the tiles occupied by the entity itself
     envLayout = environment.layout + TILE_FROM_XY(x,y);
     for (i=0; i<height; i++) {
         for (j=0; j<width; j++) {
-            if (envLayout->status == UNDISCOVERED)
+            if (envLayout->status == UNDISCOVERED) {
                 setTileDirtyRadarDirtyBitmap(TILE_FROM_XY(x+j, y+i));
+                setTileDiscovered(TILE_FROM_XY(x+j, y+i));
+            }
             envLayout->status = CLEAR_ALL;
             envLayout++;
         }
@@ -302,8 +381,10 @@ void activateEntityView(int x, int y, int width, int height, int viewRange) {
     for (i=0; i<width; i++) {
         envLayout = environment.layout + TILE_FROM_XY(x+i, y-1);
         for (j=0; j<amountY; j++) {
-            if (envLayout->status == UNDISCOVERED)
+            if (envLayout->status == UNDISCOVERED) {
                 setTileDirtyRadarDirtyBitmap(TILE_FROM_XY(x+i, (y-1)-j));
+                setTileDiscovered(TILE_FROM_XY(x+i, (y-1)-j));
+            }
             envLayout->status = CLEAR_ALL;
             envLayout -= environment.width;
         }
@@ -316,8 +397,10 @@ void activateEntityView(int x, int y, int width, int height, int viewRange) {
     for (i=0; i<height; i++) {
         envLayout = environment.layout + TILE_FROM_XY(x+width, y+i);
         for (j=0; j<amountX; j++) {
-            if (envLayout->status == UNDISCOVERED)
+            if (envLayout->status == UNDISCOVERED) {
                 setTileDirtyRadarDirtyBitmap(TILE_FROM_XY(x+width+j, y+i));
+                setTileDiscovered(TILE_FROM_XY(x+width+j, y+i));
+            }
             envLayout->status = CLEAR_ALL;
             envLayout++;
         }
@@ -330,8 +413,10 @@ void activateEntityView(int x, int y, int width, int height, int viewRange) {
     for (i=0; i<width; i++) {
         envLayout = environment.layout + TILE_FROM_XY(x+i, y+height);
         for (j=0; j<amountY; j++) {
-            if (envLayout->status == UNDISCOVERED)
+            if (envLayout->status == UNDISCOVERED) {
                 setTileDirtyRadarDirtyBitmap(TILE_FROM_XY(x+i, (y+height)+j));
+                setTileDiscovered(TILE_FROM_XY(x+i, (y+height)+j));
+            }
             envLayout->status = CLEAR_ALL;
             envLayout += environment.width;
         }
@@ -344,8 +429,10 @@ void activateEntityView(int x, int y, int width, int height, int viewRange) {
     for (i=0; i<height; i++) {
         envLayout = environment.layout + TILE_FROM_XY(x-1, y+i);
         for (j=0; j<amountX; j++) {
-            if (envLayout->status == UNDISCOVERED)
+            if (envLayout->status == UNDISCOVERED) {
                 setTileDirtyRadarDirtyBitmap(TILE_FROM_XY((x-1)-j, y+i));
+                setTileDiscovered(TILE_FROM_XY((x-1)-j, y+i));
+            }
             envLayout->status = CLEAR_ALL;
             envLayout--;
         }
@@ -359,8 +446,10 @@ void activateEntityView(int x, int y, int width, int height, int viewRange) {
     for (i=0; i<amountY; i++) {
         envLayout = environment.layout + TILE_FROM_XY(x+width, (y-1) - i);
         for (j=0; j<amountX && i*i + j*j <= viewRangeM2; j++) {
-            if (envLayout->status == UNDISCOVERED)
+            if (envLayout->status == UNDISCOVERED) {
                 setTileDirtyRadarDirtyBitmap(TILE_FROM_XY(x+width+j, (y-1) - i));
+                setTileDiscovered(TILE_FROM_XY(x+width+j, (y-1) - i));
+            }
             envLayout->status |= CLEAR_DOWN | CLEAR_LEFT;
             adjustShroudType(x + width + j, (y-1) - i);
             envLayout++;
@@ -372,8 +461,10 @@ void activateEntityView(int x, int y, int width, int height, int viewRange) {
     for (i=0; i<amountY; i++) {
         envLayout = environment.layout + TILE_FROM_XY(x+width, y + height + i);
         for (j=0; j<amountX && i*i + j*j <= viewRangeM2; j++) {
-            if (envLayout->status == UNDISCOVERED)
+            if (envLayout->status == UNDISCOVERED) {
                 setTileDirtyRadarDirtyBitmap(TILE_FROM_XY(x+width+j, y + height + i));
+                setTileDiscovered(TILE_FROM_XY(x+width+j, y + height + i));
+            }
             envLayout->status |= CLEAR_UP | CLEAR_LEFT;
             adjustShroudType(x + width + j, y + height + i);
             envLayout++;
@@ -385,8 +476,10 @@ void activateEntityView(int x, int y, int width, int height, int viewRange) {
     for (i=0; i<amountY; i++) {
         envLayout = environment.layout + TILE_FROM_XY(x-1, y + height + i);
         for (j=0; j<amountX && i*i + j*j <= viewRangeM2; j++) {
-            if (envLayout->status == UNDISCOVERED)
+            if (envLayout->status == UNDISCOVERED) {
                 setTileDirtyRadarDirtyBitmap(TILE_FROM_XY((x-1)-j, y + height + i));
+                setTileDiscovered(TILE_FROM_XY((x-1)-j, y + height + i));
+            }
             envLayout->status |= CLEAR_UP | CLEAR_RIGHT;
             adjustShroudType((x-1) - j, y + height + i);
             envLayout--;
@@ -398,8 +491,10 @@ void activateEntityView(int x, int y, int width, int height, int viewRange) {
     for (i=0; i<amountY; i++) {
         envLayout = environment.layout + TILE_FROM_XY(x-1, (y-1) - i);
         for (j=0; j<amountX && i*i + j*j <= viewRangeM2; j++) {
-            if (envLayout->status == UNDISCOVERED)
+            if (envLayout->status == UNDISCOVERED) {
                 setTileDirtyRadarDirtyBitmap(TILE_FROM_XY((x-1)-j, (y-1) - i));
+                setTileDiscovered(TILE_FROM_XY((x-1)-j, (y-1) - i));
+            }
             envLayout->status |= CLEAR_RIGHT | CLEAR_DOWN;
             adjustShroudType((x-1) - j, (y-1) - i);
             envLayout--;
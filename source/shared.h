@@ -37,6 +37,11 @@ enum Positioned { UP, RIGHT_UP, RIGHT, RIGHT_DOWN, DOWN, LEFT_DOWN, LEFT, LEFT_U
 
 enum GroupAI { AWAITING_REPLACEMENT = BIT(24), TECHTREE_INSUFFICIENT = BIT(25), QUEUED_FOR_REPLACEMENT = BIT(26) }; // careful! needs to be higher than any UnitGroupAI
 
+struct RandState {
+    unsigned int seed;       // state of randLogic()
+    int fixedIdx;            // position within the table used by randFixed()
+};
+
 int nrstrlen(int nr);
 
 int abs(int value);
@@ -46,6 +51,11 @@ int square_root(int value);
 
 int math_power(int base, int power);
 int randFixed();
+int randLogic();
+void initRandLogic(unsigned int seed);
+struct RandState *getRandState();
+int getRandStateSaveSize(void);
+int getRandStateSaveData(void *dest, int max_size);
 int generateRandVariation(int delta);
 int calculateDistance2(int curX, int curY, int tgtX, int tgtY);
 int withinRange(int curX, int curY, int range, int tgtX, int tgtY);
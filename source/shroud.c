@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+// Revealing the map as friendly units move, and keeping track of the area of the
+// map whose shroud changed so that drawing only needs to catch up on that area.
+//
+// The tiles activateEntityView touches for a 1x1 entity with a certain view range
+// form a fixed shape: per row, a contiguous run of tiles. Once that shape was
+// applied, its core (the tiles whose four neighbours are part of the shape too)
+// is completely clear and so are the sides of its neighbours facing it. A unit
+// stepping onto a neighbouring tile therefore only needs to apply the part of its
+// new shape that is not covered by the core of its old one.
+
+#include "shroud.h"
+
+#include "radar.h"
+#include "bitboards.h"
+#include "shared.h"
+
+
+static s8 viewRowWidth[MAX_SHROUD_VIEW_RANGE + 1][MAX_SHROUD_VIEW_RANGE + 2];     // per view range and row distance, the largest column distance of the shape. -1 if none
+static s8 viewCoreRowWidth[MAX_SHROUD_VIEW_RANGE + 1][MAX_SHROUD_VIEW_RANGE + 2]; // the same, for the core of the shape
+
+static int shroudDirtyX1, shroudDirtyY1, shroudDirtyX2, shroudDirtyY2; // inclusive; x1 > x2 when clean
+
+
+void initShroud() {
+    int viewRange, row, width, i;
+
+    for (viewRange=0; viewRange<=MAX_SHROUD_VIEW_RANGE; viewRange++) {
+        for (row=0; row<=MAX_SHROUD_VIEW_RANGE+1; row++)
+            viewRowWidth[viewRange][row] = -1;
+        // the axes reach viewRange tiles far, diagonally it's a quarter circle with radius viewRange - 1
+        // starting from the tiles next to the entity
+        viewRowWidth[viewRange][0] = viewRange;
+        for (row=1; row<=viewRange; row++) {
+            for (width=0; (row-1)*(row-1) + width*width <= (viewRange-1)*(viewRange-1); width++);
+            viewRowWidth[viewRange][row] = width;
+        }
+        for (row=0; row<=MAX_SHROUD_VIEW_RANGE+1; row++) {
+            i = viewRowWidth[viewRange][row] - 1;
+            i = min(i, viewRowWidth[viewRange][(row > 0) ? (row-1) : 1]);
+            i = min(i, viewRowWidth[viewRange][row+1 <= MAX_SHROUD_VIEW_RANGE+1 ? row+1 : row]);
+            viewCoreRowWidth[viewRange][row] = max(i, -1);
+        }
+    }
+    clearShroudDirtyArea();
+}
+
+void initShroudWithScenario() {
+    setShroudDirtyArea(0, 0, environment.width - 1, environment.height - 1);
+}
+
+
+// tile x,y is part of the shape of a 1x1 entity at entityX, entityY. the operation performed is the same as activateEntityView's
+static inline void revealViewTile(int x, int y, int entityX, int entityY, int viewRange, int adjusting) {
+    struct EnvironmentLayout *envLayout = &environment.layout[TILE_FROM_XY(x,y)];
+    int diffX = x - entityX;
+    int diffY = y - entityY;
+
+    if (!diffX || !diffY) {
+        if (abs(diffX + diffY) < viewRange) { // the entity itself or its axes
+            if (!adjusting) {
+                if (envLayout->status == UNDISCOVERED) {
+                    setTileDirtyRadarDirtyBitmap(TILE_FROM_XY(x,y));
+                    setTileDiscovered(TILE_FROM_XY(x,y));
+                }
+                envLayout->status = CLEAR_ALL;
+            }
+        } else if (adjusting) // the far end of an axis
+            adjustShroudType(x, y);
+        return;
+    }
+    if (!adjusting)
+        return;
+
+    if (envLayout->status == UNDISCOVERED) {
+        setTileDirtyRadarDirtyBitmap(TILE_FROM_XY(x,y));
+        setTileDiscovered(TILE_FROM_XY(x,y));
+    }
+    envLayout->status |= ((diffY < 0) ? CLEAR_DOWN : CLEAR_UP) | ((diffX < 0) ? CLEAR_RIGHT : CLEAR_LEFT);
+    adjustShroudType(x, y);
+}
+
+void activateUnitMoveView(int x, int y, enum UnitMove move, int viewRange) { /* x and y being the new position, not the old */
+    #ifndef DISABLE_SHROUD
+    int moveX = 0, moveY = 0;
+    int diffY, width, core;
+    int adjusting;
+    int i;
+
+    if (viewRange < 1 || viewRange > MAX_SHROUD_VIEW_RANGE) {
+        activateEntityView(x, y, 1, 1, viewRange);
+        return;
+    }
+
+    // the unit came from x - moveX, y - moveY
+    if (move >= UM_MOVE_RIGHT_UP && move <= UM_MOVE_RIGHT_DOWN)
+        moveX = 1;
+    else if (move >= UM_MOVE_LEFT_DOWN && move <= UM_MOVE_LEFT_UP)
+        moveX = -1;
+    if (move >= UM_MOVE_RIGHT_DOWN && move <= UM_MOVE_LEFT_DOWN)
+        moveY = 1;
+    else if (move == UM_MOVE_UP || move == UM_MOVE_RIGHT_UP || move == UM_MOVE_LEFT_UP)
+        moveY = -1;
+    if (!moveX && !moveY) {
+        activateEntityView(x, y, 1, 1, viewRange);
+        return;
+    }
+
+    setShroudDirtyArea(x - viewRange - 1, y - viewRange - 1, x + viewRange + 1, y + viewRange + 1);
+
+    // just like activateEntityView, the axes are cleared before the remainder is adjusted to them
+    for (adjusting=0; adjusting<=1; adjusting++) {
+        for (diffY=-viewRange; diffY<=viewRange; diffY++) {
+            if (y + diffY < 0 || y + diffY >= environment.height)
+                continue;
+            width = viewRowWidth[viewRange][abs(diffY)];
+            // the core of the shape at the previous position, expressed in columns relative to the current position
+            core = (abs(diffY + moveY) <= viewRange) ? viewCoreRowWidth[viewRange][abs(diffY + moveY)] : -1;
+            for (i=max(-width, -x); i<=width && x + i < environment.width; i++) {
+                if (core >= 0 && i + moveX >= -core && i + moveX <= core) {
+                    i = core - moveX; // skip the remainder of the core
+                    continue;
+                }
+                revealViewTile(x + i, y + diffY, x, y, viewRange, adjusting);
+            }
+        }
+    }
+    #endif
+}
+
+
+// the shroud sprite for a tile with the given status, as drawn by drawEnvironment
+u8 getShroudSprite(unsigned char status) {
+    switch (status) {
+        case UNDISCOVERED:
+            return 0;
+        case CLEAR_ALL:
+            return SHROUD_SPRITE_NONE;
+        // three sides clear
+        case (CLEAR_UP | CLEAR_RIGHT | CLEAR_DOWN):
+            return 4;
+        case (CLEAR_RIGHT | CLEAR_DOWN | CLEAR_LEFT):
+            return 5;
+        case (CLEAR_DOWN | CLEAR_LEFT | CLEAR_UP):
+            return 4 | SHROUD_SPRITE_HFLIP;
+        case (CLEAR_LEFT | CLEAR_UP | CLEAR_RIGHT):
+            return 5 | SHROUD_SPRITE_VFLIP;
+        // two sides clear
+        case (CLEAR_UP | CLEAR_RIGHT):
+            return 3;
+        case (CLEAR_RIGHT | CLEAR_DOWN):
+            return 3 | SHROUD_SPRITE_VFLIP;
+        case (CLEAR_DOWN | CLEAR_LEFT):
+            return 3 | SHROUD_SPRITE_HFLIP | SHROUD_SPRITE_VFLIP;
+        case (CLEAR_LEFT | CLEAR_UP):
+            return 3 | SHROUD_SPRITE_HFLIP;
+        // one side clear
+        case CLEAR_UP:
+            return 1;
+        case CLEAR_RIGHT:
+            return 2;
+        case CLEAR_DOWN:
+            return 1 | SHROUD_SPRITE_VFLIP;
+        case CLEAR_LEFT:
+        default: // default should not happen, but the switch statement requires it
+            return 2 | SHROUD_SPRITE_HFLIP;
+    }
+}
+
+
+// marks the given area of the map (clipped to the map) as having a changed shroud
+void setShroudDirtyArea(int x1, int y1, int x2, int y2) {
+    x1 = max(x1, 0);
+    y1 = max(y1, 0);
+    x2 = min(x2, environment.width - 1);
+    y2 = min(y2, environment.height - 1);
+    if (x1 > x2 || y1 > y2)
+        return;
+    if (shroudDirtyX1 > shroudDirtyX2) {
+        shroudDirtyX1 = x1;
+        shroudDirtyY1 = y1;
+        shroudDirtyX2 = x2;
+        shroudDirtyY2 = y2;
+        return;
+    }
+    shroudDirtyX1 = min(shroudDirtyX1, x1);
+    shroudDirtyY1 = min(shroudDirtyY1, y1);
+    shroudDirtyX2 = max(shroudDirtyX2, x2);
+    shroudDirtyY2 = max(shroudDirtyY2, y2);
+}
+
+// returns 0 if the shroud did not change since clearShroudDirtyArea was last called
+int getShroudDirtyArea(int *x1, int *y1, int *x2, int *y2) {
+    *x1 = shroudDirtyX1;
+    *y1 = shroudDirtyY1;
+    *x2 = shroudDirtyX2;
+    *y2 = shroudDirtyY2;
+    return (shroudDirtyX1 <= shroudDirtyX2);
+}
+
+void clearShroudDirtyArea() {
+    shroudDirtyX1 = 1;
+    shroudDirtyX2 = 0;
+}
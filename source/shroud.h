@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: MIT
+// Copyright © 2007-2025 Sander Stolk
+
+#ifndef _SHROUD_H_
+#define _SHROUD_H_
+
+#include "environment.h"
+#include "units.h"
+
+#define MAX_SHROUD_VIEW_RANGE  31 /* larger view ranges are handled by activateEntityView */
+
+// shroud sprites, as derived from the status of a tile. the lower bits hold the offset from the base shroud graphics
+#define SHROUD_SPRITE_NONE   0xFF
+#define SHROUD_SPRITE_HFLIP  BIT(4)
+#define SHROUD_SPRITE_VFLIP  BIT(5)
+#define SHROUD_SPRITE_GRAPHICS_MASK  0x0F
+
+void initShroud();
+void initShroudWithScenario();
+
+void activateUnitMoveView(int x, int y, enum UnitMove move, int viewRange);
+
+u8 getShroudSprite(unsigned char status);
+
+void setShroudDirtyArea(int x1, int y1, int x2, int y2);
+int getShroudDirtyArea(int *x1, int *y1, int *x2, int *y2);
+void clearShroudDirtyArea();
+
+#endif
@@ -19,10 +19,18 @@
 #include "radar.h"
 #include "soundeffects.h"
 #include "rumble.h"
+#include "pathfinding.h"
+#include "bitboards.h"
+#include "lineoffire.h"
+#include "ringsearch.h"
+#include "distancefields.h"
+#include "influence.h"
 
 
 struct StructureInfo structureInfo[MAX_DIFFERENT_STRUCTURES];
+struct StructureInfoText structureInfoText[MAX_DIFFERENT_STRUCTURES];
 struct Structure structure[MAX_STRUCTURES_ON_MAP];
+struct Referrers structuresByLogicAid;
 
 static int structure_smoke_graphics_offset = 0;
 static int structure_rally_graphics_offset;
@@ -54,14 +62,15 @@ void initStructures() {
     for (i=0; i<amountOfStructures; i++) {
         readstr(fp, oneline);
         replaceEOLwithEOF(oneline, 255);
-        strcpy(structureInfo[i].name, oneline);
+        strcpy(structureInfoText[i].name, oneline);
         structureInfo[i].enabled = 1;
+        structureInfo[i].radar = !strcmp(oneline, "Radar");
     }
     closeFile(fp);
     
     // get information on each and every available structure
     for (i=0; i<amountOfStructures; i++) {
-        fp = openFile(structureInfo[i].name, FS_STRUCTURES_INFO);
+        fp = openFile(structureInfoText[i].name, FS_STRUCTURES_INFO);
         
         // GENERAL section
         do {
@@ -69,7 +78,7 @@ void initStructures() {
         } while (strncmp(oneline, "[GENERAL]", strlen("[GENERAL]")));
         readstr(fp, oneline);
         replaceEOLwithEOF(oneline, 255);
-        strcpy(structureInfo[i].description, oneline + strlen("Description="));
+        strcpy(structureInfoText[i].description, oneline + strlen("Description="));
         
         // CONSTRUCTING section
         do {
@@ -316,7 +325,7 @@ void initStructuresWithScenario() {
             break;
         
         for (i=0; i<MAX_DIFFERENT_STRUCTURES && structureInfo[i].enabled; i++) {
-            if (!strncmp(positionBehindSide, structureInfo[i].name, strlen(structureInfo[i].name)) && positionBehindSide[strlen(structureInfo[i].name)] == ',') {
+            if (!strncmp(positionBehindSide, structureInfoText[i].name, strlen(structureInfoText[i].name)) && positionBehindSide[strlen(structureInfoText[i].name)] == ',') {
                 structure[amountOfStructures].info = i;
                 break;
             }
@@ -324,7 +333,7 @@ void initStructuresWithScenario() {
         if (i == MAX_DIFFERENT_STRUCTURES)
             error("In the scenario an unknown structure was mentioned", oneline);
         
-        sscanf(positionBehindSide + strlen(structureInfo[i].name), ",%i,%i,%i", &k, &structure[amountOfStructures].x, &structure[amountOfStructures].y);
+        sscanf(positionBehindSide + strlen(structureInfoText[i].name), ",%i,%i,%i", &k, &structure[amountOfStructures].x, &structure[amountOfStructures].y);
         structure[amountOfStructures].armour = (k < 0) ? (INFINITE_ARMOUR) : ((structureInfo[i].max_armour * k) / 100);
         amountOfStructures++;
     }
@@ -338,10 +347,13 @@ void initStructuresWithScenario() {
     
     for (j=0; j<environment.width*environment.height; j++)
         environment.layout[j].contains_structure = -1;
+    initDistanceFieldsWithScenario(); // the units were placed already, the structures are yet to be
     for (j=MAX_DIFFERENT_FACTIONS; j<MAX_STRUCTURES_ON_MAP; j++) {
         structure[j].enabled = 0;
         structure[j].group = 0;
     }
+    initInfluenceWithScenario();
+    initStructureReferrers();
     for (j=MAX_DIFFERENT_FACTIONS; j<amountOfStructures; j++) {
         k = structure[j].armour;
         if (getGameType() == MULTIPLAYER_CLIENT)
@@ -374,8 +386,8 @@ int getStructureNameInfo(char *buffer) {
         return -1;
     
     for (i=0; i<MAX_DIFFERENT_STRUCTURES && structureInfo[i].enabled; i++) {
-        len = strlen(structureInfo[i].name);
-        if (!strncmp(buffer, structureInfo[i].name, len) && (buffer[len]==0 || buffer[len]==','))
+        len = strlen(structureInfoText[i].name);
+        if (!strncmp(buffer, structureInfoText[i].name, len) && (buffer[len]==0 || buffer[len]==','))
             return i;
     }
     error("Non existant structure name encountered:", buffer);
@@ -425,29 +437,44 @@ void adjustBarrierType(int x, int y) {
     
     structureNr = environment.layout[TILE_FROM_XY(x,y)].contains_structure;
     if (connected == 0 || connected == 4) // no connections or only up connected
-        structure[structureNr].logic_aid = 0;
+        setStructureLogicAid(structure + structureNr, 0);
     else if (connected == 15) // all connections
-        structure[structureNr].logic_aid = 11;
+        setStructureLogicAid(structure + structureNr, 11);
     else if (connected == 11) // left, right, down
-        structure[structureNr].logic_aid = 10;
+        setStructureLogicAid(structure + structureNr, 10);
     else if (connected == 7) // left, right, up
-        structure[structureNr].logic_aid = 9;
+        setStructureLogicAid(structure + structureNr, 9);
     else if (connected == 14) // right, up, down
-        structure[structureNr].logic_aid = 8;
+        setStructureLogicAid(structure + structureNr, 8);
     else if (connected == 13) // left, up, down
-        structure[structureNr].logic_aid = 7;
+        setStructureLogicAid(structure + structureNr, 7);
     else if (connected == 10) // right, down
-        structure[structureNr].logic_aid = 6;
+        setStructureLogicAid(structure + structureNr, 6);
     else if (connected == 9) // left, down
-        structure[structureNr].logic_aid = 5;
+        setStructureLogicAid(structure + structureNr, 5);
     else if (connected == 12 || connected == 8) // up, down connected or only down connected
-        structure[structureNr].logic_aid = 4;
+        setStructureLogicAid(structure + structureNr, 4);
     else if (connected == 6)
-        structure[structureNr].logic_aid = 3;
+        setStructureLogicAid(structure + structureNr, 3);
     else if (connected == 5)
-        structure[structureNr].logic_aid = 2;
+        setStructureLogicAid(structure + structureNr, 2);
     else
-        structure[structureNr].logic_aid = 1;
+        setStructureLogicAid(structure + structureNr, 1);
+}
+
+
+// (re)lists all structures, e.g. after a scenario or savegame was loaded
+void initStructureReferrers() {
+    int i;
+    
+    initReferrers(&structuresByLogicAid, MAX_UNITS_ON_MAP);
+    for (i=0; i<MAX_STRUCTURES_ON_MAP; i++)
+        setReferrerKey(&structuresByLogicAid, i, structure[i].logic_aid);
+}
+
+void setStructureLogicAid(struct Structure *curStructure, int logic_aid) {
+    curStructure->logic_aid = logic_aid;
+    setReferrerKey(&structuresByLogicAid, curStructure - structure, logic_aid);
 }
 
 
@@ -535,7 +562,7 @@ int addStructure(enum Side side, int x, int y, int info, int forced) {
     curStructure->y = y;
     curStructure->turret_positioned = UP;
     curStructure->move = SM_NONE;
-    curStructure->logic_aid = 0;
+    setStructureLogicAid(curStructure, 0);
     curStructure->contains_unit = -1;
     curStructure->armour = curStructureInfo->max_armour;
     curStructure->smoke_time = 0;
@@ -569,7 +596,7 @@ int addStructure(enum Side side, int x, int y, int info, int forced) {
             }
             // set tile's traversability to be untraversable due to the newly created structure
             if (!curStructureInfo->foundation)
-                environment.layout[TILE_FROM_XY(x+k, y+i)].traversability = UNTRAVERSABLE;
+                setTileTraversability(TILE_FROM_XY(x+k, y+i), UNTRAVERSABLE);
             // also cause a creation-explosion
 //          if (!forced)
                 addExplosion((x + k) * 16 + 8, (y + i) * 16 + 8, curStructureInfo->created_explosion_info, (i & 1) * (FPS/5) + (k&1 * (FPS/10)));
@@ -578,6 +605,13 @@ int addStructure(enum Side side, int x, int y, int info, int forced) {
                 addRumble(8, FPS/2);
         }
     }
+    #ifndef REMOVE_ASTAR_PATHFINDING
+    if (!curStructureInfo->foundation)
+        invalidatePathfindingArea(x, y, curStructureInfo->width, curStructureInfo->height);
+    #endif
+    invalidateLinesOfFire();
+    addDistanceFieldsStructure(side, x, y, curStructureInfo->width, curStructureInfo->height);
+    addInfluenceStructure(j);
     setOreStorage(side, getOreStorage(side) + curStructureInfo->ore_storage);
     setPowerGeneration(side, getPowerGeneration(side) + curStructureInfo->power_generating);
     setPowerConsumation(side, getPowerConsumation(side) + curStructureInfo->power_consuming);
@@ -595,7 +629,7 @@ int addStructure(enum Side side, int x, int y, int info, int forced) {
             if (unitInfo[i].can_collect_ore) {
                 i = addUnit(side, curStructure->x + curStructureInfo->release_tile, curStructure->y + curStructureInfo->height - 1, i, 1);
                 if (i >= 0) {
-                    environment.layout[TILE_FROM_XY(unit[i].x, unit[i].y)].contains_unit = -1;
+                    setTileUnit(TILE_FROM_XY(unit[i].x, unit[i].y), -1);
                     curStructure->contains_unit = i;
                     if (side == FRIENDLY)
                         playSoundeffect(SE_MINER_DEPLOYED);
@@ -643,63 +677,17 @@ inline int structureOnTile(int tile, enum Side side) {
     return -1;
 }
 
+static int structureOfSideOnTile(int tile, void *side) {
+    return structureOnTile(tile, *(enum Side *) side);
+}
+
 int getDistanceToNearestStructure(enum Side side, int x, int y) {
     // basicly using Manhattan distance for ease of use, and excluding foundation and barrier
-    int maxwh;
-    int j, k;
-    int ypj_x, ymj_x;
-    int xpj_st_envwidth, xmj_lt_zero, ypj_st_envheight, ymj_lt_zero;
-    int xpk_st_envwidth, xmk_lt_zero, ypk_st_envheight, ymk_lt_zero;
-    
-    //maxwh = max(environment.width, environment.height); // <-- actual value
-    maxwh = MAX_BUILDING_DISTANCE + 1; // <-- cheat, as I know it'll only be used to check for the allowing of placing buildings
-    
-    for (j=1; j<maxwh; j++) {
-        
-        ypj_x = TILE_FROM_XY(x, y+j);
-        ymj_x = TILE_FROM_XY(x, y-j);
-        
-        if ((y+j < environment.height && structureOnTile(ypj_x, side) >= 0) ||                 // bottom column middle tile
-            (x+j < environment.width && structureOnTile(TILE_FROM_XY(x+j, y), side) >= 0) ||   // right column middle tile
-            (x-j >= 0 && structureOnTile(TILE_FROM_XY(x-j, y), side) >= 0) ||                   // left column middle tile
-            (y-j >= 0 && structureOnTile(ymj_x, side) >= 0))                                     // top row middle tile
-            return j;
-          
-        xpj_st_envwidth = x+j < environment.width;
-        xmj_lt_zero = x-j >= 0;
-        ypj_st_envheight = y+j < environment.height;
-        ymj_lt_zero = y-j >= 0;
-        
-        for (k=1; k<j; k++) {
-            xpk_st_envwidth = x+k < environment.width;
-            xmk_lt_zero = x-k >= 0;
-            ypk_st_envheight = y+k < environment.height;
-            ymk_lt_zero = y-k >= 0;
-            
-            if ((ypj_st_envheight && // bottom row
-                ((xpk_st_envwidth && structureOnTile(ypj_x + k, side) >= 0) ||
-                 (xmk_lt_zero && structureOnTile(ypj_x - k, side) >= 0))) ||
-               (xpj_st_envwidth && // right column
-                ((ypk_st_envheight && structureOnTile(TILE_FROM_XY(x+j, y+k), side) >= 0) ||
-                 (ymk_lt_zero && structureOnTile(TILE_FROM_XY(x+j, y-k), side) >= 0))) ||
-               (xmj_lt_zero && // left column
-                ((ypk_st_envheight && structureOnTile(TILE_FROM_XY(x-j, y+k), side) >= 0) ||
-                 (ymk_lt_zero && structureOnTile(TILE_FROM_XY(x-j, y-k), side) >= 0))) ||
-               (ymj_lt_zero && // top row
-                ((xpk_st_envwidth && structureOnTile(ymj_x + k, side) >= 0) ||
-                 (xmk_lt_zero && structureOnTile(ymj_x - k, side) >= 0))))
-                    return (j + k);
-        }
-        
-        if ((y+j < environment.height && // bottom row outer tiles (the corner tiles)
-            ((x+j < environment.width && structureOnTile(ypj_x + j, side) >= 0) ||
-             (x-j >= 0 && structureOnTile(ypj_x - j, side) >= 0))) ||
-           (y-j >= 0 && // top row outer tiles (the corner tiles)
-            ((x+j < environment.width && structureOnTile(ymj_x + j, side) >= 0) ||
-             (x-j >= 0 && structureOnTile(ymj_x - j, side) >= 0))))
-                return (j + j);
-    }
+    int distance;
     
+    // not searching any further, as I know it'll only be used to check for the allowing of placing buildings
+    if (searchRings(TILE_FROM_XY(x, y), MAX_BUILDING_DISTANCE, structureOfSideOnTile, &side, &distance) >= 0)
+        return distance;
     return MAX_BUILDING_DISTANCE + 1;
 }
 
@@ -965,10 +953,10 @@ void loadStructuresGraphicsBG(int baseBg, int *offsetBg) {
     
     for (i=0; i<MAX_DIFFERENT_STRUCTURES && structureInfo[i].enabled; i++) {
         structureInfo[i].graphics_offset = (*offsetBg)/(8*8);
-        strcpy(filePosition, structureInfo[i].name);
+        strcpy(filePosition, structureInfoText[i].name);
         *offsetBg += copyFileVRAM((uint16*)(baseBg + *offsetBg), filename, FS_STRUCTURES_GRAPHICS);
         if (structureInfo[i].active_ani > 0) {
-            sprintf(filePosition, "%s_active", structureInfo[i].name);
+            strcat(filePosition, "_active");
             *offsetBg += copyFileVRAM((uint16*)(baseBg + *offsetBg), filename, FS_STRUCTURES_GRAPHICS);
         }
     }
@@ -1023,7 +1011,7 @@ inline void doStructureAttemptToShoot(struct Structure *curStructure, struct Str
                 curStructure->reload_time = 1;
             
             // re-evaluate target:
-            curStructure->logic_aid = sideUnitWithinShootRange(!curStructure->side, curStructure->x, curStructure->y, curStructureInfo->shoot_range, curStructureInfo->projectile_info);
+            setStructureLogicAid(curStructure, sideUnitWithinShootRange(!curStructure->side, curStructure->x, curStructure->y, curStructureInfo->shoot_range, curStructureInfo->projectile_info));
             // ... and switch mode to regular guard if there's no target.
             if (curStructure->logic_aid == -1)
                 curStructure->logic -= 2; // to regular guard
@@ -1032,12 +1020,24 @@ inline void doStructureAttemptToShoot(struct Structure *curStructure, struct Str
 }
 
 
+// sells a structure, refunding half of its build cost weighed by its armour left
+void sellStructure(int nr) {
+    struct Structure *curStructure = &structure[nr];
+    
+    if (curStructure->armour > 0) {
+        changeCredits(curStructure->side, ((curStructure->armour * structureInfo[curStructure->info].build_cost) / structureInfo[curStructure->info].max_armour) / 2);
+        curStructure->armour = 0;
+    }
+}
+
+
 void doStructuresLogic() {
     static int frame = 0;
     int i, j, k, l;
     int aid;
     int creditsRequired, creditsReceived;
     int oldRetreatTile, newRetreatTile;
+    int x, y, next;
     struct Structure *curStructure;
     struct StructureInfo *curStructureInfo;
     struct TechtreeItem *techtreeItem;
@@ -1085,31 +1085,30 @@ void doStructuresLogic() {
                     }
                 }
                 
-                // any unit attacking this structure should stop
+                // any unit attacking this structure should stop. those are listed by a tile of it
                 aid = TILE_FROM_XY(curStructure->x + curStructureInfo->width/2, curStructure->y + curStructureInfo->height/2);
-                for (j=0; j<MAX_UNITS_ON_MAP; j++) {
-                    if (unit[j].enabled && (unit[j].logic == UL_ATTACK_LOCATION || unit[j].logic == UL_ATTACK_AREA)) {
-                        k = environment.layout[unit[j].logic_aid].contains_structure;
-                        if (k < -1)
-                            k = environment.layout[unit[j].logic_aid + (k + 1)].contains_structure;
-                        if (k == i) {
-                            if (getGameType() == SINGLEPLAYER) {
-                                if (unit[j].side != FRIENDLY) {
-                                    if (unit[j].group == UGAI_HUNT) {
-                                        unit[j].logic = UL_HUNT;
-                                        unit[j].logic_aid = 0;
-                                    } else if (unit[j].group == UGAI_KAMIKAZE)
-                                        unit[j].logic = UL_KAMIKAZE;
-                                    else /*if (unit[j].group == UGAI_GUARD_AREA || unit[j].group == UGAI_PATROL)*/
-                                        unit[j].logic = UL_GUARD_RETREAT;
-                                    continue;
+                for (y=curStructure->y; y<curStructure->y + curStructureInfo->height; y++) {
+                    for (x=curStructure->x; x<curStructure->x + curStructureInfo->width; x++) {
+                        FOR_EACH_REFERRER(&unitsByLogicAid, TILE_FROM_XY(x, y), j, next) {
+                            if (unit[j].enabled && (unit[j].logic == UL_ATTACK_LOCATION || unit[j].logic == UL_ATTACK_AREA)) {
+                                if (getGameType() == SINGLEPLAYER) {
+                                    if (unit[j].side != FRIENDLY) {
+                                        if (unit[j].group == UGAI_HUNT) {
+                                            unit[j].logic = UL_HUNT;
+                                            setUnitLogicAid(unit + j, 0);
+                                        } else if (unit[j].group == UGAI_KAMIKAZE)
+                                            unit[j].logic = UL_KAMIKAZE;
+                                        else /*if (unit[j].group == UGAI_GUARD_AREA || unit[j].group == UGAI_PATROL)*/
+                                            unit[j].logic = UL_GUARD_RETREAT;
+                                        continue;
+                                    }
                                 }
+                                if (unit[j].group & (UGAI_ATTACK_FORCED | UGAI_ATTACK)) {
+                                    unit[j].logic = UL_CONTINUE_ATTACK;
+                                    setUnitLogicAid(unit + j, aid);
+                                } else /*if (unit[j].group & UGAI_GUARD)*/
+                                    unit[j].logic = UL_GUARD_RETREAT;
                             }
-                            if (unit[j].group & (UGAI_ATTACK_FORCED | UGAI_ATTACK)) {
-                                unit[j].logic = UL_CONTINUE_ATTACK;
-                                unit[j].logic_aid = aid;
-                            } else /*if (unit[j].group & UGAI_GUARD)*/
-                                unit[j].logic = UL_GUARD_RETREAT;
                         }
                     }
                 }
@@ -1124,9 +1123,9 @@ void doStructuresLogic() {
                             break;
                         }
                     }
-                    for (j=0; j<MAX_UNITS_ON_MAP; j++) {
-                        if (unit[j].enabled && unit[j].retreat_tile == oldRetreatTile && unitInfo[unit[j].info].can_collect_ore)
-                            unit[j].retreat_tile = newRetreatTile;
+                    FOR_EACH_REFERRER(&unitsByRetreatTile, oldRetreatTile, j, next) {
+                        if (unit[j].enabled && unitInfo[unit[j].info].can_collect_ore)
+                            setUnitRetreatTile(unit + j, newRetreatTile);
                     }
                 }
             
@@ -1150,6 +1149,13 @@ void doStructuresLogic() {
                         initTileTraversability(environment.layout + TILE_FROM_XY(curStructure->x + k, curStructure->y + j));
                     }
                 }
+                #ifndef REMOVE_ASTAR_PATHFINDING
+                invalidatePathfindingArea(curStructure->x, curStructure->y, curStructureInfo->width, curStructureInfo->height);
+                #endif
+                invalidateLinesOfFire();
+                removeDistanceFieldsStructure(curStructure->side);
+                removeInfluenceStructure(curStructure - structure);
+                addInfluenceLoss(curStructure->side, curStructure->x, curStructure->y, curStructureInfo->build_cost);
                 if (!curStructureInfo->no_overlay_on_destruction)
                     addStructureDestroyedOverlay(curStructure->x, curStructure->y, curStructureInfo->width, curStructureInfo->height);
                 if (!curStructureInfo->no_sound_on_destruction)
@@ -1232,7 +1238,7 @@ void doStructuresLogic() {
                     curStructure->move = SM_REPAIRING_UNIT;
                     unit[curStructure->contains_unit].move_aid = (unit[curStructure->contains_unit].armour * unitInfo[unit[curStructure->contains_unit].info].repair_time) / unitInfo[unit[curStructure->contains_unit].info].max_armour;
                     if (!curStructure->logic_aid)
-                        curStructure->logic_aid = 1;
+                        setStructureLogicAid(curStructure, 1);
                 }
                 
                 // extracting ore
@@ -1240,7 +1246,7 @@ void doStructuresLogic() {
                     curStructure->move = SM_EXTRACTING_ORE;
                     unit[curStructure->contains_unit].move_aid = ((MAX_ORED_BY_UNIT - unit[curStructure->contains_unit].ore) * TIME_TO_EXTRACT_MAX_ORED) / MAX_ORED_BY_UNIT;
                     if (!curStructure->logic_aid)
-                        curStructure->logic_aid = 1;
+                        setStructureLogicAid(curStructure, 1);
                 }
             
                 // guarding
@@ -1251,7 +1257,7 @@ void doStructuresLogic() {
                         if ((frame + i) % (FPS / getGameSpeed()) == 0) {
                             aid = sideUnitWithinShootRange(!curStructure->side, curStructure->x, curStructure->y, curStructureInfo->shoot_range, curStructureInfo->projectile_info);
                             if (aid != -1) {
-                                curStructure->logic_aid = aid; 
+                                setStructureLogicAid(curStructure, aid); 
                                 curStructure->logic += 2; // to guarding unit
                             }
                         }
@@ -1328,7 +1334,7 @@ void doStructuresLogic() {
                 if (unit[curStructure->contains_unit].ore <= 0) {
 //                  environment.layout[(curStructure->y + curStructureInfo->height - 1) * mapWidth + curStructure->x + curStructureInfo->release_tile].contains_unit = -1;
                     if (dropUnit(curStructure->contains_unit, curStructure->x + curStructureInfo->release_tile, curStructure->y + curStructureInfo->height - 1)) {
-                        unit[curStructure->contains_unit].retreat_tile = TILE_FROM_XY(curStructure->x + curStructureInfo->release_tile, curStructure->y + curStructureInfo->height - 1);
+                        setUnitRetreatTile(unit + curStructure->contains_unit, TILE_FROM_XY(curStructure->x + curStructureInfo->release_tile, curStructure->y + curStructureInfo->height - 1));
                         unit[curStructure->contains_unit].ore = 0;
                         curStructure->contains_unit = -1;
                         curStructure->move = SM_NONE;
@@ -1371,19 +1377,19 @@ void doStructuresLogic() {
                 curStructure->smoke_time--;
             
             if (curStructureInfo->active_ani) {
-                if (!strcmp(curStructureInfo->name, "Radar")) {
+                if (curStructureInfo->radar) {
                     if (getPowerConsumation(curStructure->side) > getPowerGeneration(curStructure->side))
-                        curStructure->logic_aid = 0;
+                        setStructureLogicAid(curStructure, 0);
                     else if (!curStructure->logic_aid)
-                        curStructure->logic_aid = 1;
+                        setStructureLogicAid(curStructure, 1);
                 }
                 if (curStructure->logic_aid > 0 && !curStructureInfo->barrier && !curStructureInfo->shoot_range) {
                     if ((curStructureInfo->can_extract_ore && curStructure->move != SM_EXTRACTING_ORE) || (curStructureInfo->can_repair_unit && curStructure->move != SM_REPAIRING_UNIT))
-                        curStructure->logic_aid = 0;
+                        setStructureLogicAid(curStructure, 0);
                     else {
-                        curStructure->logic_aid++;
+                        setStructureLogicAid(curStructure, curStructure->logic_aid + 1);
                         if (curStructure->logic_aid >= STRUCTURE_ANIMATION_FRAME_DURATION * curStructureInfo->active_ani)
-                            curStructure->logic_aid = 1 * (curStructure->move == SM_EXTRACTING_ORE || curStructure->move == SM_REPAIRING_UNIT || !strcmp(curStructureInfo->name, "Radar"));
+                            setStructureLogicAid(curStructure, 1 * (curStructure->move == SM_EXTRACTING_ORE || curStructure->move == SM_REPAIRING_UNIT || curStructureInfo->radar));
                     }
                 }
             }
@@ -1420,7 +1426,7 @@ void doStructureLogicHit(int nr, int projectileSourceTile) {
                     unitInfo[unit[i].info].shoot_range > 0) {
                     if (unit[i].logic == UL_GUARD || unit[i].logic == UL_GUARD_RETREAT || unit[i].logic == UL_GUARD_AREA || unit[i].move == UM_MOVE_HOLD) {
                         unit[i].logic = UL_ATTACK_UNIT;
-                        unit[i].logic_aid = unitNrWhichShot;
+                        setUnitLogicAid(unit + i, unitNrWhichShot);
                         if (unit[i].side == FRIENDLY)
                             unit[i].group = (unit[i].group & (~UGAI_FRIENDLY_MASK)) | UGAI_GUARD;
                     }
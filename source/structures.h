@@ -6,6 +6,7 @@
 
 #include <nds.h>
 
+#include "referrers.h"
 #include "settings.h"
 #include "shared.h"
 
@@ -38,10 +39,15 @@ struct Flag {
     int y;
 };
 
-struct StructureInfo {
-    int enabled;
+// the names and descriptions are kept apart, in structureInfoText, as only the info screen and menus and the loading
+// of a scenario read these. the game logic and the drawing of structures go through structureInfo every frame
+struct StructureInfoText {
     char name[MAX_STRUCTURE_NAME_LENGTH+1];
     char description[MAX_DESCRIPTION_LENGTH+1];
+};
+
+struct StructureInfo {
+    int enabled;
     int build_time; /* --seconds-- frames */
     int build_cost;
     int repair_time;
@@ -57,6 +63,7 @@ struct StructureInfo {
     int view_range; /* tiles */
     int foundation; /* is it something to build on top of? */
     int barrier; /* is it a wall */
+    int radar; /* is it the one named Radar, powering the radar screen */
     
     int projectile_info;
     int rotate_speed; /* frames to rotate turret */
@@ -86,19 +93,19 @@ struct StructureInfo {
 };
 
 struct Structure {
-    int enabled;
+    unsigned char enabled;
+    unsigned char primary;            /* do created units roll out of this structure? */
+    unsigned char selected;
+    unsigned char side;               /* enum Side: friendly or enemy */
+    unsigned char turret_positioned;  /* enum Positioned */
+    unsigned char logic;              /* enum StructureLogic */
+    unsigned char move;               /* enum StructureMove */
     int info; /* used as a reference to a StructureInfo */
-    int primary; /* do created units roll out of this structure? */
     int group; /* yes, hotkeys for structures do exist ;) */
-    int selected;
-    enum Side side; /* friendly or enemy */
     int x;
     int y;
     int armour;
-    enum Positioned turret_positioned;
-    enum StructureLogic logic;
     int logic_aid; /* used for turret guarding unit, and for barrier form, and for structure 'active' timer */
-    enum StructureMove move;
     int move_aid;
     int smoke_time;
     int reload_time;
@@ -108,6 +115,10 @@ struct Structure {
     int multiplayer_id;
 };
 
+// the records gone through every frame. a data cache line of the DS is 32 bytes
+_Static_assert(sizeof(struct Structure) <= 2*32, "struct Structure no longer fits two cache lines");
+_Static_assert(sizeof(struct StructureInfo) <= 6*32, "struct StructureInfo no longer fits six cache lines");
+
 void initStructures();
 void initStructuresWithScenario();
 
@@ -117,6 +128,11 @@ int foundationRequired();
 int getDistanceToNearestStructure(enum Side side, int x, int y);
 
 int addStructure(enum Side side, int x, int y, int info, int forced);
+void sellStructure(int nr);
+
+// the structures listed by the unit their logic_aid holds, which is set through this
+void initStructureReferrers();
+void setStructureLogicAid(struct Structure *curStructure, int logic_aid);
 void doStructuresLogic();
 void doStructureLogicHit(int nr, int projectileSourceTile);
 
@@ -127,7 +143,9 @@ void loadStructureRallyGraphicsSprites(int *offsetSp);
 void loadStructuresGraphicsSprites(int *offsetSp);
 
 extern struct StructureInfo structureInfo[];
+extern struct StructureInfoText structureInfoText[];
 extern struct Structure structure[];
+extern struct Referrers structuresByLogicAid;
 
 int getStructuresSaveSize(void);
 int getStructuresSaveData(void *dest, int max_size);
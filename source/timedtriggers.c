@@ -337,7 +337,7 @@ void initTimedtriggers() {
         } else {
             timer.structure_kill[i].info = getStructureNameInfo(oneline + len);
             if (timer.structure_kill[i].info >= 0)
-                len += strlen(structureInfo[timer.structure_kill[i].info].name);
+                len += strlen(structureInfoText[timer.structure_kill[i].info].name);
         }
         if (oneline[len] == ',') // a wav was mentioned
             strcpy(timer.structure_kill[i].wav, oneline + len + 2); // 2 because we're going to skip ", "
@@ -375,7 +375,7 @@ void initTimedtriggers() {
         } else {
             timer.unit_kill[i].info = getUnitNameInfo(oneline + len);
             if (timer.unit_kill[i].info >= 0)
-                len += strlen(unitInfo[timer.unit_kill[i].info].name);
+                len += strlen(unitInfoText[timer.unit_kill[i].info].name);
         }
         if (oneline[len] == ',') // a wav was mentioned
             strcpy(timer.unit_kill[i].wav, oneline + len + 2); // 2 because we're going to skip ", "
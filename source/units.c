@@ -19,6 +19,12 @@
 #include "playscreen.h"
 #include "soundeffects.h"
 #include "pathfinding.h"
+#include "shroud.h"
+#include "bitboards.h"
+#include "entitypool.h"
+#include "ringsearch.h"
+#include "distancefields.h"
+#include "influence.h"
 
 #define USE_REDUCED_UNIT_SELECTED_GFX
 #define USE_REDUCED_UNIT_COLLECTED_GFX
@@ -38,8 +44,23 @@ struct UnitReinforcement unitReinforcement[MAX_REINFORCEMENTS];
 
 
 struct UnitInfo unitInfo[MAX_DIFFERENT_UNITS];
+struct UnitInfoText unitInfoText[MAX_DIFFERENT_UNITS];
 struct Unit unit[MAX_UNITS_ON_MAP];
-int focusOnUnitNr;
+static struct EntityPool unitPool;
+int focusOnUnitHandle;
+
+s16 unitGridFirst[MAX_UNIT_GRID_CELLS];
+s16 unitGridNext[MAX_UNITS_ON_MAP];
+s16 unitGridCell[MAX_UNITS_ON_MAP]; // the cell each unit is currently listed in, -1 if none
+
+struct Referrers unitsByLogicAid;
+struct Referrers unitsByRetreatTile;
+int unitGridWidth, unitGridHeight;
+
+// the structure of the player for the hunting units of each side to attack, and the logic frame it was looked for in
+static int bestStructureToAttack[MAX_DIFFERENT_FACTIONS];
+static unsigned int bestStructureToAttackFrame[MAX_DIFFERENT_FACTIONS];
+static unsigned int unitsLogicFrame;
 
 static int unit_smoke_graphics_offset = 0;
 static int unit_bleed_graphics_offset;
@@ -53,11 +74,11 @@ static int unitMultiplayerIdCounter;
 
 
 inline int getFocusOnUnitNr() {
-    return focusOnUnitNr;
+    return getUnitOfHandle(focusOnUnitHandle);
 }
 
 inline void setFocusOnUnitNr(int nr) {
-    focusOnUnitNr = nr;
+    focusOnUnitHandle = getUnitHandle(nr);
 }
 
 
@@ -76,14 +97,14 @@ void initUnits() {
     for (i=0; i<amountOfUnits; i++) {
         readstr(fp, oneline);
         replaceEOLwithEOF(oneline, 255);
-        strcpy(unitInfo[i].name, oneline);
+        strcpy(unitInfoText[i].name, oneline);
         unitInfo[i].enabled = 1;
     }
     closeFile(fp);
     
     // get information on each and every available unit
     for (i=0; i<amountOfUnits; i++) {
-        fp = openFile(unitInfo[i].name, FS_UNITS_INFO);
+        fp = openFile(unitInfoText[i].name, FS_UNITS_INFO);
         
         // GENERAL section
         do {
@@ -91,7 +112,7 @@ void initUnits() {
         } while (strncmp(oneline, "[GENERAL]", strlen("[GENERAL]")));
         readstr(fp, oneline);
         replaceEOLwithEOF(oneline, 255);
-        strcpy(unitInfo[i].description, oneline + strlen("Description="));
+        strcpy(unitInfoText[i].description, oneline + strlen("Description="));
         readstr(fp, oneline);
         if (!strncmp(oneline + strlen("Type="), "Foot", strlen("Foot")))
             unitInfo[i].type = UT_FOOT;
@@ -299,11 +320,11 @@ void initUnitsWithScenario() {
     int i,j,k;
     
     unitMultiplayerIdCounter = 0;
-    focusOnUnitNr = -1;
+    focusOnUnitHandle = -1;
     
     j = environment.width*environment.height;
     for (i=0; i<j; i++)
-        environment.layout[i].contains_unit = -1;
+        setTileUnit(i, -1);
     
     for (i=0; i<MAX_DIFFERENT_FACTIONS; i++) {
         setUnitCount(i, 0);
@@ -332,7 +353,7 @@ void initUnitsWithScenario() {
             unit[amountOfUnits].side = !unit[amountOfUnits].side;
         
         for (i=0; i<MAX_DIFFERENT_UNITS && unitInfo[i].enabled; i++) {
-            if (!strncmp(positionBehindSide, unitInfo[i].name, strlen(unitInfo[i].name)) && positionBehindSide[strlen(unitInfo[i].name)] == ',') {
+            if (!strncmp(positionBehindSide, unitInfoText[i].name, strlen(unitInfoText[i].name)) && positionBehindSide[strlen(unitInfoText[i].name)] == ',') {
                 unit[amountOfUnits].info = i;
                 break;
             }
@@ -340,7 +361,7 @@ void initUnitsWithScenario() {
         if (i == MAX_DIFFERENT_UNITS || !unitInfo[i].enabled)
             error("In the scenario an unknown unit was mentioned", oneline);
             
-        sscanf(positionBehindSide + strlen(unitInfo[i].name), ",%i,%i,%i,%i,", &j, &unit[amountOfUnits].x, &unit[amountOfUnits].y, &k);
+        sscanf(positionBehindSide + strlen(unitInfoText[i].name), ",%i,%i,%i,%i,", &j, &unit[amountOfUnits].x, &unit[amountOfUnits].y, &k);
         unit[amountOfUnits].armour = (j < 0) ? (INFINITE_ARMOUR) : (unitInfo[i].max_armour * j / 100);
         
         if (unit[amountOfUnits].x >= environment.width || unit[amountOfUnits].y >= environment.height)
@@ -374,10 +395,10 @@ void initUnitsWithScenario() {
                 } else if (lastCharacter == 'd') { // guard
                     // variables already set, so nothing to do here
                 } else { // there are behaviours (Hunt|Attack) with parameters
-                    char firstCharacter = positionBehindSide[strlen(unitInfo[i].name) + 5 + nrstrlen(j) + nrstrlen(unit[amountOfUnits].x) + nrstrlen(unit[amountOfUnits].y) + nrstrlen(k)];
+                    char firstCharacter = positionBehindSide[strlen(unitInfoText[i].name) + 5 + nrstrlen(j) + nrstrlen(unit[amountOfUnits].x) + nrstrlen(unit[amountOfUnits].y) + nrstrlen(k)];
                     if (firstCharacter == 'H') { // Hunt
                         unit[amountOfUnits].logic = UL_HUNT;
-                        sscanf(positionBehindSide + strlen(unitInfo[i].name) + 6 + nrstrlen(j) + nrstrlen(unit[amountOfUnits].x) + nrstrlen(unit[amountOfUnits].y) + nrstrlen(k) + strlen("Hunt"), "%i", &unit[amountOfUnits].logic_aid);
+                        sscanf(positionBehindSide + strlen(unitInfoText[i].name) + 6 + nrstrlen(j) + nrstrlen(unit[amountOfUnits].x) + nrstrlen(unit[amountOfUnits].y) + nrstrlen(k) + strlen("Hunt"), "%i", &unit[amountOfUnits].logic_aid);
                         unit[amountOfUnits].logic_aid = (2*(unit[amountOfUnits].logic_aid*FPS)) / getGameSpeed();
                         unit[amountOfUnits].group = UGAI_HUNT;
                         if (unit[amountOfUnits].x == 0 || unit[amountOfUnits].x == environment.width - 1 || unit[amountOfUnits].y == 0 || unit[amountOfUnits].y == environment.height - 1) {
@@ -393,7 +414,7 @@ void initUnitsWithScenario() {
                         }
                     } else if (firstCharacter == 'A') {  // Attack
                         int tgt_x, tgt_y;
-                        sscanf(positionBehindSide + strlen(unitInfo[i].name) + 6 + nrstrlen(j) + nrstrlen(unit[amountOfUnits].x) + nrstrlen(unit[amountOfUnits].y) + nrstrlen(k) + strlen("Attack"), "%i,%i", &tgt_x, &tgt_y);
+                        sscanf(positionBehindSide + strlen(unitInfoText[i].name) + 6 + nrstrlen(j) + nrstrlen(unit[amountOfUnits].x) + nrstrlen(unit[amountOfUnits].y) + nrstrlen(k) + strlen("Attack"), "%i,%i", &tgt_x, &tgt_y);
                         unit[amountOfUnits].logic = UL_ATTACK_AREA;
                         unit[amountOfUnits].logic_aid = TILE_FROM_XY(tgt_x, tgt_y);
                         unit[amountOfUnits].group = UGAI_HUNT; // retaliate if attacked!
@@ -403,10 +424,10 @@ void initUnitsWithScenario() {
                     }
                 }
             } else { // unit[amountOfUnits].side == FRIENDLY
-                char firstCharacter = positionBehindSide[strlen(unitInfo[i].name) + 5 + nrstrlen(j) + nrstrlen(unit[amountOfUnits].x) + nrstrlen(unit[amountOfUnits].y) + nrstrlen(k)];
+                char firstCharacter = positionBehindSide[strlen(unitInfoText[i].name) + 5 + nrstrlen(j) + nrstrlen(unit[amountOfUnits].x) + nrstrlen(unit[amountOfUnits].y) + nrstrlen(k)];
                 if (firstCharacter == 'R') {  // Reinforcement (behaviour for Friendly unit only!)
                     int tgt_x, tgt_y;
-                    sscanf(positionBehindSide + strlen(unitInfo[i].name) + 6 + nrstrlen(j) + nrstrlen(unit[amountOfUnits].x) + nrstrlen(unit[amountOfUnits].y) + nrstrlen(k) + strlen("Reinforcement"), "%i,%i,%i", &unit[amountOfUnits].logic_aid, &tgt_x, &tgt_y);
+                    sscanf(positionBehindSide + strlen(unitInfoText[i].name) + 6 + nrstrlen(j) + nrstrlen(unit[amountOfUnits].x) + nrstrlen(unit[amountOfUnits].y) + nrstrlen(k) + strlen("Reinforcement"), "%i,%i,%i", &unit[amountOfUnits].logic_aid, &tgt_x, &tgt_y);
                     unit[amountOfUnits].logic_aid = (2*(unit[amountOfUnits].logic_aid*FPS)) / getGameSpeed();
                     if (unit[amountOfUnits].x == 0 || unit[amountOfUnits].x == environment.width - 1 || unit[amountOfUnits].y == 0 || unit[amountOfUnits].y == environment.height - 1) {
                         unitReinforcement[amountOfReinforcementUnits].delay     = unit[amountOfUnits].logic_aid;
@@ -445,7 +466,7 @@ void initUnitsWithScenario() {
         unit[amountOfUnits].smoke_time = 0;
         // if (unitInfo[unit[amountOfUnits].info].double_shot && (unit[amountOfUnits].reload_time - (SHOOT_ANIMATION_DURATION_FAKED + 1) >= DOUBLE_SHOT_AT)) // try to make sure it doesn't look like it's shooting from the get-go
             unit[amountOfUnits].reload_time = max((unitInfo->double_shot?DOUBLE_SHOT_AT:0), unitInfo->reload_time - (SHOOT_ANIMATION_DURATION_FAKED + 1));
-        environment.layout[unit[amountOfUnits].retreat_tile].contains_unit = amountOfUnits;
+        setTileUnit(unit[amountOfUnits].retreat_tile, amountOfUnits);
         
         if (unit[amountOfUnits].side == FRIENDLY)
             activateEntityView(unit[amountOfUnits].x, unit[amountOfUnits].y, 1, 1, unitInfo[unit[amountOfUnits].info].view_range);
@@ -476,6 +497,96 @@ void initUnitsWithScenario() {
     // C28 - end
     
     initUnitsSpeed();
+    initUnitGrid();
+    initUnitReferrers();
+}
+
+
+inline int getUnitGridCell(int x, int y) {
+    return (y >> UNIT_GRID_SHIFT) * unitGridWidth + (x >> UNIT_GRID_SHIFT);
+}
+
+inline int getUnitGridWidth() {
+    return unitGridWidth;
+}
+
+inline int getUnitGridHeight() {
+    return unitGridHeight;
+}
+
+// a handle to refer to a unit by for longer than the logic frame, which no longer refers to it once it was disabled
+int getUnitHandle(int unitnr) {
+    return getEntityPoolHandle(&unitPool, unitnr);
+}
+
+// returns the unit the handle refers to, or -1 if it no longer refers to one
+int getUnitOfHandle(int handle) {
+    return getEntityPoolEntryOfHandle(&unitPool, handle);
+}
+
+// to be called whenever a unit is enabled, disabled or its x or y changed
+void updateUnitGrid(int unitnr) {
+    struct Unit *curUnit = unit + unitnr;
+    int cell = curUnit->enabled ? getUnitGridCell(curUnit->x, curUnit->y) : -1;
+    int oldCell = unitGridCell[unitnr];
+    s16 *link;
+    
+    if (curUnit->enabled)
+        useEntityPoolEntry(&unitPool, unitnr);
+    else
+        freeEntityPoolEntry(&unitPool, unitnr);
+    
+    if (cell == oldCell)
+        return;
+    
+    moveInfluenceUnit(unitnr, oldCell, cell);
+    if (oldCell >= 0) {
+        for (link = &unitGridFirst[oldCell]; *link != unitnr; link = &unitGridNext[*link]);
+        *link = unitGridNext[unitnr];
+    }
+    if (cell >= 0) {
+        unitGridNext[unitnr] = unitGridFirst[cell];
+        unitGridFirst[cell] = unitnr;
+    }
+    unitGridCell[unitnr] = cell;
+}
+
+// (re)builds the grid from scratch, e.g. after a scenario or savegame was loaded
+void initUnitGrid() {
+    int i;
+    
+    unitGridWidth  = (environment.width  + (1 << UNIT_GRID_SHIFT) - 1) >> UNIT_GRID_SHIFT;
+    unitGridHeight = (environment.height + (1 << UNIT_GRID_SHIFT) - 1) >> UNIT_GRID_SHIFT;
+    for (i=0; i<MAX_UNIT_GRID_CELLS; i++)
+        unitGridFirst[i] = -1;
+    initInfluenceOfUnits();
+    initEntityPool(&unitPool, MAX_UNITS_ON_MAP);
+    for (i=0; i<MAX_UNITS_ON_MAP; i++) {
+        unitGridCell[i] = -1;
+        updateUnitGrid(i);
+    }
+}
+
+// (re)lists all units, e.g. after a scenario or savegame was loaded
+void initUnitReferrers() {
+    int i;
+    
+    initReferrers(&unitsByLogicAid, MAX_TILES_ENVIRONMENT);
+    initReferrers(&unitsByRetreatTile, MAX_TILES_ENVIRONMENT);
+    for (i=0; i<MAX_UNITS_ON_MAP; i++) {
+        setReferrerKey(&unitsByLogicAid, i, unit[i].logic_aid);
+        setReferrerKey(&unitsByRetreatTile, i, unit[i].retreat_tile);
+    }
+}
+
+void setUnitLogicAid(struct Unit *curUnit, int logic_aid) {
+    curUnit->logic_aid = logic_aid;
+    setReferrerKey(&unitsByLogicAid, curUnit - unit, logic_aid);
+}
+
+void setUnitRetreatTile(struct Unit *curUnit, int retreat_tile) {
+    curUnit->retreat_tile = retreat_tile;
+    setReferrerKey(&unitsByRetreatTile, curUnit - unit, retreat_tile);
 }
 
 
@@ -487,8 +598,8 @@ int getUnitNameInfo(char *buffer) {
         return -1;
     
     for (i=0; i<MAX_DIFFERENT_UNITS && unitInfo[i].enabled; i++) {
-        len = strlen(unitInfo[i].name);
-        if (!strncmp(buffer, unitInfo[i].name, len) && (buffer[len]==0 || buffer[len]==','))
+        len = strlen(unitInfoText[i].name);
+        if (!strncmp(buffer, unitInfoText[i].name, len) && (buffer[len]==0 || buffer[len]==','))
             return i;
     }
     error("Non existant unit name encountered:", buffer);
@@ -514,7 +625,7 @@ void reserveTileForUnit(int unit_nr, int x, int y, enum UnitMove move) {
     
     envLayout = &environment.layout[TILE_FROM_XY(x,y)];
     if (envLayout->contains_unit <= -1)
-        envLayout->contains_unit = -unit_nr - 2;
+        setTileUnit(TILE_FROM_XY(x,y), -unit_nr - 2);
 }
 
 int freeToMoveUnitViaTile(struct Unit *current, int tile) {
@@ -660,160 +771,33 @@ int freeToPlaceUnitOnTile(struct Unit *current, int tile) {
 }
 
 
-int nearestEnvironmentTile(int curTile, enum EnvironmentTileGraphics graphicsMin, enum EnvironmentTileGraphics graphicsMax) {
-    int maxwh;
-    int j, k;
-    int ypj_x, ymj_x;
-    int xpj_st_envwidth, xmj_lt_zero, ypj_st_envheight, ymj_lt_zero;
-    int xpk_st_envwidth, xmk_lt_zero, ypk_st_envheight, ymk_lt_zero;
+struct EnvironmentTileRange {
+    enum EnvironmentTileGraphics graphicsMin;
+    enum EnvironmentTileGraphics graphicsMax;
+};
+
+static int environmentTileInRange(int tile, void *range) {
+    struct EnvironmentTileRange *curRange = range;
     
-    int x = X_FROM_TILE(curTile);
-    int y = Y_FROM_TILE(curTile);
+    return isEnvironmentTileBetween(tile, curRange->graphicsMin, curRange->graphicsMax) ? tile : -1;
+}
+
+static int unoccupiedEnvironmentTileInRange(int tile, void *range) {
+    struct EnvironmentTileRange *curRange = range;
     
-    maxwh = max(environment.width, environment.height);
-    for (j=1; j<maxwh; j++) {
-        
-        ypj_x = TILE_FROM_XY(x, y+j);
-        ymj_x = TILE_FROM_XY(x, y-j);
-        
-        if (y+j < environment.height && isEnvironmentTileBetween(ypj_x, graphicsMin, graphicsMax))                          // bottom row middle tile
-            return ypj_x;
-        if (x+j < environment.width && isEnvironmentTileBetween(TILE_FROM_XY(x+j, y), graphicsMin, graphicsMax))  // right column middle tile
-            return TILE_FROM_XY(x+j, y);
-        if (x-j >= 0 && isEnvironmentTileBetween(TILE_FROM_XY(x-j, y), graphicsMin, graphicsMax))                  // left column middle tile
-            return TILE_FROM_XY(x-j, y);
-        if (y-j >= 0 && isEnvironmentTileBetween(ymj_x, graphicsMin, graphicsMax))                                           // top row middle tile
-            return ymj_x;
-        
-        xpj_st_envwidth = x+j < environment.width;
-        xmj_lt_zero = x-j >= 0;
-        ypj_st_envheight = y+j < environment.height;
-        ymj_lt_zero = y-j >= 0;
-        
-        for (k=1; k<j; k++) {
-            xpk_st_envwidth = x+k < environment.width;
-            xmk_lt_zero = x-k >= 0;
-            ypk_st_envheight = y+k < environment.height;
-            ymk_lt_zero = y-k >= 0;
-            
-            if (ypj_st_envheight) { // bottom row
-                if (xpk_st_envwidth && isEnvironmentTileBetween( ypj_x + k, graphicsMin, graphicsMax))
-                    return ypj_x + k;
-                if (xmk_lt_zero && isEnvironmentTileBetween(ypj_x - k, graphicsMin, graphicsMax))
-                    return ypj_x - k;
-            }
-            if (xpj_st_envwidth) { // right column
-                if (ypk_st_envheight && isEnvironmentTileBetween(TILE_FROM_XY(x+j, y+k), graphicsMin, graphicsMax))
-                    return TILE_FROM_XY(x+j, y+k);
-                if (ymk_lt_zero && isEnvironmentTileBetween(TILE_FROM_XY(x+j, y-k), graphicsMin, graphicsMax))
-                    return TILE_FROM_XY(x+j, y-k);
-            }
-            if (xmj_lt_zero) { // left column
-                if (ypk_st_envheight && isEnvironmentTileBetween(TILE_FROM_XY(x-j, y+k), graphicsMin, graphicsMax))
-                    return TILE_FROM_XY(x-j, y+k);
-                if (ymk_lt_zero && isEnvironmentTileBetween(TILE_FROM_XY(x-j, y-k), graphicsMin, graphicsMax))
-                    return TILE_FROM_XY(x-j, y-k);
-            }
-            if (ymj_lt_zero) { // top row
-                if (xpk_st_envwidth && isEnvironmentTileBetween(ymj_x + k, graphicsMin, graphicsMax))
-                    return ymj_x + k;
-                if (xmk_lt_zero && isEnvironmentTileBetween(ymj_x - k, graphicsMin, graphicsMax))
-                    return ymj_x - k;
-            }
-        }
-        
-        if (y+j < environment.height) { // bottom row outer tiles (the corner tiles)
-            if (x+j < environment.width && isEnvironmentTileBetween(ypj_x + j, graphicsMin, graphicsMax))
-                return ypj_x + j;
-            if (x-j >= 0 && isEnvironmentTileBetween(ypj_x - j, graphicsMin, graphicsMax))
-                return ypj_x - j;
-        }
-        if (y-j >= 0) { // top row outer tiles (the corner tiles)
-            if (x+j < environment.width && isEnvironmentTileBetween(ymj_x + j, graphicsMin, graphicsMax))
-                return ymj_x + j;
-            if (x-j >= 0 && isEnvironmentTileBetween(ymj_x - j, graphicsMin, graphicsMax))
-                return ymj_x - j;
-        }
-    }
-    return -1;
+    return (environment.layout[tile].contains_unit == -1 && isEnvironmentTileBetween(tile, curRange->graphicsMin, curRange->graphicsMax)) ? tile : -1;
 }
 
-int nearestEnvironmentTileUnoccupied(int curTile, enum EnvironmentTileGraphics graphicsMin, enum EnvironmentTileGraphics graphicsMax) {
-    int maxwh;
-    int j, k;
-    int ypj_x, ymj_x;
-    int xpj_st_envwidth, xmj_lt_zero, ypj_st_envheight, ymj_lt_zero;
-    int xpk_st_envwidth, xmk_lt_zero, ypk_st_envheight, ymk_lt_zero;
+int nearestEnvironmentTile(int curTile, enum EnvironmentTileGraphics graphicsMin, enum EnvironmentTileGraphics graphicsMax) {
+    struct EnvironmentTileRange range = { graphicsMin, graphicsMax };
     
-    int x = X_FROM_TILE(curTile);
-    int y = Y_FROM_TILE(curTile);
+    return searchRings(curTile, RING_SEARCH_MAX_RADIUS, environmentTileInRange, &range, 0);
+}
+
+int nearestEnvironmentTileUnoccupied(int curTile, enum EnvironmentTileGraphics graphicsMin, enum EnvironmentTileGraphics graphicsMax) {
+    struct EnvironmentTileRange range = { graphicsMin, graphicsMax };
     
-    maxwh = max(environment.width, environment.height);
-    for (j=1; j<maxwh; j++) {
-        
-        ypj_x = TILE_FROM_XY(x, y+j);
-        ymj_x = TILE_FROM_XY(x, y-j);
-        
-        if (y+j < environment.height && environment.layout[ypj_x].contains_unit == -1 && isEnvironmentTileBetween(ypj_x, graphicsMin, graphicsMax))                          // bottom row middle tile
-            return ypj_x;
-        if (x+j < environment.width && environment.layout[TILE_FROM_XY(x+j, y)].contains_unit == -1 && isEnvironmentTileBetween(environment.width * y + x + j, graphicsMin, graphicsMax))  // right column middle tile
-            return TILE_FROM_XY(x+j, y);
-        if (x-j >= 0 && environment.layout[TILE_FROM_XY(x-j, y)].contains_unit == -1 && isEnvironmentTileBetween(environment.width * y + x - j, graphicsMin, graphicsMax))                  // left column middle tile
-            return TILE_FROM_XY(x-j, y);
-        if (y-j >= 0 && environment.layout[ymj_x].contains_unit == -1 && isEnvironmentTileBetween(ymj_x, graphicsMin, graphicsMax))                                           // top row middle tile
-            return ymj_x;
-        
-        xpj_st_envwidth = x+j < environment.width;
-        xmj_lt_zero = x-j >= 0;
-        ypj_st_envheight = y+j < environment.height;
-        ymj_lt_zero = y-j >= 0;
-        
-        for (k=1; k<j; k++) {
-            xpk_st_envwidth = x+k < environment.width;
-            xmk_lt_zero = x-k >= 0;
-            ypk_st_envheight = y+k < environment.height;
-            ymk_lt_zero = y-k >= 0;
-            
-            if (ypj_st_envheight) { // bottom row
-                if (xpk_st_envwidth && environment.layout[ypj_x + k].contains_unit == -1 && isEnvironmentTileBetween(ypj_x + k, graphicsMin, graphicsMax))
-                    return ypj_x + k;
-                if (xmk_lt_zero && environment.layout[ypj_x - k].contains_unit == -1 && isEnvironmentTileBetween(ypj_x - k, graphicsMin, graphicsMax))
-                    return ypj_x - k;
-            }
-            if (xpj_st_envwidth) { // right column
-                if (ypk_st_envheight && environment.layout[TILE_FROM_XY(x+j, y+k)].contains_unit == -1 && isEnvironmentTileBetween(TILE_FROM_XY(x+j, y+k), graphicsMin, graphicsMax))
-                    return TILE_FROM_XY(x+j, y+k);
-                if (ymk_lt_zero && environment.layout[TILE_FROM_XY(x+j, y-k)].contains_unit == -1 && isEnvironmentTileBetween(TILE_FROM_XY(x+j, y-k), graphicsMin, graphicsMax))
-                    return TILE_FROM_XY(x+j, y-k);
-            }
-            if (xmj_lt_zero) { // left column
-                if (ypk_st_envheight && environment.layout[TILE_FROM_XY(x-j, y+k)].contains_unit == -1 && isEnvironmentTileBetween(TILE_FROM_XY(x-j, y+k), graphicsMin, graphicsMax))
-                    return TILE_FROM_XY(x-j, y+k);
-                if (ymk_lt_zero && environment.layout[TILE_FROM_XY(x-j, y-k)].contains_unit == -1 && isEnvironmentTileBetween(TILE_FROM_XY(x-j, y-k), graphicsMin, graphicsMax))
-                    return TILE_FROM_XY(x-j, y-k);
-            }
-            if (ymj_lt_zero) { // top row
-                if (xpk_st_envwidth && environment.layout[ymj_x + k].contains_unit == -1 && isEnvironmentTileBetween(ymj_x + k, graphicsMin, graphicsMax))
-                    return ymj_x + k;
-                if (xmk_lt_zero && environment.layout[ymj_x - k].contains_unit == -1 && isEnvironmentTileBetween(ymj_x - k, graphicsMin, graphicsMax))
-                    return ymj_x - k;
-            }
-        }
-        
-        if (y+j < environment.height) { // bottom row outer tiles (the corner tiles)
-            if (x+j < environment.width && environment.layout[ypj_x + j].contains_unit == -1 && isEnvironmentTileBetween(ypj_x + j, graphicsMin, graphicsMax))
-                return ypj_x + j;
-            if (x-j >= 0 && environment.layout[ypj_x - j].contains_unit == -1 && isEnvironmentTileBetween(ypj_x - j, graphicsMin, graphicsMax))
-                return ypj_x - j;
-        }
-        if (y-j >= 0) { // top row outer tiles (the corner tiles)
-            if (x+j < environment.width && environment.layout[ymj_x + j].contains_unit == -1 && isEnvironmentTileBetween(ymj_x + j, graphicsMin, graphicsMax))
-                return ymj_x + j;
-            if (x-j >= 0 && environment.layout[ymj_x - j].contains_unit == -1 && isEnvironmentTileBetween(ymj_x - j, graphicsMin, graphicsMax))
-                return ymj_x - j;
-        }
-    }
-    return -1;
+    return searchRings(curTile, RING_SEARCH_MAX_RADIUS, unoccupiedEnvironmentTileInRange, &range, 0);
 }
 
 // WARNING: this function should only be used by placeUnitOnTile
@@ -980,7 +964,8 @@ int placeUnitOnTile(int unit_nr, int tile) {
     unit[unit_nr].x = X_FROM_TILE(tile);
     unit[unit_nr].y = Y_FROM_TILE(tile);;
     unit[unit_nr].guard_tile = tile;
-    environment.layout[tile].contains_unit = unit_nr;
+    setTileUnit(tile, unit_nr);
+    updateUnitGrid(unit_nr);
     return 1;
 }
 
@@ -1004,23 +989,24 @@ int dropUnit(int unitnr, int x, int y) {
     #ifdef REMOVE_ASTAR_PATHFINDING
     curUnit->hugging_obstacle = 0;
     #endif
+    updateUnitGrid(unitnr);
     
     tile = TILE_FROM_XY(x,y);
-    curUnit->logic_aid = tile;
+    setUnitLogicAid(curUnit, tile);
     structureNr = environment.layout[tile].contains_structure;
     if (structureNr < -1)
         structureNr = environment.layout[tile + structureNr + 1].contains_structure;
     if (structureNr >= 0) {
         if (structure[structureNr].rally_tile < 0)
-            curUnit->logic_aid = tile + ((y+1 < environment.height) * environment.width);
+            setUnitLogicAid(curUnit, tile + ((y+1 < environment.height) * environment.width));
         else {
-            curUnit->logic_aid = structure[structureNr].rally_tile;
+            setUnitLogicAid(curUnit, structure[structureNr].rally_tile);
             if (!structureInfo[structure[structureNr].info].can_extract_ore) { // B34, part2 (feeders returned after their mining job to the structure's rally point instead of to the structure itself)
-                curUnit->retreat_tile = structure[structureNr].rally_tile;
+                setUnitRetreatTile(curUnit, structure[structureNr].rally_tile);
                 curUnit->logic = UL_MOVE_LOCATION; // could have used 'UL_RETREAT' but units will then not perform idle animation at their destination
-                curUnit->logic_aid = curUnit->retreat_tile;
+                setUnitLogicAid(curUnit, curUnit->retreat_tile);
             } else { // B34, part1 (feeders should automatically start extracting ore when a rally tile is set - pretending the unit retreated, if it's not a newly created unit, takes care of that)
-                curUnit->retreat_tile = tile; // retreat tile set to structure
+                setUnitRetreatTile(curUnit, tile); // retreat tile set to structure
                 if (curUnit->side != FRIENDLY || curUnit->logic != UL_GUARD)
                     curUnit->logic = UL_RETREAT;
             }
@@ -1029,8 +1015,8 @@ int dropUnit(int unitnr, int x, int y) {
     
     if (getGameType() == SINGLEPLAYER) {
         if (curUnit->side != FRIENDLY && curUnitInfo->can_collect_ore) {
-            curUnit->retreat_tile = tile;
-            curUnit->logic_aid = nearestEnvironmentTile(tile, ORE, OREHILL16);
+            setUnitRetreatTile(curUnit, tile);
+            setUnitLogicAid(curUnit, nearestEnvironmentTile(tile, ORE, OREHILL16));
             curUnit->logic = (curUnit->logic_aid == -1) ? UL_GUARD : UL_RETREAT; // pretending the unit retreated if it can start mining
         }
     }
@@ -1060,7 +1046,7 @@ int dropUnit(int unitnr, int x, int y) {
         curUnit->move_aid = curUnitInfo->speed;
         if (y < environment.height - 1) {
             if (freeToPlaceUnitOnTile(&unit[unitnr], TILE_FROM_XY(x,y+1)) && unitCanLeaveGrid(curUnit, TILE_FROM_XY(x,y+1), 3)) {
-                environment.layout[tile].contains_unit = unitnr;
+                setTileUnit(tile, unitnr);
                 curUnit->unit_positioned = DOWN;
                 curUnit->turret_positioned = DOWN;
                 curUnit->move = UM_MOVE_DOWN;
@@ -1071,7 +1057,7 @@ int dropUnit(int unitnr, int x, int y) {
                 return 1;
             }
             if (x > 0 && freeToPlaceUnitOnTile(&unit[unitnr], TILE_FROM_XY(x-1,y+1)) && unitCanLeaveGrid(curUnit, TILE_FROM_XY(x-1,y+1), 3)) {
-                environment.layout[tile].contains_unit = unitnr;
+                setTileUnit(tile, unitnr);
 //                curUnit->logic_aid -= 1;
                 curUnit->unit_positioned = LEFT_DOWN;
                 curUnit->turret_positioned = LEFT_DOWN;
@@ -1083,7 +1069,7 @@ int dropUnit(int unitnr, int x, int y) {
                 return 1;
             }
             if ((x < environment.width - 1) && freeToPlaceUnitOnTile(&unit[unitnr], TILE_FROM_XY(x+1,y+1)) && unitCanLeaveGrid(curUnit, TILE_FROM_XY(x+1,y+1), 3)) {
-                environment.layout[tile].contains_unit = unitnr;
+                setTileUnit(tile, unitnr);
 //                curUnit->logic_aid += 1;
                 curUnit->unit_positioned = RIGHT_DOWN;
                 curUnit->turret_positioned = RIGHT_DOWN;
@@ -1174,27 +1160,28 @@ int dropUnit(int unitnr, int x, int y) {
 
 int addUnit(enum Side side, int x, int y, int info, int forced) {
     int i, j;
-    struct Unit *curUnit = unit;
+    struct Unit *curUnit;
     struct UnitInfo *curUnitInfo = unitInfo + info;
     struct StructureInfo *curStructureInfo;
     struct Structure *curStructure;
     int structureId;
     
-    for (i=0; i<MAX_UNITS_ON_MAP; i++, curUnit++) {
-        if (!curUnit->enabled && !(curUnit->group & AWAITING_REPLACEMENT)) {
+    for (i=getFreeEntityPoolEntry(&unitPool, 0); i>=0; i=getFreeEntityPoolEntry(&unitPool, i+1)) {
+        curUnit = unit + i;
+        if (!(curUnit->group & AWAITING_REPLACEMENT)) {
             curUnit->group = 0;
             curUnit->selected = 0;
             curUnit->info = info;
             curUnit->side = side;
             curUnit->x = x;
             curUnit->y = y;
-            curUnit->retreat_tile = TILE_FROM_XY(x,y);
+            setUnitRetreatTile(curUnit, TILE_FROM_XY(x,y));
             curUnit->guard_tile   = TILE_FROM_XY(x,y);
             curUnit->ore = 5;
             curUnit->armour = curUnitInfo->max_armour;
             curUnit->unit_positioned = DOWN;
             curUnit->turret_positioned = DOWN;
-            curUnit->logic_aid = -1;
+            setUnitLogicAid(curUnit, -1);
             #ifdef REMOVE_ASTAR_PATHFINDING
             curUnit->hugging_obstacle = 0;
             #endif
@@ -1216,12 +1203,12 @@ int addUnit(enum Side side, int x, int y, int info, int forced) {
                 if (j == -1 || !structureInfo[structure[j].info].can_extract_ore) {
                     for (j=0; j<MAX_STRUCTURES_ON_MAP; j++) {
                         if (structure[j].enabled && structure[j].primary && structure[j].side == FRIENDLY && structureInfo[structure[j].info].can_extract_ore) {
-                            curUnit->retreat_tile = TILE_FROM_XY(structure[j].x + structureInfo[structure[j].info].release_tile, structure[j].y + structureInfo[structure[j].info].height - 1);
+                            setUnitRetreatTile(curUnit, TILE_FROM_XY(structure[j].x + structureInfo[structure[j].info].release_tile, structure[j].y + structureInfo[structure[j].info].height - 1));
                             break;
                         }
                     }
                     if (j == MAX_STRUCTURES_ON_MAP)
-                        curUnit->retreat_tile = -1;
+                        setUnitRetreatTile(curUnit, -1);
                 }
             }
             
@@ -1229,8 +1216,9 @@ int addUnit(enum Side side, int x, int y, int info, int forced) {
             if (forced) {
                 curUnit->guard_tile = TILE_FROM_XY(x,y);
                 curUnit->move = UM_NONE;
-                environment.layout[curUnit->retreat_tile].contains_unit = i;
+                setTileUnit(curUnit->retreat_tile, i);
                 curUnit->enabled = 1;
+                updateUnitGrid(i);
                 if (curUnit->side == FRIENDLY)
                     activateEntityView(x, y, 1, 1, curUnitInfo->view_range);
                 setUnitCount(curUnit->side, getUnitCount(curUnit->side) + 1);
@@ -1246,7 +1234,7 @@ int addUnit(enum Side side, int x, int y, int info, int forced) {
                     curStructureInfo = structureInfo + structure->info;
                     if (!structure->logic_aid && curStructureInfo->active_ani > 0 && !curStructureInfo->barrier && 
                         curStructureInfo->projectile_info < 0 && !curStructureInfo->can_extract_ore && !curStructureInfo->can_repair_unit)
-                        curStructure->logic_aid = 1;
+                        setStructureLogicAid(curStructure, 1);
 //                    if (curStructureInfo->can_extract_ore && structure->rally_tile != ((curStructure->y + curStructureInfo->height - (1 * (curStructure->y + curStructureInfo->height >= environment.height))) * environment.width + curStructure->x + curStructureInfo->release_tile)) {
 //                        curUnit->logic = UL_MINE_LOCATION;
 //                        curUnit->logic_aid = structure[structureId].rally_tile;
@@ -1262,6 +1250,25 @@ int addUnit(enum Side side, int x, int y, int info, int forced) {
 }
 
 
+// transforms a unit into the structure it contains. returns the nr of the new structure, or -1 if it could not be placed
+int deployUnit(int unitnr) {
+    struct Unit *curUnit = &unit[unitnr];
+    int tile = TILE_FROM_XY(curUnit->x, curUnit->y);
+    int nr;
+    
+    setTileUnit(tile, -1);
+    if ((nr = addStructure(curUnit->side, curUnit->x, curUnit->y, unitInfo[curUnit->info].contains_structure, 1)) == -1) {
+        setTileUnit(tile, unitnr);
+        return -1;
+    }
+    if (structure[nr].armour != INFINITE_ARMOUR)
+        structure[nr].armour = (structure[nr].armour * 3) / 4;
+    curUnit->armour = 0;
+    curUnit->selected = 0;
+    return nr;
+}
+
+
 int unitTouchableOnTileCoordinates(int unitnr, int xtouch, int ytouch) {
     struct Unit *curUnit;
     struct UnitInfo *curUnitInfo;
@@ -1507,26 +1514,26 @@ void loadUnitsGraphicsSprites(int *offsetSp) {
 
     for (i=0; i<MAX_DIFFERENT_UNITS && unitInfo[i].enabled; i++) {
         unitInfo[i].graphics_offset = (*offsetSp)/(16*16);
-        *offsetSp += copyFileVRAM(SPRITE_EXPANDED_GFX + ((*offsetSp)>>1), unitInfo[i].name, FS_UNITS_GRAPHICS);
+        *offsetSp += copyFileVRAM(SPRITE_EXPANDED_GFX + ((*offsetSp)>>1), unitInfoText[i].name, FS_UNITS_GRAPHICS);
         
-        memcpy(oneline, unitInfo[i].name, MAX_UNIT_NAME_LENGTH);
+        memcpy(oneline, unitInfoText[i].name, MAX_UNIT_NAME_LENGTH);
         if (unitInfo[i].can_rotate_turret) {
-            sprintf(oneline + strlen(unitInfo[i].name), "_turret");
+            sprintf(oneline + strlen(unitInfoText[i].name), "_turret");
             *offsetSp += copyFileVRAM(SPRITE_EXPANDED_GFX + ((*offsetSp)>>1), oneline, FS_UNITS_GRAPHICS);
         }
         if (unitInfo[i].shoot_ani) {
             if (unitInfo[i].can_collect_ore) {
                 for (j=0; j<unitInfo[i].shoot_ani-1; j++) {
-                    sprintf(oneline + strlen(unitInfo[i].name), "_mine%i", j+1);
+                    sprintf(oneline + strlen(unitInfoText[i].name), "_mine%i", j+1);
                     *offsetSp += copyFileVRAM(SPRITE_EXPANDED_GFX + ((*offsetSp)>>1), oneline, FS_UNITS_GRAPHICS);
                 }
             } else {
-                sprintf(oneline + strlen(unitInfo[i].name), "_shoot");
+                sprintf(oneline + strlen(unitInfoText[i].name), "_shoot");
                 *offsetSp += copyFileVRAM(SPRITE_EXPANDED_GFX + ((*offsetSp)>>1), oneline, FS_UNITS_GRAPHICS);
             }
         }
         for (j=0; j<unitInfo[i].move_ani; j+=2) {
-            sprintf(oneline + strlen(unitInfo[i].name), "_move%i", j+1);
+            sprintf(oneline + strlen(unitInfoText[i].name), "_move%i", j+1);
             *offsetSp += copyFileVRAM(SPRITE_EXPANDED_GFX + ((*offsetSp)>>1), oneline, FS_UNITS_GRAPHICS);
         }
     }
@@ -1620,19 +1627,19 @@ int recalculateDestination(int unit_nr) {
         ymj_x = TILE_FROM_XY(x, y-j);
         
         if (y+j < environment.height && freeToPlaceUnitOnTile(curUnit, ypj_x)) {                // bottom row middle tile
-            curUnit->logic_aid = ypj_x;
+            setUnitLogicAid(curUnit, ypj_x);
             return 1;
         }
         if (x+j < environment.width && freeToPlaceUnitOnTile(curUnit, TILE_FROM_XY(x+j, y))) {  // right column middle tile
-            curUnit->logic_aid = TILE_FROM_XY(x+j, y);
+            setUnitLogicAid(curUnit, TILE_FROM_XY(x+j, y));
             return 1;
         }
         if (x-j >= 0 && freeToPlaceUnitOnTile(curUnit, TILE_FROM_XY(x-j, y))) {                  // left column middle tile
-            curUnit->logic_aid = TILE_FROM_XY(x-j, y);
+            setUnitLogicAid(curUnit, TILE_FROM_XY(x-j, y));
             return 1;
         }
         if (y-j >= 0 && freeToPlaceUnitOnTile(curUnit, ymj_x)) {                                  // top row middle tile
-            curUnit->logic_aid = ymj_x;
+            setUnitLogicAid(curUnit, ymj_x);
             return 1;
         }
         
@@ -1649,41 +1656,41 @@ int recalculateDestination(int unit_nr) {
             
             if (ypj_st_envheight) { // bottom row
                 if (xpk_st_envwidth && freeToPlaceUnitOnTile(curUnit, ypj_x + k)) {
-                    curUnit->logic_aid = ypj_x + k;
+                    setUnitLogicAid(curUnit, ypj_x + k);
                     return 1;
                 }
                 if (xmk_lt_zero && freeToPlaceUnitOnTile(curUnit, ypj_x - k)) {
-                    curUnit->logic_aid = ypj_x - k;
+                    setUnitLogicAid(curUnit, ypj_x - k);
                     return 1;
                 }
             }
             if (xpj_st_envwidth) { // right column
                 if (ypk_st_envheight && freeToPlaceUnitOnTile(curUnit, TILE_FROM_XY(x+j, y+k))) {
-                    curUnit->logic_aid = TILE_FROM_XY(x+j, y+k);
+                    setUnitLogicAid(curUnit, TILE_FROM_XY(x+j, y+k));
                     return 1;
                 }
                 if (ymk_lt_zero && freeToPlaceUnitOnTile(curUnit, TILE_FROM_XY(x+j, y-k))) {
-                    curUnit->logic_aid = TILE_FROM_XY(x+j, y-k);
+                    setUnitLogicAid(curUnit, TILE_FROM_XY(x+j, y-k));
                     return 1;
                 }
             }
             if (xmj_lt_zero) { // left column
                 if (ypk_st_envheight && freeToPlaceUnitOnTile(curUnit, TILE_FROM_XY(x-j, y+k))) {
-                    curUnit->logic_aid = TILE_FROM_XY(x-j, y+k);
+                    setUnitLogicAid(curUnit, TILE_FROM_XY(x-j, y+k));
                     return 1;
                 }
                 if (ymk_lt_zero && freeToPlaceUnitOnTile(curUnit, TILE_FROM_XY(x-j, y-k))) {
-                    curUnit->logic_aid = TILE_FROM_XY(x-j, y-k);
+                    setUnitLogicAid(curUnit, TILE_FROM_XY(x-j, y-k));
                     return 1;
                 }
             }
             if (ymj_lt_zero) { // top row
                 if (xpk_st_envwidth && freeToPlaceUnitOnTile(curUnit, ymj_x + k)) {
-                    curUnit->logic_aid = ymj_x + k;
+                    setUnitLogicAid(curUnit, ymj_x + k);
                     return 1;
                 }
                 if (xmk_lt_zero && freeToPlaceUnitOnTile(curUnit, ymj_x - k)) {
-                    curUnit->logic_aid = ymj_x - k;
+                    setUnitLogicAid(curUnit, ymj_x - k);
                     return 1;
                 }
             }
@@ -1691,21 +1698,21 @@ int recalculateDestination(int unit_nr) {
         
         if (y+j < environment.height) { // bottom row outer tiles (the corner tiles)
             if (x+j < environment.width && freeToPlaceUnitOnTile(curUnit, ypj_x + j)) {
-                curUnit->logic_aid = ypj_x + j;
+                setUnitLogicAid(curUnit, ypj_x + j);
                 return 1;
             }
             if (x-j >= 0 && freeToPlaceUnitOnTile(curUnit, ypj_x - j)) {
-                curUnit->logic_aid = ypj_x - j;
+                setUnitLogicAid(curUnit, ypj_x - j);
                 return 1;
             }
         }
         if (y-j >= 0) { // top row outer tiles (the corner tiles)
             if (x+j < environment.width && freeToPlaceUnitOnTile(curUnit, ymj_x + j)) {
-                curUnit->logic_aid = ymj_x + j;
+                setUnitLogicAid(curUnit, ymj_x + j);
                 return 1;
             }
             if (x-j >= 0 && freeToPlaceUnitOnTile(curUnit, ymj_x - j)) {
-                curUnit->logic_aid = ymj_x - j;
+                setUnitLogicAid(curUnit, ymj_x - j);
                 return 1;
             }
         }
@@ -1893,8 +1900,9 @@ enum UnitMove findBestAttackPath(int unit_nr, int curX, int curY, int shoot_rang
 #endif
 
 
-int getBestStructureToAttackAI() {
+static int findBestStructureToAttackAI(enum Side ownSide) {
     int i, j;
+    int best, bestScore = 0, score;
     struct PriorityStructureAI *priorityStructureAI = getPriorityStructureAI();
     
     // first a quick check if any enemy structures exist
@@ -1905,17 +1913,47 @@ int getBestStructureToAttackAI() {
     if (i == getAmountOfSides())
         return -1;
     
+    // of the structures first on the list, the one least defended and where the fewest units of the side were lost
     for (i=0; i<priorityStructureAI->amountOfItems; i++) {
+        best = -1;
         for (j=MAX_DIFFERENT_FACTIONS; j<MAX_STRUCTURES_ON_MAP; j++) {
-            if (structure[j].info == priorityStructureAI->item[i] && structure[j].enabled && structure[j].side == FRIENDLY)
-                return j;
+            if (structure[j].info == priorityStructureAI->item[i] && structure[j].enabled && structure[j].side == FRIENDLY) {
+                score = getInfluenceThreat(ownSide, structure[j].x, structure[j].y);
+                if (best < 0 || score < bestScore) {
+                    best = j;
+                    bestScore = score;
+                }
+            }
         }
+        if (best >= 0)
+            return best;
     }
+    // otherwise, the one amidst the most value for the least defence
+    best = -1;
     for (i=MAX_DIFFERENT_FACTIONS; i<MAX_STRUCTURES_ON_MAP; i++) {
-        if (structure[i].enabled && structure[i].side == FRIENDLY && !structureInfo[structure[i].info].foundation)
-            return i;
+        if (structure[i].enabled && structure[i].side == FRIENDLY && !structureInfo[structure[i].info].foundation) {
+            score = getInfluenceStructureValue(FRIENDLY, structure[i].x, structure[i].y) - getInfluenceThreat(ownSide, structure[i].x, structure[i].y);
+            if (best < 0 || score > bestScore) {
+                best = i;
+                bestScore = score;
+            }
+        }
     }
-    return -1;
+    return best;
+}
+
+// the structure of the player for the hunting units of a side to attack. it is looked for once every logic frame, as
+// all of them would find the same one
+int getBestStructureToAttackAI(enum Side ownSide) {
+    int best = bestStructureToAttack[ownSide];
+    
+    if (bestStructureToAttackFrame[ownSide] != unitsLogicFrame ||
+        (best >= 0 && !(structure[best].enabled && structure[best].side == FRIENDLY))) {
+        best = findBestStructureToAttackAI(ownSide);
+        bestStructureToAttack[ownSide] = best;
+        bestStructureToAttackFrame[ownSide] = unitsLogicFrame;
+    }
+    return best;
 }
 
 inline int enemyOfStructureOnTile(int tile, enum Side notOfSide) {
@@ -1932,14 +1970,24 @@ inline int enemyOfStructureOnTile(int tile, enum Side notOfSide) {
     return -1;
 }
 
+struct AttackSearch {
+    enum Side ownSide;
+    int offensiveOnly;
+};
+
+static int structureToAttackOnTile(int tile, void *search) {
+    struct AttackSearch *curSearch = search;
+    int result = enemyOfStructureOnTile(tile, curSearch->ownSide);
+    
+    if (result >= 0 && (!curSearch->offensiveOnly || structureInfo[structure[result].info].shoot_range > 0))
+        return result;
+    return -1;
+}
+
 int getNearestStructureToAttackAI(enum Side ownSide, int x, int y, int offensiveOnly, int maxRadius) {
     // basicly using Manhattan distance for ease of use
-    int result;
-    int maxwh;
-    int i, j, k;
-    int ypj_x, ymj_x;
-    int xpj_st_envwidth, xmj_lt_zero, ypj_st_envheight, ymj_lt_zero;
-    int xpk_st_envwidth, xmk_lt_zero, ypk_st_envheight, ymk_lt_zero;
+    struct AttackSearch search = { ownSide, offensiveOnly };
+    int i;
     
     // first a quick check if any enemy structures exist    
     for (i=0; i<getAmountOfSides(); i++) {
@@ -1949,91 +1997,9 @@ int getNearestStructureToAttackAI(enum Side ownSide, int x, int y, int offensive
     if (i == getAmountOfSides())
         return -1;
     
-    maxwh = max(environment.width, environment.height);
-    if (maxRadius)
-        maxwh = min(1 + maxRadius, maxwh);
-    for (j=1; j<maxwh; j++) {
-        
-        ypj_x = TILE_FROM_XY(x, y+j);
-        ymj_x = TILE_FROM_XY(x, y-j);
-        
-        if (y+j < environment.height && (result = enemyOfStructureOnTile(ypj_x, ownSide)) >= 0)                 // bottom column middle tile
-            if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                return result; //environment.layout[ypj_x].contains_unit;
-        if (x+j < environment.width && (result = enemyOfStructureOnTile(TILE_FROM_XY(x+j, y), ownSide)) >= 0)  // right column middle tile
-            if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                return result; //environment.layout[environment.width * y + x + j].contains_unit;
-        if (x-j >= 0 && (result = enemyOfStructureOnTile(TILE_FROM_XY(x-j, y), ownSide)) >= 0)                  // left column middle tile
-            if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                return result; //environment.layout[environment.width * y + x - j].contains_unit;
-        if (y-j >= 0 && (result = enemyOfStructureOnTile(ymj_x, ownSide)) >= 0)                                  // top row middle tile
-            if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                return result; //environment.layout[ymj_x].contains_unit;
-          
-        xpj_st_envwidth = x+j < environment.width;
-        xmj_lt_zero = x-j >= 0;
-        ypj_st_envheight = y+j < environment.height;
-        ymj_lt_zero = y-j >= 0;
-        
-        for (k=1; k<j; k++) {
-            xpk_st_envwidth = x+k < environment.width;
-            xmk_lt_zero = x-k >= 0;
-            ypk_st_envheight = y+k < environment.height;
-            ymk_lt_zero = y-k >= 0;
-            
-            if (ypj_st_envheight) { // bottom row
-                if (xpk_st_envwidth && (result = enemyOfStructureOnTile(ypj_x + k, ownSide)) >= 0)
-                    if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                        return result;
-                if (xmk_lt_zero && (result = enemyOfStructureOnTile(ypj_x - k, ownSide)) >= 0)
-                    if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                        return result;
-            }
-            if (xpj_st_envwidth) { // right column
-                if (ypk_st_envheight && (result = enemyOfStructureOnTile(TILE_FROM_XY(x+j, y+k), ownSide)) >= 0)
-                    if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                        return result;
-                if (ymk_lt_zero && (result = enemyOfStructureOnTile(TILE_FROM_XY(x+j, y-k), ownSide)) >= 0)
-                    if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                        return result;
-            }
-            if (xmj_lt_zero) { // left column
-                if (ypk_st_envheight && (result = enemyOfStructureOnTile(TILE_FROM_XY(x-j, y+k), ownSide)) >= 0)
-                    if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                        return result;
-                if (ymk_lt_zero && (result = enemyOfStructureOnTile(TILE_FROM_XY(x-j, y-k), ownSide)) >= 0)
-                    if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                        return result;
-            }
-            if (ymj_lt_zero) { // top row
-                if (xpk_st_envwidth && (result = enemyOfStructureOnTile(ymj_x + k, ownSide)) >= 0)
-                    if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                        return result;
-                if (xmk_lt_zero && (result = enemyOfStructureOnTile(ymj_x - k, ownSide)) >= 0)
-                    if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                        return result;
-            }
-        }
-        
-        if (y+j < environment.height) { // bottom row outer tiles (the corner tiles)
-            if (x+j < environment.width && (result = enemyOfStructureOnTile(ypj_x + j, ownSide)) >= 0)
-                if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                    return result;
-            if (x-j >= 0 && (result = enemyOfStructureOnTile(ypj_x - j, ownSide)) >= 0)
-                if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                    return result;
-        }
-        if (y-j >= 0) { // top row outer tiles (the corner tiles)
-            if (x+j < environment.width && (result = enemyOfStructureOnTile(ymj_x + j, ownSide)) >= 0)
-                if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                    return result;
-            if (x-j >= 0 && (result = enemyOfStructureOnTile(ymj_x - j, ownSide)) >= 0)
-                if (!offensiveOnly || structureInfo[structure[result].info].shoot_range > 0)
-                    return result;
-        }
-    }
-    
-    return -1;
+    // no enemy structure is nearer than its distance field holds
+    return searchRingsFrom(TILE_FROM_XY(x, y), getDistanceToNearestTarget(DFT_STRUCTURES, ownSide, TILE_FROM_XY(x, y)),
+                           maxRadius ? maxRadius : RING_SEARCH_MAX_RADIUS, structureToAttackOnTile, &search, 0);
 }
 
 inline int enemyOfUnitOnTile(int tile, enum Side notOfSide) {
@@ -2048,14 +2014,19 @@ inline int enemyOfUnitOnTile(int tile, enum Side notOfSide) {
     return -1;
 }
 
+static int unitToAttackOnTile(int tile, void *search) {
+    struct AttackSearch *curSearch = search;
+    int result = enemyOfUnitOnTile(tile, curSearch->ownSide);
+    
+    if (result >= 0 && (!curSearch->offensiveOnly || unitInfo[unit[result].info].shoot_range > 0))
+        return result;
+    return -1;
+}
+
 int getNearestUnitToAttackAI(enum Side ownSide, int x, int y, int offensiveOnly, int maxRadius) {
     // basicly using Manhattan distance for ease of use
-    int result;
-    int maxwh;
-    int i, j, k;
-    int ypj_x, ymj_x;
-    int xpj_st_envwidth, xmj_lt_zero, ypj_st_envheight, ymj_lt_zero;
-    int xpk_st_envwidth, xmk_lt_zero, ypk_st_envheight, ymk_lt_zero;
+    struct AttackSearch search = { ownSide, offensiveOnly };
+    int i;
 
     // first a quick check if any enemy units exist    
     for (i=0; i<getAmountOfSides(); i++) {
@@ -2065,268 +2036,11 @@ int getNearestUnitToAttackAI(enum Side ownSide, int x, int y, int offensiveOnly,
     if (i == getAmountOfSides())
         return -1;
     
-    maxwh = max(environment.width, environment.height);
-    if (maxRadius)
-        maxwh = min(1 + maxRadius, maxwh);
-    for (j=1; j<maxwh; j++) {
-        
-        ypj_x = TILE_FROM_XY(x, y+j);
-        ymj_x = TILE_FROM_XY(x, y-j);
-        
-        if (y+j < environment.height && (result = enemyOfUnitOnTile(ypj_x, ownSide)) >= 0)                 // bottom column middle tile
-            if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                return result; //environment.layout[ypj_x].contains_unit;
-        if (x+j < environment.width && (result = enemyOfUnitOnTile(TILE_FROM_XY(x+j, y), ownSide)) >= 0)  // right column middle tile
-            if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                return result; //environment.layout[environment.width * y + x + j].contains_unit;
-        if (x-j >= 0 && (result = enemyOfUnitOnTile(TILE_FROM_XY(x-j, y), ownSide)) >= 0)                  // left column middle tile
-            if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                return result; //environment.layout[environment.width * y + x - j].contains_unit;
-        if (y-j >= 0 && (result = enemyOfUnitOnTile(ymj_x, ownSide)) >= 0)                                  // top row middle tile
-            if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                return result; //environment.layout[ymj_x].contains_unit;
-          
-        xpj_st_envwidth = x+j < environment.width;
-        xmj_lt_zero = x-j >= 0;
-        ypj_st_envheight = y+j < environment.height;
-        ymj_lt_zero = y-j >= 0;
-        
-        for (k=1; k<j; k++) {
-            xpk_st_envwidth = x+k < environment.width;
-            xmk_lt_zero = x-k >= 0;
-            ypk_st_envheight = y+k < environment.height;
-            ymk_lt_zero = y-k >= 0;
-            
-            if (ypj_st_envheight) { // bottom row
-                if (xpk_st_envwidth && (result = enemyOfUnitOnTile(ypj_x + k, ownSide)) >= 0)
-                    if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                        return result; //environment.layout[ypj_x + k].contains_unit;
-                if (xmk_lt_zero && (result = enemyOfUnitOnTile(ypj_x - k, ownSide)) >= 0)
-                    if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                        return result; //environment.layout[ypj_x - k].contains_unit;
-            }
-            if (xpj_st_envwidth) { // right column
-                if (ypk_st_envheight && (result = enemyOfUnitOnTile(TILE_FROM_XY(x+j, y+k), ownSide)) >= 0)
-                    if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                        return result; //environment.layout[environment.width * (y + k) + x + j].contains_unit;
-                if (ymk_lt_zero && (result = enemyOfUnitOnTile(TILE_FROM_XY(x+j, y-k), ownSide)) >= 0)
-                    if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                        return result; //environment.layout[environment.width * (y - k) + x + j].contains_unit;
-            }
-            if (xmj_lt_zero) { // left column
-                if (ypk_st_envheight && (result = enemyOfUnitOnTile(TILE_FROM_XY(x-j, y+k), ownSide)) >= 0)
-                    if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                        return result; //environment.layout[environment.width * (y + k) + x - j].contains_unit;
-                if (ymk_lt_zero && (result = enemyOfUnitOnTile(TILE_FROM_XY(x-j, y-k), ownSide)) >= 0)
-                    if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                        return result; //environment.layout[environment.width * (y - k) + x - j].contains_unit;
-            }
-            if (ymj_lt_zero) { // top row
-                if (xpk_st_envwidth && (result = enemyOfUnitOnTile(ymj_x + k, ownSide)) >= 0)
-                    if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                        return result; //environment.layout[ymj_x + k].contains_unit;
-                if (xmk_lt_zero && (result = enemyOfUnitOnTile(ymj_x - k, ownSide)) >= 0)
-                    if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                        return result; //environment.layout[ymj_x - k].contains_unit;
-            }
-        }
-        
-        if (y+j < environment.height) { // bottom row outer tiles (the corner tiles)
-            if (x+j < environment.width && (result = enemyOfUnitOnTile(ypj_x + j, ownSide)) >= 0)
-                if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                    return result; //environment.layout[ypj_x + j].contains_unit;
-            if (x-j >= 0 && (result = enemyOfUnitOnTile(ypj_x - j, ownSide)) >= 0)
-                if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                    return result; //environment.layout[ypj_x - j].contains_unit;
-        }
-        if (y-j >= 0) { // top row outer tiles (the corner tiles)
-            if (x+j < environment.width && (result = enemyOfUnitOnTile(ymj_x + j, ownSide)) >= 0)
-                if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                    return result; //environment.layout[ymj_x + j].contains_unit;
-            if (x-j >= 0 && (result = enemyOfUnitOnTile(ymj_x - j, ownSide)) >= 0)
-                if (!offensiveOnly || unitInfo[unit[result].info].shoot_range > 0)
-                    return result; //environment.layout[ymj_x - j].contains_unit;
-        }
-    }
-    
-    return -1;
-}
-
-// TODO: MAKE THIS OPTIMIZED! OPTIMIZED VERSION FAILS!!!
-void activateUnitMoveView(int x, int y, enum UnitMove move, int viewRange) { /* x and y being the new position, not the old */
-    #ifndef DISABLE_SHROUD
-    char section; // up, right, down, left bit.
-    char statusModifier = 0;
-    int diagonal;
-    int viewRange2 = viewRange * viewRange;
-    int coordCalc;
-    int i, j, tile;
-    
-    if ((diagonal = (move % 2 == 0))) // diagonal, affects only two sections
-        section = BIT((move/2)-1) | BIT((move/2)%4);
-    else // not diagonal, affects three sections
-        section = ~(BIT(((move/2)+2)%4));
-    
-//    if (diagonal) { // use non-optimized stuff
-        activateEntityView(x, y, 1, 1, viewRange);
-        return;
-//    }
-    
-    if (move <= UM_MOVE_RIGHT_UP && move >= UM_MOVE_LEFT_UP)
-        statusModifier |= CLEAR_DOWN;
-    else if (move >= UM_MOVE_RIGHT_DOWN && move <= UM_MOVE_LEFT_DOWN)
-        statusModifier |= CLEAR_UP;
-    if (move >= UM_MOVE_RIGHT_UP && move <= UM_MOVE_RIGHT_DOWN)
-        statusModifier |= CLEAR_LEFT;
-    else if (move >= UM_MOVE_LEFT_DOWN && move <= UM_MOVE_LEFT_UP)
-        statusModifier |= CLEAR_RIGHT;
-    
-    if (section & BIT(0)) { // up
-        if (y - viewRange >= 0) {
-//            if (diagonal)
-//                environment.layout[((y - viewRange) + 1) * environment.width + x].status = CLEAR_ALL;
-            tile = TILE_FROM_XY(x, y - viewRange);
-//            if (environment.layout[tile].status == UNDISCOVERED)
-                setTileDirtyRadarDirtyBitmap(tile);
-            environment.layout[tile].status |= statusModifier;
-            adjustShroudType(x, y - viewRange);
-        }
-    }
-    if (section & BIT(1)) { // right
-        if (x + viewRange < environment.width) {
-//            if (diagonal)
-//                environment.layout[y * environment.width + x + viewRange - 1].status = CLEAR_ALL;
-            tile = TILE_FROM_XY(x + viewRange, y);
-//            if (environment.layout[tile].status == UNDISCOVERED)
-                setTileDirtyRadarDirtyBitmap(tile);
-            environment.layout[tile].status |= statusModifier;
-            adjustShroudType(x + viewRange, y);
-        }
-    }
-    if (section & BIT(2)) { // down
-        if (y + viewRange < environment.height) {
-//            if (diagonal)
-//                environment.layout[(y + viewRange - 1) * environment.width + x].status = CLEAR_ALL;
-            tile = TILE_FROM_XY(x, y + viewRange);
-//            if (environment.layout[tile].status == UNDISCOVERED)
-                setTileDirtyRadarDirtyBitmap(tile);
-            environment.layout[tile].status |= statusModifier;
-            adjustShroudType(x, y + viewRange);
-        }
-    }
-    if (section & BIT(3)) { // left
-        if (x - viewRange >= 0) {
-//            if (diagonal)
-//                environment.layout[y * environment.width + (x - viewRange) + 1].status = CLEAR_ALL;
-            tile = TILE_FROM_XY(x - viewRange, y);
-//            if (environment.layout[tile].status == UNDISCOVERED)
-                setTileDirtyRadarDirtyBitmap(tile);
-            environment.layout[tile].status |= statusModifier;
-            adjustShroudType(x - viewRange, y);
-        }
-    }
-
-    
-    for (i=1, j=1; i<viewRange; i++) {
-        for (; j <= viewRange - i; j++) {
-            coordCalc = viewRange - j;
-            if (coordCalc * coordCalc + i*i <= viewRange2) { // found two outer tiles
-                if (section & BIT(0)) { // up
-                    if (y - coordCalc >= 0) {
-                        if (x - i >= 0) {
-//                            if (diagonal)
-//                                environment.layout[((y - coordCalc) + 1) * environment.width + (x - i)].status = CLEAR_ALL;
-                            tile = TILE_FROM_XY(x-i, y - coordCalc);
-//                            if (environment.layout[tile].status == UNDISCOVERED)
-                                setTileDirtyRadarDirtyBitmap(tile);
-                            environment.layout[tile].status |= statusModifier;
-                            adjustShroudType(x - i, y - coordCalc);
-                        }
-                        if (x + i < environment.width) {
-//                            if (diagonal)
-//                                environment.layout[((y - coordCalc) + 1) * environment.width + (x + i)].status = CLEAR_ALL;
-                            tile = TILE_FROM_XY(x+i, y - coordCalc);
-//                            if (environment.layout[tile].status == UNDISCOVERED)
-                                setTileDirtyRadarDirtyBitmap(tile);
-                            environment.layout[tile].status |= statusModifier;
-                            adjustShroudType(x + i, y - coordCalc);
-                        }
-                    }
-                }
-                if (section & BIT(1)) { // right
-                    if (x + coordCalc < environment.width) {
-                        if (y - i >= 0) {
-//                            if (diagonal)
-//                                environment.layout[(y - i) * environment.width + x + coordCalc - 1].status = CLEAR_ALL;
-                            tile = TILE_FROM_XY(x + coordCalc, y - i);
-//                            if (environment.layout[tile].status == UNDISCOVERED)
-                                setTileDirtyRadarDirtyBitmap(tile);
-                            environment.layout[tile].status |= statusModifier;
-                            adjustShroudType(x + coordCalc, y - i);
-                        }
-                        if (y + i < environment.height) {
-//                            if (diagonal)
-//                                environment.layout[(y + i) * environment.width + x + coordCalc - 1].status = CLEAR_ALL;
-                            tile = TILE_FROM_XY(x + coordCalc, y + i);
-//                            if (environment.layout[tile].status == UNDISCOVERED)
-                                setTileDirtyRadarDirtyBitmap(tile);
-                            environment.layout[tile].status |= statusModifier;
-                            adjustShroudType(x + coordCalc, y + i);
-                        }
-                    }
-                }
-                if (section & BIT(2)) { // down
-                    if (y + coordCalc < environment.height) {
-                        if (x - i >= 0) {
-//                            if (diagonal)
-//                                environment.layout[((y + coordCalc) - 1) * environment.width + (x - i)].status = CLEAR_ALL;
-                            tile = TILE_FROM_XY(x-i, y + coordCalc);
-//                            if (environment.layout[tile].status == UNDISCOVERED)
-                                setTileDirtyRadarDirtyBitmap(tile);
-                            environment.layout[tile].status |= statusModifier;
-                            adjustShroudType(x - i, y + coordCalc);
-                        }
-                        if (x + i < environment.width) {
-//                            if (diagonal)
-//                                environment.layout[((y + coordCalc) - 1) * environment.width + (x + i)].status = CLEAR_ALL;
-                            tile = TILE_FROM_XY(x+i, y + coordCalc);
-//                            if (environment.layout[tile].status == UNDISCOVERED)
-                                setTileDirtyRadarDirtyBitmap(tile);
-                            environment.layout[tile].status |= statusModifier;
-                            adjustShroudType(x + i, y + coordCalc);
-                        }
-                    }
-                }
-                if (section & BIT(3)) { // left
-                    if (x - coordCalc >= 0) {
-                        if (y - i >= 0) {
-//                            if (diagonal)
-//                                environment.layout[(y - i) * environment.width + (x - coordCalc) + 1].status = CLEAR_ALL;
-                            tile = TILE_FROM_XY(x - coordCalc, y - i);
-//                            if (environment.layout[tile].status == UNDISCOVERED)
-                                setTileDirtyRadarDirtyBitmap(tile);
-                            environment.layout[tile].status |= statusModifier;
-                            adjustShroudType(x - coordCalc, y - i);
-                        }
-                        if (y + i < environment.height) {
-//                            if (diagonal)
-//                                environment.layout[(y + i) * environment.width + (x - coordCalc) + 1].status = CLEAR_ALL;
-                            tile = TILE_FROM_XY(x - coordCalc, y + i);
-//                            if (environment.layout[tile].status == UNDISCOVERED)
-                                setTileDirtyRadarDirtyBitmap(tile);
-                            environment.layout[tile].status |= statusModifier;
-                            adjustShroudType(x - coordCalc, y + i);
-                        }
-                    }
-                }
-                break;
-            }
-        }
-    }
-    #endif
+    // no enemy unit is nearer than its distance field holds
+    return searchRingsFrom(TILE_FROM_XY(x, y), getDistanceToNearestTarget(DFT_UNITS, ownSide, TILE_FROM_XY(x, y)),
+                           maxRadius ? maxRadius : RING_SEARCH_MAX_RADIUS, unitToAttackOnTile, &search, 0);
 }
 
-
 /*inline*/ void doUnitAttemptToShoot(struct Unit *curUnit, struct UnitInfo *curUnitInfo, int tgt_x, int tgt_y, int randomness) {
     if (randomness>0) {
         int rx=0, ry=0;
@@ -2396,31 +2110,29 @@ inline void doUnitDeath(int unitnr) {
     int tilenrCur, tilenrTo;
     int x, y;
     int aid;
-    int i;
+    int i, next;
+    
+    addInfluenceLoss(curUnit->side, curUnit->x, curUnit->y, curUnitInfo->build_cost);
     
     // any paths stored for this unit should be removed
     #ifndef REMOVE_ASTAR_PATHFINDING
     removePathfindingPath(unitnr);
     #endif
     
-    // if focused on, focus should stop
-    if (focusOnUnitNr == unitnr)
-        focusOnUnitNr = -1;
-    
     // any structure attacking this unit should stop
-    for (i=0; i<MAX_STRUCTURES_ON_MAP; i++) {
-        if (structure[i].enabled && structure[i].logic_aid == unitnr && structure[i].logic >= SL_GUARD_UNIT)
+    FOR_EACH_REFERRER(&structuresByLogicAid, unitnr, i, next) {
+        if (structure[i].enabled && structure[i].logic >= SL_GUARD_UNIT)
             structure[i].logic -= 2;
     }
     // any unit attacking this unit should stop
     aid = TILE_FROM_XY(curUnit->x, curUnit->y);
-    for (i=0; i<MAX_UNITS_ON_MAP; i++) {
-        if (unit[i].enabled && unit[i].logic_aid == unitnr && (unit[i].logic == UL_ATTACK_UNIT || unit[i].logic == UL_GUARD_UNIT)) {
+    FOR_EACH_REFERRER(&unitsByLogicAid, unitnr, i, next) {
+        if (unit[i].enabled && (unit[i].logic == UL_ATTACK_UNIT || unit[i].logic == UL_GUARD_UNIT)) {
             if (getGameType() == SINGLEPLAYER) {
                 if (unit[i].side != FRIENDLY) {
                     if (unit[i].group == UGAI_AMBUSH || unit[i].group == UGAI_HUNT) {
                         unit[i].logic = UL_HUNT;
-                        unit[i].logic_aid = 0;
+                        setUnitLogicAid(unit + i, 0);
                         unit[i].group = UGAI_HUNT;
                     } else if (unit[i].group == UGAI_KAMIKAZE)
                         unit[i].logic = UL_KAMIKAZE;
@@ -2432,7 +2144,7 @@ inline void doUnitDeath(int unitnr) {
             if (unit[i].logic == UL_ATTACK_UNIT) {
                 if (unit[i].group & (UGAI_ATTACK_FORCED | UGAI_ATTACK)) {
                     unit[i].logic = UL_CONTINUE_ATTACK;
-                    unit[i].logic_aid = aid;
+                    setUnitLogicAid(unit + i, aid);
                 } else /*if (unit[j].group & UGAI_GUARD)*/
                     unit[i].logic = UL_GUARD_RETREAT;
             } else {
@@ -2455,15 +2167,15 @@ inline void doUnitDeath(int unitnr) {
         else if (curUnit->move != UM_MOVE_LEFT && curUnit->move != UM_MOVE_RIGHT)
             tilenrTo -= mapWidth;
         if (environment.layout[tilenrTo].contains_unit == (-unitnr) - 2)
-            environment.layout[tilenrTo].contains_unit = -1;
+            setTileUnit(tilenrTo, -1);
     }
     // current tile set to not contain the current unit
     if (environment.layout[tilenrCur].contains_unit == unitnr) {
-        environment.layout[tilenrCur].contains_unit = -1;
+        setTileUnit(tilenrCur, -1);
         // maybe tile should be reserved by a unit which was trying to overrun this dead unit
         i = unitMovingOntoTile(tilenrCur);
         if (i >= 0)
-            environment.layout[tilenrCur].contains_unit = -1 - (i+1);
+            setTileUnit(tilenrCur, -1 - (i+1));
         
         if ((curUnitInfo->type == UT_WHEELED || curUnitInfo->type == UT_TRACKED) &&
             environment.layout[tilenrCur].contains_structure == -1)
@@ -2476,6 +2188,7 @@ inline void doUnitDeath(int unitnr) {
     if (environment.layout[tilenrCur].contains_structure < -1 || environment.layout[tilenrCur].contains_structure >= MAX_DIFFERENT_FACTIONS) {
         setUnitCount(curUnit->side, getUnitCount(curUnit->side) - 1);
         curUnit->enabled = 0;
+        updateUnitGrid(unitnr);
         return;
     }
     
@@ -2485,13 +2198,13 @@ inline void doUnitDeath(int unitnr) {
     addExplosion(x, y, curUnitInfo->explosion_info, 0);
     if (curUnitInfo->graphics_size > SPRITE_SIZE_16) {
         if (x-16 >= 0)
-            addExplosion(x-16, y, curUnitInfo->explosion_info, rand()%6);
+            addExplosion(x-16, y, curUnitInfo->explosion_info, randLogic()%6);
         if (x+16 < mapWidth*16)
-            addExplosion(x+16, y, curUnitInfo->explosion_info, rand()%6);
+            addExplosion(x+16, y, curUnitInfo->explosion_info, randLogic()%6);
         if (y-16 >= 0)
-            addExplosion(x, y-16, curUnitInfo->explosion_info, rand()%6);
+            addExplosion(x, y-16, curUnitInfo->explosion_info, randLogic()%6);
         if (y+16 < environment.height * 16)
-            addExplosion(x, y+16, curUnitInfo->explosion_info, rand()%6);
+            addExplosion(x, y+16, curUnitInfo->explosion_info, randLogic()%6);
     }
     if (curUnitInfo->death_soundeffect >= 0) {
         x = curUnit->x;
@@ -2513,6 +2226,7 @@ inline void doUnitDeath(int unitnr) {
     }
     
     curUnit->enabled = 0;
+    updateUnitGrid(unitnr);
     
     setUnitCount(curUnit->side, getUnitCount(curUnit->side) - 1);
     setUnitDeaths(curUnit->side, getUnitDeaths(curUnit->side) + 1);
@@ -2583,7 +2297,7 @@ void setUnitToAttackDestinationBlockingEntity(struct Unit *curUnit, int dest_x,
                 {
                     // attack this opposing unit
                     curUnit->logic = UL_ATTACK_UNIT;
-                    curUnit->logic_aid = envLayout->contains_unit;
+                    setUnitLogicAid(curUnit, envLayout->contains_unit);
                     return;
                 }
                 structureNr = envLayout->contains_structure;
@@ -2595,7 +2309,7 @@ void setUnitToAttackDestinationBlockingEntity(struct Unit *curUnit, int dest_x,
                 {
                     // attack this opposing structure
                     curUnit->logic = UL_ATTACK_LOCATION;
-                    curUnit->logic_aid = tileCheckNr[(CHECK_BLOCKING_PATH_TILES_WIDTH/2) + j];
+                    setUnitLogicAid(curUnit, tileCheckNr[(CHECK_BLOCKING_PATH_TILES_WIDTH/2) + j]);
                     return;
                 }
                 
@@ -2612,7 +2326,7 @@ void setUnitToAttackDestinationBlockingEntity(struct Unit *curUnit, int dest_x,
 
 void doUnitsLogic() {
     static int frame = 0;
-    int i, j;
+    int i, j, next;
     int rotate;
     int tilenrTo;
     int bestStructureToAttack, closestUnitToAttack;
@@ -2626,11 +2340,13 @@ void doUnitsLogic() {
     
     startProfilingFunction("doUnitsLogic");
     
+    unitsLogicFrame++;
+    updateDistanceFields();
     for (i=0; i<MAX_DIFFERENT_FACTIONS; i++)
         stagingChecked[i] = 0;
     
-    curUnit = &unit[0];
-    for (i=0; i<MAX_UNITS_ON_MAP; i++,curUnit++) {
+    FOR_EACH_USED_ENTITY_POOL_ENTRY(&unitPool, i) {
+        curUnit = unit + i;
         if (curUnit->enabled) {
             
             curUnitInfo = unitInfo + curUnit->info;
@@ -2647,7 +2363,7 @@ void doUnitsLogic() {
                     curUnit->logic = UL_MINE_LOCATION;
                 else if (curUnit->logic == UL_ATTACK_UNIT) {
                     curUnit->logic = UL_MOVE_LOCATION;
-                    curUnit->logic_aid = TILE_FROM_XY(unit[curUnit->logic_aid].x, unit[curUnit->logic_aid].y);
+                    setUnitLogicAid(curUnit, TILE_FROM_XY(unit[curUnit->logic_aid].x, unit[curUnit->logic_aid].y));
                 }
                 #ifdef REMOVE_ASTAR_PATHFINDING
                 curUnit->hugging_obstacle = 0;
@@ -2658,12 +2374,12 @@ void doUnitsLogic() {
             if (getGameType() == SINGLEPLAYER) {
                 if (curUnit->side != FRIENDLY && (curUnit->logic == UL_HUNT || curUnit->logic == UL_KAMIKAZE)) {
                     if (curUnit->logic == UL_HUNT && curUnit->logic_aid > 0)
-                        curUnit->logic_aid--;
+                        setUnitLogicAid(curUnit, curUnit->logic_aid - 1);
                     else {
-                        bestStructureToAttack = getBestStructureToAttackAI();
+                        bestStructureToAttack = getBestStructureToAttackAI(curUnit->side);
                         if (bestStructureToAttack >= 0) {
                             curUnit->logic = UL_ATTACK_LOCATION;
-                            curUnit->logic_aid = TILE_FROM_XY(structure[bestStructureToAttack].x, structure[bestStructureToAttack].y);
+                            setUnitLogicAid(curUnit, TILE_FROM_XY(structure[bestStructureToAttack].x, structure[bestStructureToAttack].y));
                             #ifdef DEBUG_BUILD
                             if (curUnit->logic_aid < 0 || curUnit->logic_aid >= mapWidth * environment.height) errorSI("hunt/kamikaze's bestStructureToAttack's attack-tile", curUnit->logic_aid);
                             #endif
@@ -2674,7 +2390,7 @@ void doUnitsLogic() {
                             closestUnitToAttack = getNearestUnitToAttackAI(curUnit->side, curUnit->x, curUnit->y, 0, 0);
                             if (closestUnitToAttack >= 0) {
                                 curUnit->logic = UL_ATTACK_UNIT;
-                                curUnit->logic_aid = closestUnitToAttack;
+                                setUnitLogicAid(curUnit, closestUnitToAttack);
                                 #ifdef DEBUG_BUILD
                                 if (TILE_FROM_XY(unit[closestUnitToAttack].x, unit[closestUnitToAttack].y) < 0 || TILE_FROM_XY(unit[closestUnitToAttack].x, unit[closestUnitToAttack].y) >= mapWidth * environment.height) errorSI("hunt/kamikaze's closestUnitToAttack's attack-tile", TILE_FROM_XY(unit[closestUnitToAttack].x, unit[closestUnitToAttack].y));
                                 #endif
@@ -2690,7 +2406,7 @@ void doUnitsLogic() {
                         for (j=0; j<MAX_UNITS_ON_MAP; j++) {
                             if (unit[j].group == curUnit->group && unit[j].enabled && unit[j].side != FRIENDLY && ((unit[j].logic == UL_HUNT && unit[j].logic_aid == 0) || unit[j].logic == UL_KAMIKAZE)) {
                                 unit[j].logic     = curUnit->logic;
-                                unit[j].logic_aid = curUnit->logic_aid;
+                                setUnitLogicAid(unit + j, curUnit->logic_aid);
                             }
                         }
                     }
@@ -2718,7 +2434,7 @@ void doUnitsLogic() {
                     j = sideUnitWithinRange(!curUnit->side, curUnit->x, curUnit->y, curUnitInfo->view_range);
                     if (j >= 0) {
                         curUnit->logic = UL_ATTACK_UNIT;
-                        curUnit->logic_aid = j;
+                        setUnitLogicAid(curUnit, j);
                         #ifdef REMOVE_ASTAR_PATHFINDING
                         curUnit->hugging_obstacle = 0;
                         #endif
@@ -2729,21 +2445,21 @@ void doUnitsLogic() {
                 if (curUnit->logic == UL_CONTINUE_ATTACK) {
                     // figure out what to attack. i.e. set a new (ATTACK) logic and logic_aid, remembering the old logic_aid.
                     aid = curUnit->logic_aid;
-                    curUnit->logic_aid = getNearestStructureToAttackAI(curUnit->side, X_FROM_TILE(aid), Y_FROM_TILE(aid), 1, MAX_RADIUS_CONTINUE_ATTACK);
+                    setUnitLogicAid(curUnit, getNearestStructureToAttackAI(curUnit->side, X_FROM_TILE(aid), Y_FROM_TILE(aid), 1, MAX_RADIUS_CONTINUE_ATTACK));
                     if (curUnit->logic_aid >= 0) {
                         curUnit->logic = UL_ATTACK_LOCATION;
-                        curUnit->logic_aid = TILE_FROM_XY(structure[curUnit->logic_aid].x + structureInfo[structure[curUnit->logic_aid].info].width/2, structure[curUnit->logic_aid].y + structureInfo[structure[curUnit->logic_aid].info].height/2);
+                        setUnitLogicAid(curUnit, TILE_FROM_XY(structure[curUnit->logic_aid].x + structureInfo[structure[curUnit->logic_aid].info].width/2, structure[curUnit->logic_aid].y + structureInfo[structure[curUnit->logic_aid].info].height/2));
                     } else {
-                        curUnit->logic_aid = getNearestUnitToAttackAI(curUnit->side, X_FROM_TILE(aid), Y_FROM_TILE(aid), 1, MAX_RADIUS_CONTINUE_ATTACK);
+                        setUnitLogicAid(curUnit, getNearestUnitToAttackAI(curUnit->side, X_FROM_TILE(aid), Y_FROM_TILE(aid), 1, MAX_RADIUS_CONTINUE_ATTACK));
                         if (curUnit->logic_aid >= 0)
                             curUnit->logic = UL_ATTACK_UNIT;
                         else {
-                            curUnit->logic_aid = getNearestStructureToAttackAI(curUnit->side, X_FROM_TILE(aid), Y_FROM_TILE(aid), 0, MAX_RADIUS_CONTINUE_ATTACK);
+                            setUnitLogicAid(curUnit, getNearestStructureToAttackAI(curUnit->side, X_FROM_TILE(aid), Y_FROM_TILE(aid), 0, MAX_RADIUS_CONTINUE_ATTACK));
                             if (curUnit->logic_aid >= 0) {
                                 curUnit->logic = UL_ATTACK_LOCATION;
-                                curUnit->logic_aid = TILE_FROM_XY(structure[curUnit->logic_aid].x + structureInfo[structure[curUnit->logic_aid].info].width/2, structure[curUnit->logic_aid].y + structureInfo[structure[curUnit->logic_aid].info].height/2);
+                                setUnitLogicAid(curUnit, TILE_FROM_XY(structure[curUnit->logic_aid].x + structureInfo[structure[curUnit->logic_aid].info].width/2, structure[curUnit->logic_aid].y + structureInfo[structure[curUnit->logic_aid].info].height/2));
                             } else {
-                                curUnit->logic_aid = getNearestUnitToAttackAI(curUnit->side, X_FROM_TILE(aid), Y_FROM_TILE(aid), 0, MAX_RADIUS_CONTINUE_ATTACK);
+                                setUnitLogicAid(curUnit, getNearestUnitToAttackAI(curUnit->side, X_FROM_TILE(aid), Y_FROM_TILE(aid), 0, MAX_RADIUS_CONTINUE_ATTACK));
                                 if (curUnit->logic_aid >= 0)
                                     curUnit->logic = UL_ATTACK_UNIT;
                                 else {
@@ -2755,10 +2471,10 @@ void doUnitsLogic() {
                     }
                     
                     // find all units which have the same logic_aid (tile it -was- attacking before) and set the logic and logic_aid
-                    for (j=0; j<MAX_UNITS_ON_MAP; j++) {
-                        if (unit[j].enabled && unit[j].logic == UL_CONTINUE_ATTACK && unit[j].logic_aid == aid && unit[j].side == curUnit->side) {
+                    FOR_EACH_REFERRER(&unitsByLogicAid, aid, j, next) {
+                        if (unit[j].enabled && unit[j].logic == UL_CONTINUE_ATTACK && unit[j].side == curUnit->side) {
                             unit[j].logic = curUnit->logic;
-                            unit[j].logic_aid = curUnit->logic_aid;
+                            setUnitLogicAid(unit + j, curUnit->logic_aid);
                             unit[j].guard_tile = TILE_FROM_XY(unit[j].x, unit[j].y);
                         }
                     }
@@ -2786,7 +2502,7 @@ void doUnitsLogic() {
                             // if 'UL_GUARD' when should be 'UL_HUNT' then switch
                             if (curUnit->group == UGAI_HUNT && curUnit->logic == UL_GUARD) {
                                 curUnit->logic = UL_HUNT;
-                                curUnit->logic_aid = 0;
+                                setUnitLogicAid(curUnit, 0);
                             }
                         }
                     }
@@ -2826,7 +2542,7 @@ void doUnitsLogic() {
                                                     unit[j].group &= (~UGAI_STAGING);
                                                     if (unit[j].group == UGAI_HUNT) {
                                                         unit[j].logic = UL_HUNT;
-                                                        unit[j].logic_aid = 0;
+                                                        setUnitLogicAid(unit + j, 0);
                                                     } else if (unit[j].group == UGAI_KAMIKAZE)
                                                         unit[j].logic = UL_KAMIKAZE;
                                                 }
@@ -2852,7 +2568,7 @@ void doUnitsLogic() {
                             }
                         // DarkEz Fix for: Feeders try to collect resource from a rallytile, and won't continue to another tile before that tile is empty and can be attempted to harvest.
                         } else if (curUnit->move == UM_NONE && curUnit->logic == UL_MINE_LOCATION) {
-                            curUnit->logic_aid = TILE_FROM_XY(curUnit->x, curUnit->y); // make current position the tile to try to extract ore from.
+                            setUnitLogicAid(curUnit, TILE_FROM_XY(curUnit->x, curUnit->y)); // make current position the tile to try to extract ore from.
                         } else if (curUnit->move != UM_MOVE_HOLD && curUnit->move != UM_MOVE_HOLD_INITIAL) {
                             curUnit->move_aid = curUnitInfo->speed;
                             rotate = 0;
@@ -3042,7 +2758,7 @@ void doUnitsLogic() {
                         aid = sideUnitWithinShootRange(!curUnit->side, curUnit->x, curUnit->y, curUnitInfo->shoot_range, curUnitInfo->projectile_info);
                         if (aid != -1) {
                             curUnit->logic = UL_GUARD_UNIT;
-                            curUnit->logic_aid = aid;
+                            setUnitLogicAid(curUnit, aid);
                         }
                     }
                 }
@@ -3052,18 +2768,18 @@ void doUnitsLogic() {
                            sideUnitWithinRange(!curUnit->side, curUnit->x, curUnit->y, curUnitInfo->view_range);
                     if (aid != -1) {
                         curUnit->logic = UL_ATTACK_UNIT;
-                        curUnit->logic_aid = aid;
+                        setUnitLogicAid(curUnit, aid);
                     } else if (curUnit->group & UGAI_PATROL) {
-                        if (rand() % UNITS_PATROLLING_MOVE_CHANCE == 0) {
+                        if (randLogic() % UNITS_PATROLLING_MOVE_CHANCE == 0) {
                             curUnit->logic = UL_GUARD_RETREAT;
                             curUnit->guard_tile = curUnit->retreat_tile;
-                            j = (rand() % (2*MAX_RADIUS_PATROLLING + 1)) - MAX_RADIUS_PATROLLING; // adjust y coordinate
+                            j = (randLogic() % (2*MAX_RADIUS_PATROLLING + 1)) - MAX_RADIUS_PATROLLING; // adjust y coordinate
                             if (Y_FROM_TILE(curUnit->retreat_tile) + j < 0)
                                 j = 0;
                             else if (Y_FROM_TILE(curUnit->retreat_tile) + j >= environment.height)
                                 j = environment.height - 1;
                             curUnit->guard_tile += j * mapWidth;
-                            j = (rand() % (2*MAX_RADIUS_PATROLLING + 1)) - MAX_RADIUS_PATROLLING; // adjust x coordinate
+                            j = (randLogic() % (2*MAX_RADIUS_PATROLLING + 1)) - MAX_RADIUS_PATROLLING; // adjust x coordinate
                             if (X_FROM_TILE(curUnit->retreat_tile) + j < 0)
                                 j = 0;
                             else if (X_FROM_TILE(curUnit->retreat_tile) + j >= environment.width)
@@ -3124,7 +2840,7 @@ void doUnitsLogic() {
                 curUnit->move_aid--;
                 if (curUnit->move_aid == curUnitInfo->speed/2) {
                     setTileDirtyRadarDirtyBitmap(TILE_FROM_XY(curUnit->x, curUnit->y));
-                    environment.layout[TILE_FROM_XY(curUnit->x, curUnit->y)].contains_unit = -1;
+                    setTileUnit(TILE_FROM_XY(curUnit->x, curUnit->y), -1);
                     switch (curUnit->move) {
                         case UM_MOVE_LEFT_UP:
                             curUnit->x -= 1;
@@ -3156,6 +2872,7 @@ void doUnitsLogic() {
                             break;
                         default: break;
                     }
+                    updateUnitGrid(i);
                     if (environment.layout[TILE_FROM_XY(curUnit->x, curUnit->y)].contains_unit >= 0) { // must've been infantry now run over
                         unit[environment.layout[TILE_FROM_XY(curUnit->x, curUnit->y)].contains_unit].armour = 0;
                         addOverlay(curUnit->x, curUnit->y, OT_BLOOD, 0);
@@ -3166,12 +2883,13 @@ void doUnitsLogic() {
                     if (j < -1)
                         j = environment.layout[TILE_FROM_XY(curUnit->x + j + 1, curUnit->y)].contains_structure;
                     if (j >= 0 && !structureInfo[structure[j].info].foundation) { // unit entered a structure
-                        environment.layout[TILE_FROM_XY(curUnit->x, curUnit->y)].contains_unit = -1;
+                        setTileUnit(TILE_FROM_XY(curUnit->x, curUnit->y), -1);
                         curUnit->selected = 0;
                         curUnit->move = UM_NONE;
                         curUnit->move_aid = 0;
                         curUnit->x = structure[j].x + structureInfo[structure[j].info].release_tile;
                         curUnit->y = structure[j].y + structureInfo[structure[j].info].height - 1;
+                        updateUnitGrid(i);
                         curUnit->unit_positioned = DOWN;
                         if (structure[j].contains_unit >= 0) // structure already contains a unit
                             dropUnit(i, structure[j].x + structureInfo[structure[j].info].release_tile, structure[j].y + structureInfo[structure[j].info].height - 1);
@@ -3181,17 +2899,17 @@ void doUnitsLogic() {
 //                              environment.layout[curUnit->y*mapWidth + curUnit->x].contains_unit = i;
                             
                             // any structure attacking this unit should stop
-                            for (j=0; j<MAX_STRUCTURES_ON_MAP; j++) {
-                                if (structure[j].enabled && structure[j].logic >= SL_GUARD_UNIT && structure[j].logic_aid == i)
+                            FOR_EACH_REFERRER(&structuresByLogicAid, i, j, next) {
+                                if (structure[j].enabled && structure[j].logic >= SL_GUARD_UNIT)
                                     structure[j].logic -= 2;
                             }
                             
                             // any unit attacking this unit should either stop or divert its attention to the structure
-                            for (j=0; j<MAX_UNITS_ON_MAP; j++) {
-                                if (unit[j].enabled && unit[j].logic_aid == i) {
+                            FOR_EACH_REFERRER(&unitsByLogicAid, i, j, next) {
+                                if (unit[j].enabled) {
                                     if (unit[j].logic == UL_ATTACK_UNIT) {
                                         unit[j].logic = UL_ATTACK_LOCATION;
-                                        unit[j].logic_aid = TILE_FROM_XY(curUnit->x, curUnit->y);
+                                        setUnitLogicAid(unit + j, TILE_FROM_XY(curUnit->x, curUnit->y));
                                     }
                                     if (unit[j].logic == UL_GUARD_UNIT)
                                         unit[j].logic = UL_GUARD_RETREAT;
@@ -3199,7 +2917,7 @@ void doUnitsLogic() {
                             }
                         }
                     } else {
-                        environment.layout[TILE_FROM_XY(curUnit->x, curUnit->y)].contains_unit = i;
+                        setTileUnit(TILE_FROM_XY(curUnit->x, curUnit->y), i);
                         setTileDirtyRadarDirtyBitmap(TILE_FROM_XY(curUnit->x, curUnit->y));
                         if (curUnit->side == FRIENDLY)
                             activateUnitMoveView(curUnit->x, curUnit->y, curUnit->move, curUnitInfo->view_range);
@@ -3298,11 +3016,11 @@ void doUnitsLogic() {
                                    (environment.layout[TILE_FROM_XY(curUnit->x, curUnit->y)].ore_level <= 0)) { // move to a nearby place to ore and mine that. otherwise continue mining here.
                             tilenrTo = getNextTile(curUnit->x, curUnit->y, curUnit->unit_positioned + 1);
                             if (isEnvironmentTileBetween(tilenrTo, ORE, OREHILL16) && environment.layout[tilenrTo].contains_unit == -1)
-                                curUnit->logic_aid = tilenrTo;
+                                setUnitLogicAid(curUnit, tilenrTo);
                             else {
                                 tilenrTo = nearestEnvironmentTileUnoccupied(TILE_FROM_XY(curUnit->x, curUnit->y), ORE, OREHILL16);
                                 if (tilenrTo >= 0)
-                                    curUnit->logic_aid = tilenrTo;
+                                    setUnitLogicAid(curUnit, tilenrTo);
                                 else if (environment.layout[TILE_FROM_XY(curUnit->x, curUnit->y)].ore_level <= 0) // no other place to harvest
                                     curUnit->logic = UL_RETREAT;
                             }
@@ -3324,7 +3042,7 @@ void doUnitsLogic() {
                     if (curUnit->smoke_time > -UNITS_IDLE_TIME_THRESHHOLD) // concerning idling
                         curUnit->smoke_time--;
                     else if (curUnit->smoke_time == -UNITS_IDLE_TIME_THRESHHOLD) { // maybe let the unit start looking around out of boredom
-                        if ((rand() % /*UNITS_IDLE_CHANCE*/ (curUnitInfo->idle_ani / getGameSpeed())) == 0 &&
+                        if ((randLogic() % /*UNITS_IDLE_CHANCE*/ (curUnitInfo->idle_ani / getGameSpeed())) == 0 &&
                             (curUnit->move == UM_MOVE_HOLD || (curUnit->move == UM_NONE && (curUnit->logic == UL_GUARD || curUnit->logic == UL_GUARD_AREA || curUnit->logic == UL_AMBUSH || curUnit->logic == UL_MOVE_LOCATION)))) {
                             if (curUnitInfo->can_rotate_turret)
                                 curUnit->move = (curUnit->move == UM_MOVE_HOLD) ? UM_IDLE_TURRET1_HOLD : UM_IDLE_TURRET1;
@@ -3360,16 +3078,16 @@ void doUnitsLogic() {
 //                if (getGameType() == SINGLEPLAYER) {
                     if (curUnitReinforcement->side != FRIENDLY) {
                         curUnit->logic = UL_HUNT;
-                        curUnit->logic_aid = 1;
+                        setUnitLogicAid(curUnit, 1);
                         curUnit->group = UGAI_HUNT;
                     } else {
                         // (curUnitReinforcement->side == FRIENDLY and as such this unit is used as Reinforcement moving to a target location)
                         curUnit->logic = UL_MOVE_LOCATION;
-                        curUnit->logic_aid = curUnitReinforcement->logic_aid;
+                        setUnitLogicAid(curUnit, curUnitReinforcement->logic_aid);
                         curUnit->group = 0;
                         
                         curUnit->guard_tile   = curUnit->logic_aid;
-                        curUnit->retreat_tile = curUnit->logic_aid;
+                        setUnitRetreatTile(curUnit, curUnit->logic_aid);
                         
                         /*
                         // guard 1st friendly structure (should be HQ?)
@@ -3378,7 +3096,7 @@ void doUnitsLogic() {
                             if (structure[k].side == FRIENDLY) {
                                 curUnit->guard_tile = environment.width * (structure[k].y + structureInfo[structure[k].info].height/2)+
                                                       structure[k].x + structureInfo[structure[k].info].width/2;
-                                curUnit->retreat_tile = curUnit->guard_tile;
+                                setUnitRetreatTile(curUnit, curUnit->guard_tile);
                                 break;
                             }
                         }
@@ -3424,7 +3142,7 @@ void doUnitLogicHit(int nr, int projectileSourceTile) {
             structureNrWhichShot = environment.layout[projectileSourceTile].contains_structure;
             if (unitNrWhichShot >= 0 && !unit[unitNrWhichShot].side != !unit[nr].side) {
                 unit[nr].logic = UL_ATTACK_UNIT;
-                unit[nr].logic_aid = unitNrWhichShot;
+                setUnitLogicAid(unit + nr, unitNrWhichShot);
                 #ifdef REMOVE_ASTAR_PATHFINDING
                 unit[nr].hugging_obstacle = 0;
                 #endif
@@ -3439,7 +3157,7 @@ void doUnitLogicHit(int nr, int projectileSourceTile) {
                 if (structureNrWhichShot < -1) structureNrWhichShot = environment.layout[projectileSourceTile + structureNrWhichShot + 1].contains_structure;
                 if (!structure[structureNrWhichShot].side != !unit[nr].side) {
                     unit[nr].logic = UL_ATTACK_LOCATION;
-                    unit[nr].logic_aid = projectileSourceTile;
+                    setUnitLogicAid(unit + nr, projectileSourceTile);
                     #ifdef REMOVE_ASTAR_PATHFINDING
                     unit[nr].hugging_obstacle = 0;
                     #endif
@@ -3462,7 +3180,7 @@ void doUnitLogicHit(int nr, int projectileSourceTile) {
                         unitInfo[unit[i].info].shoot_range > 0 && !unitInfo[unit[i].info].can_heal_foot) {
                         if (unit[i].logic == UL_GUARD || unit[i].logic == UL_GUARD_RETREAT || unit[i].move == UM_MOVE_HOLD) {
                             unit[i].logic = UL_ATTACK_UNIT;
-                            unit[i].logic_aid = unitNrWhichShot;
+                            setUnitLogicAid(unit + i, unitNrWhichShot);
                             unit[i].group = (unit[i].group & (~UGAI_FRIENDLY_MASK)) | UGAI_GUARD;
                         }
                         if (unit[i].logic == UL_ATTACK_LOCATION && !(unit[i].group & UGAI_ATTACK_FORCED)) {
@@ -3472,7 +3190,7 @@ void doUnitLogicHit(int nr, int projectileSourceTile) {
                                 structureCurrentlyShootingAt = environment.layout[unit[i].logic_aid + (structureCurrentlyShootingAt + 1)].contains_structure;
                             if (structureCurrentlyShootingAt >= 0 && structureInfo[structure[structureCurrentlyShootingAt].info].shoot_range <= 0) {
                                 unit[i].logic = UL_ATTACK_UNIT;
-                                unit[i].logic_aid = unitNrWhichShot;
+                                setUnitLogicAid(unit + i, unitNrWhichShot);
                             }
                         }
                     }
@@ -3503,7 +3221,7 @@ void doUnitLogicHit(int nr, int projectileSourceTile) {
                         unit[nr].logic = UL_GUARD_RETREAT;
                     else { // can't move away in this direction. let's freak out and attack.
                         unit[nr].logic = UL_ATTACK_LOCATION;
-                        unit[nr].logic_aid = projectileSourceTile;
+                        setUnitLogicAid(unit + nr, projectileSourceTile);
                         unit[nr].group = (unit[nr].group & (~UGAI_FRIENDLY_MASK)) | UGAI_GUARD;
                     }
                 }
@@ -3518,7 +3236,7 @@ void doUnitLogicHit(int nr, int projectileSourceTile) {
                             unitInfo[unit[i].info].shoot_range > 0 && !unitInfo[unit[i].info].can_heal_foot) {
                             if (unit[i].logic == UL_GUARD || unit[i].logic == UL_GUARD_RETREAT || (unit[nr].move == UM_MOVE_HOLD && unit[i].logic != UL_ATTACK_LOCATION)) {
                                 unit[i].logic = UL_ATTACK_LOCATION;
-                                unit[i].logic_aid = projectileSourceTile;
+                                setUnitLogicAid(unit + i, projectileSourceTile);
                                 unit[i].group = (unit[i].group & (~UGAI_FRIENDLY_MASK)) | UGAI_GUARD;
                             }
                             if (unit[i].logic == UL_ATTACK_LOCATION && !(unit[i].group & UGAI_ATTACK_FORCED)) {
@@ -3528,7 +3246,7 @@ void doUnitLogicHit(int nr, int projectileSourceTile) {
                                     structureCurrentlyShootingAt = environment.layout[unit[i].logic_aid + (structureCurrentlyShootingAt + 1)].contains_structure;
                                 if (structureCurrentlyShootingAt >= MAX_DIFFERENT_FACTIONS && structureInfo[structure[structureCurrentlyShootingAt].info].shoot_range <= 0) {
                                     unit[i].logic = UL_ATTACK_LOCATION;
-                                    unit[i].logic_aid = projectileSourceTile;
+                                    setUnitLogicAid(unit + i, projectileSourceTile);
                                 }
                             }
                         }
@@ -3542,17 +3260,16 @@ void doUnitLogicHit(int nr, int projectileSourceTile) {
 void doUnitsSelectAll() {
     int i;
     struct UnitInfo *curUnitInfo;
-    struct Unit *curUnit = &unit[0];
+    struct Unit *curUnit;
     
     // select all FRIENDLY units, other than collectors. deselect ENEMY units too.
-    for (i=0; i<MAX_UNITS_ON_MAP; i++,curUnit++) {
-        if (curUnit->enabled) {
-            if (curUnit->side==FRIENDLY) {
-                curUnitInfo = unitInfo + curUnit->info;
-                curUnit->selected=!curUnitInfo->can_collect_ore;
-            } else {
-                curUnit->selected=0;  // enemy unit
-            }
+    FOR_EACH_USED_ENTITY_POOL_ENTRY(&unitPool, i) {
+        curUnit = unit + i;
+        if (curUnit->side==FRIENDLY) {
+            curUnitInfo = unitInfo + curUnit->info;
+            curUnit->selected=!curUnitInfo->can_collect_ore;
+        } else {
+            curUnit->selected=0;  // enemy unit
         }
     }
 
@@ -9,6 +9,7 @@
 #include "environment.h"
 #include "projectiles.h"
 #include "pathfinding.h"
+#include "referrers.h"
 #include "settings.h"
 #include "shared.h"
 
@@ -26,6 +27,10 @@
 #define MAX_RADIUS_ATTACK_AREA              2
 #define UNITS_PATROLLING_MOVE_CHANCE       (3 * FPS)
 
+// units are kept track of in a grid of cells of 8x8 tiles, to quickly find the units within a range
+#define UNIT_GRID_SHIFT       3
+#define MAX_UNIT_GRID_CELLS   (MAX_TILES_ENVIRONMENT/64 + MAX_TILES_ENVIRONMENT/8 + 1) /* enough for any width and height of the map */
+
 #define MAX_ORED_BY_UNIT      5*(MAX_ENVIRONMENT_ORE_LEVEL/2)
 #define MAX_TIME_TO_ORE_TILE  ((2*((((5*(MAX_ENVIRONMENT_ORE_LEVEL/2)) * FPS) / 60) / 2)) / getGameSpeed())
 
@@ -52,11 +57,16 @@ enum UnitGroupAI { UGAI_AMBUSH = BIT(0), UGAI_GUARD_AREA = BIT(1), UGAI_HUNT = B
 #define UGAI_FRIENDLY_MASK  (UGAI_ATTACK_FORCED | UGAI_ATTACK | UGAI_GUARD)
 
 
+// the names and descriptions are kept apart, in unitInfoText, as only the info screen and menus and the loading of
+// a scenario read these. the game logic and the drawing of units go through unitInfo for every unit, every frame
+struct UnitInfoText {
+    char name[MAX_UNIT_NAME_LENGTH+1];
+    char description[MAX_DESCRIPTION_LENGTH+1];
+};
+
 struct UnitInfo {
     int enabled;
-    char name[MAX_UNIT_NAME_LENGTH+1];
     enum UnitType type;
-    char description[MAX_DESCRIPTION_LENGTH+1];
     int build_time; /* --seconds-- frames */
     int build_cost;
     int repair_time;
@@ -93,11 +103,15 @@ struct UnitInfo {
 };
 
 struct Unit {
-    int enabled;
+    unsigned char  enabled;
+    unsigned char  selected;
+    unsigned char  side;               /* enum Side: friendly or enemy */
+    unsigned char  logic;              /* enum UnitLogic: long-term logic, so to speak */
+    unsigned char  unit_positioned;    /* enum Positioned */
+    unsigned char  turret_positioned;  /* enum Positioned */
+    unsigned short move;               /* enum UnitMove: specifies the move the unit needs to make - needs to be done before other actions can be performed */
     int info; /* used as a reference to a UnitInfo */
     int group;
-    int selected;
-    enum Side side; /* friendly or enemy */
     int x;
     int y;
     short int guard_tile;
@@ -105,11 +119,7 @@ struct Unit {
     int armour;
     short int ore;
     short int contains; /* used as a reference to either a unit or structure */
-    enum Positioned unit_positioned;
-    enum Positioned turret_positioned;
-    enum UnitLogic logic; /* long-term logic, so to speak */
     int logic_aid; /* position or unit for long-term logic */
-    enum UnitMove move; /* specifies the move the unit needs to make - needs to be done before other actions can be performed */
     int move_aid;
     #ifdef REMOVE_ASTAR_PATHFINDING
     int hugging_obstacle; /* < 0 means keeping the obstacle on the right, > 0 on the left */
@@ -120,6 +130,10 @@ struct Unit {
     int multiplayer_id;
 };
 
+// the records gone through every frame. a data cache line of the DS is 32 bytes
+_Static_assert(sizeof(struct Unit) <= 2*32, "struct Unit no longer fits two cache lines");
+_Static_assert(sizeof(struct UnitInfo) <= 5*32, "struct UnitInfo no longer fits five cache lines");
+
 
 void initUnits();
 void initUnitsWithScenario();
@@ -127,12 +141,29 @@ void initUnitsWithScenario();
 int getUnitNameInfo(char *buffer);
 
 int freeToMoveUnitViaTile(struct Unit *current, int tile);
+int freeToPlaceUnitOnTile(struct Unit *current, int tile);
 int getNextTile(int curX, int curY, enum UnitMove move);
 int unitMovingOntoTileBesides(int tile, int exceptionUnitNr);
 int isTileBlockedByOtherUnit(struct Unit *current, int tile);
+int nearestEnvironmentTile(int curTile, enum EnvironmentTileGraphics graphicsMin, enum EnvironmentTileGraphics graphicsMax);
+int nearestEnvironmentTileUnoccupied(int curTile, enum EnvironmentTileGraphics graphicsMin, enum EnvironmentTileGraphics graphicsMax);
+
+void initUnitGrid();
+void updateUnitGrid(int unitnr);
+int getUnitGridCell(int x, int y);
+int getUnitGridWidth();
+int getUnitGridHeight();
+int getUnitHandle(int unitnr);
+int getUnitOfHandle(int handle);
+
+// the units listed by the unit or tile their logic_aid holds, and by their retreat_tile. both are set through these
+void initUnitReferrers();
+void setUnitLogicAid(struct Unit *curUnit, int logic_aid);
+void setUnitRetreatTile(struct Unit *curUnit, int retreat_tile);
 
 int dropUnit(int unitnr, int x, int y);
 int addUnit(enum Side side, int x, int y, int info, int forced);
+int deployUnit(int unitnr);
 
 void drawUnitWithShift(int unitnr, int x_add, int y_add);
 void drawUnit(int unitnr);
@@ -153,7 +184,12 @@ int getFocusOnUnitNr();
 void setFocusOnUnitNr(int nr);
 
 extern struct UnitInfo unitInfo[];
+extern struct UnitInfoText unitInfoText[];
 extern struct Unit unit[];
+extern s16 unitGridFirst[]; // per cell, the first unit in it (or -1)
+extern s16 unitGridNext[];  // per unit, the next unit in the same cell (or -1)
+extern struct Referrers unitsByLogicAid;
+extern struct Referrers unitsByRetreatTile;
 
 struct UnitReinforcement *getUnitsReinforcements();
 int getUnitsSaveSize(void);